@@ -24,6 +24,14 @@ public:
     // Must be implemented by each action
     virtual void init() = 0;
     virtual void loop() = 0;
+
+    // Lifecycle hooks called by ActionHandler. onEnter and onResume run
+    // before the next loop(), onSuspend and onExit run at the transition.
+    // By default entering and resuming both redo init().
+    virtual void onEnter() { init(); }   // Activated with fresh params
+    virtual void onSuspend() {}          // Another action was pushed on top
+    virtual void onResume() { init(); }  // Back on top after popAction()
+    virtual void onExit() {}             // Popped, or replaced by activateRun()
 };
 
 #endif
\ No newline at end of file
@@ -17,16 +17,25 @@ class StickConfigMenuAction;
 class StickModeMenuAction;
 class TriggerConfigMenuAction;
 class TriggerModeMenuAction;
+class ProfileBindingsMenuAction;
 struct TextInputActionParams;
 
 class ActionHandler
 {
 private:
+    // Hook still owed to the current action, run at the start of loop()
+    enum class PendingHook : uint8_t
+    {
+        NONE,
+        ENTER,
+        RESUME
+    };
+
     static const int MAX_ACTION_STACK_SIZE = 16;
 
     DeviceManager *devices;
     Action *currentAction;
-    bool actionInitialized;
+    PendingHook pendingHook;
     char lastRunFilename[64];
 
     // Action stack for navigation
@@ -45,9 +54,11 @@ private:
     StickModeMenuAction *stickModeMenuAction;
     TriggerConfigMenuAction *triggerConfigMenuAction;
     TriggerModeMenuAction *triggerModeMenuAction;
+    ProfileBindingsMenuAction *profileBindingsMenuAction;
 
     void pushAction(Action *action);
     void replaceCurrentAction(Action *action);
+    void exitAll();
 
 public:
     ActionHandler(DeviceManager *dev);
@@ -65,6 +76,7 @@ public:
     void activateStickModeMenu(StickConfigActionParams params);
     void activateTriggerConfigMenu();
     void activateTriggerModeMenu();
+    void activateProfileBindingsMenu();
 
     // Get current action (returns nullptr if none active)
     Action *getCurrentAction() { return currentAction; }
@@ -75,8 +87,25 @@ public:
     void popAction();        // Go back to previous action
     void popToRunAction();   // Pop all actions back to Run (base action)
 
-    void setup();
+    // Start the Run action with a profile; an empty filename keeps the
+    // profile already in mappingConfig (restored from flash)
+    void setup(const char *bootProfile = "/Default.json");
     void loop();
+
+    // The SD card came up after setup() (fast boot)
+    void onStorageReady();
+
+    // Map and queue the reports once; the input tier's frame, safe from its interrupt
+    void inputFrame();
+
+    // Send what the input frames queued for USB; from loop()
+    void sendReports();
+
+    // Hand the pad's edited profile to the running mapping engine
+    bool publishConfig(int pad);
+
+    // Load profile JSON from memory into the pad's config and publish it
+    bool loadProfile(int pad, const char *json, size_t length, const char *filename);
     void clearAction();
 };
 
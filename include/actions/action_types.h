@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include <cstdint>
 #include "utils.h"
+#include "logging/log.h"
 
 enum class ActionType : uint8_t
 {
@@ -50,44 +51,55 @@ enum class StickId : uint8_t
     RIGHT_STICK = 1
 };
 
+// Profiles are plain data: what is pressed, turbo phases and timers live in
+// MappingPipeline, so a config can be copied between pads and caches freely.
+// Fields are ordered largest first so the compiler adds no padding; keycodes
+// are Teensy KEY_* codes and the 0xE8xx/0xE9xx ranges, all 16 bit.
+
 struct ButtonMapping
 {
-    uint8_t genericButton;
-    int keyCode;
-    bool currentlyPressed;
+    static const uint16_t NO_MACRO = 0xFFFF;
+    static const uint8_t MAX_TURBO_RATE = 30;
+    static const uint8_t MIN_TURBO_DUTY = 10;
+    static const uint8_t MAX_TURBO_DUTY = 90;
+    static const uint16_t DEFAULT_HOLD_TIME = 200;
+
+    uint32_t chordButtons = 0; // Other generic buttons that must be held as well (bitmask)
+    uint16_t keyCode = 0;
+    uint16_t holdKeyCode = 0;  // Sent when held past holdTime, keyCode is sent on a tap (0 = not tap-hold)
+    uint16_t holdTime = DEFAULT_HOLD_TIME; // Tap/hold decision time in ms
+    uint16_t macro = NO_MACRO; // Offset of the macro in JoystickMappingConfig::macroCode, replaces keyCode
+    uint8_t genericButton = 0;
+    uint8_t layer = 0;         // Layer the mapping belongs to (0 = base layer)
+    uint8_t turboRate = 0;     // Autofire pulses per second while held (0 = off)
+    uint8_t turboDuty = 50;    // Percentage of each pulse the key is down
 };
 
 // Analog stick configuration
 struct StickConfig
 {
-    StickBehavior behavior = StickBehavior::DISABLED;
     float sensitivity = 0.15f;
-    int deadzone = 16;
-    int activationThreshold = 64;
-
-    int keyUp = KEY_UP;
-    int keyDown = KEY_DOWN;
-    int keyLeft = KEY_LEFT;
-    int keyRight = KEY_RIGHT;
-
-    bool upPressed = false;
-    bool downPressed = false;
-    bool leftPressed = false;
-    bool rightPressed = false;
+
+    uint16_t keyUp = KEY_UP;
+    uint16_t keyDown = KEY_DOWN;
+    uint16_t keyLeft = KEY_LEFT;
+    uint16_t keyRight = KEY_RIGHT;
+
+    StickBehavior behavior = StickBehavior::DISABLED;
+    uint8_t deadzone = 16;
+    uint8_t activationThreshold = 64;
 };
 
 struct TriggerConfig
 {
-    TriggerBehavior behavior = TriggerBehavior::DISABLED;
     float sensitivity = 0.15f;
-    int deadzone = 16;
-    int activationThreshold = 64;
 
-    int keyLeft = KEY_LEFT;
-    int keyRight = KEY_RIGHT;
+    uint16_t keyLeft = KEY_LEFT;
+    uint16_t keyRight = KEY_RIGHT;
 
-    bool leftPressed = false;
-    bool rightPressed = false;
+    TriggerBehavior behavior = TriggerBehavior::DISABLED;
+    uint8_t deadzone = 16;
+    uint8_t activationThreshold = 64;
 };
 
 // Complete joystick mapping configuration
@@ -95,19 +107,41 @@ struct JoystickMappingConfig
 {
     static const int MAX_MAPPINGS = 32;
     static const int MAX_FILENAME_LENGTH = 64;
+    static const int MAX_LAYERS = 4;
+    static const int MAX_MACRO_BYTES = 512;
+    static const int MAX_DISPLAY_NAME_LENGTH = 21; // One LCD row
 
-    char filename[MAX_FILENAME_LENGTH];
-    char displayName[MAX_FILENAME_LENGTH];
     ButtonMapping mappings[MAX_MAPPINGS];
     int numMappings;
     StickConfig leftStick;
     StickConfig rightStick;
     TriggerConfig triggers;
+
+    // Compiled macros for all mappings (see mapping/macro.h)
+    int macroCodeSize;
+    uint8_t macroCode[MAX_MACRO_BYTES];
+
+    // Layers: holding layerButtons[n] switches to layer n (layer 0 is the base)
+    int numLayers;
+    uint8_t layerButtons[MAX_LAYERS];
+
+    // Match tables, rebuilt by MappingConfig::prepareMatching()
+    uint32_t layerButtonMask;                // All layer buttons
+    uint32_t matchButtons[MAX_MAPPINGS];     // Buttons each entry of matchOrder needs held
+    uint32_t matchGroupStart;                // Bit k set where a smaller chord size begins
+    uint8_t matchOrder[MAX_MAPPINGS];        // Mapping indices by layer, larger chords first
+    uint8_t layerStart[MAX_LAYERS + 1];      // Range of each layer in matchOrder
+
+    char filename[MAX_FILENAME_LENGTH];
+    char displayName[MAX_DISPLAY_NAME_LENGTH]; // filename without path and extension, cut to the LCD
     bool modified; // Flag to track if config has been changed since loading
 
-    JoystickMappingConfig() : numMappings(0), modified(false)
+    JoystickMappingConfig() : numMappings(0), macroCodeSize(0), numLayers(1), layerButtonMask(0), modified(false)
     {
         filename[0] = '\0';
+        displayName[0] = '\0';
+        layerStart[0] = 0;
+        layerStart[1] = 0;
     }
 
     void setFilename(const char *newName)
@@ -115,17 +149,20 @@ struct JoystickMappingConfig
         strncpy(filename, newName, MAX_FILENAME_LENGTH - 1);
         filename[MAX_FILENAME_LENGTH - 1] = '\0';
 
-        Utils::trimFilenameToBuffer(filename, displayName, MAX_FILENAME_LENGTH);
+        Utils::trimFilenameToBuffer(filename, displayName, MAX_DISPLAY_NAME_LENGTH);
 
-        Serial.print("Setting filename to: ");
-        Serial.println(newName);
-        Serial.print("Saved filename as: ");
-        Serial.println(filename);
-        Serial.print("Display name as: ");
-        Serial.println(displayName);
+        LOG_DEBUG("Config: Filename %s", filename);
+        LOG_DEBUG("Config: Display name %s", displayName);
     }
 };
 
+// Size budgets: several profiles are kept in RAM (one per pad plus the
+// binding cache) and one is mirrored to flash, so growth should be deliberate
+static_assert(sizeof(ButtonMapping) == 16, "ButtonMapping grew past 16 bytes");
+static_assert(sizeof(StickConfig) <= 16, "StickConfig grew past 16 bytes");
+static_assert(sizeof(TriggerConfig) <= 12, "TriggerConfig grew past 12 bytes");
+static_assert(sizeof(JoystickMappingConfig) <= 1344, "JoystickMappingConfig grew past its budget");
+
 struct RunActionParams
 {
     char filename[JoystickMappingConfig::MAX_FILENAME_LENGTH];
@@ -154,7 +191,10 @@ struct BindKeyActionParams
     bool isRightStick; // true for right stick, false for left stick (only used for STICK_* targets)
 };
 
-// Global joystick mapping configuration instance
-extern JoystickMappingConfig mappingConfig;
+// Per-pad mapping configurations (one per connected controller)
+extern JoystickMappingConfig padConfigs[];
+
+// Configuration of the first pad, the one edited through the menus
+extern JoystickMappingConfig &mappingConfig;
 
 #endif
\ No newline at end of file
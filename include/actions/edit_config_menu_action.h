@@ -10,6 +10,7 @@ private:
 
     void buildMenuItems();
     String getButtonKeyPair(int index);
+    void changeTurboRate(bool isDecrease);
 
 public:
     EditConfigMenuAction(DeviceManager *dev, ActionHandler *hdlr);
@@ -20,6 +21,10 @@ public:
     // Implement pure virtual methods from MenuAction
     void onInit() override;
     void onConfirm() override;
+
+    // Left/right steps the turbo rate of the selected mapping
+    void onLeft() override;
+    void onRight() override;
 };
 
 #endif // EDIT_CONFIG_MENU_ACTION_H
\ No newline at end of file
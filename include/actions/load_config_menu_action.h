@@ -2,6 +2,7 @@
 #define LOAD_CONFIG_MENU_ACTION_H
 
 #include "actions/menu_action.h"
+#include "storage/storage.h"
 
 class LoadConfigMenuAction : public MenuAction
 {
@@ -10,7 +11,13 @@ private:
     static const int MAX_FILENAME_LEN = 32;  // Max length for full path+filename
     char configFiles[MAX_CONFIG_FILES][MAX_FILENAME_LEN]; // Store full filenames with path
 
+    // The last successful scan is reused until a save changes the card
+    bool scanValid;
+    uint32_t scanFileChangeCount;
+    int scanCount;
+
     void scanConfigFiles();
+    static void onListEntry(void *context, const char *filename, const StorageStat &stat);
     void sortConfigFiles(int count);
 
 public:
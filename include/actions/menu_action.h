@@ -6,6 +6,7 @@
 #include <USBHost_t36.h>
 #include "actions/action.h"
 #include "actions/action_handler.h"
+#include "input/gamepad_input.h"
 
 struct MenuItem
 {
@@ -77,6 +78,7 @@ class MenuAction : public Action
 protected:
     static const int MAX_ITEMS = 32; // Match JoystickMappingConfig::MAX_MAPPINGS
     static const int MAX_TITLE_LEN = 20;
+    static const int PAGE_SIZE = 3; // Visible item rows
 
     char menuTitle[MAX_TITLE_LEN];
     MenuItem menuItems[MAX_ITEMS];
@@ -85,13 +87,25 @@ protected:
     int selectedIndex;
     int scrollOffset;
 
+    // What this menu last wrote to the LCD, so repaints only send changed
+    // characters. Invalid after anything else has drawn on the screen.
+    static const int LCD_COLS = 20;
+    static const int LCD_ROWS = 4;
+    char shownRows[LCD_ROWS][LCD_COLS + 1];
+    bool screenValid;
+    void drawRow(int row, char marker, const char *text);
+
     // Timeout tracking
-    unsigned long lastInputTime;
+    int timeoutTimer;
+    bool timedOut;
     static const unsigned long TIMEOUT_MS = 30000;
+    static void onTimeout(void *context, uint32_t data);
 
     // Protected methods for derived classes
     void moveUp();
     void moveDown();
+    void moveBy(int delta);
+    void handleInput(const InputEvent &event);
     void updateScrollOffset();
     void displayMenu();
     void resetTimeout();
@@ -104,6 +118,9 @@ public:
     // Action lifecycle methods
     void init() override;
     void loop() override;
+    void onSuspend() override;
+    void onResume() override;
+    void onExit() override;
 
     // Pure virtual methods that derived classes must implement
     virtual void onInit() {};
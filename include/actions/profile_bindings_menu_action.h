@@ -0,0 +1,20 @@
+#ifndef PROFILE_BINDINGS_MENU_ACTION_H
+#define PROFILE_BINDINGS_MENU_ACTION_H
+
+#include "actions/menu_action.h"
+
+// Lists the controller -> profile bindings. The first item binds the pad
+// plugged in as pad 1 to the loaded config; confirming a binding removes it.
+class ProfileBindingsMenuAction : public MenuAction
+{
+private:
+    void buildMenuItems();
+
+public:
+    ProfileBindingsMenuAction(DeviceManager *dev, ActionHandler *hdlr);
+
+    void onInit() override;
+    void onConfirm() override;
+};
+
+#endif // PROFILE_BINDINGS_MENU_ACTION_H
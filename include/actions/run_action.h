@@ -3,25 +3,55 @@
 
 #include "actions/action.h"
 #include "actions/action_types.h"
+#include "actions/tuning_overlay.h"
 #include "mapping/joystick_mappings.h"
+#include "mapping/mapping_pipeline.h"
+#include "mapping/macro_engine.h"
+#include "output/hid_output.h"
+#include "devices.h"
+#include "timing/timer_wheel.h"
 
 class RunAction : public Action
 {
 private:
     RunActionParams params;
 
-    // Controller info
-    JoystickController::joytype_t controllerType;
+    // One pipeline per controller, merged into a single HID output
+    MappingPipeline pipelines[DeviceManager::MAX_JOYSTICKS];
+    LiveConfig liveConfigs[DeviceManager::MAX_JOYSTICKS]; // What each pipeline runs; padConfigs are the shadows
+    int numPipelines;
+    bool bootBindingsApplied;
+    HidOutput output;
+    MacroEngine macros;
 
-    // Mouse/scroll update timing
-    unsigned long lastStickUpdate;
-    unsigned long stickUpdateInterval;
-    unsigned long lastTriggerUpdate;
-    unsigned long backlightOnTime;
+    // Input frame state: its own timers, advanced by the frame. The frame
+    // maps only while mapping is set; everything that changes pipelines,
+    // output or profiles from loop() runs with it cleared or the tier paused.
+    TimerWheel inputTimers;
+    bool mapping;
+    bool menuRequested; // Set by the frame, acted on in loop()
+    void startMapping();
+    void stopMapping();
+
+    // Select+Start on pad 1 opens live tuning; mapping carries on underneath
+    TuningOverlay tuning;
+    uint8_t tuningChords; // Pad 1's chord count at the last loop
+    void updateTuning();
+    void openTuning();
+    void closeTuning();
+
+    int backlightTimer;
     static const unsigned long BACKLIGHT_TIMEOUT_MS = 15000;
+    static void onBacklightTimeout(void *context, uint32_t data);
+
+    // Copy of the active profile in program flash, for fast boot
+    int flashSaveTimer;
+    static const unsigned long FLASH_SAVE_DELAY_MS = 5000;
+    static void onFlashSave(void *context, uint32_t data);
+    void scheduleFlashSave();
 
-    // D-pad axis tracking (for PS4/PS5)
-    int lastDPadAxisValue;
+    // Releases output when a pad is unplugged
+    static void onHotplug(void *context, const HotplugEvent &event);
 
     // Keyboard passthrough event handlers
     static void onKeyPress(int unicode);
@@ -34,24 +64,10 @@ private:
     void initializeDefaultStickConfigs();
     void initializeDefaultTriggerConfigs();
     
-    void processButtonMappings();
-    void processDPadAxisMappings();
-    void processAnalogStick(StickConfig &stick, int xAxis, int yAxis);
-
-    void processMouseMovement(StickConfig &stick, int xValue, int yValue);
-    void processButtonEmulation(StickConfig &stick, int xValue, int yValue);
-    void processScrollWheel(StickConfig &stick, int yValue);
-    void processWASDKeys(StickConfig &stick, int xValue, int yValue);
-    void processArrowKeys(StickConfig &stick, int xValue, int yValue);
-
-    void processTriggers(int leftAxis, int rightAxis);
-    void processTriggerButtons(int leftValue, int rightValue);
-    void processTriggerMouseX(int leftValue, int rightValue);
-    void processTriggerMouseY(int leftValue, int rightValue);
-    void processTriggerScroll(int leftValue, int rightValue);
-
-    int applyDeadzone(int value, int centerValue, int deadzone);
-    const char *getGenericButtonName(uint8_t genericButton);
+    void loadPlayerProfiles();
+    bool applyBinding(int pad, uint16_t vendorId, uint16_t productId);
+    void applyBootBindings();
+    void releaseAll();
 
     void DisplayLoadedFile();
 
@@ -61,7 +77,29 @@ public:
     void init() override;
     void loop() override;
 
+    void onSuspend() override;
+    void onResume() override;
+    void onExit() override;
+
     void setParams(RunActionParams p);  // For singleton reuse
+
+    // Process every pad and queue the reports; from the input tier's
+    // interrupt, or from loop() when there is no tier
+    void inputFrame();
+
+    // Send the reports the frames queued; loop() only, USB may make it wait
+    void sendReports();
+
+    // Validate and compile the pad's entry in padConfigs and hand it to its
+    // pipeline. False if it fails validation and the pipeline keeps the old one.
+    bool publishConfig(int pad);
+
+    // Make profile JSON from memory the pad's profile, unsaved, and publish
+    // it. False if the menus are open or it does not parse or validate.
+    bool loadProfile(int pad, const char *json, size_t length, const char *filename);
+
+    // SD card is up after a fast boot: check the flash profile, load the rest
+    void onStorageReady();
 };
 
 #endif
\ No newline at end of file
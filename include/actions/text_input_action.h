@@ -20,9 +20,11 @@ private:
     int cursorPosition;
 
     // Display state
-    unsigned long lastBlinkTime;
+    int blinkTimer;
+    bool blinkDue;
     bool cursorVisible;
-    const unsigned long blinkInterval = 500;
+    static const unsigned long BLINK_INTERVAL_MS = 500;
+    static void onBlink(void *context, uint32_t data);
 
     void updateDisplay();
     void handleKeyPress(int unicode);
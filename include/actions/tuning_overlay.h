@@ -0,0 +1,58 @@
+#ifndef TUNING_OVERLAY_H
+#define TUNING_OVERLAY_H
+
+#include <Arduino.h>
+#include <LiquidCrystal_I2C.h>
+#include "actions/action_types.h"
+#include "input/gamepad_input.h"
+#include "mapping/joystick_mappings.h"
+
+// Live tuning screen drawn over RunAction while mapping keeps running
+// Up/down picks a stick or trigger parameter and left/right nudges it in the
+// profile being edited; RunAction publishes the profile, so the change is
+// live from the next input frame. draw() sends only the characters that
+// changed, usually just the value, and at most once per loop.
+class TuningOverlay
+{
+public:
+    // Held together on pad 1 to open and close the overlay
+    static const uint32_t CHORD = (1u << GenericController::BTN_SELECT) | (1u << GenericController::BTN_START);
+
+    // Buttons the overlay reads; pad 1 does not map them while it is open
+    static const uint32_t BUTTONS = CHORD |
+                                    (1u << GenericController::BTN_DPAD_UP) | (1u << GenericController::BTN_DPAD_DOWN) |
+                                    (1u << GenericController::BTN_DPAD_LEFT) | (1u << GenericController::BTN_DPAD_RIGHT);
+
+    TuningOverlay();
+
+    void open(LiquidCrystal_I2C *display, JoystickMappingConfig *profile);
+    void close();
+    bool isOpen() const { return config != nullptr; }
+
+    // True if the event changed the profile
+    bool handle(GamepadInputEvent event);
+
+    // Bring the LCD up to date
+    void draw();
+
+private:
+    static const int LCD_COLS = 20;
+    static const int LCD_ROWS = 4;
+    static const int PARAMS_PER_GROUP = 3; // Sensitivity, deadzone, threshold
+    static const int NUM_FIELDS = 3 * PARAMS_PER_GROUP; // Left stick, right stick, triggers
+
+    static constexpr float SENSITIVITY_STEP = 0.01f;
+    static constexpr float MAX_SENSITIVITY = 2.0f;
+
+    LiquidCrystal_I2C *lcd;
+    JoystickMappingConfig *config;
+    int field;
+    bool dirty;
+    char shownRows[LCD_ROWS][LCD_COLS + 1];
+
+    void getParams(float *&sensitivity, uint8_t *&deadzone, uint8_t *&threshold) const;
+    bool nudge(int steps);
+    void drawRow(int row, const char *text);
+};
+
+#endif // TUNING_OVERLAY_H
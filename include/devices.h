@@ -2,18 +2,24 @@
 #define DEVICES_H
 
 #include <USBHost_t36.h>
-#include <../lib/LCD_I2C-master/LiquidCrystal_I2C.h>
+#include <LiquidCrystal_I2C.h>
 #include "input/gamepad_input.h"
 #include "input/keyboard_input.h"
+#include "input/controller_snapshot.h"
+#include "input/hotplug.h"
+#include "timing/double_buffer.h"
 
 class DeviceManager
 {
 public:
+    static const int MAX_JOYSTICKS = 4;
+
     // USB host devices
     USBHost *host;
-    KeyboardController *keyboard;
-    MouseController *mouse;
-    JoystickController *joystick;
+    HotplugKeyboard *keyboard;
+    HotplugMouse *mouse;
+    HotplugJoystick *joysticks[MAX_JOYSTICKS];
+    int numJoysticks;
 
     // Non USB devices to share around
     LiquidCrystal_I2C *lcd;
@@ -26,23 +32,47 @@ public:
     void setup();
     void loop();
 
+    // LCD init waits out the controller's power-up delays; boot calls it once
+    // mapping is running when it can, so nothing is drawn before then
+    void startDisplay();
+    bool isDisplayStarted() const { return displayStarted; }
+
+    // Apply plug/unplug events, then read every pad once; called from loop()
+    // unless the input tier reads the pads
+    void updateSnapshots();
+
+    // Read every pad once and publish pad 1 for the menus; the input frame
+    void captureSnapshots();
+
+    // Look the connected pads up again after the controller database changed
+    void refreshLayouts();
+
 private:
-    // Track device connection states
-    bool keyboardConnected;
-    bool mouseConnected;
-    bool joystickConnected;
+    HotplugManager hotplug;
+    bool displayStarted;
+    ControllerSnapshot snapshots[MAX_JOYSTICKS];
+
+    // The menus read pad 1 from loop(), once per loop, whoever captured it
+    DoubleBuffer<ControllerSnapshot> menuFeed;
+    ControllerSnapshot menuSnapshot;
+    uint32_t menuSequence;
+
+    void updateMenuSnapshot();
 
-    // Check for device connection changes
-    void checkDeviceConnections();
+    static void onHotplug(void *context, const HotplugEvent &event);
 
 public:
     // Getters to access the controllers
     KeyboardController *getKeyboard() { return keyboard; }
     MouseController *getMouse() { return mouse; }
-    JoystickController *getJoystick() { return joystick; }
+    JoystickController *getJoystick() { return joysticks[0]; } // Pad used for menus
+    JoystickController *getJoystick(int index) { return (index >= 0 && index < numJoysticks) ? joysticks[index] : nullptr; }
+    int getJoystickCount() { return numJoysticks; }
+    const ControllerSnapshot *getSnapshot(int index) { return &snapshots[index]; }
     LiquidCrystal_I2C *getLCD() { return lcd; }
     GamepadInput *getGamepadInput() { return gamepadInput; }
     KeyboardInput *getKeyboardInput() { return keyboardInput; }
+    HotplugManager *getHotplug() { return &hotplug; }
 };
 
 #endif
\ No newline at end of file
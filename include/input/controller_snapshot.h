@@ -0,0 +1,44 @@
+#ifndef CONTROLLER_SNAPSHOT_H
+#define CONTROLLER_SNAPSHOT_H
+
+#include <Arduino.h>
+#include <USBHost_t36.h>
+#include "mapping/controller_database.h"
+
+// One pad's state, read from the USB driver once per loop
+// DeviceManager captures a snapshot per pad; the menus and the mapping
+// pipelines only read these, so every frame decodes each pad exactly once.
+struct ControllerSnapshot
+{
+    static const int NUM_AXES = ControllerLayout::NUM_AXES;
+
+    bool connected;
+    JoystickController::joytype_t type;
+    uint16_t vendorId;
+    uint16_t productId;
+    const ControllerLayout *layout; // Valid once connected
+
+    uint32_t buttons;       // Generic buttons, D-pad included
+    uint8_t axisMask;       // Generic axes the layout provides
+    uint8_t axes[NUM_AXES]; // Generic axes, normalised to 0-255
+    uint32_t sequence;      // Bumped on every capture, so readers can spot skipped loops
+
+    ControllerSnapshot();
+
+    // Hotplug: look up the layout for a newly connected pad, or drop it
+    void connect(JoystickController *joystick);
+    void disconnect();
+
+    // Refresh from the driver; does nothing while disconnected
+    void capture(JoystickController *joystick);
+
+    bool isPressed(uint8_t genericButton) const { return (buttons & (1u << genericButton)) != 0; }
+    bool hasAxis(uint8_t genericAxis) const { return (axisMask & (1u << genericAxis)) != 0; }
+
+private:
+    bool rawAxes; // Layout axes need no normalising
+
+    void updateAxisMask();
+};
+
+#endif // CONTROLLER_SNAPSHOT_H
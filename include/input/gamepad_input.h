@@ -2,7 +2,8 @@
 #define INPUT_H
 
 #include <Arduino.h>
-#include <USBHost_t36.h>
+#include "input/controller_snapshot.h"
+#include "input/input_event_queue.h"
 #include "mapping/joystick_mappings.h"
 
 // Input event types
@@ -20,39 +21,76 @@ enum GamepadInputEvent
     INPUT_SELECT   // Select/Share button
 };
 
+// Turns snapshot edges into a queue of press/release/repeat/long-press events
+// Only the actions that read input call update(), so nothing is queued while
+// the Run action has the pad (unless its tuning overlay is open); a skipped
+// loop resyncs instead of replaying.
 class GamepadInput
 {
 private:
-    JoystickController *joystick;
+    const ControllerSnapshot *snapshot;
+    InputEventQueue queue;
 
     // Button state tracking
-    uint32_t lastButtons;
-    uint8_t lastDPadValue;
+    uint32_t lastButtons;  // Generic buttons at the last update
+    uint32_t lastSequence; // Snapshot sequence at the last update
 
-    // Timing for debounce and repeat
-    unsigned long buttonPressTime[32]; // Track press time for each button
-    bool buttonRepeating[32];          // Track if button is in repeat mode
+    // Repeat / long-press state per generic button
+    uint32_t timedButtons;   // Buttons with a running timer (bitmask)
+    uint8_t repeatCount[32]; // Repeats generated since the press
+    int buttonTimer[32];     // Repeat or long-press timer per held button
 
-    const unsigned long debounceDelay = 150;  // Initial delay before registering press
     const unsigned long repeatDelay = 400;    // Delay before repeat starts
     const unsigned long repeatInterval = 100; // Interval between repeats
+    const unsigned long minRepeatInterval = 25;
+    const uint8_t repeatAccelerateAfter = 8;  // Interval halves after every this many repeats
+    const unsigned long longPressDelay = 800;
+
+    // A longer gap between updates resyncs instead of reporting stale edges
+    static const uint32_t MAX_SKIPPED_LOOPS = 4;
+
+    // D-pad repeats; the face and system buttons report a long press instead
+    static const uint32_t REPEAT_BUTTONS =
+        (1u << GenericController::BTN_DPAD_UP) | (1u << GenericController::BTN_DPAD_DOWN) |
+        (1u << GenericController::BTN_DPAD_LEFT) | (1u << GenericController::BTN_DPAD_RIGHT);
+    static const uint32_t LONG_PRESS_BUTTONS =
+        (1u << GenericController::BTN_SOUTH) | (1u << GenericController::BTN_EAST) |
+        (1u << GenericController::BTN_MENU) | (1u << GenericController::BTN_START) |
+        (1u << GenericController::BTN_SELECT);
+
+    static void onRepeatTimer(void *context, uint32_t genericButton);
+    static void onLongPressTimer(void *context, uint32_t genericButton);
 
     // Helper methods
     bool isButtonPressed(uint8_t genericButton);
-    bool isDPadPressed(uint8_t dpadButton);
-    GamepadInputEvent checkButton(uint8_t genericButton, GamepadInputEvent event);
-    GamepadInputEvent checkDPad();
+    void onPress(uint8_t genericButton, uint32_t buttons);
+    void onRelease(uint8_t genericButton, uint32_t buttons);
+    void cancelTimers();
 
 public:
-    GamepadInput(JoystickController *controller);
+    GamepadInput(const ControllerSnapshot *controllerSnapshot);
+
+    // Interval before the repeat after `repeats` repeats
+    unsigned long getRepeatInterval(uint8_t repeats) const;
 
     void reset();
 
-    // Get the current input event (with debouncing and repeat)
+    // Queue the edges since the last update; runs at most once per snapshot
+    void update();
+
+    // Next queued event, oldest first
+    bool pollEvent(InputEvent &event);
+    void clearEvents();
+    uint32_t getDroppedCount() const { return queue.getDroppedCount(); }
+
+    // Navigation meaning of a queued event (presses and repeats only)
+    static GamepadInputEvent toNavigationEvent(const InputEvent &event);
+
+    // Update, then return the next navigation event, discarding anything else
     GamepadInputEvent getEvent();
 
     // Check if a specific button is currently held (no debounce)
     bool isHeld(uint8_t genericButton);
 };
 
-#endif // INPUT_H
\ No newline at end of file
+#endif // INPUT_H
@@ -0,0 +1,137 @@
+#ifndef HOTPLUG_H
+#define HOTPLUG_H
+
+#include <Arduino.h>
+#include <USBHost_t36.h>
+
+enum class HotplugDeviceType : uint8_t
+{
+    KEYBOARD,
+    MOUSE,
+    JOYSTICK
+};
+
+struct HotplugEvent
+{
+    bool connected;          // false = disconnected
+    HotplugDeviceType type;
+    uint8_t index;           // Pad number for JOYSTICK, 0 otherwise
+    uint16_t vendorId;       // Of the device that came or went, 0 if unknown
+    uint16_t productId;
+};
+
+typedef void (*HotplugCallback)(void *context, const HotplugEvent &event);
+
+// Claim/disconnect edges latched by a driver. USBHost_t36 runs the driver
+// hooks while enumerating, in interrupt context, so they only set bits here
+// and HotplugManager::update() does the real work from loop().
+class HotplugLatch
+{
+public:
+    static const uint8_t CLAIMED = 0x01;
+    static const uint8_t RELEASED = 0x02;
+
+    void set(uint8_t edge);
+    uint8_t take() { return __atomic_exchange_n(&edges, 0, __ATOMIC_ACQUIRE); }
+
+private:
+    volatile uint8_t edges = 0;
+};
+
+// Drivers that report their claim/disconnect hooks. Boot keyboards and
+// Xbox pads are claimed as USB drivers, everything else as HID collections.
+class HotplugKeyboard : public KeyboardController
+{
+public:
+    HotplugKeyboard(USBHost &host) : KeyboardController(host) {}
+    HotplugLatch latch;
+
+protected:
+    bool claim(Device_t *dev, int type, const uint8_t *descriptors, uint32_t len) override;
+    void disconnect() override;
+    hidclaim_t claim_collection(USBHIDParser *driver, Device_t *dev, uint32_t topusage) override;
+    void disconnect_collection(Device_t *dev) override;
+};
+
+class HotplugMouse : public MouseController
+{
+public:
+    HotplugMouse(USBHost &host) : MouseController(host) {}
+    HotplugLatch latch;
+
+protected:
+    hidclaim_t claim_collection(USBHIDParser *driver, Device_t *dev, uint32_t topusage) override;
+    void disconnect_collection(Device_t *dev) override;
+};
+
+class HotplugJoystick : public JoystickController
+{
+public:
+    HotplugJoystick(USBHost &host) : JoystickController(host) {}
+    HotplugLatch latch;
+
+protected:
+    bool claim(Device_t *dev, int type, const uint8_t *descriptors, uint32_t len) override;
+    void disconnect() override;
+    hidclaim_t claim_collection(USBHIDParser *driver, Device_t *dev, uint32_t topusage) override;
+    void disconnect_collection(Device_t *dev) override;
+};
+
+// Hotplug dispatcher
+// Turns latched driver edges into typed connect/disconnect events for the
+// subscribers. Nothing is polled: update() is a single flag test unless a
+// driver hook fired since the last call.
+class HotplugManager
+{
+public:
+    static const int MAX_SUBSCRIBERS = 8;
+    static const int MAX_JOYSTICKS = 4;
+    static const int MAX_DEVICES = 2 + MAX_JOYSTICKS;
+
+    HotplugManager();
+
+    // Register the drivers to watch; any of them may be nullptr
+    void attach(HotplugKeyboard *keyboard, HotplugMouse *mouse, HotplugJoystick *const *joysticks, int numJoysticks);
+
+    // Subscribers are called in the order they subscribed. Returns false if full.
+    bool subscribe(HotplugCallback callback, void *context);
+
+    // Dispatch whatever happened since the last call
+    void update();
+
+    bool isConnected(HotplugDeviceType type, uint8_t index = 0) const;
+
+    // Raised by HotplugLatch::set()
+    static void signal() { __atomic_store_n(&pending, true, __ATOMIC_RELEASE); }
+
+private:
+    struct Device
+    {
+        HotplugDeviceType type;
+        uint8_t index;
+        HotplugLatch *latch;
+        void *driver;
+        bool connected;
+        uint16_t vendorId;
+        uint16_t productId;
+    };
+
+    struct Subscriber
+    {
+        HotplugCallback callback;
+        void *context;
+    };
+
+    Device devices[MAX_DEVICES];
+    int numDevices;
+    Subscriber subscribers[MAX_SUBSCRIBERS];
+    int numSubscribers;
+
+    static volatile bool pending;
+
+    void addDevice(HotplugDeviceType type, uint8_t index, HotplugLatch *latch, void *driver);
+    static bool readDriver(const Device &device, uint16_t &vendorId, uint16_t &productId);
+    void dispatch(const Device &device, bool connected);
+};
+
+#endif // HOTPLUG_H
@@ -0,0 +1,47 @@
+#ifndef INPUT_EVENT_QUEUE_H
+#define INPUT_EVENT_QUEUE_H
+
+#include <Arduino.h>
+
+// Edge reported for one generic button
+enum class InputEdge : uint8_t
+{
+    PRESS = 0,
+    RELEASE = 1,
+    REPEAT = 2,    // Auto-repeat while a navigation button is held
+    LONG_PRESS = 3 // Fired once when a non-repeating button is held long enough
+};
+
+struct InputEvent
+{
+    InputEdge type;
+    uint8_t button;       // GenericController button
+    uint32_t heldButtons; // Every generic button held when the edge happened, for chords
+};
+
+// Fixed-size FIFO of input events
+// GamepadInput pushes every edge it sees; actions drain it in order.
+class InputEventQueue
+{
+public:
+    static const uint8_t CAPACITY = 64; // Power of two
+
+    InputEventQueue();
+
+    // Returns false, and counts the loss, when the queue is full
+    bool push(InputEdge type, uint8_t button, uint32_t heldButtons);
+    bool pop(InputEvent &event);
+    void clear();
+
+    uint8_t size() const { return (uint8_t)(head - tail); }
+    bool isEmpty() const { return head == tail; }
+    uint32_t getDroppedCount() const { return dropped; }
+
+private:
+    InputEvent events[CAPACITY];
+    uint8_t head; // Next write, free-running
+    uint8_t tail; // Next read, free-running
+    uint32_t dropped;
+};
+
+#endif // INPUT_EVENT_QUEUE_H
@@ -0,0 +1,109 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+
+// Log levels; LOG_LEVEL picks the most verbose one compiled in
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// Deferred logging
+// A log call only stores the format pointer and up to MAX_ARGS integer or
+// string arguments in a ring buffer; drain() formats and writes them to
+// Serial from the main loop when the port has room, so a host that is not
+// reading never stalls the mapping path. The format must outlive the record
+// (a literal); string arguments are copied into it, up to MAX_TEXT bytes
+// between them, so buffers may change once the call returns.
+// Any number of producers (the main loop and the input tier interrupt) and
+// one consumer (drain()); producers claim a slot with a compare-and-swap.
+class Log
+{
+public:
+    static const int MAX_ARGS = 3;
+    static const uint16_t CAPACITY = 64; // Records, power of two
+    static const int MAX_LINE = 96;
+    static const int MAX_TEXT = 40; // String argument bytes per record, terminators included
+
+    // Levels are filtered at compile time by the LOG_* macros
+    template <typename... Args>
+    static void write(const char *format, Args... args)
+    {
+        static_assert(sizeof...(Args) <= MAX_ARGS, "Log: too many arguments");
+        intptr_t values[MAX_ARGS + 1] = {toArg(args)...};
+        bool strings[MAX_ARGS + 1] = {isString(args)...};
+        push(format, values, strings, sizeof...(Args));
+    }
+
+    // Write up to maxRecords queued records without blocking
+    static void drain(int maxRecords = 4);
+
+    // Format the oldest record into line (for drain and tests); false if empty
+    static bool pop(char *line, size_t size);
+
+    static uint16_t getPending();
+    static uint32_t getDroppedCount() { return dropped; }
+
+private:
+    struct Record
+    {
+        const char *format;
+        intptr_t args[MAX_ARGS]; // Strings: offset into text
+        uint8_t argCount;
+        uint8_t stringArgs; // Bit n set when args[n] is a string
+        char text[MAX_TEXT];
+        bool ready; // Set once the producer has filled it in
+    };
+
+    static Record records[CAPACITY];
+    static uint16_t head; // Next slot to claim
+    static uint16_t tail; // Next read, consumer only
+    static uint32_t dropped;
+    static uint32_t reportedDropped;
+
+    static intptr_t toArg(int value) { return value; }
+    static intptr_t toArg(unsigned int value) { return (intptr_t)value; }
+    static intptr_t toArg(long value) { return (intptr_t)value; }
+    static intptr_t toArg(unsigned long value) { return (intptr_t)value; }
+    static intptr_t toArg(const char *value) { return (intptr_t)value; }
+
+    template <typename T>
+    static bool isString(T) { return false; }
+    static bool isString(const char *) { return true; }
+    static bool isString(char *) { return true; }
+
+    static void push(const char *format, const intptr_t *args, const bool *strings, uint8_t argCount);
+    static size_t format(char *line, size_t size, const Record &record);
+};
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) Log::write(__VA_ARGS__)
+#else
+#define LOG_ERROR(...) do { } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) Log::write(__VA_ARGS__)
+#else
+#define LOG_WARN(...) do { } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) Log::write(__VA_ARGS__)
+#else
+#define LOG_INFO(...) do { } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) Log::write(__VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do { } while (0)
+#endif
+
+#endif // LOG_H
@@ -0,0 +1,127 @@
+#ifndef CONTROLLER_DATABASE_H
+#define CONTROLLER_DATABASE_H
+
+#include <Arduino.h>
+#include <USBHost_t36.h>
+
+// How a controller reports its D-pad
+enum class DPadEncoding : uint8_t
+{
+    BUTTONS = 0, // Four physical buttons, mapped through buttonMap
+    HAT = 1      // Hat switch axis: 0 = up, clockwise to 7 = up-left, anything else = neutral
+};
+
+// Layout of one controller model: how its physical buttons and axes map onto
+// the GenericController buttons and axes. Everything the mapping engine needs
+// per frame is a direct array index.
+struct ControllerLayout
+{
+    static const uint8_t NO_MAPPING = 0xFF;
+    static const int MAX_BUTTONS = 32;
+    static const int NUM_AXES = 6;
+    static const int MAX_NAME_LENGTH = 8;
+
+    uint16_t vendorId;  // 0 = default layout for the joystick type
+    uint16_t productId;
+    uint8_t joyType;    // JoystickController::joytype_t
+    DPadEncoding dpadEncoding;
+    uint8_t dpadAxis;   // Physical axis carrying the hat (DPadEncoding::HAT only)
+
+    // Raw ranges, normalised to 0-255 for the mapping engine; values outside
+    // the range are clamped to it
+    int16_t stickMin;
+    int16_t stickMax;
+    int16_t triggerMin;
+    int16_t triggerMax;
+
+    uint8_t axisMap[NUM_AXES];                // Generic axis -> physical axis
+    uint8_t buttonMap[MAX_BUTTONS];           // Physical button -> generic button
+    uint8_t genericToPhysical[MAX_BUTTONS];   // Generic button -> physical button (derived)
+    char name[MAX_NAME_LENGTH + 1];
+
+    int normaliseStick(int raw) const
+    {
+        raw = constrain(raw, (int)stickMin, (int)stickMax);
+        if (stickMin == 0 && stickMax == 255)
+        {
+            return raw;
+        }
+        return (int)(((long)(raw - stickMin) * 255) / (stickMax - stickMin));
+    }
+
+    int normaliseTrigger(int raw) const
+    {
+        raw = constrain(raw, (int)triggerMin, (int)triggerMax);
+        if (triggerMin == 0 && triggerMax == 255)
+        {
+            return raw;
+        }
+        return (int)(((long)(raw - triggerMin) * 255) / (triggerMax - triggerMin));
+    }
+};
+
+// Controller layout database
+// Built-in layouts are always present; /controllers.bin on the SD card adds
+// or overrides entries, so supporting a new pad is a data change.
+//
+// File format (little endian):
+//   header: "GPDB", uint8 version, uint8 recordSize, uint16 recordCount
+//   record (64 bytes):
+//     uint16 vid, uint16 pid, uint8 joyType, uint8 dpadEncoding, uint8 dpadAxis, uint8 reserved,
+//     int16 stickMin, int16 stickMax, int16 triggerMin, int16 triggerMax,
+//     uint8 axisMap[6], uint8 reserved[2], uint8 buttonMap[32], char name[8]
+// tools/build_controller_db.py generates the file from tools/controllers.json.
+class ControllerDatabase
+{
+public:
+    static const int MAX_LAYOUTS = 24;
+    static const uint8_t FILE_VERSION = 1;
+    static const uint8_t RECORD_SIZE = 64;
+    static const int HEADER_SIZE = 8;
+
+    // Register built-in layouts and merge /controllers.bin if present
+    static void init(const char *filename = "/controllers.bin");
+
+    // init() in two steps. stage() builds the new table aside, so the card
+    // can be read while the input frame runs on the current one; publish()
+    // makes it current and must not overlap a frame. Snapshots keep pointers
+    // into the table, so follow it with DeviceManager::refreshLayouts().
+    static void stage(const char *filename = "/controllers.bin");
+    static void publish();
+
+    // Find the best layout: exact VID/PID, then joystick type, then generic
+    static const ControllerLayout *find(uint16_t vendorId, uint16_t productId, JoystickController::joytype_t type);
+    static const ControllerLayout *find(JoystickController *joystick);
+    static const ControllerLayout *findByType(JoystickController::joytype_t type);
+
+    static int getLayoutCount() { return layoutCount; }
+
+private:
+    static const int HASH_SIZE = 64; // Power of two, > 2 * MAX_LAYOUTS
+    static const int MAX_JOY_TYPES = 16;
+    static const uint8_t EMPTY_SLOT = 0xFF;
+
+    static ControllerLayout layouts[MAX_LAYOUTS];
+    static int layoutCount;
+    static bool initialized;
+
+    // Built by stage(), copied over layouts[] by publish()
+    static ControllerLayout staged[MAX_LAYOUTS];
+    static int stagedCount;
+
+    // Open addressing VID/PID index and per-type index into layouts[]
+    static uint8_t vidPidIndex[HASH_SIZE];
+    static uint8_t typeIndex[MAX_JOY_TYPES];
+    static uint8_t genericIndex;
+
+    static void registerBuiltins();
+    static bool loadFromSD(const char *filename);
+    static bool addLayout(const ControllerLayout &layout);
+    static void rebuildIndex();
+    static void deriveReverseMap(ControllerLayout &layout);
+    static bool parseRecord(const uint8_t *record, ControllerLayout &layout);
+
+    static uint32_t hashVidPid(uint16_t vendorId, uint16_t productId);
+};
+
+#endif // CONTROLLER_DATABASE_H
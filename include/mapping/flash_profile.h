@@ -0,0 +1,52 @@
+#ifndef FLASH_PROFILE_H
+#define FLASH_PROFILE_H
+
+#include <Arduino.h>
+#include "actions/action_types.h"
+
+// Last active profile in program flash
+// The compiled JoystickMappingConfig is kept in a LittleFS file in the
+// Teensy's program flash, so boot can restore it and start mapping before
+// the SD card is up. The header records the struct size and the size and
+// CRC-32 of the SD file it came from; a different build or an edited file
+// invalidates it, even one edited to the same size.
+class FlashProfile
+{
+public:
+    static const uint32_t FS_SIZE = 128 * 1024;
+    static const uint32_t MAGIC = 0x32504647; // "GFP2"
+
+    // Mount the flash file system
+    static bool begin();
+
+    // Restore the cached profile; false if there is none or it does not fit this build
+    static bool load(JoystickMappingConfig &config);
+
+    // Cache config as the last active profile. Skips the write (and the
+    // flash wear) when the cached copy is already identical.
+    static bool save(const JoystickMappingConfig &config);
+
+    // True if config's SD file still has the contents that were cached
+    static bool matchesSD(const JoystickMappingConfig &config);
+
+private:
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t configSize;
+        uint32_t sourceSize; // Size of the SD file when cached
+        uint32_t sourceCrc;  // CRC-32 of the SD file when cached
+        uint32_t checksum;   // Over the config bytes
+    };
+
+    static bool mounted;
+    static Header cached; // Header of what is in flash, magic 0 if nothing
+
+    static uint32_t checksum(const JoystickMappingConfig &config);
+    static uint32_t crc32(const uint8_t *data, size_t length, uint32_t crc);
+
+    // Size and CRC-32 of an SD file; both 0 if it cannot be read
+    static void hashSourceFile(const char *filename, uint32_t &size, uint32_t &crc);
+};
+
+#endif // FLASH_PROFILE_H
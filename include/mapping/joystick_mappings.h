@@ -44,8 +44,16 @@ namespace GenericController
     const uint8_t AXIS_RIGHT_Y = 3;
     const uint8_t AXIS_LEFT_TRIGGER = 4;
     const uint8_t AXIS_RIGHT_TRIGGER = 5;
+
+    // D-pad direction mask (bit n = BTN_DPAD_UP + n)
+    const uint8_t DPAD_MASK_UP = 1 << 0;
+    const uint8_t DPAD_MASK_DOWN = 1 << 1;
+    const uint8_t DPAD_MASK_LEFT = 1 << 2;
+    const uint8_t DPAD_MASK_RIGHT = 1 << 3;
 }
 
+struct ControllerLayout;
+
 // Mapper class to translate controller-specific buttons to generic buttons
 class JoystickMapping
 {
@@ -60,39 +68,45 @@ private:
     static const ButtonNameMapping buttonNameMap[];
     static const int buttonNameMapSize;
 
-    // Controller-specific button mapping
-    struct ControllerButtonMapping
-    {
-        uint8_t physicalButton;
-        uint8_t genericButton;
-    };
-
-    static const ControllerButtonMapping xbox360ButtonMap[];
-    static const int xbox360ButtonMapSize;
-    static const ControllerButtonMapping ps4ButtonMap[];
-    static const int ps4ButtonMapSize;
+    // Hat switch value -> D-pad direction mask, diagonals included
+    static const uint8_t hatDirectionTable[9];
 
 public:
+    // Controller-specific lookups go through ControllerDatabase::find(), so a
+    // VID/PID layout wins over the default for the joystick type
     // Map controller-specific button to generic button
-    static int mapButtonToGeneric(JoystickController::joytype_t type, uint8_t controllerButton);
+    static int mapButtonToGeneric(JoystickController *joystick, uint8_t controllerButton);
 
     // Map controller-specific axis to generic axis
-    static int mapAxisToGeneric(JoystickController::joytype_t type, uint8_t controllerAxis);
+    static int mapAxisToGeneric(JoystickController *joystick, uint8_t controllerAxis);
 
     // Map generic button to controller-specific button (reverse mapping)
-    static int mapGenericToButton(JoystickController::joytype_t type, uint8_t genericButton);
+    static int mapGenericToButton(JoystickController *joystick, uint8_t genericButton);
 
     // Check if controller uses D-pad as axis and get the axis number
-    static bool usesDPadAxis(JoystickController::joytype_t type, uint8_t &axisNumber);
+    static bool usesDPadAxis(JoystickController *joystick, uint8_t &axisNumber);
+
+    // Map hat switch value to D-pad direction mask (0 = neutral or invalid)
+    static uint8_t mapHatToDPadMask(int hatValue)
+    {
+        return (unsigned)hatValue < 9 ? hatDirectionTable[hatValue] : 0;
+    }
 
-    // Map D-pad axis value to generic D-pad button
-    static int mapDPadValueToButton(JoystickController::joytype_t type, uint8_t axisValue);
+    // Decode the current controller state into a bitmask of generic buttons
+    // (bit n = generic button n), with a hat D-pad folded in as D-pad buttons
+    static uint32_t getGenericButtons(const ControllerLayout *layout, JoystickController *joystick);
 
     // Get button name for generic button
     static const char *getGenericButtonName(uint8_t genericButton);
 
     // Parse button name to generic button
     static int parseGenericButtonName(const char *buttonName);
+
+    // Chords are written "L1+A": the last button is the primary button and
+    // the others are returned as a bitmask of generic buttons
+    static const int MAX_CHORD_NAME_LENGTH = 48;
+    static int parseChordName(const char *chordName, uint32_t &chordButtons);
+    static void formatChordName(uint8_t genericButton, uint32_t chordButtons, char *buffer, size_t bufferSize);
 };
 
 // Xbox 360 physical button mapping
@@ -4,6 +4,34 @@
 class KeyboardMapping
 {
 public:
+    // USB joystick buttons as mapping targets ("Joy 1" to "Joy 32")
+    // The range is unused by the Teensy key codes; HidOutput routes it to Joystick.
+    static const int JOYSTICK_BUTTON_BASE = 0xE800;
+    static const int MAX_JOYSTICK_BUTTONS = 32;
+
+    static bool isJoystickButton(int keyCode)
+    {
+        return keyCode > JOYSTICK_BUTTON_BASE && keyCode <= JOYSTICK_BUTTON_BASE + MAX_JOYSTICK_BUTTONS;
+    }
+
+    // Mouse buttons and wheel steps as mapping targets, merged into the mouse report
+    // A button code is MOUSE_BUTTON_BASE plus the Teensy MOUSE_LEFT..MOUSE_FORWARD bit.
+    static const int MOUSE_BUTTON_BASE = 0xE900;
+    static const int MOUSE_WHEEL_UP = 0xE941;
+    static const int MOUSE_WHEEL_DOWN = 0xE942;
+    static const int MOUSE_WHEEL_LEFT = 0xE943;
+    static const int MOUSE_WHEEL_RIGHT = 0xE944;
+
+    static bool isMouseButton(int keyCode)
+    {
+        return keyCode > MOUSE_BUTTON_BASE && keyCode < MOUSE_BUTTON_BASE + 0x20;
+    }
+
+    static bool isMouseWheel(int keyCode)
+    {
+        return keyCode >= MOUSE_WHEEL_UP && keyCode <= MOUSE_WHEEL_RIGHT;
+    }
+
     static int parseKeyCode(const char *keyStr);
     static const char *keyCodeToString(int keyCode);
 
@@ -0,0 +1,43 @@
+#ifndef LIVE_CONFIG_H
+#define LIVE_CONFIG_H
+
+#include <Arduino.h>
+#include "actions/action_types.h"
+
+// Double-buffered profile the mapping engine runs on
+// Menus, loaders and bindings edit the pad's entry in padConfigs, the shadow
+// copy. publish() checks it, copies it into the buffer the engine is not
+// using, compiles it there and hands it over with one pointer store. The
+// engine takes it at the start of its next frame, so it never sees a config
+// that is still being written, and carries its held keys across.
+//
+// One publisher (loop()) and one engine (the input frame). The engine only
+// changes buffers in take(), which loop() cannot interrupt.
+class LiveConfig
+{
+public:
+    LiveConfig();
+
+    // loop() side. False if shadow fails validation; the engine keeps what it has.
+    bool publish(const JoystickMappingConfig &shadow);
+
+    // Engine side, at a frame boundary: the config published since the last
+    // call, now active, or nullptr if there is none
+    const JoystickMappingConfig *take();
+
+    const JoystickMappingConfig *getActive() const { return active; }
+
+    // nullptr if config is usable, else what is wrong with it
+    static const char *validate(const JoystickMappingConfig &config);
+
+    // Build what the engine needs from a validated config: match tables and
+    // the fixed keys of the WASD and arrow stick modes
+    static void compile(JoystickMappingConfig &config);
+
+private:
+    JoystickMappingConfig buffers[2];
+    const JoystickMappingConfig *active; // Engine only
+    JoystickMappingConfig *pending;      // Published, not taken yet
+};
+
+#endif // LIVE_CONFIG_H
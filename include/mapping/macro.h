@@ -0,0 +1,43 @@
+#ifndef MACRO_H
+#define MACRO_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Macro bytecode
+// Profiles describe macros as a list of steps; they are compiled once at
+// load time into this compact form and run by MacroEngine:
+//   "+L Ctrl"        press        OP_PRESS   key(u16)
+//   "-L Ctrl"        release      OP_RELEASE key(u16)
+//   "t"              tap          OP_PRESS, OP_WAIT 0, OP_RELEASE
+//   "wait 50"        wait (ms)    OP_WAIT    ms(u16), 0 = next tick
+//   "mouse 10 -5 0"  mouse move   OP_MOUSE   x(s8) y(s8) wheel(s8)
+// Every macro ends with OP_END.
+namespace MacroOp
+{
+    const uint8_t OP_END = 0;
+    const uint8_t OP_PRESS = 1;
+    const uint8_t OP_RELEASE = 2;
+    const uint8_t OP_WAIT = 3;
+    const uint8_t OP_MOUSE = 4;
+}
+
+class Macro
+{
+public:
+    static const int MAX_STEP_LENGTH = 32;
+
+    // Compile steps into code[0..capacity). Returns bytes written or -1 on error.
+    static int compile(JsonArray steps, uint8_t *code, int capacity);
+
+    // Turn compiled code back into steps (for saving profiles)
+    static void decompile(const uint8_t *code, JsonArray steps);
+
+    // Size of the instruction at code, including its operands
+    static int instructionSize(uint8_t op);
+
+private:
+    static int compileStep(const char *step, uint8_t *code, int capacity);
+};
+
+#endif
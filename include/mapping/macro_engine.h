@@ -0,0 +1,53 @@
+#ifndef MACRO_ENGINE_H
+#define MACRO_ENGINE_H
+
+#include <Arduino.h>
+#include "mapping/macro.h"
+#include "output/hid_output.h"
+
+// Runs compiled macros without blocking.
+// A fixed pool of executors is advanced once per loop by tick(); each one
+// runs steps until it reaches a wait, so any number of macros (up to the
+// pool size) overlap and USBHost::Task() is never stalled.
+class MacroEngine
+{
+public:
+    static const int MAX_EXECUTORS = 8;
+    static const int MAX_HELD_KEYS = 6;
+
+    MacroEngine();
+
+    // Start a macro from the next tick(); returns false if every executor is busy
+    bool start(const uint8_t *code, HidOutput *output, unsigned long now);
+
+    // Advance all running macros up to the given time
+    void tick(unsigned long now);
+
+    // Abort everything and release the keys macros were holding
+    void stopAll();
+
+    // Macros running from [from, from + size) continue at the same offset
+    // from to; with to == nullptr they are stopped instead
+    void relocate(const uint8_t *from, const uint8_t *to, size_t size);
+
+    int getActiveCount() const { return activeCount; }
+
+private:
+    struct Executor
+    {
+        const uint8_t *code; // nullptr = free
+        uint16_t pc;
+        unsigned long wakeTime;
+        HidOutput *output;
+        uint16_t heldKeys[MAX_HELD_KEYS];
+        uint8_t numHeld;
+    };
+
+    Executor executors[MAX_EXECUTORS];
+    int activeCount;
+
+    void run(Executor &executor, unsigned long now);
+    void stop(Executor &executor);
+};
+
+#endif
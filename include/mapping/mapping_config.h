@@ -2,15 +2,13 @@
 #define MAPPING_CONFIG_H
 
 #include <Arduino.h>
-#include <SD.h>
 #include <ArduinoJson.h>
 #include "actions/action_types.h"
+#include "storage/storage.h"
 
 class MappingConfig
 {
 private:
-    static const int CHIPSELECT_PIN = BUILTIN_SDCARD; // Teensy 4.1 built-in SD
-
     // Stick behavior string mapping
     struct StickBehaviorMapping
     {
@@ -30,12 +28,29 @@ private:
     static const TriggerBehaviorMapping triggerBehaviorMap[];
     static const int triggerBehaviorMapSize;
 
+    static uint32_t fileChangeCount;
+    static Storage *storage;
+
 public:
     static bool loadConfig(const char *filename, JoystickMappingConfig &config);
+
+    // Same from JSON already in memory (e.g. uploaded over serial); filename names the result
+    static bool loadConfig(const char *json, size_t length, const char *filename, JoystickMappingConfig &config);
     static bool saveConfig(const char *filename, JoystickMappingConfig &config);
 
     static void initSD();
 
+    // Where profiles and the other config files live: the SD card behind a
+    // read-ahead cache, unless a test or benchmark swaps in another Storage
+    static Storage &getStorage() { return *storage; }
+    static void setStorage(Storage &newStorage) { storage = &newStorage; }
+
+    // Bumped whenever a save touches the SD card, so file lists can be cached
+    static uint32_t getFileChangeCount() { return fileChangeCount; }
+
+    // Rebuild the per-layer chord match tables after mappings change
+    static void prepareMatching(JoystickMappingConfig &config);
+
     // Make these public for Utils class
     static StickBehavior parseStickBehavior(const char *behaviorStr);
     static const char *stickBehaviorToString(StickBehavior behavior);
@@ -44,15 +59,18 @@ public:
     static const char *triggerBehaviorToString(TriggerBehavior behaviour);
 
 private:
-    static void loadMappings(JsonDocument &doc, ButtonMapping *mappings, int &numMappings, int maxMappings);
+    static bool loadDocument(JsonDocument &doc, DeserializationError error, const char *filename, JoystickMappingConfig &config);
+    static void loadMappings(JsonDocument &doc, JoystickMappingConfig &config);
     static void loadStickConfig(JsonDocument &doc, StickConfig *leftStick, StickConfig *rightStick);
     static void loadTriggerConfig(JsonDocument &doc, TriggerConfig *trigger);
+    static void loadLayers(JsonDocument &doc, JoystickMappingConfig &config);
 
-    static bool saveMappings(JsonDocument &doc, ButtonMapping *mappings, int numMappings);
+    static bool saveMappings(JsonDocument &doc, JoystickMappingConfig &config);
     static bool saveStickConfig(JsonDocument &doc, StickConfig *leftStick, StickConfig *rightStick);
     static bool saveTriggerConfig(JsonDocument &doc, TriggerConfig *trigger);
+    static bool saveLayers(JsonDocument &doc, JoystickMappingConfig &config);
 
-    static void parseStickConfig(StickConfig *leftStick, ArduinoJson::V742PB22::JsonObject &left);
+    static void parseStickConfig(StickConfig *leftStick, JsonObject &left);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,133 @@
+#ifndef MAPPING_PIPELINE_H
+#define MAPPING_PIPELINE_H
+
+#include <Arduino.h>
+#include <USBHost_t36.h>
+#include "input/controller_snapshot.h"
+#include "actions/action_types.h"
+#include "mapping/joystick_mappings.h"
+#include "mapping/controller_database.h"
+#include "mapping/macro_engine.h"
+#include "mapping/live_config.h"
+#include "timing/timer_wheel.h"
+#include "output/hid_output.h"
+
+// Per-controller mapping state: one pad, its profile and its layout.
+// Each frame it turns the pad state into key, mouse and joystick events on the
+// shared HidOutput, so several pads can run side by side with their own profiles.
+class MappingPipeline
+{
+private:
+    int index;
+    const ControllerSnapshot *snapshot;
+    LiveConfig *live;
+    const JoystickMappingConfig *config; // The live config's active buffer
+    HidOutput *output;
+    MacroEngine *macros;
+    TimerWheel *timers;
+
+    // Controller info
+    JoystickController::joytype_t controllerType;
+    const ControllerLayout *layout;
+    bool connected;
+    uint32_t genericButtons;
+    uint32_t ignoredButtons; // Taken by loop() for now, not mapped
+
+    // Chord loop() acts on (Select+Start on pad 1). Its buttons map as
+    // usual; once all of them are down within CHORD_WINDOW of each other
+    // they let go and stay unmapped until released, and chordCount ticks.
+    static const unsigned long CHORD_WINDOW = 50;
+    uint32_t chordButtons;
+    uint32_t chordLastHeld;
+    unsigned long chordStart; // Last press of a chord button
+    bool chordTaken;
+    uint8_t chordCount;
+
+    // Button mapping state, one bit per mapping index
+    uint32_t pressedMappings; // Matched last frame
+    uint32_t pendingTapHolds; // Tap-hold mappings waiting for their decision
+    uint32_t deferredPresses; // Pressed while a decision was pending, not sent yet
+    uint32_t deferredTaps;    // Pressed and released while a decision was pending
+    uint32_t tapReleases;     // Tapped keys to release next frame
+    uint32_t turboKeysDown;   // Turbo mappings in the key-down part of their pulse
+    int16_t mappingTimers[JoystickMappingConfig::MAX_MAPPINGS]; // Tap-hold or turbo timer per mapping
+
+    // Keys held by stick and trigger button emulation
+    static const uint8_t STICK_UP = 0x01;
+    static const uint8_t STICK_DOWN = 0x02;
+    static const uint8_t STICK_LEFT = 0x04;
+    static const uint8_t STICK_RIGHT = 0x08;
+    static const uint8_t TRIGGER_LEFT = 0x01;
+    static const uint8_t TRIGGER_RIGHT = 0x02;
+    uint8_t stickKeysDown[2]; // Left, right
+    uint8_t triggerKeysDown;
+
+    // Mouse/scroll output is paced by a periodic timer
+    static const unsigned long ANALOG_UPDATE_INTERVAL = 1000 / 60;
+    int analogTimer;
+    bool analogTickDue;
+
+    void updateLayout();
+    bool usesAnalogTick() const;
+    static void onAnalogTimer(void *context, uint32_t data);
+    void releaseHeld();
+    void adopt(const JoystickMappingConfig *next);
+    void filterChord(uint32_t buttons);
+
+    uint32_t matchMappings() const;
+    void processButtonMappings();
+    void pressMapping(int mappingIndex);
+    void releaseMapping(int mappingIndex);
+    void tapMapping(int mappingIndex);
+    void resolveHold(int mappingIndex);
+    void flushDeferred();
+    static void onTapHoldTimer(void *context, uint32_t mappingIndex);
+    void startTurbo(int mappingIndex);
+    void stopTurbo(int mappingIndex);
+    static void onTurboTimer(void *context, uint32_t mappingIndex);
+    void processAnalogStick(const StickConfig &stick, uint8_t xAxis, uint8_t yAxis); // Generic axes
+
+    void processMouseMovement(const StickConfig &stick, int xValue, int yValue);
+    void processButtonEmulation(const StickConfig &stick, int xValue, int yValue);
+    void processScrollWheel(const StickConfig &stick, int yValue);
+    void processJoystick(const StickConfig &stick, int xValue, int yValue, bool rightStick);
+
+    void processTriggers(uint8_t leftAxis, uint8_t rightAxis);
+    void processTriggerButtons(int leftValue, int rightValue);
+    void processTriggerMouseX(int leftValue, int rightValue);
+    void processTriggerMouseY(int leftValue, int rightValue);
+    void processTriggerScroll(int leftValue, int rightValue);
+    void processTriggerJoystick(int leftValue, int rightValue);
+
+    int applyDeadzone(int value, int centerValue, int deadzone);
+    bool updateKey(uint8_t &keysDown, uint8_t bit, bool shouldBePressed, int keyCode);
+
+public:
+    MappingPipeline();
+
+    void bind(int padIndex, const ControllerSnapshot *padSnapshot, LiveConfig *liveConfig, HidOutput *out,
+              MacroEngine *macroEngine, TimerWheel *timerWheel);
+
+    // Run one frame, on a newly published config if there is one.
+    // Returns false if the controller is not connected.
+    bool process();
+
+    // Release everything this pad holds (e.g. before a profile change)
+    void reset();
+
+    // Leave these buttons unmapped, releasing what they hold; from loop()
+    void setIgnoredButtons(uint32_t buttons) { __atomic_store_n(&ignoredButtons, buttons, __ATOMIC_RELEASE); }
+
+    // Watch these buttons for a chord pressed together; from loop()
+    void setChordButtons(uint32_t buttons) { __atomic_store_n(&chordButtons, buttons, __ATOMIC_RELEASE); }
+
+    // Chords pressed so far, wrapping; loop() acts when it changes
+    uint8_t getChordCount() const { return __atomic_load_n(&chordCount, __ATOMIC_ACQUIRE); }
+
+    bool isConnected() const { return connected; }
+    bool isMenuPressed() const { return (genericButtons & (1u << GenericController::BTN_MENU)) != 0; }
+    uint32_t getGenericButtons() const { return genericButtons; }
+    const ControllerLayout *getLayout() const { return layout; }
+};
+
+#endif
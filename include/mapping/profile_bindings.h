@@ -0,0 +1,60 @@
+#ifndef PROFILE_BINDINGS_H
+#define PROFILE_BINDINGS_H
+
+#include <Arduino.h>
+#include "actions/action_types.h"
+
+// Controller -> profile bindings
+// Binds a controller model (VID/PID) to a config file, so plugging a pad in
+// switches to its profile. Bound profiles are parsed once, at boot and after
+// changes, into a small cache; the swap on hotplug is then a plain copy.
+//
+// Stored on the SD card as JSON (not *.json, so it stays out of the config list):
+//   {"bindings":[{"vid":"054C","pid":"09CC","profile":"/Ps4.json"}]}
+class ProfileBindings
+{
+public:
+    static const int MAX_BINDINGS = 8;
+    static const int MAX_CACHED_PROFILES = 4;
+
+    struct Binding
+    {
+        uint16_t vendorId;
+        uint16_t productId;
+        char profile[JoystickMappingConfig::MAX_FILENAME_LENGTH];
+        int8_t cacheSlot; // -1 = not preparsed, read from SD when applied
+    };
+
+    // Load the binding table and preparse the bound profiles
+    static void init(const char *filename = "/bindings.cfg");
+
+    // Add or replace the binding for a controller model, or remove one.
+    // Both write the table back to SD.
+    static bool bind(uint16_t vendorId, uint16_t productId, const char *profile);
+    static bool unbind(int index);
+
+    static const Binding *find(uint16_t vendorId, uint16_t productId);
+    static int getCount() { return numBindings; }
+    static const Binding &get(int index) { return bindings[index]; }
+
+    // Copy the profile bound to this controller into config.
+    // Returns false if there is no binding or it could not be loaded.
+    static bool apply(uint16_t vendorId, uint16_t productId, JoystickMappingConfig &config);
+
+    // Reparse the cache if a config file was saved since it was built
+    static void refresh();
+
+private:
+    static Binding bindings[MAX_BINDINGS];
+    static int numBindings;
+    static JoystickMappingConfig cache[MAX_CACHED_PROFILES];
+    static uint32_t cacheFileChangeCount;
+    static char filename[JoystickMappingConfig::MAX_FILENAME_LENGTH];
+
+    static int indexOf(uint16_t vendorId, uint16_t productId);
+    static bool load();
+    static bool save();
+    static void rebuildCache();
+};
+
+#endif // PROFILE_BINDINGS_H
@@ -0,0 +1,134 @@
+#ifndef HID_OUTPUT_H
+#define HID_OUTPUT_H
+
+#include <Arduino.h>
+
+// Shared USB HID output stage
+// Every mapping pipeline writes key, mouse and joystick events here; flush()
+// merges them once per frame into reports, and send() hands those to USB.
+// Keys are reference counted so a key held by several pads is pressed once
+// and released when the last one lets go. Joystick and mouse buttons use the
+// same path (KeyboardMapping joystick and mouse codes).
+//
+// The Teensy USB calls wait (up to 50 ms, calling yield()) while the host has
+// not collected earlier reports, which must not happen in the input tier's
+// interrupt. So flush() only queues reports, and send() runs from loop().
+// One producer and one consumer: flush() runs in one context at a time (the
+// input frame, or loop() while frames are held off), send() only in loop().
+// Anything the queue cannot take stays pending and goes with the next flush().
+class HidOutput
+{
+public:
+    static const int MAX_HELD_KEYS = 32;
+    static const uint8_t QUEUE_SIZE = 64; // Reports, power of two
+
+    // USB joystick axes
+    static const uint8_t AXIS_X = 0;
+    static const uint8_t AXIS_Y = 1;
+    static const uint8_t AXIS_Z = 2;
+    static const uint8_t AXIS_Z_ROTATE = 3;
+    static const uint8_t AXIS_SLIDER_LEFT = 4;
+    static const uint8_t AXIS_SLIDER_RIGHT = 5;
+    static const int NUM_JOYSTICK_AXES = 6;
+    static const uint16_t JOYSTICK_AXIS_MAX = 1023;
+
+    HidOutput();
+
+    void pressKey(int keyCode);
+    void releaseKey(int keyCode);
+
+    // Accumulated and sent with the button state as a single Mouse.move() per frame
+    void moveMouse(int x, int y, int wheel, int horiz = 0);
+
+    // Deflection from centre (-128..127 of a 0-255 axis); pads add up, untouched axes recentre
+    void moveJoystickAxis(uint8_t axis, int offset);
+
+    // 0-255 to the 10-bit joystick range, end points exact (0 -> 0, 128 -> 514, 255 -> 1023)
+    static uint16_t scaleJoystickAxis(uint8_t value) { return (uint16_t)((value << 2) | (value >> 6)); }
+
+    // Queue the merged key changes, mouse movement and joystick report for this frame
+    void flush();
+
+    // Send the queued reports; loop() only, may wait for the host
+    void send();
+
+    // Drop all references and release every key we pressed, then send
+    void releaseAll();
+
+    uint8_t getQueued() const;
+
+    bool isKeyHeld(int keyCode) const;
+
+private:
+    struct KeyState
+    {
+        int keyCode;
+        uint8_t refCount;
+        bool sent; // Press has been queued for the host
+    };
+
+    KeyState keys[MAX_HELD_KEYS];
+    int numKeys;
+
+    int mouseX;
+    int mouseY;
+    int mouseWheel;
+    int mouseHoriz;
+    uint8_t mouseButtons;     // MOUSE_LEFT..MOUSE_FORWARD held by mappings
+    uint8_t sentMouseButtons; // Button state in the last mouse report
+
+    // Joystick report, sent manually and only when it changes
+    struct JoystickReport
+    {
+        uint16_t axes[NUM_JOYSTICK_AXES];
+        uint32_t buttons;
+    };
+
+    struct Report
+    {
+        enum Type : uint8_t
+        {
+            KEY_PRESS,
+            KEY_RELEASE,
+            MOUSE,
+            JOYSTICK
+        };
+
+        Type type;
+        union
+        {
+            int keyCode;
+            struct
+            {
+                uint8_t buttons;
+                int8_t x;
+                int8_t y;
+                int8_t wheel;
+                int8_t horiz;
+            } mouse;
+            JoystickReport joystick;
+        };
+    };
+
+    int joystickOffsets[NUM_JOYSTICK_AXES];
+    uint32_t joystickButtons;
+    bool joystickActive; // Something touched the joystick since the last flush
+    bool joystickManual; // Joystick.useManualSend() done
+    bool joystickNeutral; // Last report was centred with no buttons
+    JoystickReport sentReport;     // Last joystick report queued
+    uint32_t sentJoystickButtons; // Buttons in the last joystick report sent, for send()
+
+    Report queue[QUEUE_SIZE];
+    uint8_t queueHead; // Next write, flush() only, free-running
+    uint8_t queueTail; // Next read, send() only, free-running
+
+    int findKey(int keyCode) const;
+    bool applyKey(int keyCode, bool pressed);
+    void flushJoystick();
+    Report *claimReport();
+    void commitReport();
+    void sendReport(const Report &report);
+    static int clampMouse(int value);
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef CONTROL_PORT_H
+#define CONTROL_PORT_H
+
+#include <Arduino.h>
+#include "actions/action_types.h"
+#include "protocol/frame_codec.h"
+#include "protocol/control_protocol.h"
+
+class ActionHandler;
+class DeviceManager;
+
+// Device end of the binary control protocol on the USB serial port
+// poll() runs from loop() and handles what has arrived, up to a byte budget,
+// without waiting for the rest. A reply that does not fit the USB buffer
+// is kept and sent on a later poll(); nothing more is read meanwhile.
+//
+// Profiles are uploaded in chunks into a RAM staging buffer and only
+// parsed when activated, through RunAction and the live config, so the
+// mapping engine switches at a frame boundary like any other profile change.
+// While a host is talking to the port the deferred log is left for DUMP_LOG
+// instead of being printed between the frames.
+class ControlPort
+{
+public:
+    static void begin(ActionHandler *actionHandler, DeviceManager *deviceManager);
+    static void poll();
+
+    // A valid frame arrived within the last HOST_TIMEOUT_MS
+    static bool isHostAttached();
+
+private:
+    static const int MAX_BYTES_PER_POLL = 128;
+    static const unsigned long HOST_TIMEOUT_MS = 5000;
+
+    static ActionHandler *handler;
+    static DeviceManager *devices;
+    static FrameParser parser;
+    static uint32_t framesReceived;
+    static unsigned long lastFrameMs;
+
+    // Staged profile
+    static char upload[ControlProtocol::MAX_PROFILE_SIZE];
+    static char uploadName[JoystickMappingConfig::MAX_FILENAME_LENGTH];
+    static uint16_t uploadSize;     // Announced by UPLOAD_BEGIN
+    static uint16_t uploadReceived;
+    static bool uploadOpen;         // UPLOAD_BEGIN seen, not superseded
+
+    // Reply waiting for room in the USB buffer
+    static uint8_t reply[FrameCodec::MAX_FRAME];
+    static size_t replyLength;
+
+    static void handleFrame();
+    static void handleUploadBegin(const uint8_t *payload, size_t length);
+    static void handleUploadData(const uint8_t *payload, size_t length);
+    static void handleActivate(const uint8_t *payload, size_t length);
+    static void handleMetrics();
+    static void handleDumpLog();
+
+    static void sendReply(const uint8_t *payload, size_t length);
+    static void sendError(ControlProtocol::ErrorCode code);
+    static bool flushReply();
+};
+
+#endif // CONTROL_PORT_H
@@ -0,0 +1,110 @@
+#ifndef CONTROL_PROTOCOL_H
+#define CONTROL_PROTOCOL_H
+
+// Plain C++ on purpose: the host control client builds this file too
+#include <stdint.h>
+#include "protocol/frame_codec.h"
+
+// Messages of the binary control protocol (see FrameCodec for the framing)
+// The host sends a request and waits for the reply, which has the request's
+// type with REPLY set and the same sequence number, or NAK.
+namespace ControlProtocol
+{
+    const uint8_t VERSION = 1;
+    const uint8_t REPLY = 0x80;
+    const uint16_t MAX_PROFILE_SIZE = 8192; // Profile JSON the device can stage
+
+    enum MessageType : uint8_t
+    {
+        // -> (nothing); <- version (1), max payload (2), max profile size (2)
+        PING = 0x01,
+
+        // -> profile size (2), name; <- (nothing)
+        // Starts a new upload into the RAM staging buffer
+        UPLOAD_BEGIN = 0x10,
+
+        // -> offset (2), data; <- bytes received so far (2)
+        // Chunks must arrive in order
+        UPLOAD_DATA = 0x11,
+
+        // -> pad (1); <- (nothing)
+        // Parses the uploaded profile into the pad's config and publishes it
+        ACTIVATE = 0x12,
+
+        // -> (nothing); <- Metrics, see below
+        GET_METRICS = 0x20,
+
+        // -> (nothing); <- records still queued (2), then log lines ending in '\n'
+        // Takes the oldest records off the deferred log
+        DUMP_LOG = 0x30,
+
+        // <- request type (1), ErrorCode (1)
+        NAK = 0x7F
+    };
+
+    enum ErrorCode : uint8_t
+    {
+        ERR_UNKNOWN_TYPE = 1,
+        ERR_BAD_LENGTH = 2,
+        ERR_TOO_LARGE = 3,    // Profile does not fit the staging buffer
+        ERR_NO_UPLOAD = 4,    // UPLOAD_DATA or ACTIVATE without a complete upload
+        ERR_OUT_OF_ORDER = 5, // UPLOAD_DATA offset is not where the last chunk ended
+        ERR_BAD_PAD = 6,
+        ERR_REJECTED = 7      // Not in the Run screen, or the profile did not parse or validate
+    };
+
+    // GET_METRICS reply, little endian, in this order
+    const size_t METRICS_SIZE = 44;
+    struct Metrics
+    {
+        uint32_t uptimeMs;
+        uint32_t tierFrames;      // MappingTier::Stats since the last metrics read
+        uint32_t tierPaused;
+        uint32_t tierMinIntervalUs;
+        uint32_t tierMaxIntervalUs;
+        uint32_t tierMaxFrameUs;
+        uint8_t tierRunning;
+        uint8_t padsConnected;    // Bit per pad
+        uint16_t logPending;
+        uint32_t logDropped;
+        uint32_t framesReceived;  // Valid frames from the host
+        uint32_t frameErrors;     // Frames dropped for a bad length or CRC
+        uint32_t uploadBytes;     // Size of the staged profile
+    };
+
+    inline void encodeMetrics(const Metrics &m, uint8_t *p)
+    {
+        FrameCodec::put32(p + 0, m.uptimeMs);
+        FrameCodec::put32(p + 4, m.tierFrames);
+        FrameCodec::put32(p + 8, m.tierPaused);
+        FrameCodec::put32(p + 12, m.tierMinIntervalUs);
+        FrameCodec::put32(p + 16, m.tierMaxIntervalUs);
+        FrameCodec::put32(p + 20, m.tierMaxFrameUs);
+        p[24] = m.tierRunning;
+        p[25] = m.padsConnected;
+        FrameCodec::put16(p + 26, m.logPending);
+        FrameCodec::put32(p + 28, m.logDropped);
+        FrameCodec::put32(p + 32, m.framesReceived);
+        FrameCodec::put32(p + 36, m.frameErrors);
+        FrameCodec::put32(p + 40, m.uploadBytes);
+    }
+
+    inline void decodeMetrics(const uint8_t *p, Metrics &m)
+    {
+        m.uptimeMs = FrameCodec::get32(p + 0);
+        m.tierFrames = FrameCodec::get32(p + 4);
+        m.tierPaused = FrameCodec::get32(p + 8);
+        m.tierMinIntervalUs = FrameCodec::get32(p + 12);
+        m.tierMaxIntervalUs = FrameCodec::get32(p + 16);
+        m.tierMaxFrameUs = FrameCodec::get32(p + 20);
+        m.tierRunning = p[24];
+        m.padsConnected = p[25];
+        m.logPending = FrameCodec::get16(p + 26);
+        m.logDropped = FrameCodec::get32(p + 28);
+        m.framesReceived = FrameCodec::get32(p + 32);
+        m.frameErrors = FrameCodec::get32(p + 36);
+        m.uploadBytes = FrameCodec::get32(p + 40);
+    }
+}
+
+#endif // CONTROL_PROTOCOL_H
@@ -0,0 +1,74 @@
+#ifndef FRAME_CODEC_H
+#define FRAME_CODEC_H
+
+// Plain C++ on purpose: the host control client builds this file too
+#include <stddef.h>
+#include <stdint.h>
+
+// Framing for the binary control protocol on the USB serial port
+//
+//   0xA5 0x5A | type | sequence | length (2) | payload (length) | CRC (2)
+//
+// Multi-byte fields are little endian. The CRC is CRC-16/CCITT-FALSE over
+// type, sequence, length and payload. Text the firmware prints between
+// frames is skipped: the parser hunts for the sync bytes and drops anything
+// whose length or CRC is wrong.
+namespace FrameCodec
+{
+    const uint8_t SYNC1 = 0xA5;
+    const uint8_t SYNC2 = 0x5A;
+    const size_t HEADER_SIZE = 6; // Sync, type, sequence, length
+    const size_t CRC_SIZE = 2;
+    const size_t MAX_PAYLOAD = 256;
+    const size_t MAX_FRAME = HEADER_SIZE + MAX_PAYLOAD + CRC_SIZE;
+
+    uint16_t crc16(const uint8_t *data, size_t length, uint16_t crc = 0xFFFF);
+
+    // Write a frame into out; returns its size, or 0 if it does not fit
+    size_t encode(uint8_t type, uint8_t sequence, const uint8_t *payload, size_t length, uint8_t *out, size_t outSize);
+
+    inline void put16(uint8_t *p, uint16_t value)
+    {
+        p[0] = (uint8_t)value;
+        p[1] = (uint8_t)(value >> 8);
+    }
+
+    inline void put32(uint8_t *p, uint32_t value)
+    {
+        put16(p, (uint16_t)value);
+        put16(p + 2, (uint16_t)(value >> 16));
+    }
+
+    inline uint16_t get16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+    inline uint32_t get32(const uint8_t *p) { return get16(p) | ((uint32_t)get16(p + 2) << 16); }
+}
+
+// Incremental frame parser
+// Takes one byte at a time, never waits for more, and keeps only the frame
+// being received, so the caller can feed whatever the port has right now.
+class FrameParser
+{
+public:
+    FrameParser();
+
+    // True when b completed a valid frame; it stays readable until the next feed()
+    bool feed(uint8_t b);
+    void reset();
+
+    uint8_t getType() const { return buffer[2]; }
+    uint8_t getSequence() const { return buffer[3]; }
+    const uint8_t *getPayload() const { return buffer + FrameCodec::HEADER_SIZE; }
+    size_t getLength() const { return length; }
+
+    // Frames thrown away for a bad length or CRC
+    uint32_t getErrorCount() const { return errors; }
+
+private:
+    uint8_t buffer[FrameCodec::MAX_FRAME];
+    size_t received; // Bytes of the current frame so far
+    size_t length;   // Payload length, once the header is in
+    bool complete;   // The last byte finished a frame
+    uint32_t errors;
+};
+
+#endif // FRAME_CODEC_H
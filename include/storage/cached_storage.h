@@ -0,0 +1,89 @@
+#ifndef CACHED_STORAGE_H
+#define CACHED_STORAGE_H
+
+#include <Arduino.h>
+#include "storage/storage.h"
+
+// Block read-ahead cache in front of another Storage
+// Reads are served from BLOCK_SIZE blocks kept in RAM; a miss reads the
+// missing block and the READ_AHEAD - 1 blocks after it in one go, since
+// every file here is read front to back. Blocks and sizes stay cached
+// after close, so reopening a profile costs no backend access at all.
+//
+// Everything that changes a file must go through this layer: writes,
+// removes and renames drop the affected file from the cache. Call
+// invalidate() if the backend may have changed behind its back.
+class CachedStorage : public Storage
+{
+public:
+    static const uint32_t BLOCK_SIZE = 512;
+    static const int NUM_BLOCKS = 16;
+    static const int READ_AHEAD = 4;
+    static const int MAX_CACHED_FILES = 8;
+    static const int MAX_OPEN_FILES = 4;
+
+    explicit CachedStorage(Storage &backend);
+
+    bool begin() override;
+
+    bool stat(const char *path, StorageStat &stat) override;
+    bool remove(const char *path) override;
+    bool rename(const char *from, const char *to) override;
+    int list(const char *directory, StorageListCallback callback, void *context) override;
+
+    int openHandle(const char *path, StorageMode mode) override;
+    int read(int handle, uint32_t offset, void *buffer, uint32_t length) override;
+    int write(int handle, const void *data, uint32_t length) override;
+    uint32_t size(int handle) override;
+    void close(int handle) override;
+
+    // Forget everything cached
+    void invalidate();
+
+    uint32_t getHits() const { return hits; }
+    uint32_t getMisses() const { return misses; }
+
+private:
+    struct CachedFile
+    {
+        bool valid;
+        char path[MAX_PATH_LENGTH];
+        uint32_t size;
+        uint32_t lastUse;
+    };
+
+    struct Block
+    {
+        int8_t file; // CachedFile index, -1 if free
+        uint16_t index;
+        uint16_t length;
+        uint32_t lastUse;
+        uint8_t data[BLOCK_SIZE];
+    };
+
+    struct Handle
+    {
+        bool open;
+        bool writing;
+        int8_t file;       // CachedFile index when reading
+        int backendHandle; // Opened on the first miss when reading
+        int8_t lastBlock;  // Block the previous read ended in
+    };
+
+    Storage &backend;
+    CachedFile files[MAX_CACHED_FILES];
+    Block blocks[NUM_BLOCKS];
+    Handle handles[MAX_OPEN_FILES];
+    uint32_t useCounter;
+    uint32_t hits;
+    uint32_t misses;
+
+    int findFile(const char *path) const;
+    int addFile(const char *path, uint32_t size);
+    void dropFile(int file);
+    void dropPath(const char *path);
+    int findBlock(int file, uint16_t index) const;
+    int fillBlocks(Handle &handle, uint16_t index);
+};
+
+#endif // CACHED_STORAGE_H
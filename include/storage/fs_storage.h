@@ -0,0 +1,54 @@
+#ifndef FS_STORAGE_H
+#define FS_STORAGE_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <SD.h>
+#include <LittleFS.h>
+#include "storage/storage.h"
+
+// Storage on a Teensy FS (SD card, LittleFS). Subclasses mount it.
+class FsStorage : public Storage
+{
+public:
+    static const int MAX_OPEN_FILES = 4;
+
+    explicit FsStorage(FS &fs);
+
+    bool stat(const char *path, StorageStat &stat) override;
+    bool remove(const char *path) override;
+    bool rename(const char *from, const char *to) override;
+    int list(const char *directory, StorageListCallback callback, void *context) override;
+
+    int openHandle(const char *path, StorageMode mode) override;
+    int read(int handle, uint32_t offset, void *buffer, uint32_t length) override;
+    int write(int handle, const void *data, uint32_t length) override;
+    uint32_t size(int handle) override;
+    void close(int handle) override;
+
+private:
+    FS &fs;
+    File files[MAX_OPEN_FILES];
+};
+
+// Built-in SD slot of the Teensy 4.1
+class SdStorage : public FsStorage
+{
+public:
+    SdStorage() : FsStorage(SD) {}
+    bool begin() override { return SD.begin(BUILTIN_SDCARD); }
+};
+
+// LittleFS in the part of program flash the firmware does not use
+class FlashStorage : public FsStorage
+{
+public:
+    explicit FlashStorage(uint32_t fsSize) : FsStorage(flash), fsSize(fsSize) {}
+    bool begin() override { return flash.begin(fsSize); }
+
+private:
+    LittleFS_Program flash;
+    uint32_t fsSize;
+};
+
+#endif // FS_STORAGE_H
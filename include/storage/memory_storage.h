@@ -0,0 +1,56 @@
+#ifndef MEMORY_STORAGE_H
+#define MEMORY_STORAGE_H
+
+#include <Arduino.h>
+#include "storage/storage.h"
+
+// Storage in RAM
+// A flat directory of fixed-size files, for host tests and benchmarks that
+// need a file system without the SD card stub. Counts the backend traffic
+// so tests can check what a cache in front of it saved.
+class MemoryStorage : public Storage
+{
+public:
+    static const int MAX_FILES = 16;
+    static const uint32_t MAX_FILE_SIZE = 8192;
+    static const int MAX_OPEN_FILES = 4;
+
+    MemoryStorage();
+
+    bool begin() override { return true; }
+
+    bool stat(const char *path, StorageStat &stat) override;
+    bool remove(const char *path) override;
+    bool rename(const char *from, const char *to) override;
+    int list(const char *directory, StorageListCallback callback, void *context) override;
+
+    int openHandle(const char *path, StorageMode mode) override;
+    int read(int handle, uint32_t offset, void *buffer, uint32_t length) override;
+    int write(int handle, const void *data, uint32_t length) override;
+    uint32_t size(int handle) override;
+    void close(int handle) override;
+
+    // Drop every file
+    void clear();
+
+    uint32_t openCount;
+    uint32_t readCount;
+    uint32_t bytesRead;
+
+private:
+    struct Entry
+    {
+        bool used;
+        char name[MAX_PATH_LENGTH]; // Without the leading '/'
+        uint32_t size;
+        uint8_t data[MAX_FILE_SIZE];
+    };
+
+    Entry files[MAX_FILES];
+    int8_t handles[MAX_OPEN_FILES]; // File index, -1 if free
+
+    static const char *baseName(const char *path);
+    int find(const char *path) const;
+};
+
+#endif // MEMORY_STORAGE_H
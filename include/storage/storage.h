@@ -0,0 +1,93 @@
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <Arduino.h>
+
+enum class StorageMode : uint8_t
+{
+    READ,
+    WRITE // Creates the file, or truncates it if it exists
+};
+
+struct StorageStat
+{
+    uint32_t size;
+    bool isDirectory;
+};
+
+// Called once per directory entry; name has no directory part
+typedef void (*StorageListCallback)(void *context, const char *name, const StorageStat &stat);
+
+class StorageFile;
+
+// Storage interface
+// What the persistence code needs from a file system, so profiles can live
+// on the SD card, in program flash or in RAM (host tests and benchmarks)
+// without the callers knowing. Backends hand out small integer handles from
+// a fixed table; StorageFile wraps one as a Stream for ArduinoJson.
+class Storage
+{
+public:
+    static const int MAX_PATH_LENGTH = 64;
+    static const int INVALID_HANDLE = -1;
+
+    virtual ~Storage() {}
+
+    virtual bool begin() = 0;
+
+    // Returns a closed StorageFile if the file cannot be opened
+    StorageFile open(const char *path, StorageMode mode = StorageMode::READ);
+
+    virtual bool stat(const char *path, StorageStat &stat) = 0;
+    bool exists(const char *path);
+    virtual bool remove(const char *path) = 0;
+    virtual bool rename(const char *from, const char *to) = 0;
+
+    // Returns the number of entries listed, or -1 if directory cannot be read
+    virtual int list(const char *directory, StorageListCallback callback, void *context) = 0;
+
+    // Handle level, used by StorageFile and by layers stacked on a backend.
+    // Reads are positional; writes append.
+    virtual int openHandle(const char *path, StorageMode mode) = 0;
+    virtual int read(int handle, uint32_t offset, void *buffer, uint32_t length) = 0;
+    virtual int write(int handle, const void *data, uint32_t length) = 0;
+    virtual uint32_t size(int handle) = 0;
+    virtual void close(int handle) = 0;
+};
+
+// Open file on a Storage. Closes itself when it goes out of scope.
+class StorageFile : public Stream
+{
+public:
+    StorageFile();
+    StorageFile(Storage *storage, int handle);
+    StorageFile(StorageFile &&other);
+    StorageFile &operator=(StorageFile &&other);
+    StorageFile(const StorageFile &) = delete;
+    StorageFile &operator=(const StorageFile &) = delete;
+    ~StorageFile() { close(); }
+
+    explicit operator bool() const { return handle != Storage::INVALID_HANDLE; }
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    int read(void *buffer, uint32_t length);
+    size_t readBytes(char *buffer, size_t length);
+
+    size_t write(uint8_t b) override;
+    size_t write(const uint8_t *buffer, size_t length) override;
+    using Print::write;
+
+    uint32_t size();
+    uint32_t position() const { return pos; }
+    bool seek(uint32_t position);
+    void close();
+
+private:
+    Storage *storage;
+    int handle;
+    uint32_t pos;
+};
+
+#endif // STORAGE_H
@@ -0,0 +1,41 @@
+#ifndef BOOT_PROFILER_H
+#define BOOT_PROFILER_H
+
+#include <Arduino.h>
+
+// Boot profiler
+// setup() marks the end of each phase; HidOutput reports the first HID
+// report it sends. Once that has happened, update() logs the breakdown in
+// microseconds, so the log shows where the time to the first usable
+// keystroke went.
+class BootProfiler
+{
+public:
+    static const int MAX_PHASES = 12;
+
+    // Phase names must be string literals
+    static void mark(const char *phase);
+
+    // Called for every HID report; only the first one is recorded
+    static void hidEvent()
+    {
+        if (firstHidMicros == 0)
+        {
+            firstHidMicros = micros() | 1;
+        }
+    }
+
+    // Print the report once the first HID event has been seen
+    static void update();
+
+    static uint32_t getFirstHidMicros() { return firstHidMicros; }
+
+private:
+    static const char *phaseNames[MAX_PHASES];
+    static uint32_t phaseMicros[MAX_PHASES];
+    static int numPhases;
+    static uint32_t firstHidMicros;
+    static bool reported;
+};
+
+#endif // BOOT_PROFILER_H
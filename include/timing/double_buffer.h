@@ -0,0 +1,47 @@
+#ifndef DOUBLE_BUFFER_H
+#define DOUBLE_BUFFER_H
+
+#include <Arduino.h>
+
+// Lock-free hand-over of a value between loop() and an interrupt
+// One writer and one reader, either of which may interrupt the other.
+// write() fills the slot that is not published and then publishes it by
+// bumping the sequence; read() copies the published slot and tries again
+// if a write was published meanwhile, so it never returns a torn value.
+// The reader never blocks the writer, and an interrupt that reads cannot
+// be interrupted by the writer, so it always gets through first time.
+template <typename T>
+class DoubleBuffer
+{
+public:
+    DoubleBuffer() : sequence(0) {}
+
+    void write(const T &value)
+    {
+        uint32_t next = sequence + 1;
+        slots[next & 1] = value;
+        __atomic_store_n(&sequence, next, __ATOMIC_RELEASE);
+    }
+
+    // Latest value; false if nothing was written yet
+    bool read(T &value) const
+    {
+        uint32_t published;
+        do
+        {
+            published = __atomic_load_n(&sequence, __ATOMIC_ACQUIRE);
+            value = slots[published & 1];
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        } while (__atomic_load_n(&sequence, __ATOMIC_RELAXED) != published);
+        return published != 0;
+    }
+
+    // Number of writes so far
+    uint32_t getSequence() const { return __atomic_load_n(&sequence, __ATOMIC_ACQUIRE); }
+
+private:
+    T slots[2];
+    uint32_t sequence;
+};
+
+#endif // DOUBLE_BUFFER_H
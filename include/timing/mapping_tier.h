@@ -0,0 +1,72 @@
+#ifndef MAPPING_TIER_H
+#define MAPPING_TIER_H
+
+#include <Arduino.h>
+#include <IntervalTimer.h>
+#include "timing/double_buffer.h"
+
+// Two-tier execution
+// A 1 kHz timer interrupt runs the input frame: read the pads, map, queue the
+// HID reports. loop() keeps everything slow or blocking (LCD, SD card, menus,
+// log output, handing the reports to USB, which may wait for the host), so
+// a redraw or a profile save no longer holds up the mapping itself.
+//
+// The tiers share no locks. Each interrupt checks the pause count before
+// running the frame; loop() raises it around code that changes what the
+// frame reads (plug events, layout and profile reloads). An interrupt runs
+// to completion, so once pause() returns no frame is half way through.
+// Timing statistics come back to loop() through a DoubleBuffer.
+//
+// Without a free hardware timer isRunning() stays false and the frame is
+// left to loop(), as before.
+class MappingTier
+{
+public:
+    typedef void (*Frame)(void *context);
+
+    static const uint32_t PERIOD_US = 1000;
+
+    struct Stats
+    {
+        uint32_t frames;        // Interrupts taken
+        uint32_t paused;        // Interrupts that skipped the frame
+        uint32_t minIntervalUs; // Shortest and longest time between frame starts
+        uint32_t maxIntervalUs;
+        uint32_t maxFrameUs;    // Longest frame
+    };
+
+    // Start calling frame from the timer interrupt; false if no timer is free
+    static bool begin(Frame frame, void *context);
+    static void end();
+    static bool isRunning() { return running; }
+
+    // Hold frames off while loop() changes state they read; nests
+    static void pause();
+    static void resume();
+
+    // Statistics since begin() or the last resetStats()
+    static void getStats(Stats &stats);
+    static void resetStats();
+
+private:
+    // Below both USB controllers, so their interrupts still cut into a frame
+    static const uint8_t PRIORITY = 144;
+
+    static IntervalTimer timer;
+    static Frame frame;
+    static void *context;
+    static bool running;
+    static uint8_t pauseDepth;
+
+    // Owned by the interrupt; loop() only sees the published copy
+    static Stats stats;
+    static DoubleBuffer<Stats> published;
+    static uint32_t lastStart;
+    static uint32_t resetRequests; // Bumped by loop()
+    static uint32_t resetsSeen;
+
+    static void onTimer();
+    static void clearStats();
+};
+
+#endif // MAPPING_TIER_H
@@ -0,0 +1,40 @@
+#ifndef TIMER_SERVICE_H
+#define TIMER_SERVICE_H
+
+#include <Arduino.h>
+#include "timing/timer_wheel.h"
+
+// Shared timer service
+// One TimerWheel for everything in loop(), advanced once per loop() in main.cpp.
+// The mapping pipelines run their own wheel in the input frame.
+// Callbacks run only when their timer is due, so idle timers cost nothing in
+// the hot loop. Time comes from millis() unless another clock is injected,
+// which lets every time-based behaviour run against a virtual clock.
+class TimerService
+{
+public:
+    typedef unsigned long (*Clock)();
+
+    // Replace the time source; nullptr restores millis()
+    static void setClock(Clock clock);
+    static unsigned long now();
+
+    // Fire every timer due by now()
+    static void update();
+
+    // Start a one-shot timer, delay counted from the last update() (or from the
+    // firing time when called inside a callback). Returns TimerWheel::INVALID_TIMER if full.
+    static int schedule(unsigned long delay, TimerWheel::Callback callback, void *context, uint32_t data = 0);
+
+    // Stop a timer and set the id to TimerWheel::INVALID_TIMER
+    static void cancel(int &id);
+
+    static TimerWheel *getWheel() { return &wheel; }
+
+private:
+    static TimerWheel wheel;
+    static Clock clock;
+    static bool updating;
+};
+
+#endif // TIMER_SERVICE_H
@@ -0,0 +1,77 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <Arduino.h>
+
+// Hierarchical timing wheel with 1 ms resolution
+// Level 0 has one slot per millisecond for the next 64 ms, level 1 one slot
+// per 64 ms for the next ~4 s, and longer timers wait on an overflow list.
+// Timers come from a fixed pool and only the slots that come due are touched,
+// so advance() costs nothing while no timer is running and scales with the
+// number of active timers, not with how many could be configured.
+class TimerWheel
+{
+public:
+    typedef void (*Callback)(void *context, uint32_t data);
+
+    static const int MAX_TIMERS = 48;
+    static const int INVALID_TIMER = -1;
+
+    TimerWheel();
+
+    // Start a one-shot timer; returns its id, or INVALID_TIMER if the pool is full.
+    // The delay counts from the last advance() time and is at least 1 ms.
+    // A callback may schedule new timers (e.g. to repeat itself).
+    int schedule(unsigned long delay, Callback callback, void *context, uint32_t data);
+
+    // Stop a timer; stale or invalid ids are ignored
+    void cancel(int id);
+
+    // Fire every timer due up to and including now
+    void advance(unsigned long now);
+
+    // Drop all timers without firing them
+    void cancelAll();
+
+    int getActiveCount() const { return activeCount; }
+    unsigned long getTime() const { return currentTime; }
+
+private:
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+    static const unsigned long SLOT_MASK = SLOTS - 1;
+    static const unsigned long LEVEL1_SPAN = (unsigned long)SLOTS * SLOTS;
+
+    // List heads: level 0 slots, level 1 slots, overflow, free pool
+    static const int LIST_LEVEL1 = SLOTS;
+    static const int LIST_OVERFLOW = 2 * SLOTS;
+    static const int LIST_FREE = 2 * SLOTS + 1;
+    static const int NUM_LISTS = 2 * SLOTS + 2;
+    static const int8_t NONE = -1;
+
+    struct Timer
+    {
+        unsigned long expiry;
+        Callback callback;
+        void *context;
+        uint32_t data;
+        int8_t next;
+        int8_t prev;
+        uint8_t list;
+        uint8_t generation; // Bumped on every reuse so old ids stop matching
+    };
+
+    Timer timers[MAX_TIMERS];
+    int8_t heads[NUM_LISTS];
+    unsigned long currentTime;
+    int activeCount;
+    int level0Count;
+
+    void link(int index, int list);
+    void unlink(int index);
+    void insert(int index);
+    void release(int index);
+    void cascade(int list);
+};
+
+#endif // TIMER_WHEEL_H
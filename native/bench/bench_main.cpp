@@ -0,0 +1,519 @@
+// Host benchmark for the mapping engine (native env).
+//
+// Runs the real setup() from main.cpp against the stubs, then measures
+//   - ns per RunAction::loop() frame under synthetic controller states,
+//     with one pad and with all pads active
+//   - ns per menu input frame (snapshot + GamepadInput::getEvent())
+//   - press-to-report latency under a synthetic UI load, with the input
+//     frame polled from loop() and from the simulated 1 kHz timer interrupt
+//   - us per MappingConfig::loadConfig() for profiles of several sizes
+//   - the same load from RAM storage, with and without the read-ahead cache
+//   - ns per deferred log record, queued and drained separately
+//   - bytes used by the profile structures and the copies kept in RAM
+//
+// Results are written to stdout as one JSON object per line so they can be
+// collected and compared between commits:
+//   .pio/build/native/program [frames] > bench_output.txt
+
+#include <Arduino.h>
+#include <USBHost_t36.h>
+#include <SD.h>
+#include <IntervalTimer.h>
+#include <chrono>
+#include "main.h"
+#include "devices.h"
+#include "actions/action.h"
+#include "actions/action_handler.h"
+#include "mapping/mapping_config.h"
+#include "mapping/joystick_mappings.h"
+#include "mapping/mapping_pipeline.h"
+#include "mapping/profile_bindings.h"
+#include "timing/timer_service.h"
+#include "timing/mapping_tier.h"
+#include "logging/log.h"
+#include "storage/memory_storage.h"
+#include "storage/cached_storage.h"
+
+extern DeviceManager devices;
+extern ActionHandler actionHandler;
+
+namespace
+{
+    const uint16_t XBOX360_VID = 0x045E;
+    const uint16_t XBOX360_PID = 0x028E;
+    const uint16_t PS4_VID = 0x054C;
+    const uint16_t PS4_PID = 0x09CC;
+
+    const int AXIS_CENTER = 128;
+
+    typedef void (*FrameSetup)(JoystickController &joy, uint32_t frame);
+
+    struct LoopCase
+    {
+        const char *name;
+        JoystickController::joytype_t type;
+        uint16_t vid;
+        uint16_t pid;
+        FrameSetup setup;
+        int pads;
+    };
+
+    void centerAxes(JoystickController &joy)
+    {
+        for (uint8_t axis = GenericController::AXIS_LEFT_X; axis <= GenericController::AXIS_RIGHT_Y; axis++)
+        {
+            joy.simSetAxis(JoystickMapping::mapAxisToGeneric(&joy, axis), AXIS_CENTER);
+        }
+        joy.simSetAxis(JoystickMapping::mapAxisToGeneric(&joy, GenericController::AXIS_LEFT_TRIGGER), 0);
+        joy.simSetAxis(JoystickMapping::mapAxisToGeneric(&joy, GenericController::AXIS_RIGHT_TRIGGER), 0);
+    }
+
+    void setupIdle(JoystickController &joy, uint32_t frame)
+    {
+        (void)frame;
+        joy.simSetButtons(0);
+    }
+
+    void setupXboxButtons(JoystickController &joy, uint32_t frame)
+    {
+        // Face buttons and shoulders toggle every frame (press/release storm)
+        const uint32_t mask = (1u << Xbox360Physical::A) | (1u << Xbox360Physical::B) |
+                              (1u << Xbox360Physical::X) | (1u << Xbox360Physical::Y) |
+                              (1u << Xbox360Physical::LB) | (1u << Xbox360Physical::RB);
+        joy.simSetButtons((frame & 1) ? mask : 0);
+    }
+
+    void setupXboxSticks(JoystickController &joy, uint32_t frame)
+    {
+        // Sticks sweep around the full range, triggers ramp up and down
+        int phase = (int)(frame % 256);
+        joy.simSetButtons(0);
+        joy.simSetAxis(GenericController::AXIS_LEFT_X, phase);
+        joy.simSetAxis(GenericController::AXIS_LEFT_Y, 255 - phase);
+        joy.simSetAxis(GenericController::AXIS_RIGHT_X, 255 - phase);
+        joy.simSetAxis(GenericController::AXIS_RIGHT_Y, phase);
+        joy.simSetAxis(GenericController::AXIS_LEFT_TRIGGER, phase);
+        joy.simSetAxis(GenericController::AXIS_RIGHT_TRIGGER, 255 - phase);
+    }
+
+    void setupPs4DPad(JoystickController &joy, uint32_t frame)
+    {
+        // Hat switch walks through all eight directions and neutral
+        joy.simSetButtons(0);
+        joy.simSetAxis(PS4Physical::DPAD_AXIS, (int)(frame % 9));
+    }
+
+    void setupPs4Mixed(JoystickController &joy, uint32_t frame)
+    {
+        const uint32_t mask = (1u << PS4Physical::CROSS) | (1u << PS4Physical::CIRCLE) |
+                              (1u << PS4Physical::L1) | (1u << PS4Physical::R1);
+        joy.simSetButtons((frame & 2) ? mask : 0);
+        joy.simSetAxis(PS4Physical::DPAD_AXIS, (int)((frame / 4) % 9));
+        joy.simSetAxis(JoystickMapping::mapAxisToGeneric(&joy, GenericController::AXIS_RIGHT_X), (int)(frame % 256));
+    }
+
+    const LoopCase loopCases[] = {
+        {"disconnected", JoystickController::UNKNOWN, 0, 0, setupIdle, 1},
+        {"xbox360_idle", JoystickController::XBOX360, XBOX360_VID, XBOX360_PID, setupIdle, 1},
+        {"xbox360_buttons", JoystickController::XBOX360, XBOX360_VID, XBOX360_PID, setupXboxButtons, 1},
+        {"xbox360_sticks", JoystickController::XBOX360, XBOX360_VID, XBOX360_PID, setupXboxSticks, 1},
+        {"ps4_idle", JoystickController::PS4, PS4_VID, PS4_PID, setupIdle, 1},
+        {"ps4_dpad", JoystickController::PS4, PS4_VID, PS4_PID, setupPs4DPad, 1},
+        {"ps4_mixed", JoystickController::PS4, PS4_VID, PS4_PID, setupPs4Mixed, 1},
+        {"four_pads_idle", JoystickController::PS4, PS4_VID, PS4_PID, setupIdle, 4},
+        {"four_pads_mixed", JoystickController::PS4, PS4_VID, PS4_PID, setupPs4Mixed, 4},
+    };
+
+    const int profileSizes[] = {0, 4, 16, 32};
+
+    const char *const profileButtons[] = {
+        "A", "B", "X", "Y", "L1", "R1", "L2", "R2", "Select", "Start",
+        "L3", "R3", "Up", "Down", "Left", "Right", "Touchpad"};
+
+    const char *const profileKeys[] = {
+        "a", "b", "c", "d", "Space", "Enter", "L Shift", "L Ctrl", "F1", "Up"};
+
+    double elapsedNs(std::chrono::steady_clock::time_point start)
+    {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    }
+
+    void setupFrame(const LoopCase &loopCase, uint32_t frame)
+    {
+        for (int pad = 0; pad < loopCase.pads; pad++)
+        {
+            // Offset each pad so they are not in lockstep
+            loopCase.setup(*devices.getJoystick(pad), frame + pad * 3);
+        }
+    }
+
+    void runFrame(Action *action)
+    {
+        // Same order as loop() in main.cpp, minus the USB host task
+        devices.updateSnapshots();
+        TimerService::update();
+        action->loop();
+        actionHandler.sendReports();
+    }
+
+    Action *runActionFor(const LoopCase &loopCase)
+    {
+        for (int pad = 0; pad < devices.getJoystickCount(); pad++)
+        {
+            JoystickController &joy = *devices.getJoystick(pad);
+            if (loopCase.vid == 0 || pad >= loopCase.pads)
+            {
+                joy.simDisconnect();
+            }
+            else
+            {
+                joy.simConnect(loopCase.type, loopCase.vid, loopCase.pid + pad);
+                centerAxes(joy);
+            }
+        }
+
+        // Let RunAction pick up the controller type before timing starts
+        Action *action = actionHandler.getCurrentAction();
+        for (uint32_t frame = 0; frame < 64; frame++)
+        {
+            setupFrame(loopCase, frame);
+            runFrame(action);
+        }
+        return action;
+    }
+
+    void benchRunActionLoop(uint32_t frames)
+    {
+        for (const LoopCase &loopCase : loopCases)
+        {
+            Action *action = runActionFor(loopCase);
+
+            unsigned long keyReports = Keyboard.reportCount;
+            unsigned long mouseReports = Mouse.reportCount;
+            unsigned long serialBytes = Serial.bytesWritten;
+
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t frame = 0; frame < frames; frame++)
+            {
+                setupFrame(loopCase, frame);
+                runFrame(action);
+            }
+            double ns = elapsedNs(start);
+
+            printf("{\"suite\":\"run_action_loop\",\"case\":\"%s\",\"pads\":%d,\"frames\":%lu,\"ns_per_frame\":%.1f,"
+                   "\"key_reports\":%lu,\"mouse_reports\":%lu,\"serial_bytes\":%lu}\n",
+                   loopCase.name, loopCase.pads, (unsigned long)frames, ns / frames,
+                   Keyboard.reportCount - keyReports,
+                   Mouse.reportCount - mouseReports,
+                   Serial.bytesWritten - serialBytes);
+        }
+
+        for (int pad = 0; pad < devices.getJoystickCount(); pad++)
+        {
+            devices.getJoystick(pad)->simDisconnect();
+        }
+    }
+
+    void benchMenuInput(uint32_t frames)
+    {
+        // What a menu frame pays to read the pad: snapshot plus GamepadInput::getEvent()
+        JoystickController &joy = *devices.getJoystick(0);
+        joy.simConnect(JoystickController::PS4, PS4_VID, PS4_PID);
+        centerAxes(joy);
+
+        GamepadInput *input = devices.getGamepadInput();
+        input->reset();
+
+        unsigned long events = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t frame = 0; frame < frames; frame++)
+        {
+            setupPs4Mixed(joy, frame);
+            devices.updateSnapshots();
+            TimerService::update();
+            if (input->getEvent() != INPUT_NONE)
+            {
+                events++;
+            }
+        }
+        double ns = elapsedNs(start);
+
+        printf("{\"suite\":\"menu_input\",\"case\":\"ps4_mixed\",\"frames\":%lu,\"ns_per_frame\":%.1f,\"events\":%lu}\n",
+               (unsigned long)frames, ns / frames, events);
+
+        input->reset();
+        joy.simDisconnect();
+    }
+
+    void benchInputFrame(void *context)
+    {
+        // Same as inputFrame() in main.cpp
+        (void)context;
+        devices.captureSnapshots();
+        actionHandler.inputFrame();
+    }
+
+    void runLoadedLoop(unsigned long loadUs, bool press, unsigned long &pressMicros)
+    {
+        // loop() from main.cpp, minus the log, then the UI work as a wait
+        // the timer interrupt can cut into. A press comes in half way.
+        const uint32_t mask = 1u << Xbox360Physical::A;
+        devices.loop();
+        TimerService::update();
+        actionHandler.loop();
+        actionHandler.sendReports();
+
+        delayMicroseconds(loadUs / 2);
+        if (press)
+        {
+            devices.getJoystick(0)->simSetButtons(mask);
+            pressMicros = micros();
+        }
+        delayMicroseconds(loadUs - loadUs / 2);
+        delayMicroseconds(100); // The rest of loop()
+        actionHandler.sendReports();
+    }
+
+    void benchMappingTier(uint32_t presses)
+    {
+        static const unsigned long loads[] = {0, 2000, 10000};
+
+        runActionFor(loopCases[1]); // One Xbox 360 pad, default profile
+        JoystickController &joy = *devices.getJoystick(0);
+        nativeClockSetManual(true);
+
+        for (int interrupt = 0; interrupt < 2; interrupt++)
+        {
+            IntervalTimer::simSetAvailable(interrupt != 0);
+            if (interrupt != 0)
+            {
+                MappingTier::begin(benchInputFrame, nullptr);
+            }
+
+            for (unsigned long loadUs : loads)
+            {
+                unsigned long pressMicros = 0;
+                unsigned long totalUs = 0;
+                unsigned long maxUs = 0;
+                MappingTier::resetStats();
+
+                for (uint32_t press = 0; press < presses; press++)
+                {
+                    unsigned long pressCount = Keyboard.pressCount;
+                    runLoadedLoop(loadUs, true, pressMicros);
+                    for (int i = 0; i < 100 && Keyboard.pressCount == pressCount; i++)
+                    {
+                        runLoadedLoop(loadUs, false, pressMicros);
+                    }
+
+                    unsigned long latency = Keyboard.lastPressMicros - pressMicros;
+                    totalUs += latency;
+                    maxUs = max(maxUs, latency);
+
+                    // Let go and settle before the next press
+                    joy.simSetButtons(0);
+                    for (int i = 0; i < 3; i++)
+                    {
+                        runLoadedLoop(loadUs, false, pressMicros);
+                    }
+                    delay(20);
+                }
+
+                MappingTier::Stats stats;
+                MappingTier::getStats(stats);
+                printf("{\"suite\":\"mapping_tier\",\"case\":\"%s_load_%luus\",\"presses\":%lu,"
+                       "\"avg_latency_us\":%lu,\"max_latency_us\":%lu,\"tier_frames\":%lu,"
+                       "\"min_interval_us\":%lu,\"max_interval_us\":%lu}\n",
+                       interrupt ? "interrupt" : "polled", loadUs, (unsigned long)presses,
+                       totalUs / presses, maxUs, (unsigned long)stats.frames,
+                       (unsigned long)(stats.frames > 1 ? stats.minIntervalUs : 0),
+                       (unsigned long)stats.maxIntervalUs);
+            }
+        }
+
+        MappingTier::end();
+        IntervalTimer::simSetAvailable(false);
+        nativeClockSetManual(false);
+        joy.simDisconnect();
+        runActionFor(loopCases[0]);
+    }
+
+    void benchLog(uint32_t records)
+    {
+        char line[Log::MAX_LINE];
+        uint32_t batches = records / Log::CAPACITY + 1;
+        double writeNs = 0;
+        double drainNs = 0;
+
+        for (uint32_t batch = 0; batch < batches; batch++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (uint16_t i = 0; i < Log::CAPACITY; i++)
+            {
+                Log::write("MappingPipeline: Button %s pressed -> Key %d", "A", (int)i);
+            }
+            writeNs += elapsedNs(start);
+
+            start = std::chrono::steady_clock::now();
+            while (Log::pop(line, sizeof(line)))
+            {
+            }
+            drainNs += elapsedNs(start);
+        }
+
+        uint32_t total = batches * Log::CAPACITY;
+        printf("{\"suite\":\"log\",\"case\":\"two_args\",\"records\":%lu,\"ns_per_write\":%.1f,"
+               "\"ns_per_format\":%.1f,\"dropped\":%lu}\n",
+               (unsigned long)total, writeNs / total, drainNs / total, (unsigned long)Log::getDroppedCount());
+    }
+
+    std::string buildProfile(int numMappings)
+    {
+        const int buttonCount = sizeof(profileButtons) / sizeof(profileButtons[0]);
+        const int keyCount = sizeof(profileKeys) / sizeof(profileKeys[0]);
+
+        std::string json = "{\n  \"mappings\": [\n";
+        for (int i = 0; i < numMappings; i++)
+        {
+            json += "    {\"button\": \"";
+            json += profileButtons[i % buttonCount];
+            json += "\", \"key\": \"";
+            json += profileKeys[i % keyCount];
+            json += (i + 1 < numMappings) ? "\"},\n" : "\"}\n";
+        }
+        json += "  ],\n";
+        json += "  \"leftStick\": {\"behavior\": \"Custom Keys\", \"sensitivity\": 0.15, \"deadzone\": 16, "
+                "\"activationThreshold\": 64, \"keys\": {\"up\": \"w\", \"down\": \"s\", \"left\": \"a\", \"right\": \"d\"}},\n";
+        json += "  \"rightStick\": {\"behavior\": \"Mouse\", \"sensitivity\": 0.2, \"deadzone\": 12, \"activationThreshold\": 64},\n";
+        json += "  \"triggers\": {\"behavior\": \"Keys\", \"sensitivity\": 0.15, \"deadzone\": 16, "
+                "\"activationThreshold\": 64, \"keys\": {\"left\": \"Left\", \"right\": \"Right\"}}\n";
+        json += "}\n";
+        return json;
+    }
+
+    void benchLoadConfig(uint32_t iterations)
+    {
+        static JoystickMappingConfig scratch;
+
+        for (int numMappings : profileSizes)
+        {
+            char filename[32];
+            snprintf(filename, sizeof(filename), "/Bench%d.json", numMappings);
+
+            std::string profile = buildProfile(numMappings);
+            SD.simWriteFile(filename, profile);
+
+            bool ok = true;
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < iterations; i++)
+            {
+                ok &= MappingConfig::loadConfig(filename, scratch);
+            }
+            double ns = elapsedNs(start);
+
+            printf("{\"suite\":\"load_config\",\"case\":\"mappings_%d\",\"bytes\":%lu,\"iterations\":%lu,"
+                   "\"us_per_load\":%.2f,\"ok\":%s}\n",
+                   numMappings, (unsigned long)profile.size(), (unsigned long)iterations,
+                   ns / iterations / 1000.0, ok ? "true" : "false");
+
+            SD.remove(filename);
+        }
+    }
+
+    void benchStorage(uint32_t iterations)
+    {
+        static JoystickMappingConfig scratch;
+        static MemoryStorage memory;
+        static CachedStorage cache(memory);
+
+        const int numMappings = profileSizes[sizeof(profileSizes) / sizeof(profileSizes[0]) - 1];
+        std::string profile = buildProfile(numMappings);
+        {
+            StorageFile file = memory.open("/Bench.json", StorageMode::WRITE);
+            file.write((const uint8_t *)profile.data(), profile.size());
+        }
+
+        Storage &previous = MappingConfig::getStorage();
+        Storage *const backends[] = {&memory, &cache};
+        const char *const names[] = {"memory", "cached"};
+
+        for (int b = 0; b < 2; b++)
+        {
+            MappingConfig::setStorage(*backends[b]);
+            uint32_t reads = memory.readCount;
+
+            bool ok = true;
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < iterations; i++)
+            {
+                ok &= MappingConfig::loadConfig("/Bench.json", scratch);
+            }
+            double ns = elapsedNs(start);
+
+            printf("{\"suite\":\"storage\",\"case\":\"%s\",\"bytes\":%lu,\"iterations\":%lu,"
+                   "\"us_per_load\":%.2f,\"backend_reads_per_load\":%.2f,\"ok\":%s}\n",
+                   names[b], (unsigned long)profile.size(), (unsigned long)iterations,
+                   ns / iterations / 1000.0, (double)(memory.readCount - reads) / iterations,
+                   ok ? "true" : "false");
+        }
+
+        MappingConfig::setStorage(previous);
+    }
+
+    void reportMemory()
+    {
+        struct Entry
+        {
+            const char *name;
+            size_t bytes;
+        };
+        const Entry entries[] = {
+            {"ButtonMapping", sizeof(ButtonMapping)},
+            {"StickConfig", sizeof(StickConfig)},
+            {"TriggerConfig", sizeof(TriggerConfig)},
+            {"JoystickMappingConfig", sizeof(JoystickMappingConfig)},
+            {"MappingPipeline", sizeof(MappingPipeline)},
+            {"pad_configs", sizeof(JoystickMappingConfig) * DeviceManager::MAX_JOYSTICKS},
+            {"binding_cache", sizeof(JoystickMappingConfig) * ProfileBindings::MAX_CACHED_PROFILES},
+        };
+
+        for (const Entry &entry : entries)
+        {
+            printf("{\"suite\":\"memory\",\"case\":\"%s\",\"bytes\":%lu}\n", entry.name, (unsigned long)entry.bytes);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t frames = 200000;
+    if (argc > 1)
+    {
+        frames = (uint32_t)strtoul(argv[1], nullptr, 10);
+    }
+    if (frames == 0)
+    {
+        frames = 1;
+    }
+
+    setup();
+    loop(); // First loop initialises RunAction and writes the default profile
+
+    // Every pad runs a copy of the default profile, so keys overlap between pads
+    for (int pad = 1; pad < devices.getJoystickCount(); pad++)
+    {
+        padConfigs[pad] = mappingConfig;
+        actionHandler.publishConfig(pad);
+    }
+
+    benchRunActionLoop(frames);
+    benchMenuInput(frames);
+    benchMappingTier(frames / 1000 > 0 ? frames / 1000 : 1);
+    benchLoadConfig(frames / 100 > 0 ? frames / 100 : 1);
+    benchStorage(frames / 100 > 0 ? frames / 100 : 1);
+    benchLog(frames);
+    reportMemory();
+
+    return 0;
+}
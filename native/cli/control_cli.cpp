@@ -0,0 +1,159 @@
+// Host client for the serial control protocol
+// Talks to the board's USB serial port, or to the simulated device in
+// native/device. The protocol side is in control_client.cpp.
+//
+//   control_cli <port> ping
+//   control_cli <port> upload <profile.json> [name]
+//   control_cli <port> activate [pad]
+//   control_cli <port> metrics
+//   control_cli <port> log
+
+#include "control_client.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace ControlProtocol;
+using ControlClient::Link;
+
+namespace
+{
+    int runPing(Link &link)
+    {
+        ControlClient::DeviceInfo info;
+        if (!ControlClient::ping(link, info))
+        {
+            return 1;
+        }
+        printf("protocol %u, payload up to %u bytes, profiles up to %u bytes\n", info.version, info.maxPayload,
+               info.maxProfileSize);
+        return 0;
+    }
+
+    int runUpload(Link &link, const char *path, const char *name)
+    {
+        FILE *file = fopen(path, "rb");
+        if (file == nullptr)
+        {
+            fprintf(stderr, "control_cli: cannot open %s: %s\n", path, strerror(errno));
+            return 1;
+        }
+        static uint8_t profile[MAX_PROFILE_SIZE + 1];
+        size_t size = fread(profile, 1, sizeof(profile), file);
+        fclose(file);
+        if (size == 0 || size > MAX_PROFILE_SIZE)
+        {
+            fprintf(stderr, "control_cli: %s must be 1 to %u bytes\n", path, MAX_PROFILE_SIZE);
+            return 1;
+        }
+
+        // Profiles are named like files on the card: "/Name.json"
+        char defaultName[64];
+        if (name == nullptr)
+        {
+            const char *base = strrchr(path, '/');
+            snprintf(defaultName, sizeof(defaultName), "/%s", base != nullptr ? base + 1 : path);
+            name = defaultName;
+        }
+
+        if (!ControlClient::upload(link, profile, size, name))
+        {
+            return 1;
+        }
+        printf("uploaded %s as %s, %zu bytes\n", path, name, size);
+        return 0;
+    }
+
+    int runActivate(Link &link, int pad)
+    {
+        if (!ControlClient::activate(link, pad))
+        {
+            return 1;
+        }
+        printf("pad %d runs the uploaded profile\n", pad + 1);
+        return 0;
+    }
+
+    int runMetrics(Link &link)
+    {
+        Metrics m;
+        if (!ControlClient::getMetrics(link, m))
+        {
+            return 1;
+        }
+
+        printf("uptime          %u ms\n", m.uptimeMs);
+        printf("input tier      %s\n", m.tierRunning ? "timer interrupt" : "loop()");
+        printf("frames          %u (%u paused)\n", m.tierFrames, m.tierPaused);
+        if (m.tierFrames > 1)
+        {
+            printf("frame interval  %u..%u us\n", m.tierMinIntervalUs, m.tierMaxIntervalUs);
+        }
+        printf("longest frame   %u us\n", m.tierMaxFrameUs);
+        printf("pads connected  0x%x\n", m.padsConnected);
+        printf("log             %u queued, %u dropped\n", m.logPending, m.logDropped);
+        printf("link            %u frames, %u bad\n", m.framesReceived, m.frameErrors);
+        printf("staged profile  %u bytes\n", m.uploadBytes);
+        return 0;
+    }
+
+    int runDumpLog(Link &link)
+    {
+        return ControlClient::dumpLog(link, stdout) ? 0 : 1;
+    }
+
+    int usage()
+    {
+        fprintf(stderr,
+                "usage: control_cli <port> ping\n"
+                "       control_cli <port> upload <profile.json> [name]\n"
+                "       control_cli <port> activate [pad]\n"
+                "       control_cli <port> metrics\n"
+                "       control_cli <port> log\n");
+        return 2;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        return usage();
+    }
+
+    const char *command = argv[2];
+    Link link;
+    if (!link.open(argv[1]))
+    {
+        return 1;
+    }
+
+    if (strcmp(command, "ping") == 0)
+    {
+        return runPing(link);
+    }
+    if (strcmp(command, "upload") == 0 && argc >= 4)
+    {
+        return runUpload(link, argv[3], argc >= 5 ? argv[4] : nullptr);
+    }
+    if (strcmp(command, "activate") == 0)
+    {
+        // Pads are numbered from 1, as on the LCD
+        int pad = argc >= 4 ? atoi(argv[3]) : 1;
+        if (pad < 1)
+        {
+            return usage();
+        }
+        return runActivate(link, pad - 1);
+    }
+    if (strcmp(command, "metrics") == 0)
+    {
+        return runMetrics(link);
+    }
+    if (strcmp(command, "log") == 0)
+    {
+        return runDumpLog(link);
+    }
+    return usage();
+}
@@ -0,0 +1,230 @@
+#include "control_client.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace ControlProtocol;
+
+namespace ControlClient
+{
+    Link::~Link()
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+
+    bool Link::open(const char *path)
+    {
+        fd = ::open(path, O_RDWR | O_NOCTTY);
+        if (fd < 0)
+        {
+            fprintf(stderr, "control_cli: cannot open %s: %s\n", path, strerror(errno));
+            return false;
+        }
+
+        // Raw bytes both ways; the baud rate means nothing to USB CDC
+        termios mode;
+        if (tcgetattr(fd, &mode) == 0)
+        {
+            cfmakeraw(&mode);
+            cfsetspeed(&mode, B115200);
+            tcsetattr(fd, TCSANOW, &mode);
+        }
+
+        // Text printed before we came is of no use
+        tcflush(fd, TCIFLUSH);
+        return true;
+    }
+
+    bool Link::request(uint8_t type, const uint8_t *payload, size_t length, Reply &reply)
+    {
+        uint8_t frame[FrameCodec::MAX_FRAME];
+        size_t frameLength = FrameCodec::encode(type, ++sequence, payload, length, frame, sizeof(frame));
+        if (frameLength == 0 || !writeAll(frame, frameLength))
+        {
+            return false;
+        }
+
+        long deadline = nowMs() + REPLY_TIMEOUT_MS;
+        while (nowMs() < deadline)
+        {
+            pollfd ready = {fd, POLLIN, 0};
+            if (poll(&ready, 1, (int)(deadline - nowMs())) <= 0)
+            {
+                continue;
+            }
+
+            uint8_t buffer[256];
+            ssize_t count = read(fd, buffer, sizeof(buffer));
+            for (ssize_t i = 0; i < count; i++)
+            {
+                // Log text and stale replies are skipped
+                if (parser.feed(buffer[i]) && parser.getSequence() == sequence)
+                {
+                    reply.type = parser.getType();
+                    reply.length = parser.getLength();
+                    memcpy(reply.payload, parser.getPayload(), reply.length);
+                    return true;
+                }
+            }
+        }
+
+        fprintf(stderr, "control_cli: no reply to request 0x%02x\n", type);
+        return false;
+    }
+
+    bool Link::writeAll(const uint8_t *data, size_t length)
+    {
+        while (length > 0)
+        {
+            ssize_t count = write(fd, data, length);
+            if (count < 0)
+            {
+                fprintf(stderr, "control_cli: write failed: %s\n", strerror(errno));
+                return false;
+            }
+            data += count;
+            length -= (size_t)count;
+        }
+        return true;
+    }
+
+    long Link::nowMs()
+    {
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return now.tv_sec * 1000L + now.tv_nsec / 1000000L;
+    }
+
+    namespace
+    {
+        const char *errorName(uint8_t code)
+        {
+            switch (code)
+            {
+            case ERR_UNKNOWN_TYPE:
+                return "unknown request";
+            case ERR_BAD_LENGTH:
+                return "bad length";
+            case ERR_TOO_LARGE:
+                return "profile too large";
+            case ERR_NO_UPLOAD:
+                return "no complete upload";
+            case ERR_OUT_OF_ORDER:
+                return "chunk out of order";
+            case ERR_BAD_PAD:
+                return "no such pad";
+            case ERR_REJECTED:
+                return "rejected (menus open, or the profile did not parse or validate)";
+            default:
+                return "unknown error";
+            }
+        }
+    }
+
+    bool exchange(Link &link, uint8_t type, const uint8_t *payload, size_t length, Reply &reply)
+    {
+        if (!link.request(type, payload, length, reply))
+        {
+            return false;
+        }
+        if (reply.type == NAK && reply.length >= 2)
+        {
+            fprintf(stderr, "control_cli: device refused request 0x%02x: %s\n", type, errorName(reply.payload[1]));
+            return false;
+        }
+        if (reply.type != (type | REPLY))
+        {
+            fprintf(stderr, "control_cli: unexpected reply 0x%02x\n", reply.type);
+            return false;
+        }
+        return true;
+    }
+
+    bool ping(Link &link, DeviceInfo &info)
+    {
+        Reply reply;
+        if (!exchange(link, PING, nullptr, 0, reply) || reply.length < 5)
+        {
+            return false;
+        }
+        info.version = reply.payload[0];
+        info.maxPayload = FrameCodec::get16(reply.payload + 1);
+        info.maxProfileSize = FrameCodec::get16(reply.payload + 3);
+        return true;
+    }
+
+    bool upload(Link &link, const uint8_t *profile, size_t size, const char *name)
+    {
+        uint8_t payload[FrameCodec::MAX_PAYLOAD];
+        size_t nameLength = strlen(name);
+        if (nameLength + 2 > sizeof(payload))
+        {
+            fprintf(stderr, "control_cli: name too long\n");
+            return false;
+        }
+        FrameCodec::put16(payload, (uint16_t)size);
+        memcpy(payload + 2, name, nameLength);
+
+        Reply reply;
+        if (!exchange(link, UPLOAD_BEGIN, payload, nameLength + 2, reply))
+        {
+            return false;
+        }
+
+        const size_t chunk = FrameCodec::MAX_PAYLOAD - 2;
+        for (size_t offset = 0; offset < size; offset += chunk)
+        {
+            size_t count = size - offset < chunk ? size - offset : chunk;
+            FrameCodec::put16(payload, (uint16_t)offset);
+            memcpy(payload + 2, profile + offset, count);
+            if (!exchange(link, UPLOAD_DATA, payload, count + 2, reply))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool activate(Link &link, int pad)
+    {
+        uint8_t payload = (uint8_t)pad;
+        Reply reply;
+        return exchange(link, ACTIVATE, &payload, 1, reply);
+    }
+
+    bool getMetrics(Link &link, Metrics &metrics)
+    {
+        Reply reply;
+        if (!exchange(link, GET_METRICS, nullptr, 0, reply) || reply.length < METRICS_SIZE)
+        {
+            return false;
+        }
+        decodeMetrics(reply.payload, metrics);
+        return true;
+    }
+
+    bool dumpLog(Link &link, FILE *out)
+    {
+        // The device sends what fits and says how much is left
+        for (;;)
+        {
+            Reply reply;
+            if (!exchange(link, DUMP_LOG, nullptr, 0, reply) || reply.length < 2)
+            {
+                return false;
+            }
+            fwrite(reply.payload + 2, 1, reply.length - 2, out);
+            if (FrameCodec::get16(reply.payload) == 0 || reply.length == 2)
+            {
+                return true;
+            }
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef CONTROL_CLIENT_H
+#define CONTROL_CLIENT_H
+
+// Host side of the serial control protocol
+// The link and the requests, without any printing of results; control_cli
+// is the command line around them, and the native tests drive a simulated
+// device with them. Plain POSIX, no firmware code besides the shared framing.
+
+#include "protocol/frame_codec.h"
+#include "protocol/control_protocol.h"
+#include <stdio.h>
+
+namespace ControlClient
+{
+    const int REPLY_TIMEOUT_MS = 2000;
+
+    struct Reply
+    {
+        uint8_t type;
+        uint8_t payload[FrameCodec::MAX_PAYLOAD];
+        size_t length;
+    };
+
+    class Link
+    {
+    public:
+        Link() : fd(-1), sequence(0) {}
+        ~Link();
+
+        // Open the port raw, dropping whatever the device printed before
+        bool open(const char *path);
+
+        // Send a request and wait for its reply; false on timeout
+        bool request(uint8_t type, const uint8_t *payload, size_t length, Reply &reply);
+
+    private:
+        int fd;
+        uint8_t sequence;
+        FrameParser parser;
+
+        bool writeAll(const uint8_t *data, size_t length);
+        static long nowMs();
+    };
+
+    // PING reply
+    struct DeviceInfo
+    {
+        uint8_t version;
+        uint16_t maxPayload;
+        uint16_t maxProfileSize;
+    };
+
+    // Request and check the reply type; prints the device's error if there is one
+    bool exchange(Link &link, uint8_t type, const uint8_t *payload, size_t length, Reply &reply);
+
+    bool ping(Link &link, DeviceInfo &info);
+
+    // Stage a profile under a card-style name ("/Name.json") in chunks
+    bool upload(Link &link, const uint8_t *profile, size_t size, const char *name);
+
+    // Pads are numbered from 0 here
+    bool activate(Link &link, int pad);
+
+    bool getMetrics(Link &link, ControlProtocol::Metrics &metrics);
+
+    // Fetch the deferred log until the device has none left
+    bool dumpLog(Link &link, FILE *out);
+}
+
+#endif // CONTROL_CLIENT_H
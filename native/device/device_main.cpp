@@ -0,0 +1,71 @@
+// Simulated device for the serial control protocol
+// Runs the firmware on the host with its USB serial port on a pseudo-terminal
+// and prints the terminal's path, so the control client can talk to it the
+// way it talks to the board:
+//
+//   pio run -e native_device && .pio/build/native_device/program [seconds]
+//   pio run -e native_cli && .pio/build/native_cli/program /dev/pts/N metrics
+
+#include <Arduino.h>
+#include "main.h"
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace
+{
+    volatile sig_atomic_t stopping = 0;
+
+    void onSignal(int signal)
+    {
+        (void)signal;
+        stopping = 1;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    // Run time in seconds, 0 until interrupted
+    unsigned long seconds = argc > 1 ? strtoul(argv[1], nullptr, 10) : 0;
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+    {
+        perror("Device: pseudo-terminal");
+        return 1;
+    }
+
+    // Hold the client end open in raw mode, like a CDC port: no echo or
+    // line editing, and the device keeps running between clients
+    const char *path = ptsname(master);
+    int client = open(path, O_RDWR | O_NOCTTY);
+    termios mode;
+    if (client < 0 || tcgetattr(client, &mode) != 0)
+    {
+        perror("Device: pseudo-terminal");
+        return 1;
+    }
+    cfmakeraw(&mode);
+    tcsetattr(client, TCSANOW, &mode);
+
+    printf("%s\n", path);
+    fflush(stdout);
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    Serial.simAttach(master);
+    setup();
+    while (!stopping && (seconds == 0 || millis() < seconds * 1000))
+    {
+        loop();
+        usleep(1000);
+    }
+
+    close(client);
+    close(master);
+    return 0;
+}
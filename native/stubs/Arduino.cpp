@@ -0,0 +1,326 @@
+#include <Arduino.h>
+#include <IntervalTimer.h>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+
+NativeSerial Serial;
+usb_keyboard_class Keyboard;
+uint8_t usb_mouse_buttons_state = 0;
+usb_mouse_class Mouse;
+usb_joystick_class Joystick;
+
+namespace
+{
+    bool clockManual = false;
+    unsigned long long clockOffsetUs = 0;
+    unsigned long long manualUs = 0;
+
+    unsigned long long realMicros()
+    {
+        static const auto start = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return (unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    }
+
+    unsigned long long nowMicros()
+    {
+        return clockManual ? manualUs : realMicros() + clockOffsetUs;
+    }
+
+    void advanceManual(unsigned long long us)
+    {
+        // Timer interrupts due on the way fire at their own time
+        unsigned long long target = manualUs + us;
+        IntervalTimer::simRunUntil(manualUs, target);
+        manualUs = target;
+    }
+
+    bool serialEcho()
+    {
+        static const bool echo = getenv("NATIVE_SERIAL_ECHO") != nullptr;
+        return echo;
+    }
+}
+
+unsigned long millis()
+{
+    return (unsigned long)(nowMicros() / 1000);
+}
+
+unsigned long micros()
+{
+    return (unsigned long)nowMicros();
+}
+
+void delay(unsigned long ms)
+{
+    if (clockManual)
+    {
+        advanceManual((unsigned long long)ms * 1000);
+    }
+    else
+    {
+        clockOffsetUs += (unsigned long long)ms * 1000;
+    }
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    if (clockManual)
+    {
+        advanceManual(us);
+    }
+    else
+    {
+        clockOffsetUs += us;
+    }
+}
+
+void yield()
+{
+}
+
+void nativeClockSetManual(bool manual)
+{
+    if (manual && !clockManual)
+    {
+        manualUs = nowMicros();
+    }
+    else if (!manual && clockManual)
+    {
+        clockOffsetUs = manualUs > realMicros() ? manualUs - realMicros() : 0;
+    }
+    clockManual = manual;
+}
+
+void nativeClockSet(unsigned long ms)
+{
+    manualUs = (unsigned long long)ms * 1000;
+}
+
+void nativeClockAdvance(unsigned long ms)
+{
+    advanceManual((unsigned long long)ms * 1000);
+}
+
+size_t NativeSerial::write(uint8_t b)
+{
+    return write(&b, 1);
+}
+
+size_t NativeSerial::write(const uint8_t *buffer, size_t size)
+{
+    bytesWritten += size;
+    if (fd >= 0)
+    {
+        // Like a full USB buffer, a host that is not reading loses output
+        transmit();
+        size_t count = size < TX_SIZE - txLength ? size : TX_SIZE - txLength;
+        memcpy(tx + txLength, buffer, count);
+        txLength += count;
+        transmit();
+    }
+    else if (serialEcho())
+    {
+        fwrite(buffer, 1, size, stderr);
+    }
+    return size;
+}
+
+int NativeSerial::availableForWrite()
+{
+    if (fd < 0)
+    {
+        return writeRoom;
+    }
+    transmit();
+    return (int)(TX_SIZE - txLength) < writeRoom ? (int)(TX_SIZE - txLength) : writeRoom;
+}
+
+void NativeSerial::transmit()
+{
+    // The descriptor is non-blocking and may take only part of it
+    size_t sent = 0;
+    while (sent < txLength)
+    {
+        ssize_t count = ::write(fd, tx + sent, txLength - sent);
+        if (count <= 0)
+        {
+            break;
+        }
+        sent += (size_t)count;
+    }
+    memmove(tx, tx + sent, txLength - sent);
+    txLength -= sent;
+}
+
+void NativeSerial::simAttach(int newFd)
+{
+    fd = newFd;
+    txLength = 0;
+    if (fd >= 0)
+    {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+}
+
+void NativeSerial::simFeed(const uint8_t *data, size_t size)
+{
+    for (size_t i = 0; i < size && rxHead - rxTail < RX_SIZE; i++)
+    {
+        rx[rxHead++ % RX_SIZE] = data[i];
+    }
+}
+
+void NativeSerial::receive()
+{
+    if (fd >= 0)
+    {
+        transmit();
+    }
+    if (fd < 0 || rxHead - rxTail == RX_SIZE)
+    {
+        return;
+    }
+
+    uint8_t buffer[256];
+    size_t room = RX_SIZE - (rxHead - rxTail);
+    ssize_t count = ::read(fd, buffer, room < sizeof(buffer) ? room : sizeof(buffer));
+    if (count > 0)
+    {
+        simFeed(buffer, (size_t)count);
+    }
+}
+
+int NativeSerial::available()
+{
+    receive();
+    return (int)(rxHead - rxTail);
+}
+
+int NativeSerial::read()
+{
+    if (available() == 0)
+    {
+        return -1;
+    }
+    return rx[rxTail++ % RX_SIZE];
+}
+
+int NativeSerial::peek()
+{
+    if (available() == 0)
+    {
+        return -1;
+    }
+    return rx[rxTail % RX_SIZE];
+}
+
+size_t usb_keyboard_class::press(uint16_t n)
+{
+    pressCount++;
+    lastPressMicros = micros();
+    for (int i = 0; i < MAX_KEYS; i++)
+    {
+        if (keys[i] == n)
+        {
+            return 1;
+        }
+    }
+    for (int i = 0; i < MAX_KEYS; i++)
+    {
+        if (keys[i] == 0)
+        {
+            keys[i] = n;
+            reportCount++;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+size_t usb_keyboard_class::release(uint16_t n)
+{
+    releaseCount++;
+    for (int i = 0; i < MAX_KEYS; i++)
+    {
+        if (keys[i] == n)
+        {
+            keys[i] = 0;
+            reportCount++;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void usb_keyboard_class::releaseAll()
+{
+    for (int i = 0; i < MAX_KEYS; i++)
+    {
+        keys[i] = 0;
+    }
+    reportCount++;
+}
+
+bool usb_keyboard_class::isPressed(uint16_t n) const
+{
+    for (int i = 0; i < MAX_KEYS; i++)
+    {
+        if (keys[i] == n)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void usb_mouse_class::move(int8_t x, int8_t y, int8_t wheel, int8_t horiz)
+{
+    totalX += x;
+    totalY += y;
+    totalWheel += wheel;
+    totalHoriz += horiz;
+    reportCount++;
+}
+
+void usb_mouse_class::set_buttons(uint8_t left, uint8_t middle, uint8_t right, uint8_t back, uint8_t forward)
+{
+    uint8_t buttons = 0;
+    if (left)
+        buttons |= MOUSE_LEFT;
+    if (middle)
+        buttons |= MOUSE_MIDDLE;
+    if (right)
+        buttons |= MOUSE_RIGHT;
+    if (back)
+        buttons |= MOUSE_BACK;
+    if (forward)
+        buttons |= MOUSE_FORWARD;
+    usb_mouse_buttons_state = buttons;
+    move(0, 0);
+}
+
+void usb_joystick_class::button(uint8_t num, bool val)
+{
+    if (num < 1 || num > 32)
+    {
+        return;
+    }
+    if (val)
+    {
+        buttons |= (1u << (num - 1));
+    }
+    else
+    {
+        buttons &= ~(1u << (num - 1));
+    }
+    autoSend();
+}
+
+void usb_joystick_class::setAxis(int axis, unsigned int val)
+{
+    axes[axis] = val > 1023 ? 1023 : val;
+    autoSend();
+}
@@ -0,0 +1,481 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+// Thin host-side stand-in for the Teensy Arduino core.
+// Only what the firmware actually uses is provided, so the mapping engine,
+// actions and config loaders can be built and benchmarked with the native env.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <type_traits>
+#include <strings.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define PROGMEM
+#define F(str) (str)
+
+// Time
+// The native clock runs in real time by default. delay() never sleeps; it
+// advances a virtual offset so code that waits still observes time passing.
+// Switching to manual mode freezes the clock so it only moves through
+// nativeClockAdvance()/delay(), which makes timing deterministic. Timers
+// started with IntervalTimer fire from the manual clock only.
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void nativeClockSetManual(bool manual);
+void nativeClockSet(unsigned long ms);
+void nativeClockAdvance(unsigned long ms);
+
+inline void interrupts() {}
+inline void noInterrupts() {}
+inline void __disable_irq() {}
+inline void __enable_irq() {}
+
+template <typename A, typename B>
+inline typename std::common_type<A, B>::type min(A a, B b) { return (a < b) ? a : b; }
+template <typename A, typename B>
+inline typename std::common_type<A, B>::type max(A a, B b) { return (a > b) ? a : b; }
+template <typename T, typename L, typename H>
+inline T constrain(T x, L low, H high) { return (x < low) ? low : ((x > high) ? high : x); }
+
+inline int stricmp(const char *a, const char *b) { return strcasecmp(a, b); }
+
+// String
+class String
+{
+public:
+    String() {}
+    String(const char *s) : str(s ? s : "") {}
+    String(const std::string &s) : str(s) {}
+    String(char c) : str(1, c) {}
+    String(int v) : str(std::to_string(v)) {}
+    String(unsigned int v) : str(std::to_string(v)) {}
+    String(long v) : str(std::to_string(v)) {}
+    String(unsigned long v) : str(std::to_string(v)) {}
+
+    unsigned int length() const { return (unsigned int)str.length(); }
+    const char *c_str() const { return str.c_str(); }
+
+    int lastIndexOf(char c) const
+    {
+        size_t pos = str.rfind(c);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+
+    int indexOf(char c) const
+    {
+        size_t pos = str.find(c);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+
+    String substring(unsigned int from) const
+    {
+        return from >= str.length() ? String() : String(str.substr(from));
+    }
+
+    String substring(unsigned int from, unsigned int to) const
+    {
+        if (from >= str.length() || to <= from)
+            return String();
+        return String(str.substr(from, to - from));
+    }
+
+    void remove(unsigned int index) { remove(index, (unsigned int)str.length()); }
+    void remove(unsigned int index, unsigned int count)
+    {
+        if (index < str.length())
+            str.erase(index, count);
+    }
+
+    void toCharArray(char *buf, unsigned int bufsize) const
+    {
+        if (buf == nullptr || bufsize == 0)
+            return;
+        strncpy(buf, str.c_str(), bufsize - 1);
+        buf[bufsize - 1] = '\0';
+    }
+
+    String &operator+=(const String &o) { str += o.str; return *this; }
+    String &operator+=(const char *s) { str += s; return *this; }
+    String &operator+=(char c) { str += c; return *this; }
+
+    friend String operator+(const String &a, const String &b) { return String(a.str + b.str); }
+    friend String operator+(const String &a, const char *b) { return String(a.str + b); }
+
+    bool operator==(const String &o) const { return str == o.str; }
+    bool operator==(const char *s) const { return str == s; }
+    bool operator!=(const String &o) const { return str != o.str; }
+
+private:
+    std::string str;
+};
+
+// Print
+class Print
+{
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t b) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+        size_t n = 0;
+        while (size--)
+            n += write(*buffer++);
+        return n;
+    }
+    size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+
+    size_t print(const char *s) { return write(s); }
+    size_t print(const String &s) { return write(s.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int n, int base = DEC) { return printNumber((long)n, base); }
+    size_t print(unsigned int n, int base = DEC) { return printUnsigned(n, base); }
+    size_t print(long n, int base = DEC) { return printNumber(n, base); }
+    size_t print(unsigned long n, int base = DEC) { return printUnsigned(n, base); }
+    size_t print(long long n, int base = DEC) { return printNumber((long)n, base); }
+    size_t print(unsigned long long n, int base = DEC) { return printUnsigned((unsigned long)n, base); }
+    size_t print(double n, int digits = 2)
+    {
+        char buf[48];
+        snprintf(buf, sizeof(buf), "%.*f", digits, n);
+        return write(buf);
+    }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T &v) { size_t n = print(v); return n + println(); }
+    template <typename T>
+    size_t println(const T &v, int mod) { size_t n = print(v, mod); return n + println(); }
+
+private:
+    size_t printNumber(long n, int base)
+    {
+        if (base == DEC)
+        {
+            char buf[24];
+            snprintf(buf, sizeof(buf), "%ld", n);
+            return write(buf);
+        }
+        return printUnsigned((unsigned long)n, base);
+    }
+
+    size_t printUnsigned(unsigned long n, int base)
+    {
+        char buf[72];
+        char *p = &buf[sizeof(buf) - 1];
+        *p = '\0';
+        if (base < 2)
+            base = 10;
+        do
+        {
+            int digit = (int)(n % base);
+            *--p = (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+            n /= base;
+        } while (n);
+        return write(p);
+    }
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    size_t readBytes(char *buffer, size_t length)
+    {
+        size_t count = 0;
+        while (count < length)
+        {
+            int c = read();
+            if (c < 0)
+                break;
+            *buffer++ = (char)c;
+            count++;
+        }
+        return count;
+    }
+};
+
+// USB serial. Output is discarded unless NATIVE_SERIAL_ECHO is set in the
+// environment, so firmware logging does not distort benchmark timings.
+// simAttach() connects the port to a file descriptor instead (the simulated
+// device puts a pseudo-terminal there), with a transmit buffer in front of it
+// like the USB one: what the descriptor does not take yet goes out later,
+// and availableForWrite() is the room left. simFeed() queues input as if the
+// host had sent it.
+class NativeSerial : public Stream
+{
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    operator bool() const { return true; }
+
+    size_t write(uint8_t b) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    void flush() {}
+    int availableForWrite();
+
+    void simAttach(int fd);
+    void simFeed(const uint8_t *data, size_t size);
+
+    unsigned long bytesWritten = 0;
+    int writeRoom = 4096; // Set to 0 to simulate a host that is not reading
+
+private:
+    static const size_t RX_SIZE = 4096;
+    uint8_t rx[RX_SIZE];
+    size_t rxHead = 0;
+    size_t rxTail = 0;
+    int fd = -1;
+
+    static const size_t TX_SIZE = 4096;
+    uint8_t tx[TX_SIZE];
+    size_t txLength = 0;
+
+    void receive();
+    void transmit();
+};
+
+extern NativeSerial Serial;
+
+// USB HID keyboard/mouse. Every call that would emit a USB report on the
+// Teensy increments reportCount so benchmarks can report HID traffic.
+class usb_keyboard_class : public Print
+{
+public:
+    void begin() {}
+    void end() {}
+    size_t write(uint8_t c) override { (void)c; reportCount += 2; return 1; }
+    using Print::write;
+
+    size_t press(uint16_t n);
+    size_t release(uint16_t n);
+    void releaseAll();
+
+    bool isPressed(uint16_t n) const;
+
+    unsigned long reportCount = 0;
+    unsigned long pressCount = 0;
+    unsigned long releaseCount = 0;
+    unsigned long lastPressMicros = 0;
+
+private:
+    static const int MAX_KEYS = 6;
+    uint16_t keys[MAX_KEYS] = {};
+};
+
+extern usb_keyboard_class Keyboard;
+
+#define MOUSE_LEFT 1
+#define MOUSE_MIDDLE 4
+#define MOUSE_RIGHT 2
+#define MOUSE_BACK 8
+#define MOUSE_FORWARD 16
+#define MOUSE_ALL (MOUSE_LEFT | MOUSE_RIGHT | MOUSE_MIDDLE | MOUSE_BACK | MOUSE_FORWARD)
+
+// Button state carried by the next mouse report (Teensy usb_mouse.h)
+extern uint8_t usb_mouse_buttons_state;
+
+class usb_mouse_class
+{
+public:
+    void begin() {}
+    void end() {}
+    void move(int8_t x, int8_t y, int8_t wheel = 0, int8_t horiz = 0);
+    void click(uint8_t b = MOUSE_LEFT) { press(b); release(b); }
+    void scroll(int8_t wheel, int8_t horiz = 0) { move(0, 0, wheel, horiz); }
+    void set_buttons(uint8_t left, uint8_t middle = 0, uint8_t right = 0, uint8_t back = 0, uint8_t forward = 0);
+    void press(uint8_t b = MOUSE_LEFT) { usb_mouse_buttons_state |= (b & MOUSE_ALL); move(0, 0); }
+    void release(uint8_t b = MOUSE_LEFT) { usb_mouse_buttons_state &= ~(b & MOUSE_ALL); move(0, 0); }
+    bool isPressed(uint8_t b = MOUSE_ALL) { return (usb_mouse_buttons_state & b) != 0; }
+
+    long totalX = 0;
+    long totalY = 0;
+    long totalWheel = 0;
+    long totalHoriz = 0;
+    unsigned long reportCount = 0;
+};
+
+extern usb_mouse_class Mouse;
+
+// USB HID joystick (10-bit axes, 32 buttons). With manual send only send_now()
+// emits a report; otherwise every setter does, as on the Teensy.
+class usb_joystick_class
+{
+public:
+    void begin() {}
+    void end() {}
+    void button(uint8_t num, bool val);
+    void X(unsigned int val) { setAxis(0, val); }
+    void Y(unsigned int val) { setAxis(1, val); }
+    void Z(unsigned int val) { setAxis(2, val); }
+    void Zrotate(unsigned int val) { setAxis(3, val); }
+    void sliderLeft(unsigned int val) { setAxis(4, val); }
+    void sliderRight(unsigned int val) { setAxis(5, val); }
+    void hat(int dir) { (void)dir; autoSend(); }
+    void useManualSend(bool mode) { manualMode = mode; }
+    void send_now() { reportCount++; }
+
+    static const int NUM_AXES = 6;
+    unsigned int axes[NUM_AXES] = {512, 512, 512, 512, 512, 512};
+    uint32_t buttons = 0;
+    bool manualMode = false;
+    unsigned long reportCount = 0;
+
+private:
+    void setAxis(int axis, unsigned int val);
+    void autoSend()
+    {
+        if (!manualMode)
+        {
+            reportCount++;
+        }
+    }
+};
+
+extern usb_joystick_class Joystick;
+
+// Teensy keylayouts.h key codes (US layout)
+#define MODIFIERKEY_CTRL        ( 0x01 | 0xE000 )
+#define MODIFIERKEY_SHIFT       ( 0x02 | 0xE000 )
+#define MODIFIERKEY_ALT         ( 0x04 | 0xE000 )
+#define MODIFIERKEY_GUI         ( 0x08 | 0xE000 )
+#define MODIFIERKEY_LEFT_CTRL   ( 0x01 | 0xE000 )
+#define MODIFIERKEY_LEFT_SHIFT  ( 0x02 | 0xE000 )
+#define MODIFIERKEY_LEFT_ALT    ( 0x04 | 0xE000 )
+#define MODIFIERKEY_LEFT_GUI    ( 0x08 | 0xE000 )
+#define MODIFIERKEY_RIGHT_CTRL  ( 0x10 | 0xE000 )
+#define MODIFIERKEY_RIGHT_SHIFT ( 0x20 | 0xE000 )
+#define MODIFIERKEY_RIGHT_ALT   ( 0x40 | 0xE000 )
+#define MODIFIERKEY_RIGHT_GUI   ( 0x80 | 0xE000 )
+
+#define KEY_LEFT_CTRL   MODIFIERKEY_LEFT_CTRL
+#define KEY_LEFT_SHIFT  MODIFIERKEY_LEFT_SHIFT
+#define KEY_LEFT_ALT    MODIFIERKEY_LEFT_ALT
+#define KEY_LEFT_GUI    MODIFIERKEY_LEFT_GUI
+#define KEY_RIGHT_CTRL  MODIFIERKEY_RIGHT_CTRL
+#define KEY_RIGHT_SHIFT MODIFIERKEY_RIGHT_SHIFT
+#define KEY_RIGHT_ALT   MODIFIERKEY_RIGHT_ALT
+#define KEY_RIGHT_GUI   MODIFIERKEY_RIGHT_GUI
+
+#define KEY_A           (   4  | 0xF000 )
+#define KEY_B           (   5  | 0xF000 )
+#define KEY_C           (   6  | 0xF000 )
+#define KEY_D           (   7  | 0xF000 )
+#define KEY_E           (   8  | 0xF000 )
+#define KEY_F           (   9  | 0xF000 )
+#define KEY_G           (  10  | 0xF000 )
+#define KEY_H           (  11  | 0xF000 )
+#define KEY_I           (  12  | 0xF000 )
+#define KEY_J           (  13  | 0xF000 )
+#define KEY_K           (  14  | 0xF000 )
+#define KEY_L           (  15  | 0xF000 )
+#define KEY_M           (  16  | 0xF000 )
+#define KEY_N           (  17  | 0xF000 )
+#define KEY_O           (  18  | 0xF000 )
+#define KEY_P           (  19  | 0xF000 )
+#define KEY_Q           (  20  | 0xF000 )
+#define KEY_R           (  21  | 0xF000 )
+#define KEY_S           (  22  | 0xF000 )
+#define KEY_T           (  23  | 0xF000 )
+#define KEY_U           (  24  | 0xF000 )
+#define KEY_V           (  25  | 0xF000 )
+#define KEY_W           (  26  | 0xF000 )
+#define KEY_X           (  27  | 0xF000 )
+#define KEY_Y           (  28  | 0xF000 )
+#define KEY_Z           (  29  | 0xF000 )
+#define KEY_1           (  30  | 0xF000 )
+#define KEY_2           (  31  | 0xF000 )
+#define KEY_3           (  32  | 0xF000 )
+#define KEY_4           (  33  | 0xF000 )
+#define KEY_5           (  34  | 0xF000 )
+#define KEY_6           (  35  | 0xF000 )
+#define KEY_7           (  36  | 0xF000 )
+#define KEY_8           (  37  | 0xF000 )
+#define KEY_9           (  38  | 0xF000 )
+#define KEY_0           (  39  | 0xF000 )
+#define KEY_ENTER       (  40  | 0xF000 )
+#define KEY_RETURN      KEY_ENTER
+#define KEY_ESC         (  41  | 0xF000 )
+#define KEY_BACKSPACE   (  42  | 0xF000 )
+#define KEY_TAB         (  43  | 0xF000 )
+#define KEY_SPACE       (  44  | 0xF000 )
+#define KEY_MINUS       (  45  | 0xF000 )
+#define KEY_EQUAL       (  46  | 0xF000 )
+#define KEY_LEFT_BRACE  (  47  | 0xF000 )
+#define KEY_RIGHT_BRACE (  48  | 0xF000 )
+#define KEY_BACKSLASH   (  49  | 0xF000 )
+#define KEY_NON_US_NUM  (  50  | 0xF000 )
+#define KEY_SEMICOLON   (  51  | 0xF000 )
+#define KEY_QUOTE       (  52  | 0xF000 )
+#define KEY_TILDE       (  53  | 0xF000 )
+#define KEY_COMMA       (  54  | 0xF000 )
+#define KEY_PERIOD      (  55  | 0xF000 )
+#define KEY_SLASH       (  56  | 0xF000 )
+#define KEY_CAPS_LOCK   (  57  | 0xF000 )
+#define KEY_F1          (  58  | 0xF000 )
+#define KEY_F2          (  59  | 0xF000 )
+#define KEY_F3          (  60  | 0xF000 )
+#define KEY_F4          (  61  | 0xF000 )
+#define KEY_F5          (  62  | 0xF000 )
+#define KEY_F6          (  63  | 0xF000 )
+#define KEY_F7          (  64  | 0xF000 )
+#define KEY_F8          (  65  | 0xF000 )
+#define KEY_F9          (  66  | 0xF000 )
+#define KEY_F10         (  67  | 0xF000 )
+#define KEY_F11         (  68  | 0xF000 )
+#define KEY_F12         (  69  | 0xF000 )
+#define KEY_PRINTSCREEN (  70  | 0xF000 )
+#define KEY_SCROLL_LOCK (  71  | 0xF000 )
+#define KEY_PAUSE       (  72  | 0xF000 )
+#define KEY_INSERT      (  73  | 0xF000 )
+#define KEY_HOME        (  74  | 0xF000 )
+#define KEY_PAGE_UP     (  75  | 0xF000 )
+#define KEY_DELETE      (  76  | 0xF000 )
+#define KEY_END         (  77  | 0xF000 )
+#define KEY_PAGE_DOWN   (  78  | 0xF000 )
+#define KEY_RIGHT       (  79  | 0xF000 )
+#define KEY_LEFT        (  80  | 0xF000 )
+#define KEY_DOWN        (  81  | 0xF000 )
+#define KEY_UP          (  82  | 0xF000 )
+#define KEY_NUM_LOCK    (  83  | 0xF000 )
+#define KEYPAD_SLASH    (  84  | 0xF000 )
+#define KEYPAD_ASTERIX  (  85  | 0xF000 )
+#define KEYPAD_MINUS    (  86  | 0xF000 )
+#define KEYPAD_PLUS     (  87  | 0xF000 )
+#define KEYPAD_ENTER    (  88  | 0xF000 )
+#define KEYPAD_1        (  89  | 0xF000 )
+#define KEYPAD_2        (  90  | 0xF000 )
+#define KEYPAD_3        (  91  | 0xF000 )
+#define KEYPAD_4        (  92  | 0xF000 )
+#define KEYPAD_5        (  93  | 0xF000 )
+#define KEYPAD_6        (  94  | 0xF000 )
+#define KEYPAD_7        (  95  | 0xF000 )
+#define KEYPAD_8        (  96  | 0xF000 )
+#define KEYPAD_9        (  97  | 0xF000 )
+#define KEYPAD_0        (  98  | 0xF000 )
+#define KEYPAD_PERIOD   (  99  | 0xF000 )
+
+#endif // NATIVE_ARDUINO_H
@@ -0,0 +1,7 @@
+#ifndef NATIVE_FS_H
+#define NATIVE_FS_H
+
+// FS and File live with the SD card stub
+#include <SD.h>
+
+#endif // NATIVE_FS_H
@@ -0,0 +1,79 @@
+#include <IntervalTimer.h>
+
+IntervalTimer *IntervalTimer::active[MAX_TIMERS];
+bool IntervalTimer::available = false;
+bool IntervalTimer::firing = false;
+
+bool IntervalTimer::begin(void (*newCallback)(), unsigned int microseconds)
+{
+    end();
+    if (!available || microseconds == 0)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < MAX_TIMERS; i++)
+    {
+        if (active[i] == nullptr)
+        {
+            callback = newCallback;
+            periodUs = microseconds;
+            nextDueUs = (unsigned long long)micros() + microseconds;
+            active[i] = this;
+            return true;
+        }
+    }
+    return false;
+}
+
+void IntervalTimer::end()
+{
+    for (int i = 0; i < MAX_TIMERS; i++)
+    {
+        if (active[i] == this)
+        {
+            active[i] = nullptr;
+        }
+    }
+}
+
+void IntervalTimer::simSetAvailable(bool isAvailable)
+{
+    available = isAvailable;
+}
+
+void IntervalTimer::simRunUntil(unsigned long long &nowUs, unsigned long long targetUs)
+{
+    // A callback that waits does not nest further interrupts
+    if (firing)
+    {
+        return;
+    }
+    firing = true;
+
+    while (true)
+    {
+        IntervalTimer *next = nullptr;
+        for (int i = 0; i < MAX_TIMERS; i++)
+        {
+            if (active[i] != nullptr && active[i]->nextDueUs <= targetUs &&
+                (next == nullptr || active[i]->nextDueUs < next->nextDueUs))
+            {
+                next = active[i];
+            }
+        }
+        if (next == nullptr)
+        {
+            break;
+        }
+
+        if (next->nextDueUs > nowUs)
+        {
+            nowUs = next->nextDueUs;
+        }
+        next->nextDueUs += next->periodUs;
+        next->callback();
+    }
+
+    firing = false;
+}
@@ -0,0 +1,39 @@
+#ifndef NATIVE_INTERVAL_TIMER_H
+#define NATIVE_INTERVAL_TIMER_H
+
+// Host-side stand-in for Teensy's IntervalTimer.
+// No timer is free unless a test calls simSetAvailable(true), so firmware
+// falls back to its polled path by default. Running timers fire from the
+// manual clock: when delay() or nativeClockAdvance() move time past a due
+// point, the callback runs there with micros() reading the due time, as if
+// the interrupt had cut into whatever was waiting.
+
+#include <Arduino.h>
+
+class IntervalTimer
+{
+public:
+    static const int MAX_TIMERS = 4; // PIT channels
+
+    ~IntervalTimer() { end(); }
+
+    bool begin(void (*callback)(), unsigned int microseconds);
+    void end();
+    void priority(uint8_t n) { (void)n; }
+
+    static void simSetAvailable(bool available);
+
+    // Fire everything due up to targetUs, moving nowUs along; used by the native clock
+    static void simRunUntil(unsigned long long &nowUs, unsigned long long targetUs);
+
+private:
+    void (*callback)() = nullptr;
+    unsigned long long periodUs = 0;
+    unsigned long long nextDueUs = 0;
+
+    static IntervalTimer *active[MAX_TIMERS];
+    static bool available;
+    static bool firing;
+};
+
+#endif // NATIVE_INTERVAL_TIMER_H
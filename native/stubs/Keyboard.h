@@ -0,0 +1,7 @@
+#ifndef NATIVE_KEYBOARD_H
+#define NATIVE_KEYBOARD_H
+
+// On the Teensy the Keyboard object comes from the core; the stub lives in Arduino.h.
+#include <Arduino.h>
+
+#endif // NATIVE_KEYBOARD_H
@@ -0,0 +1,46 @@
+#include <LiquidCrystal_I2C.h>
+
+LiquidCrystal_I2C::LiquidCrystal_I2C(uint8_t lcd_Addr, uint8_t lcd_cols, uint8_t lcd_rows)
+    : opCount(0), clearCount(0), initCount(0),
+      cols(lcd_cols > MAX_COLS ? MAX_COLS : lcd_cols),
+      rows(lcd_rows > MAX_ROWS ? MAX_ROWS : lcd_rows),
+      cursorCol(0), cursorRow(0), backlightOn(false)
+{
+    (void)lcd_Addr;
+    for (int r = 0; r < MAX_ROWS; r++)
+    {
+        memset(screen[r], ' ', MAX_COLS);
+        screen[r][MAX_COLS] = '\0';
+    }
+}
+
+void LiquidCrystal_I2C::clear()
+{
+    for (int r = 0; r < MAX_ROWS; r++)
+    {
+        memset(screen[r], ' ', MAX_COLS);
+        screen[r][MAX_COLS] = '\0';
+    }
+    cursorCol = 0;
+    cursorRow = 0;
+    opCount++;
+    clearCount++;
+}
+
+void LiquidCrystal_I2C::setCursor(uint8_t col, uint8_t row)
+{
+    cursorCol = col;
+    cursorRow = row < rows ? row : rows - 1;
+    opCount++;
+}
+
+size_t LiquidCrystal_I2C::write(uint8_t c)
+{
+    if (cursorCol < cols && cursorRow < rows)
+    {
+        screen[cursorRow][cursorCol] = (char)c;
+    }
+    cursorCol++;
+    opCount++;
+    return 1;
+}
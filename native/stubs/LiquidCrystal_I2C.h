@@ -0,0 +1,49 @@
+#ifndef NATIVE_LIQUIDCRYSTAL_I2C_H
+#define NATIVE_LIQUIDCRYSTAL_I2C_H
+
+// Host-side stand-in for the I2C character LCD. Writes land in a text
+// framebuffer and every bus-level operation is counted.
+
+#include <Arduino.h>
+
+class LiquidCrystal_I2C : public Print
+{
+public:
+    static const int MAX_COLS = 20;
+    static const int MAX_ROWS = 4;
+
+    LiquidCrystal_I2C(uint8_t lcd_Addr, uint8_t lcd_cols, uint8_t lcd_rows);
+
+    void init() { initCount++; clear(); }
+    void begin(uint8_t cols, uint8_t rows) { (void)cols; (void)rows; clear(); }
+    void clear();
+    void home() { setCursor(0, 0); }
+    void setCursor(uint8_t col, uint8_t row);
+    void backlight() { backlightOn = true; opCount++; }
+    void noBacklight() { backlightOn = false; opCount++; }
+    void noCursor() { opCount++; }
+    void cursor() { opCount++; }
+    void noBlink() { opCount++; }
+    void blink() { opCount++; }
+
+    size_t write(uint8_t c) override;
+    using Print::write;
+
+    // Returns the text on one row of the framebuffer
+    const char *getRow(uint8_t row) const { return row < MAX_ROWS ? screen[row] : ""; }
+    bool isBacklightOn() const { return backlightOn; }
+
+    unsigned long opCount;
+    unsigned long clearCount;
+    unsigned long initCount;
+
+private:
+    uint8_t cols;
+    uint8_t rows;
+    uint8_t cursorCol;
+    uint8_t cursorRow;
+    bool backlightOn;
+    char screen[MAX_ROWS][MAX_COLS + 1];
+};
+
+#endif // NATIVE_LIQUIDCRYSTAL_I2C_H
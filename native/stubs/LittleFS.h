@@ -0,0 +1,19 @@
+#ifndef NATIVE_LITTLEFS_H
+#define NATIVE_LITTLEFS_H
+
+// Host-side stand-in for Teensy's LittleFS. Program flash is another
+// in-memory file system like the SD card stub, kept apart from the card.
+
+#include <SD.h>
+
+class LittleFS_Program : public SDClass
+{
+public:
+    bool begin(uint32_t size)
+    {
+        (void)size;
+        return true;
+    }
+};
+
+#endif // NATIVE_LITTLEFS_H
@@ -0,0 +1,7 @@
+#ifndef NATIVE_MOUSE_H
+#define NATIVE_MOUSE_H
+
+// On the Teensy the Mouse object comes from the core; the stub lives in Arduino.h.
+#include <Arduino.h>
+
+#endif // NATIVE_MOUSE_H
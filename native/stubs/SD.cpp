@@ -0,0 +1,202 @@
+#include <SD.h>
+
+SDClass SD;
+
+int File::available()
+{
+    if (!data)
+    {
+        return 0;
+    }
+    return pos < data->size() ? (int)(data->size() - pos) : 0;
+}
+
+int File::read()
+{
+    if (!data || pos >= data->size())
+    {
+        return -1;
+    }
+    if (owner)
+    {
+        owner->bytesRead++;
+    }
+    return (uint8_t)(*data)[pos++];
+}
+
+int File::peek()
+{
+    if (!data || pos >= data->size())
+    {
+        return -1;
+    }
+    return (uint8_t)(*data)[pos];
+}
+
+int File::read(void *buf, size_t nbyte)
+{
+    if (!data || pos >= data->size())
+    {
+        return 0;
+    }
+    size_t count = data->size() - pos;
+    if (count > nbyte)
+    {
+        count = nbyte;
+    }
+    memcpy(buf, data->data() + pos, count);
+    pos += count;
+    if (owner)
+    {
+        owner->bytesRead += count;
+    }
+    return (int)count;
+}
+
+size_t File::write(uint8_t b)
+{
+    return write(&b, 1);
+}
+
+size_t File::write(const uint8_t *buf, size_t size)
+{
+    if (!data || !writable)
+    {
+        return 0;
+    }
+    data->append((const char *)buf, size);
+    pos = data->size();
+    if (owner)
+    {
+        owner->bytesWritten += size;
+    }
+    return size;
+}
+
+bool File::seek(uint32_t newPos)
+{
+    if (!data || newPos > data->size())
+    {
+        return false;
+    }
+    pos = newPos;
+    return true;
+}
+
+uint32_t File::size() const
+{
+    return data ? (uint32_t)data->size() : 0;
+}
+
+void File::close()
+{
+    data.reset();
+    isDir = false;
+    writable = false;
+}
+
+File File::openNextFile(uint8_t mode)
+{
+    File entry;
+    if (!isDir || owner == nullptr)
+    {
+        return entry;
+    }
+
+    size_t index = 0;
+    for (auto &kv : owner->files)
+    {
+        if (index++ == dirIndex)
+        {
+            dirIndex++;
+            entry.data = kv.second;
+            entry.fileName = kv.first.substr(1);
+            entry.writable = (mode == FILE_WRITE);
+            entry.owner = owner;
+            return entry;
+        }
+    }
+    return entry;
+}
+
+std::string SDClass::normalise(const char *filepath)
+{
+    std::string path = filepath ? filepath : "";
+    if (path.empty() || path[0] != '/')
+    {
+        path = "/" + path;
+    }
+    return path;
+}
+
+bool SDClass::begin(uint8_t csPin)
+{
+    (void)csPin;
+    delay(accessDelayMs);
+    return present;
+}
+
+File SDClass::open(const char *filepath, uint8_t mode)
+{
+    File file;
+    if (!present)
+    {
+        return file;
+    }
+
+    openCount++;
+    delay(accessDelayMs);
+    std::string path = normalise(filepath);
+    file.owner = this;
+
+    if (path == "/")
+    {
+        file.isDir = true;
+        file.fileName = "/";
+        return file;
+    }
+
+    auto it = files.find(path);
+    if (it == files.end())
+    {
+        if (mode != FILE_WRITE)
+        {
+            file.owner = nullptr;
+            return file;
+        }
+        it = files.emplace(path, std::make_shared<std::string>()).first;
+    }
+
+    file.data = it->second;
+    file.fileName = path.substr(1);
+    file.writable = (mode == FILE_WRITE);
+    file.pos = file.writable ? (uint32_t)file.data->size() : 0;
+    return file;
+}
+
+bool SDClass::exists(const char *filepath)
+{
+    return present && files.count(normalise(filepath)) > 0;
+}
+
+bool SDClass::remove(const char *filepath)
+{
+    return present && files.erase(normalise(filepath)) > 0;
+}
+
+bool SDClass::rename(const char *oldPath, const char *newPath)
+{
+    auto it = files.find(normalise(oldPath));
+    if (!present || it == files.end())
+    {
+        return false;
+    }
+    files[normalise(newPath)] = it->second;
+    files.erase(it);
+    return true;
+}
+
+void SDClass::simWriteFile(const char *filepath, const std::string &contents)
+{
+    files[normalise(filepath)] = std::make_shared<std::string>(contents);
+}
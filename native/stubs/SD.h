@@ -0,0 +1,102 @@
+#ifndef NATIVE_SD_H
+#define NATIVE_SD_H
+
+// Host-side stand-in for the Teensy SD library backed by an in-memory,
+// single-directory file system. Reads and writes are counted.
+
+#include <Arduino.h>
+#include <map>
+#include <memory>
+
+#define BUILTIN_SDCARD 254
+
+#define FILE_READ 0
+#define FILE_WRITE 1
+
+class SDClass;
+
+class File : public Stream
+{
+public:
+    File() {}
+
+    operator bool() const { return isDir || data != nullptr; }
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    int read(void *buf, size_t nbyte);
+    size_t write(uint8_t b) override;
+    size_t write(const uint8_t *buf, size_t size) override;
+    using Print::write;
+
+    bool seek(uint32_t pos);
+    uint32_t position() const { return pos; }
+    uint32_t size() const;
+    void flush() {}
+    void close();
+
+    const char *name() const { return fileName.c_str(); }
+    bool isDirectory() const { return isDir; }
+    File openNextFile(uint8_t mode = FILE_READ);
+    void rewindDirectory() { dirIndex = 0; }
+
+private:
+    friend class SDClass;
+
+    std::shared_ptr<std::string> data;
+    std::string fileName;
+    uint32_t pos = 0;
+    bool writable = false;
+    bool isDir = false;
+    size_t dirIndex = 0;
+    SDClass *owner = nullptr;
+};
+
+// Common base of the Teensy file systems (FS.h in the core)
+class FS
+{
+public:
+    virtual ~FS() {}
+    virtual File open(const char *filepath, uint8_t mode = FILE_READ) = 0;
+    virtual bool exists(const char *filepath) = 0;
+    virtual bool mkdir(const char *filepath) = 0;
+    virtual bool rename(const char *oldPath, const char *newPath) = 0;
+    virtual bool remove(const char *filepath) = 0;
+};
+
+class SDClass : public FS
+{
+public:
+    bool begin(uint8_t csPin = BUILTIN_SDCARD);
+    File open(const char *filepath, uint8_t mode = FILE_READ) override;
+    bool exists(const char *filepath) override;
+    bool remove(const char *filepath) override;
+    bool rename(const char *oldPath, const char *newPath) override;
+    bool mkdir(const char *filepath) override { (void)filepath; return true; }
+
+    // Host helpers
+    void simWriteFile(const char *filepath, const std::string &contents);
+    void simClear() { files.clear(); }
+    void simSetPresent(bool isPresent) { present = isPresent; }
+
+    // Time a mount or an open takes, as delay(); 0 = instant
+    void simSetAccessDelay(unsigned long ms) { accessDelayMs = ms; }
+
+    unsigned long openCount = 0;
+    unsigned long bytesRead = 0;
+    unsigned long bytesWritten = 0;
+
+private:
+    friend class File;
+
+    static std::string normalise(const char *filepath);
+
+    std::map<std::string, std::shared_ptr<std::string>> files;
+    bool present = true;
+    unsigned long accessDelayMs = 0;
+};
+
+extern SDClass SD;
+
+#endif // NATIVE_SD_H
@@ -0,0 +1,216 @@
+#ifndef NATIVE_USBHOST_T36_H
+#define NATIVE_USBHOST_T36_H
+
+// Host-side stand-in for USBHost_t36. Devices never enumerate on their own;
+// benchmarks drive them through the sim* methods instead. simConnect() and
+// simDisconnect() call the same claim/disconnect hooks the real host does,
+// so code overriding them sees plug and unplug like on hardware.
+
+#include <Arduino.h>
+
+struct Device_t;
+
+typedef enum
+{
+    CLAIM_NO = 0,
+    CLAIM_REPORT,
+    CLAIM_INTERFACE
+} hidclaim_t;
+
+class USBHost
+{
+public:
+    void begin() {}
+    void Task() {}
+};
+
+class USBHub
+{
+public:
+    USBHub(USBHost &host) { (void)host; }
+};
+
+class USBHIDParser
+{
+public:
+    USBHIDParser(USBHost &host) { (void)host; }
+};
+
+class KeyboardController
+{
+public:
+    KeyboardController(USBHost &host) { (void)host; }
+
+    operator bool() { return vid != 0; }
+    uint16_t idVendor() { return vid; }
+    uint16_t idProduct() { return pid; }
+
+    void attachPress(void (*f)(int unicode)) { pressFunction = f; }
+    void attachRelease(void (*f)(int unicode)) { releaseFunction = f; }
+    void attachExtrasPress(void (*f)(uint32_t top, uint16_t code)) { extrasPressFunction = f; }
+    void attachExtrasRelease(void (*f)(uint32_t top, uint16_t code)) { extrasReleaseFunction = f; }
+
+    // Boot keyboards are claimed as a USB driver
+    void simConnect(uint16_t vendor, uint16_t product)
+    {
+        vid = vendor;
+        pid = product;
+        claim(nullptr, 0, nullptr, 0);
+    }
+
+    void simDisconnect()
+    {
+        disconnect();
+        vid = 0;
+        pid = 0;
+    }
+    void simKeyPress(int unicode)
+    {
+        if (pressFunction)
+            pressFunction(unicode);
+    }
+    void simKeyRelease(int unicode)
+    {
+        if (releaseFunction)
+            releaseFunction(unicode);
+    }
+
+protected:
+    virtual bool claim(Device_t *dev, int type, const uint8_t *descriptors, uint32_t len) { return true; }
+    virtual void disconnect() {}
+    virtual hidclaim_t claim_collection(USBHIDParser *driver, Device_t *dev, uint32_t topusage) { return CLAIM_REPORT; }
+    virtual void disconnect_collection(Device_t *dev) {}
+
+private:
+    uint16_t vid = 0;
+    uint16_t pid = 0;
+    void (*pressFunction)(int unicode) = nullptr;
+    void (*releaseFunction)(int unicode) = nullptr;
+    void (*extrasPressFunction)(uint32_t top, uint16_t code) = nullptr;
+    void (*extrasReleaseFunction)(uint32_t top, uint16_t code) = nullptr;
+};
+
+class MouseController
+{
+public:
+    MouseController(USBHost &host) { (void)host; }
+
+    bool available() { return connected; }
+
+    void simConnect()
+    {
+        connected = true;
+        claim_collection(nullptr, nullptr, 0x10002);
+    }
+
+    void simDisconnect()
+    {
+        disconnect_collection(nullptr);
+        connected = false;
+    }
+
+protected:
+    virtual hidclaim_t claim_collection(USBHIDParser *driver, Device_t *dev, uint32_t topusage) { return CLAIM_REPORT; }
+    virtual void disconnect_collection(Device_t *dev) {}
+
+private:
+    bool connected = false;
+};
+
+class JoystickController
+{
+public:
+    typedef enum
+    {
+        UNKNOWN = 0,
+        PS3,
+        PS4,
+        XBOXONE,
+        XBOX360,
+        PS3_MOTION,
+        SpaceNav,
+        SWITCH
+    } joytype_t;
+
+    static const int STANDARD_AXIS_COUNT = 10;
+    static const int TOTAL_AXIS_COUNT = 64;
+
+    JoystickController(USBHost &host) { (void)host; }
+
+    operator bool() { return vid != 0; }
+    bool available() { return vid != 0; }
+    uint16_t idVendor() { return vid; }
+    uint16_t idProduct() { return pid; }
+    joytype_t joystickType() { return type; }
+
+    uint32_t getButtons() { return buttons; }
+    int getAxis(uint32_t index) { return index < TOTAL_AXIS_COUNT ? axis[index] : 0; }
+    uint64_t axisMask() { return mask; }
+
+    void simConnect(joytype_t joyType, uint16_t vendor, uint16_t product)
+    {
+        type = joyType;
+        vid = vendor;
+        pid = product;
+        buttons = 0;
+        mask = 0;
+        for (int i = 0; i < TOTAL_AXIS_COUNT; i++)
+        {
+            axis[i] = 0;
+        }
+
+        // Xbox pads have their own driver, the rest come in through the HID parser
+        if (joyType == XBOX360 || joyType == XBOXONE)
+        {
+            claim(nullptr, 0, nullptr, 0);
+        }
+        else
+        {
+            claim_collection(nullptr, nullptr, 0x10005);
+        }
+    }
+
+    void simDisconnect()
+    {
+        if (type == XBOX360 || type == XBOXONE)
+        {
+            disconnect();
+        }
+        else
+        {
+            disconnect_collection(nullptr);
+        }
+        type = UNKNOWN;
+        vid = 0;
+        pid = 0;
+        buttons = 0;
+        mask = 0;
+    }
+
+    void simSetButtons(uint32_t value) { buttons = value; }
+
+    void simSetAxis(uint32_t index, int value)
+    {
+        if (index < TOTAL_AXIS_COUNT)
+        {
+            axis[index] = value;
+            mask |= (1ULL << index);
+        }
+    }
+
+protected:
+    virtual bool claim(Device_t *dev, int type, const uint8_t *descriptors, uint32_t len) { return true; }
+    virtual void disconnect() {}
+    virtual hidclaim_t claim_collection(USBHIDParser *driver, Device_t *dev, uint32_t topusage) { return CLAIM_REPORT; }
+    virtual void disconnect_collection(Device_t *dev) {}
+
+private:
+    joytype_t type = UNKNOWN;
+    uint16_t vid = 0;
+    uint16_t pid = 0;
+    uint32_t buttons = 0;
+    uint64_t mask = 0;
+    int axis[TOTAL_AXIS_COUNT] = {};
+};
+
+#endif // NATIVE_USBHOST_T36_H
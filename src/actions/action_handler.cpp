@@ -11,10 +11,11 @@
 #include "actions/stick_mode_menu_action.h"
 #include "actions/trigger_config_menu_action.h"
 #include "actions/trigger_mode_menu_action.h"
+#include "actions/profile_bindings_menu_action.h"
 #include "devices.h"
 
 ActionHandler::ActionHandler(DeviceManager *dev)
-    : devices(dev), currentAction(nullptr), actionInitialized(false), actionStackSize(0)
+    : devices(dev), currentAction(nullptr), pendingHook(PendingHook::NONE), actionStackSize(0)
 {
     for (int i = 0; i < MAX_ACTION_STACK_SIZE; i++)
     {
@@ -32,6 +33,7 @@ ActionHandler::ActionHandler(DeviceManager *dev)
     stickModeMenuAction = new StickModeMenuAction(devices, this, {});
     triggerConfigMenuAction = new TriggerConfigMenuAction(devices, this);
     triggerModeMenuAction = new TriggerModeMenuAction(devices, this);
+    profileBindingsMenuAction = new ProfileBindingsMenuAction(devices, this);
 }
 
 ActionHandler::~ActionHandler()
@@ -55,33 +57,76 @@ ActionHandler::~ActionHandler()
     delete stickModeMenuAction;   
     delete triggerConfigMenuAction;
     delete triggerModeMenuAction;
+    delete profileBindingsMenuAction;
 }
 
-void ActionHandler::setup()
+void ActionHandler::setup(const char *bootProfile)
 {
-    activateRun({"/Default.json"});
+    RunActionParams params;
+    strncpy(params.filename, bootProfile, sizeof(params.filename) - 1);
+    params.filename[sizeof(params.filename) - 1] = '\0';
+    activateRun(params);
+}
+
+void ActionHandler::onStorageReady()
+{
+    runAction->onStorageReady();
+}
+
+void ActionHandler::inputFrame()
+{
+    runAction->inputFrame();
+}
+
+void ActionHandler::sendReports()
+{
+    runAction->sendReports();
+}
+
+bool ActionHandler::publishConfig(int pad)
+{
+    return runAction->publishConfig(pad);
+}
+
+bool ActionHandler::loadProfile(int pad, const char *json, size_t length, const char *filename)
+{
+    return runAction->loadProfile(pad, json, length, filename);
 }
 
 void ActionHandler::loop()
 {
-    if (currentAction != nullptr)
+    if (currentAction == nullptr)
     {
-        if (!actionInitialized)
+        return;
+    }
+
+    if (pendingHook != PendingHook::NONE)
+    {
+        PendingHook hook = pendingHook;
+        pendingHook = PendingHook::NONE;
+
+        if (hook == PendingHook::ENTER)
+        {
+            currentAction->onEnter();
+        }
+        else
+        {
+            currentAction->onResume();
+        }
+
+        // The hook moved on to another action (e.g. Save As opening text input)
+        if (pendingHook != PendingHook::NONE)
         {
-            currentAction->init();
-            actionInitialized = true;
+            return;
         }
-        currentAction->loop();
     }
+
+    currentAction->loop();
 }
 
 void ActionHandler::activateRun(RunActionParams params)
 {
-    for (int i = 0; i < actionStackSize; i++)
-    {
-        actionStack[i] = nullptr;
-    }
-    actionStackSize = 0;
+    exitAll();
 
     runAction->setParams(params);
     replaceCurrentAction(runAction);
@@ -142,10 +187,15 @@ void ActionHandler::activateTriggerModeMenu()
     pushAction(triggerModeMenuAction);
 }
 
+void ActionHandler::activateProfileBindingsMenu()
+{
+    pushAction(profileBindingsMenuAction);
+}
+
 void ActionHandler::clearAction()
 {
     currentAction = nullptr;
-    actionInitialized = false;
+    pendingHook = PendingHook::NONE;
 }
 
 void ActionHandler::pushAction(Action *action)
@@ -157,16 +207,33 @@ void ActionHandler::pushAction(Action *action)
             actionStack[actionStackSize] = currentAction;
             actionStackSize++;
         }
+        currentAction->onSuspend();
     }
 
     currentAction = action;
-    actionInitialized = false;
+    pendingHook = PendingHook::ENTER;
 }
 
 void ActionHandler::replaceCurrentAction(Action *action)
 {
     currentAction = action;
-    actionInitialized = false;
+    pendingHook = PendingHook::ENTER;
+}
+
+void ActionHandler::exitAll()
+{
+    if (currentAction != nullptr)
+    {
+        currentAction->onExit();
+        currentAction = nullptr;
+    }
+
+    while (actionStackSize > 0)
+    {
+        actionStackSize--;
+        actionStack[actionStackSize]->onExit();
+        actionStack[actionStackSize] = nullptr;
+    }
 }
 
 void ActionHandler::popAction()
@@ -176,18 +243,32 @@ void ActionHandler::popAction()
         return;
     }
 
-    currentAction = nullptr;
+    currentAction->onExit();
 
     actionStackSize--;
     currentAction = actionStack[actionStackSize];
     actionStack[actionStackSize] = nullptr;
-    actionInitialized = false;
+    pendingHook = PendingHook::RESUME;
 }
 
 void ActionHandler::popToRunAction()
 {
-    while (actionStackSize > 0)
+    if (actionStackSize == 0)
+    {
+        return;
+    }
+
+    // Only the action that ends up on top is resumed, the ones in between just exit
+    currentAction->onExit();
+    while (actionStackSize > 1)
     {
-        popAction();
+        actionStackSize--;
+        actionStack[actionStackSize]->onExit();
+        actionStack[actionStackSize] = nullptr;
     }
-}
\ No newline at end of file
+
+    actionStackSize--;
+    currentAction = actionStack[actionStackSize];
+    actionStack[actionStackSize] = nullptr;
+    pendingHook = PendingHook::RESUME;
+}
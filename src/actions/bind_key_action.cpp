@@ -3,6 +3,7 @@
 #include "mapping/joystick_mappings.h"
 #include "mapping/keyboard_mapping.h"
 #include "devices.h"
+#include "logging/log.h"
 
 BindKeyAction::BindKeyAction(DeviceManager *dev, ActionHandler *hdlr, BindKeyActionParams p)
     : Action(dev, hdlr), params(p), lastDisplayUpdate(0)
@@ -45,12 +46,7 @@ void BindKeyAction::loop()
         {
             int keyCode = KeyboardMapping::unicodeToKeyCode(unicode);
 
-            Serial.print("BindKeyAction: Received unicode ");
-            Serial.print(unicode);
-            Serial.print(", 0x");
-            Serial.print(unicode, HEX);
-            Serial.print(", converted to keyCode ");
-            Serial.println(keyCode);
+            LOG_DEBUG("BindKeyAction: Received unicode %d, 0x%x, converted to keyCode %d", unicode, unicode, keyCode);
 
             applyKeyBinding(keyCode);
 
@@ -69,8 +65,7 @@ void BindKeyAction::loop()
 void BindKeyAction::setParams(BindKeyActionParams p)
 {
     params = p;
-    Serial.print("BindKeyAction: setParams() called with mappingIndex: ");
-    Serial.println(params.mappingIndex);
+    LOG_DEBUG("BindKeyAction: setParams() called with mappingIndex: %d", params.mappingIndex);
 }
 
 void BindKeyAction::updateDisplay()
@@ -89,7 +84,8 @@ void BindKeyAction::updateDisplay()
 
     if (params.target == BindKeyTarget::BUTTON_MAPPING)
     {
-        const char *buttonName = JoystickMapping::getGenericButtonName(mappingConfig.mappings[params.mappingIndex].genericButton);
+        char buttonName[JoystickMapping::MAX_CHORD_NAME_LENGTH];
+        JoystickMapping::formatChordName(mappingConfig.mappings[params.mappingIndex].genericButton, mappingConfig.mappings[params.mappingIndex].chordButtons, buttonName, sizeof(buttonName));
         targetName = String(buttonName);
     }
     else if (params.target == BindKeyTarget::TRIGGER_LEFT)
@@ -136,12 +132,6 @@ void BindKeyAction::updateDisplay()
 
 void BindKeyAction::applyKeyBinding(int keyCode)
 {
-    Serial.print("BindKeyAction: Binding key ");
-    Serial.print(KeyboardMapping::keyCodeToString(keyCode));
-    Serial.print(" (code: ");
-    Serial.print(keyCode);
-    Serial.print(") to ");
-
     String targetName;
     const char* stickSide = params.isRightStick ? "Right" : "Left";
     StickConfig* stickConfig = params.isRightStick ? &mappingConfig.rightStick : &mappingConfig.leftStick;
@@ -149,55 +139,48 @@ void BindKeyAction::applyKeyBinding(int keyCode)
     // Update the mapping configuration based on target type
     if (params.target == BindKeyTarget::BUTTON_MAPPING)
     {
-        const char *buttonName = JoystickMapping::getGenericButtonName(mappingConfig.mappings[params.mappingIndex].genericButton);
-        Serial.println(buttonName);
+        char buttonName[JoystickMapping::MAX_CHORD_NAME_LENGTH];
+        JoystickMapping::formatChordName(mappingConfig.mappings[params.mappingIndex].genericButton, mappingConfig.mappings[params.mappingIndex].chordButtons, buttonName, sizeof(buttonName));
         targetName = String(buttonName);
         mappingConfig.mappings[params.mappingIndex].keyCode = keyCode;
+        mappingConfig.mappings[params.mappingIndex].macro = ButtonMapping::NO_MACRO;
     }
     else if (params.target == BindKeyTarget::TRIGGER_LEFT)
     {
-        Serial.println("Left Trigger");
         targetName = "Left Trigger";
         mappingConfig.triggers.keyLeft = keyCode;
     }
     else if (params.target == BindKeyTarget::TRIGGER_RIGHT)
     {
-        Serial.println("Right Trigger");
         targetName = "Right Trigger";
         mappingConfig.triggers.keyRight = keyCode;
     }
     else if (params.target == BindKeyTarget::STICK_UP)
     {
-        Serial.print(stickSide);
-        Serial.println(" Stick Up");
         targetName = String(stickSide) + " Stick Up";
         stickConfig->keyUp = keyCode;
     }
     else if (params.target == BindKeyTarget::STICK_DOWN)
     {
-        Serial.print(stickSide);
-        Serial.println(" Stick Down");
         targetName = String(stickSide) + " Stick Down";
         stickConfig->keyDown = keyCode;
     }
     else if (params.target == BindKeyTarget::STICK_LEFT)
     {
-        Serial.print(stickSide);
-        Serial.println(" Stick Left");
         targetName = String(stickSide) + " Stick Left";
         stickConfig->keyLeft = keyCode;
     }
     else if (params.target == BindKeyTarget::STICK_RIGHT)
     {
-        Serial.print(stickSide);
-        Serial.println(" Stick Right");
         targetName = String(stickSide) + " Stick Right";
         stickConfig->keyRight = keyCode;
     }
 
+    LOG_INFO("BindKeyAction: Binding key %s (code: %d) to %s", KeyboardMapping::keyCodeToString(keyCode), keyCode, targetName.c_str());
+
     // Mark config as modified
     mappingConfig.modified = true;
-    Serial.println("BindKeyAction: Config marked as modified");
+    LOG_DEBUG("BindKeyAction: Config marked as modified");
 
     // Show confirmation on LCD
     LiquidCrystal_I2C *lcd = devices->getLCD();
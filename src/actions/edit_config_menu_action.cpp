@@ -10,6 +10,10 @@ namespace {
     constexpr const char* MENU_LEFT_STICK = "left_stick";
     constexpr const char* MENU_RIGHT_STICK = "right_stick";
     constexpr const char* MENU_TRIGGERS = "triggers";
+
+    // Turbo rates offered in the menu, in Hz (0 = off)
+    const uint8_t TURBO_RATES[] = {0, 5, 10, 15, 20, 25, 30};
+    const int NUM_TURBO_RATES = sizeof(TURBO_RATES) / sizeof(TURBO_RATES[0]);
 }
 
 EditConfigMenuAction::EditConfigMenuAction(DeviceManager *dev, ActionHandler *hdlr)
@@ -58,10 +62,26 @@ void EditConfigMenuAction::buildMenuItems()
 
     for (int i = 0; i < itemCount; i++)
     {
-        const char *buttonName = JoystickMapping::getGenericButtonName(mappingConfig.mappings[i].genericButton);
-        const char *keyName = KeyboardMapping::keyCodeToString(mappingConfig.mappings[i].keyCode);
-
-        snprintf(nameBuffer, sizeof(nameBuffer), "%s > %s", buttonName, keyName);
+        char buttonName[JoystickMapping::MAX_CHORD_NAME_LENGTH];
+        JoystickMapping::formatChordName(mappingConfig.mappings[i].genericButton, mappingConfig.mappings[i].chordButtons, buttonName, sizeof(buttonName));
+        const char *keyName = mappingConfig.mappings[i].macro != ButtonMapping::NO_MACRO
+                                  ? "Macro"
+                                  : KeyboardMapping::keyCodeToString(mappingConfig.mappings[i].keyCode);
+
+        if (mappingConfig.mappings[i].holdKeyCode != 0)
+        {
+            // Tap key / hold key
+            snprintf(nameBuffer, sizeof(nameBuffer), "%s > %s/%s", buttonName, keyName,
+                     KeyboardMapping::keyCodeToString(mappingConfig.mappings[i].holdKeyCode));
+        }
+        else if (mappingConfig.mappings[i].turboRate != 0)
+        {
+            snprintf(nameBuffer, sizeof(nameBuffer), "%s > %s T%d", buttonName, keyName, mappingConfig.mappings[i].turboRate);
+        }
+        else
+        {
+            snprintf(nameBuffer, sizeof(nameBuffer), "%s > %s", buttonName, keyName);
+        }
 
         char idBuffer[MenuItem::MAX_ID_LEN];
         snprintf(idBuffer, sizeof(idBuffer), "mapping_%d", i);
@@ -83,8 +103,11 @@ String EditConfigMenuAction::getButtonKeyPair(int index)
         return String("Invalid");
     }
 
-    const char *buttonName = JoystickMapping::getGenericButtonName(mappingConfig.mappings[index].genericButton);
-    const char *keyName = KeyboardMapping::keyCodeToString(mappingConfig.mappings[index].keyCode);
+    char buttonName[JoystickMapping::MAX_CHORD_NAME_LENGTH];
+    JoystickMapping::formatChordName(mappingConfig.mappings[index].genericButton, mappingConfig.mappings[index].chordButtons, buttonName, sizeof(buttonName));
+    const char *keyName = mappingConfig.mappings[index].macro != ButtonMapping::NO_MACRO
+                              ? "Macro"
+                              : KeyboardMapping::keyCodeToString(mappingConfig.mappings[index].keyCode);
 
     static char resultBuffer[32];
 
@@ -129,3 +152,57 @@ void EditConfigMenuAction::onConfirm()
         return;
     }
 }
+
+void EditConfigMenuAction::onLeft()
+{
+    changeTurboRate(true);
+}
+
+void EditConfigMenuAction::onRight()
+{
+    changeTurboRate(false);
+}
+
+void EditConfigMenuAction::changeTurboRate(bool isDecrease)
+{
+    MenuItem selectedItem = getSelectedItem();
+
+    // Only plain key mappings have turbo, macros and tap-hold keys have their own timing
+    if (strncmp(selectedItem.identifier, "mapping_", 8) != 0)
+    {
+        return;
+    }
+
+    int mappingIndex = selectedItem.data;
+    if (mappingIndex < 0 || mappingIndex >= mappingConfig.numMappings ||
+        mappingConfig.mappings[mappingIndex].macro != ButtonMapping::NO_MACRO ||
+        mappingConfig.mappings[mappingIndex].holdKeyCode != 0)
+    {
+        return;
+    }
+
+    ButtonMapping &mapping = mappingConfig.mappings[mappingIndex];
+
+    // Step to the neighbouring rate in the list
+    int step = 0;
+    while (step < NUM_TURBO_RATES - 1 && TURBO_RATES[step] < mapping.turboRate)
+    {
+        step++;
+    }
+
+    if (isDecrease)
+    {
+        step = step > 0 ? step - 1 : 0;
+    }
+    else if (TURBO_RATES[step] <= mapping.turboRate)
+    {
+        step = min(step + 1, NUM_TURBO_RATES - 1);
+    }
+
+    if (TURBO_RATES[step] != mapping.turboRate)
+    {
+        mapping.turboRate = TURBO_RATES[step];
+        mappingConfig.modified = true;
+        needsRefresh = true;
+    }
+}
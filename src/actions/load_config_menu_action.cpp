@@ -2,14 +2,15 @@
 #include "actions/action_handler.h"
 #include "devices.h"
 #include "utils.h"
-#include <SD.h>
+#include "mapping/mapping_config.h"
+#include "logging/log.h"
 
 namespace {
     constexpr const char* MENU_ERROR = "error";
 }
 
 LoadConfigMenuAction::LoadConfigMenuAction(DeviceManager *dev, ActionHandler *hdlr)
-    : MenuAction(dev, hdlr)
+    : MenuAction(dev, hdlr), scanValid(false), scanFileChangeCount(0), scanCount(0)
 {
     // Set the fixed title in constructor since it never changes
     setTitle("Configs");
@@ -17,71 +18,68 @@ LoadConfigMenuAction::LoadConfigMenuAction(DeviceManager *dev, ActionHandler *hd
 
 void LoadConfigMenuAction::onInit()
 {
-    Serial.println("LoadConfigMenuAction: Scanning for config files...");
+    if (scanValid && scanFileChangeCount == MappingConfig::getFileChangeCount())
+    {
+        LOG_DEBUG("LoadConfigMenuAction: Using cached file list");
+        return;
+    }
+
+    LOG_DEBUG("LoadConfigMenuAction: Scanning for config files...");
     
     // Scan for JSON files on SD card
     scanConfigFiles();
     
-    Serial.println("LoadConfigMenuAction setup complete");
+    LOG_DEBUG("LoadConfigMenuAction setup complete");
 }
 
-void LoadConfigMenuAction::scanConfigFiles()
+void LoadConfigMenuAction::onListEntry(void *context, const char *filename, const StorageStat &stat)
 {
-    clear();
-
-    // Title already set in constructor
-    int fileCount = 0;
-
-    // Open root directory
-    File root = SD.open("/");
-    if (!root)
+    LoadConfigMenuAction *action = static_cast<LoadConfigMenuAction *>(context);
+    if (stat.isDirectory || action->scanCount >= MAX_CONFIG_FILES)
     {
-        Serial.println("LoadConfigMenuAction: Failed to open root directory");
-        // Reuse pre-allocated item instead of temp array
-        addItem("No SD card found", MENU_ERROR, 0);
         return;
     }
 
-    if (!root.isDirectory())
-    {
-        Serial.println("LoadConfigMenuAction: Root is not a directory");
-        root.close();
-        // Reuse pre-allocated item instead of temp array
-        addItem("SD card error", MENU_ERROR, 0);
-        return;
-    }
+    int len = strlen(filename);
 
-    // Read all files in root directory
-    File entry = root.openNextFile();
-    while (entry && fileCount < MAX_CONFIG_FILES)
+    // Check if it's a JSON file (case insensitive)
+    if (len > 5 &&
+        (strcmp(filename + len - 5, ".json") == 0 ||
+         strcmp(filename + len - 5, ".JSON") == 0))
     {
-        if (!entry.isDirectory())
-        {
-            const char *filename = entry.name();
-            int len = strlen(filename);
+        // Store full filename with path (no heap allocation!)
+        char *path = action->configFiles[action->scanCount];
+        snprintf(path, MAX_FILENAME_LEN, "/%s", filename);
 
-            // Check if it's a JSON file (case insensitive)
-            if (len > 5 &&
-                (strcmp(filename + len - 5, ".json") == 0 ||
-                 strcmp(filename + len - 5, ".JSON") == 0))
-            {
-                // Store full filename with path (no heap allocation!)
-                snprintf(configFiles[fileCount], MAX_FILENAME_LEN, "/%s", filename);
+        LOG_DEBUG("LoadConfigMenuAction: Found config file: %s", path);
 
-                Serial.print("LoadConfigMenuAction: Found config file: ");
-                Serial.println(configFiles[fileCount]);
+        action->scanCount++;
+    }
+}
 
-                fileCount++;
-            }
-        }
-        entry.close();
-        entry = root.openNextFile();
+void LoadConfigMenuAction::scanConfigFiles()
+{
+    clear();
+    scanValid = false;
+    scanFileChangeCount = MappingConfig::getFileChangeCount();
+
+    // Title already set in constructor
+    scanCount = 0;
+
+    // Read all files in root directory
+    if (MappingConfig::getStorage().list("/", onListEntry, this) < 0)
+    {
+        LOG_ERROR("LoadConfigMenuAction: Failed to open root directory");
+        // Reuse pre-allocated item instead of temp array
+        addItem("No SD card found", MENU_ERROR, 0);
+        return;
     }
-    root.close();
+    scanValid = true;
+    int fileCount = scanCount;
 
     if (fileCount == 0)
     {
-        Serial.println("LoadConfigMenuAction: No JSON config files found");
+        LOG_INFO("LoadConfigMenuAction: No JSON config files found");
         // Reuse pre-allocated item instead of temp array
         addItem("No configs found", MENU_ERROR, 0);
         return;
@@ -101,15 +99,10 @@ void LoadConfigMenuAction::scanConfigFiles()
         // Use full path as identifier (already in char array)
         addItem(displayName, configFiles[i], i);
 
-        Serial.print("LoadConfigMenuAction: Display name: ");
-        Serial.print(displayName);
-        Serial.print(" -> ");
-        Serial.println(configFiles[i]);
+        LOG_DEBUG("LoadConfigMenuAction: Display name: %s -> %s", displayName, configFiles[i]);
     }
 
-    Serial.print("LoadConfigMenuAction: Loaded ");
-    Serial.print(fileCount);
-    Serial.println(" config files");
+    LOG_INFO("LoadConfigMenuAction: Loaded %d config files", fileCount);
 }
 
 void LoadConfigMenuAction::sortConfigFiles(int count)
@@ -141,18 +134,12 @@ void LoadConfigMenuAction::onConfirm()
 {
     MenuItem selectedItem = getSelectedItem();
 
-    Serial.print("LoadConfigMenuAction: Load config - Item confirmed: ");
-    Serial.print(selectedItem.name);
-    Serial.print(" (identifier: ");
-    Serial.print(selectedItem.identifier);
-    Serial.print(", data: ");
-    Serial.print(selectedItem.data);
-    Serial.println(")");
+    LOG_DEBUG("LoadConfigMenuAction: Load config - Item confirmed: %s (identifier: %s, data: %u)", selectedItem.name, selectedItem.identifier, selectedItem.data);
 
     // Check if there are no configs or error state (identifier is now char array)
     if (strcmp(selectedItem.identifier, MENU_ERROR) == 0)
     {
-        Serial.println("LoadConfigMenuAction: Cannot load config - error state");
+        LOG_ERROR("LoadConfigMenuAction: Cannot load config - error state");
         return;
     }
 
@@ -160,8 +147,7 @@ void LoadConfigMenuAction::onConfirm()
 
     RunActionParams runParams;
     strncpy(runParams.filename, selectedItem.identifier, MAX_FILENAME_LEN);
-    Serial.print("LoadConfigMenuAction: Loading config file: ");
-    Serial.println(runParams.filename);
+    LOG_INFO("LoadConfigMenuAction: Loading config file: %s", runParams.filename);
 
     handler->activateRun(runParams);
 }
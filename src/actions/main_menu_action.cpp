@@ -4,12 +4,14 @@
 #include "devices.h"
 #include "mapping/mapping_config.h"
 #include "utils.h"
+#include "logging/log.h"
 
 namespace {
     constexpr const char* MENU_LOAD_CONFIG = "load_config";
     constexpr const char* MENU_EDIT_CONFIG = "edit_config";
     constexpr const char* MENU_SAVE_CONFIG = "save_config";
     constexpr const char* MENU_SAVE_CONFIG_AS = "save_config_as";
+    constexpr const char* MENU_PAD_PROFILES = "pad_profiles";
 }
 
 MainMenuAction::MainMenuAction(DeviceManager *dev, ActionHandler *hdlr)
@@ -23,6 +25,7 @@ MainMenuAction::MainMenuAction(DeviceManager *dev, ActionHandler *hdlr)
     addItem("Edit config", MENU_EDIT_CONFIG);
     addItem("Save config", MENU_SAVE_CONFIG);
     addItem("Save config as...", MENU_SAVE_CONFIG_AS);
+    addItem("Pad profiles", MENU_PAD_PROFILES);
 }
 
 void MainMenuAction::onConfirm()
@@ -30,13 +33,7 @@ void MainMenuAction::onConfirm()
     // Handle confirmation for the main menu
     MenuItem selectedItem = getSelectedItem();
 
-    Serial.print("MainMenuAction: Item confirmed: ");
-    Serial.print(selectedItem.name);
-    Serial.print(" (identifier: ");
-    Serial.print(selectedItem.identifier);
-    Serial.print(", data: ");
-    Serial.print(selectedItem.data);
-    Serial.println(")");
+    LOG_DEBUG("MainMenuAction: Item confirmed: %s (identifier: %s, data: %u)", selectedItem.name, selectedItem.identifier, selectedItem.data);
 
     // Handle each menu option using identifier (now char array - use strcmp)
     if (strcmp(selectedItem.identifier, MENU_LOAD_CONFIG) == 0)
@@ -56,13 +53,16 @@ void MainMenuAction::onConfirm()
     {
         handler->activateEditConfigMenu();
     }
+    else if (strcmp(selectedItem.identifier, MENU_PAD_PROFILES) == 0)
+    {
+        handler->activateProfileBindingsMenu();
+    }
 }
 
 void MainMenuAction::performSave()
 {
     // Save the currently loaded config to its file
-    Serial.print("MainMenuAction: Saving config to: ");
-    Serial.println(mappingConfig.displayName);
+    LOG_INFO("MainMenuAction: Saving config to: %s", mappingConfig.displayName);
 
     LiquidCrystal_I2C *lcd = devices->getLCD();
     lcd->clear();
@@ -75,13 +75,13 @@ void MainMenuAction::performSave()
     lcd->setCursor(0, 0);
     if (success)
     {
-        Serial.println("MainMenuAction: Config saved successfully");
+        LOG_INFO("MainMenuAction: Config saved successfully");
         lcd->print("Saved: ");
         lcd->print(mappingConfig.displayName);
     }
     else
     {
-        Serial.println("MainMenuAction: Failed to save config");
+        LOG_ERROR("MainMenuAction: Failed to save config");
         lcd->print("Save failed!");
         lcd->setCursor(0, 1);
         lcd->print(mappingConfig.displayName);
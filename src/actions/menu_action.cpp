@@ -2,9 +2,11 @@
 #include "actions/action_handler.h"
 #include "actions/run_action.h"
 #include "devices.h"
+#include "timing/timer_service.h"
+#include "logging/log.h"
 
 MenuAction::MenuAction(DeviceManager *dev, ActionHandler *hdlr)
-    : Action(dev, hdlr)
+    : Action(dev, hdlr), screenValid(false), timeoutTimer(TimerWheel::INVALID_TIMER), timedOut(false)
 {
     selectedIndex = 0;
     scrollOffset = 0;
@@ -14,7 +16,7 @@ MenuAction::MenuAction(DeviceManager *dev, ActionHandler *hdlr)
 
 void MenuAction::init()
 {
-    Serial.println("MenuAction: Base init");
+    LOG_DEBUG("MenuAction: Base init");
 
     // Store the previous selection before calling onInit
     int previousSelection = selectedIndex;
@@ -26,69 +28,137 @@ void MenuAction::init()
     if (previousSelection > 0 && previousSelection < menuItemCount)
     {
         selectedIndex = previousSelection;
-        Serial.print("MenuAction: Restored selection to index ");
-        Serial.println(selectedIndex);
+        LOG_DEBUG("MenuAction: Restored selection to index %d", selectedIndex);
     }
     else
     {
-        Serial.print("MenuAction: Selection at index ");
-        Serial.println(selectedIndex);
+        LOG_DEBUG("MenuAction: Selection at index %d", selectedIndex);
     }
 
     // Update scroll offset for current selection
     updateScrollOffset();
 
-    lastInputTime = millis();
+    resetTimeout();
     devices->getLCD()->backlight();
 
+    screenValid = false;
     displayMenu();
 
-    Serial.println("MenuAction: initialized");
-    Serial.print("MenuAction: Selected index: ");
-    Serial.print(selectedIndex);
-    Serial.print(" of ");
-    Serial.println(menuItemCount);
+    LOG_DEBUG("MenuAction: initialized");
+    LOG_DEBUG("MenuAction: Selected index: %d of %d", selectedIndex, menuItemCount);
 
     if (selectedIndex >= 0 && selectedIndex < menuItemCount)
     {
-        Serial.print("MenuAction: Selected: ");
-        Serial.println(menuItems[selectedIndex].name);
+        LOG_DEBUG("MenuAction: Selected: %s", menuItems[selectedIndex].name);
     }
     else
     {
-        Serial.println("MenuAction: ERROR: Selected index out of bounds!");
+        LOG_ERROR("MenuAction: ERROR: Selected index out of bounds!");
     }
 }
 
+void MenuAction::onSuspend()
+{
+    // The action on top draws over us and has its own timeout
+    TimerService::cancel(timeoutTimer);
+    timeoutTimer = TimerWheel::INVALID_TIMER;
+    screenValid = false;
+}
+
+void MenuAction::onResume()
+{
+    LOG_DEBUG("MenuAction: Resume");
+
+    // Items can show values the action on top just edited; rebuilding them is
+    // cheap, it is the LCD that is slow
+    onInit();
+    if (selectedIndex >= menuItemCount)
+    {
+        selectedIndex = max(0, menuItemCount - 1);
+    }
+    updateScrollOffset();
+
+    resetTimeout();
+    displayMenu();
+}
+
+void MenuAction::onExit()
+{
+    onSuspend();
+}
+
 void MenuAction::loop()
 {
     // Check for timeout
     if (checkTimeout())
     {
-        Serial.println("MenuAction: Menu timeout - returning to run action");
+        LOG_INFO("MenuAction: Menu timeout - returning to run action");
 
         // Pop all actions back to the Run action (base of stack)
         handler->popToRunAction();
         return;
     }
 
-    // Get input event from the input handler
-    GamepadInputEvent event = devices->getGamepadInput()->getEvent();
+    // Drain every queued edge so simultaneous presses are all handled
+    GamepadInput *input = devices->getGamepadInput();
+    input->update();
+
+    InputEvent event;
+    while (input->pollEvent(event))
+    {
+        handleInput(event);
+
+        // Anything still queued belongs to the action that just took over
+        if (handler->getCurrentAction() != this)
+        {
+            return;
+        }
+    }
+}
 
-    if (event != INPUT_NONE)
+void MenuAction::handleInput(const InputEvent &event)
+{
+    if (event.type != InputEdge::RELEASE)
     {
         resetTimeout();
     }
 
+    // Hold B to leave the menus from any depth
+    if (event.type == InputEdge::LONG_PRESS && event.button == GenericController::BTN_EAST)
+    {
+        LOG_INFO("MenuAction: Cancel held - returning to run action");
+        handler->popToRunAction();
+        return;
+    }
+
+    GamepadInputEvent navigation = GamepadInput::toNavigationEvent(event);
+
+    // L1 + up/down scrolls a page at a time
+    bool pageModifier = (event.heldButtons & (1u << GenericController::BTN_L1)) != 0;
+
     // Handle the event
-    switch (event)
+    switch (navigation)
     {
     case INPUT_UP:
-        moveUp();
+        if (pageModifier)
+        {
+            moveBy(-PAGE_SIZE);
+        }
+        else
+        {
+            moveUp();
+        }
         break;
 
     case INPUT_DOWN:
-        moveDown();
+        if (pageModifier)
+        {
+            moveBy(PAGE_SIZE);
+        }
+        else
+        {
+            moveDown();
+        }
         break;
 
     case INPUT_LEFT:
@@ -103,29 +173,41 @@ void MenuAction::loop()
         // Handle selection confirmation - delegate to derived class
         if (selectedIndex >= 0 && selectedIndex < menuItemCount)
         {
-            Serial.print("MenuAction: Confirmed: ");
-            Serial.println(menuItems[selectedIndex].name);
+            LOG_INFO("MenuAction: Confirmed: %s", menuItems[selectedIndex].name);
             onConfirm();
         }
         else
         {
-            Serial.println("MenuAction: ERROR: Cannot confirm - selected index out of bounds!");
+            LOG_ERROR("MenuAction: ERROR: Cannot confirm - selected index out of bounds!");
         }
         break;
 
     case INPUT_CANCEL:
-        Serial.println("MenuAction: Cancel pressed");
+        LOG_DEBUG("MenuAction: Cancel pressed");
         // Delegate to derived class
         onCancel();
         break;
 
     case INPUT_NONE:
     default:
-        // No input, do nothing
+        // Releases and unused buttons
         break;
     }
 }
 
+void MenuAction::moveBy(int delta)
+{
+    int target = constrain(selectedIndex + delta, 0, max(0, menuItemCount - 1));
+    if (target != selectedIndex)
+    {
+        selectedIndex = target;
+        updateScrollOffset();
+        displayMenu();
+
+        LOG_DEBUG("MenuAction: Selected: %s", menuItems[selectedIndex].name);
+    }
+}
+
 void MenuAction::moveUp()
 {
     if (selectedIndex > 0)
@@ -136,8 +218,7 @@ void MenuAction::moveUp()
 
         if (selectedIndex >= 0 && selectedIndex < menuItemCount)
         {
-            Serial.print("MenuAction: Selected: ");
-            Serial.println(menuItems[selectedIndex].name);
+            LOG_DEBUG("MenuAction: Selected: %s", menuItems[selectedIndex].name);
         }
     }
 }
@@ -152,8 +233,7 @@ void MenuAction::moveDown()
 
         if (selectedIndex >= 0 && selectedIndex < menuItemCount)
         {
-            Serial.print("MenuAction: Selected: ");
-            Serial.println(menuItems[selectedIndex].name);
+            LOG_DEBUG("MenuAction: Selected: %s", menuItems[selectedIndex].name);
         }
     }
 }
@@ -184,36 +264,72 @@ void MenuAction::updateScrollOffset()
 
 void MenuAction::displayMenu()
 {
-    LiquidCrystal_I2C *lcd = devices->getLCD();
-
-    lcd->clear();
+    // A clear is cheaper than padding every row when nothing can be reused
+    if (!screenValid)
+    {
+        devices->getLCD()->clear();
+    }
 
     // Row 0: Display title
-    lcd->setCursor(0, 0);
-    lcd->print(menuTitle);
+    drawRow(0, '\0', menuTitle);
 
-    // Rows 1-3: Display menu items (3 visible items)
+    // Rows 1-3: Display menu items (3 visible items), > marks the selection
     for (int i = 0; i < 3; i++)
     {
         int itemIndex = scrollOffset + i;
 
         if (itemIndex < menuItemCount && menuItems[itemIndex].used)
         {
-            lcd->setCursor(0, i + 1);
-
-            // Add > indicator for selected item
-            if (itemIndex == selectedIndex)
-            {
-                lcd->print(">");
-                lcd->print(menuItems[itemIndex].name);
-            }
-            else
-            {
-                lcd->print(" ");
-                lcd->print(menuItems[itemIndex].name);
-            }
+            drawRow(i + 1, itemIndex == selectedIndex ? '>' : ' ', menuItems[itemIndex].name);
+        }
+        else
+        {
+            drawRow(i + 1, '\0', "");
+        }
+    }
+
+    screenValid = true;
+}
+
+void MenuAction::drawRow(int row, char marker, const char *text)
+{
+    // Full width, so a shorter line overwrites what was there before
+    char line[LCD_COLS + 1];
+    if (marker != '\0')
+    {
+        snprintf(line, sizeof(line), "%c%-19s", marker, text);
+    }
+    else
+    {
+        snprintf(line, sizeof(line), "%-20s", text);
+    }
+
+    // Send only the span that differs from what is on screen; after a clear
+    // that is everything up to the trailing blanks
+    const char *shown = screenValid ? shownRows[row] : "                    ";
+    int first = 0;
+    while (first < LCD_COLS && line[first] == shown[first])
+    {
+        first++;
+    }
+
+    if (first < LCD_COLS)
+    {
+        int last = LCD_COLS - 1;
+        while (line[last] == shown[last])
+        {
+            last--;
+        }
+
+        LiquidCrystal_I2C *lcd = devices->getLCD();
+        lcd->setCursor(first, row);
+        for (int col = first; col <= last; col++)
+        {
+            lcd->write((uint8_t)line[col]);
         }
     }
+
+    memcpy(shownRows[row], line, sizeof(line));
 }
 
 void MenuAction::setMenu(const char* title, MenuItem items[], int itemCount)
@@ -256,11 +372,8 @@ MenuItem MenuAction::getSelectedItem()
     }
     else
     {
-        Serial.print("MenuAction: ERROR: getSelectedItem() - index ");
-        Serial.print(selectedIndex);
-        Serial.print(" out of bounds (menuItemCount: ");
-        Serial.print(menuItemCount);
-        Serial.println(")");
+        LOG_ERROR("MenuAction: ERROR: getSelectedItem() - index %d out of bounds (menuItemCount: %d)", selectedIndex,
+                  menuItemCount);
         // Return empty item as fallback
         return MenuItem();
     }
@@ -268,18 +381,27 @@ MenuItem MenuAction::getSelectedItem()
 
 void MenuAction::refresh()
 {
+    screenValid = false;
     displayMenu();
 }
 
 void MenuAction::resetTimeout()
 {
-    lastInputTime = millis();
+    TimerService::cancel(timeoutTimer);
+    timeoutTimer = TimerService::schedule(TIMEOUT_MS, onTimeout, this);
+    timedOut = false;
 }
 
 bool MenuAction::checkTimeout()
 {
-    unsigned long currentTime = millis();
-    return (currentTime - lastInputTime >= TIMEOUT_MS);
+    return timedOut;
+}
+
+void MenuAction::onTimeout(void *context, uint32_t data)
+{
+    MenuAction *menu = static_cast<MenuAction *>(context);
+    menu->timedOut = true;
+    menu->timeoutTimer = TimerWheel::INVALID_TIMER;
 }
 
 void MenuAction::setTitle(const char* title)
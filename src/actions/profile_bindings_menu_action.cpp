@@ -0,0 +1,80 @@
+#include "actions/profile_bindings_menu_action.h"
+#include "actions/action_handler.h"
+#include "devices.h"
+#include "mapping/profile_bindings.h"
+#include "utils.h"
+#include "logging/log.h"
+
+namespace {
+    constexpr const char* BINDINGS_BIND_PAD = "bind_pad";
+    constexpr const char* BINDINGS_BINDING = "binding";
+}
+
+ProfileBindingsMenuAction::ProfileBindingsMenuAction(DeviceManager *dev, ActionHandler *hdlr)
+    : MenuAction(dev, hdlr)
+{
+    setTitle("Pad profiles");
+}
+
+void ProfileBindingsMenuAction::onInit()
+{
+    buildMenuItems();
+}
+
+void ProfileBindingsMenuAction::buildMenuItems()
+{
+    char nameBuffer[MenuItem::MAX_NAME_LEN];
+    char displayName[MenuItem::MAX_NAME_LEN];
+
+    clear();
+
+    const ControllerSnapshot *pad = devices->getSnapshot(0);
+    if (pad->connected)
+    {
+        snprintf(nameBuffer, sizeof(nameBuffer), "Bind %04X:%04X", pad->vendorId, pad->productId);
+    }
+    else
+    {
+        snprintf(nameBuffer, sizeof(nameBuffer), "Bind: no pad 1");
+    }
+    addItem(nameBuffer, BINDINGS_BIND_PAD);
+
+    for (int i = 0; i < ProfileBindings::getCount(); i++)
+    {
+        const ProfileBindings::Binding &binding = ProfileBindings::get(i);
+        Utils::trimFilenameToBuffer(binding.profile, displayName, sizeof(displayName));
+        snprintf(nameBuffer, sizeof(nameBuffer), "%04X:%04X %s", binding.vendorId, binding.productId, displayName);
+        addItem(nameBuffer, BINDINGS_BINDING, i);
+    }
+}
+
+void ProfileBindingsMenuAction::onConfirm()
+{
+    MenuItem selectedItem = getSelectedItem();
+
+    if (strcmp(selectedItem.identifier, BINDINGS_BIND_PAD) == 0)
+    {
+        const ControllerSnapshot *pad = devices->getSnapshot(0);
+        if (!pad->connected || mappingConfig.filename[0] == '\0')
+        {
+            LOG_WARN("ProfileBindingsMenuAction: Nothing to bind");
+            return;
+        }
+
+        LOG_INFO("ProfileBindingsMenuAction: Binding %x:%x to %s", pad->vendorId, pad->productId, mappingConfig.filename);
+        ProfileBindings::bind(pad->vendorId, pad->productId, mappingConfig.filename);
+    }
+    else if (strcmp(selectedItem.identifier, BINDINGS_BINDING) == 0)
+    {
+        LOG_INFO("ProfileBindingsMenuAction: Removing binding %u", selectedItem.data);
+        ProfileBindings::unbind((int)selectedItem.data);
+    }
+
+    buildMenuItems();
+    if (selectedIndex >= menuItemCount)
+    {
+        selectedIndex = menuItemCount - 1;
+    }
+    updateScrollOffset();
+    displayMenu();
+}
@@ -6,20 +6,28 @@
 #include <Mouse.h>
 #include <USBHost_t36.h>
 #include "utils.h"
+#include "timing/timer_service.h"
+#include "timing/mapping_tier.h"
+#include "logging/log.h"
+#include "mapping/profile_bindings.h"
+#include "mapping/flash_profile.h"
 
 RunAction::RunAction(DeviceManager *dev, ActionHandler *hdlr, RunActionParams p)
     : Action(dev, hdlr),
       params(p),
-      controllerType(JoystickController::UNKNOWN),
-      lastStickUpdate(0),
-      stickUpdateInterval(1000 / 60),
-      lastDPadAxisValue(-1)
+      numPipelines(0),
+      bootBindingsApplied(false),
+      mapping(false),
+      menuRequested(false),
+      tuningChords(0),
+      backlightTimer(TimerWheel::INVALID_TIMER),
+      flashSaveTimer(TimerWheel::INVALID_TIMER)
 {
 }
 
 void RunAction::init()
 {
-    Serial.println("RunAction: Initialized");
+    LOG_DEBUG("RunAction: Initialized");
 
     // Set up keyboard passthrough event handlers
     // KeyboardController *kbd = devices->getKeyboard();
@@ -32,23 +40,25 @@ void RunAction::init()
     //     Serial.println("Keyboard passthrough handlers attached");
     // }
 
-    // Detect controller type
-    JoystickController *joy = devices->getJoystick();
-    if (joy && *joy)
+    devices->getHotplug()->subscribe(onHotplug, this);
+
+    // One mapping pipeline per controller, all feeding the same HID output
+    numPipelines = devices->getJoystickCount();
+    for (int i = 0; i < numPipelines; i++)
     {
-        controllerType = joy->joystickType();
-        Serial.print("RunAction: Controller type detected: ");
-        Serial.println(controllerType);
+        pipelines[i].bind(i, devices->getSnapshot(i), &liveConfigs[i], &output, &macros, &inputTimers);
     }
 
-    Serial.print("RunAction: params.filename = ");
-    Serial.println(params.filename);
+    // Select and Start pressed together open the tuning overlay instead of mapping
+    pipelines[0].setChordButtons(TuningOverlay::CHORD);
+
+    LOG_DEBUG("RunAction: params.filename = %s", params.filename);
 
     if (params.filename[0] != '\0')
     {
         if (!MappingConfig::loadConfig(params.filename, mappingConfig))
         {
-            Serial.println("RunAction: Failed to load button mappings, using defaults");
+            LOG_WARN("RunAction: Failed to load button mappings, using defaults");
             initializeDefaultMappings();
             initializeDefaultStickConfigs();
             initializeDefaultTriggerConfigs();
@@ -56,577 +66,410 @@ void RunAction::init()
             MappingConfig::saveConfig(params.filename, mappingConfig);
         }
 
+        loadPlayerProfiles();
+        scheduleFlashSave();
+
         // Clear loading filename
         params.filename[0] = '\0';
     }
 
+    applyBootBindings();
+
+    // Mappings may have been edited in the menus
+    for (int i = 0; i < numPipelines; i++)
+    {
+        publishConfig(i);
+    }
+
     DisplayLoadedFile();
-    Serial.println("RunAction: RunAction initialization complete");
+    startMapping();
+    LOG_DEBUG("RunAction: RunAction initialization complete");
 }
 
 void RunAction::loop()
 {
-    if (backlightOnTime > 0)
+    if (!MappingTier::isRunning())
     {
-        unsigned long currentTime = millis();
-        if (currentTime > backlightOnTime + BACKLIGHT_TIMEOUT_MS)
-        {
-            Serial.println("RunAction: Backlight off");
-            devices->getLCD()->noBacklight();
-            backlightOnTime = 0;
-        }
+        inputFrame();
     }
 
-    JoystickController *joy = devices->getJoystick();
-
-    if (joy && *joy)
+    // Menu button on the first pad opens the menu; onSuspend() lets go of all keys
+    if (__atomic_load_n(&menuRequested, __ATOMIC_ACQUIRE))
     {
-        // Update controller type if changed
-        JoystickController::joytype_t currentType = joy->joystickType();
-        if (currentType != controllerType)
-        {
-            controllerType = currentType;
-            Serial.print("RunAction: Controller type changed to: ");
-            Serial.println(controllerType);
-        }
-
-        // Check for menu button press (Xbox/PS button)
-        uint32_t buttons = joy->getButtons();
-        for (uint8_t physicalBtn = 0; physicalBtn < 32; physicalBtn++)
-        {
-            int mappedGeneric = JoystickMapping::mapButtonToGeneric(controllerType, physicalBtn);
-            if (mappedGeneric == GenericController::BTN_MENU)
-            {
-                bool isPressed = (buttons & (1 << physicalBtn)) != 0;
-                if (isPressed)
-                {
-                    handler->activateMainMenu();
-                    return;
-                }
-                break;
-            }
-        }
-
-        // Process button mappings
-        processButtonMappings();
-
-        // Process D-pad if controller uses axis-based D-pad
-        processDPadAxisMappings();
+        handler->activateMainMenu();
+        return;
+    }
 
-        // Process analog sticks
-        int leftXAxis = JoystickMapping::mapAxisToGeneric(controllerType, GenericController::AXIS_LEFT_X);
-        int leftYAxis = JoystickMapping::mapAxisToGeneric(controllerType, GenericController::AXIS_LEFT_Y);
-        int rightXAxis = JoystickMapping::mapAxisToGeneric(controllerType, GenericController::AXIS_RIGHT_X);
-        int rightYAxis = JoystickMapping::mapAxisToGeneric(controllerType, GenericController::AXIS_RIGHT_Y);
-        int leftTriggerAxis = JoystickMapping::mapAxisToGeneric(controllerType, GenericController::AXIS_LEFT_TRIGGER);
-        int rightTriggerAxis = JoystickMapping::mapAxisToGeneric(controllerType, GenericController::AXIS_RIGHT_TRIGGER);
+    updateTuning();
+}
 
-        if (leftXAxis != -1 && leftYAxis != -1)
-        {
-            processAnalogStick(mappingConfig.leftStick, leftXAxis, leftYAxis);
-        }
+void RunAction::updateTuning()
+{
+    GamepadInput *input = devices->getGamepadInput();
 
-        if (rightXAxis != -1 && rightYAxis != -1)
-        {
-            processAnalogStick(mappingConfig.rightStick, rightXAxis, rightYAxis);
-        }
+    // Pad 1's pipeline decides what counts as the chord and keeps it unmapped
+    uint8_t chords = pipelines[0].getChordCount();
+    bool toggle = chords != tuningChords;
+    tuningChords = chords;
 
-        if (leftTriggerAxis != -1 && rightTriggerAxis != -1)
+    if (toggle)
+    {
+        if (tuning.isOpen())
         {
-            processTriggers(leftTriggerAxis, rightTriggerAxis);
+            closeTuning();
+            return;
         }
+        openTuning();
     }
-}
-
-void RunAction::processButtonMappings()
-{
-    JoystickController *joy = devices->getJoystick();
-    uint32_t buttons = joy->getButtons();
 
-    for (int i = 0; i < mappingConfig.numMappings; i++)
+    if (!tuning.isOpen())
     {
-        uint8_t genericButton = mappingConfig.mappings[i].genericButton;
+        return;
+    }
 
-        // Skip D-pad buttons if controller uses D-pad axis
-        uint8_t dpadAxis;
-        if (JoystickMapping::usesDPadAxis(controllerType, dpadAxis))
-        {
-            if (genericButton >= GenericController::BTN_DPAD_UP &&
-                genericButton <= GenericController::BTN_DPAD_RIGHT)
-            {
-                continue; // Handle these in processDPadAxisMappings
-            }
-        }
+    // Several nudges in one loop go out as one publish and one LCD update
+    bool changed = false;
+    input->update();
+    InputEvent event;
+    while (input->pollEvent(event))
+    {
+        changed |= tuning.handle(GamepadInput::toNavigationEvent(event));
+    }
 
-        // Find the controller-specific button for this generic button
-        bool isPressed = false;
+    if (changed)
+    {
+        publishConfig(0);
+    }
+    tuning.draw();
+}
 
-        // Check all physical buttons to find which maps to this generic button
-        for (uint8_t physicalBtn = 0; physicalBtn < 32; physicalBtn++)
-        {
-            int mappedGeneric = JoystickMapping::mapButtonToGeneric(controllerType, physicalBtn);
-            if (mappedGeneric == genericButton)
-            {
-                isPressed = (buttons & (1 << physicalBtn)) != 0;
-                break;
-            }
-        }
+void RunAction::openTuning()
+{
+    // Pad 1's D-pad, Select and Start drive the overlay instead of their mappings
+    pipelines[0].setIgnoredButtons(TuningOverlay::BUTTONS);
+    devices->getGamepadInput()->reset();
 
-        // Detect state change
-        if (isPressed != mappingConfig.mappings[i].currentlyPressed)
-        {
-            mappingConfig.mappings[i].currentlyPressed = isPressed;
-
-            if (isPressed)
-            {
-                Serial.print("RunAction: Button ");
-                Serial.print(getGenericButtonName(genericButton));
-                Serial.print(" pressed -> Key ");
-                Serial.println(mappingConfig.mappings[i].keyCode);
-
-                Keyboard.press(mappingConfig.mappings[i].keyCode);
-            }
-            else
-            {
-                Serial.print("RunAction: Button ");
-                Serial.print(getGenericButtonName(genericButton));
-                Serial.println(" released");
-
-                Keyboard.release(mappingConfig.mappings[i].keyCode);
-            }
-        }
-    }
+    TimerService::cancel(backlightTimer);
+    backlightTimer = TimerWheel::INVALID_TIMER;
+    tuning.open(devices->getLCD(), &mappingConfig);
 }
 
-void RunAction::processDPadAxisMappings()
+void RunAction::closeTuning()
 {
-    uint8_t dpadAxis;
-    if (!JoystickMapping::usesDPadAxis(controllerType, dpadAxis))
+    if (!tuning.isOpen())
     {
-        return; // Controller doesn't use D-pad axis
+        return;
     }
 
-    JoystickController *joy = devices->getJoystick();
-    int axisValue = joy->getAxis(dpadAxis);
+    // The D-pad maps again now; the pipeline keeps the chord unmapped until it is let go
+    tuning.close();
+    pipelines[0].setIgnoredButtons(0);
+    DisplayLoadedFile();
+}
 
-    // Only process if value changed
-    if (axisValue == lastDPadAxisValue)
+void RunAction::inputFrame()
+{
+    if (!__atomic_load_n(&mapping, __ATOMIC_ACQUIRE))
     {
         return;
     }
-    lastDPadAxisValue = axisValue;
 
-    // Check each D-pad mapping
-    for (int i = 0; i < mappingConfig.numMappings; i++)
+    unsigned long now = TimerService::now();
+    inputTimers.advance(now);
+    for (int i = 0; i < numPipelines; i++)
     {
-        uint8_t genericButton = mappingConfig.mappings[i].genericButton;
-
-        // Only process D-pad buttons
-        if (genericButton < GenericController::BTN_DPAD_UP ||
-            genericButton > GenericController::BTN_DPAD_RIGHT)
-        {
-            continue;
-        }
-
-        // Check if current axis value corresponds to this D-pad button
-        int mappedButton = JoystickMapping::mapDPadValueToButton(controllerType, axisValue);
-        bool isPressed = (mappedButton == genericButton);
-
-        // Detect state change
-        if (isPressed != mappingConfig.mappings[i].currentlyPressed)
-        {
-            mappingConfig.mappings[i].currentlyPressed = isPressed;
-
-            if (isPressed)
-            {
-                Serial.print("RunAction: D-Pad ");
-                Serial.print(getGenericButtonName(genericButton));
-                Serial.print(" pressed -> Key ");
-                Serial.println(mappingConfig.mappings[i].keyCode);
-
-                Keyboard.press(mappingConfig.mappings[i].keyCode);
-            }
-            else
-            {
-                Serial.print("RunAction: D-Pad ");
-                Serial.print(getGenericButtonName(genericButton));
-                Serial.println(" released");
-
-                Keyboard.release(mappingConfig.mappings[i].keyCode);
-            }
-        }
+        pipelines[i].process();
     }
-}
+    macros.tick(now);
 
-void RunAction::processAnalogStick(StickConfig &stick, int xAxis, int yAxis)
-{
-    if (stick.behavior == StickBehavior::DISABLED)
+    // Nothing more goes out until loop() has opened the menu
+    if (pipelines[0].isMenuPressed())
     {
+        __atomic_store_n(&menuRequested, true, __ATOMIC_RELEASE);
         return;
     }
 
-    JoystickController *joy = devices->getJoystick();
-    int xValue = joy->getAxis(xAxis);
-    int yValue = joy->getAxis(yAxis);
+    output.flush();
+}
 
-    // Apply behavior
-    switch (stick.behavior)
-    {
-    case StickBehavior::MOUSE_MOVEMENT:
-        processMouseMovement(stick, xValue, yValue);
-        break;
+void RunAction::startMapping()
+{
+    // The frame is off, so nothing can raise the flag again behind this
+    menuRequested = false;
+    __atomic_store_n(&mapping, true, __ATOMIC_RELEASE);
+}
 
-    case StickBehavior::BUTTON_EMULATION:
-        processButtonEmulation(stick, xValue, yValue);
-        break;
+void RunAction::stopMapping()
+{
+    // Frames from here on return straight away
+    __atomic_store_n(&mapping, false, __ATOMIC_SEQ_CST);
+}
 
-    case StickBehavior::SCROLL_WHEEL:
-        processScrollWheel(stick, yValue);
-        break;
+void RunAction::onSuspend()
+{
+    stopMapping();
+    releaseAll();
+}
 
-    case StickBehavior::WASD_KEYS:
-        processWASDKeys(stick, xValue, yValue);
-        break;
+void RunAction::onResume()
+{
+    // Back from the menus: pipelines stay bound and profiles stay loaded,
+    // only pad 1's mappings can have been edited
+    publishConfig(0);
+    ProfileBindings::refresh();
+    scheduleFlashSave();
+    DisplayLoadedFile();
+    startMapping();
+    LOG_DEBUG("RunAction: Resumed");
+}
 
-    case StickBehavior::ARROW_KEYS:
-        processArrowKeys(stick, xValue, yValue);
-        break;
+void RunAction::onExit()
+{
+    stopMapping();
+    releaseAll();
+}
 
-    default:
-        break;
-    }
+void RunAction::sendReports()
+{
+    output.send();
 }
 
-void RunAction::processMouseMovement(StickConfig &stick, int xValue, int yValue)
+void RunAction::releaseAll()
 {
-    unsigned long currentTime = millis();
-    if (currentTime - lastStickUpdate < stickUpdateInterval)
+    for (int i = 0; i < numPipelines; i++)
     {
-        return;
-    }
-    lastStickUpdate = currentTime;
-
-    int adjustedX = applyDeadzone(xValue, 128, stick.deadzone);
-    int adjustedY = applyDeadzone(yValue, 128, stick.deadzone);
-
-    if (adjustedX != 0 || adjustedY != 0)
-    {
-        int mouseX = (int)(adjustedX * stick.sensitivity);
-        int mouseY = (int)(adjustedY * stick.sensitivity);
-
-        // Serial.print("Mouse ");
-        // Serial.print(xValue);
-        // Serial.print(", ");
-        // Serial.print(yValue);
-        // Serial.print(" - ");
-        // Serial.print(adjustedX);
-        // Serial.print(", ");
-        // Serial.print(adjustedY);
-        // Serial.print(" - ");
-        // Serial.print(mouseX);
-        // Serial.print(", ");
-        // Serial.println(mouseY);
-
-        Mouse.move(mouseX, mouseY, 0);
+        pipelines[i].reset();
     }
+    macros.stopAll();
+    output.releaseAll();
+
+    // The menu owns the LCD and the backlight from here
+    tuning.close();
+    pipelines[0].setIgnoredButtons(0);
+    TimerService::cancel(backlightTimer);
 }
 
-void RunAction::processButtonEmulation(StickConfig &stick, int xValue, int yValue)
+void RunAction::onHotplug(void *context, const HotplugEvent &event)
 {
-    int adjustedX = applyDeadzone(xValue, 128, stick.deadzone);
-    int adjustedY = applyDeadzone(yValue, 128, stick.deadzone);
-
-    // Check each direction
-    bool shouldBeUpPressed = (adjustedY < -stick.activationThreshold);
-    bool shouldBeDownPressed = (adjustedY > stick.activationThreshold);
-    bool shouldBeLeftPressed = (adjustedX < -stick.activationThreshold);
-    bool shouldBeRightPressed = (adjustedX > stick.activationThreshold);
-
-    // Up
-    if (shouldBeUpPressed && !stick.upPressed)
+    RunAction *run = static_cast<RunAction *>(context);
+    if (event.type != HotplugDeviceType::JOYSTICK || event.index >= run->numPipelines)
     {
-        Keyboard.press(stick.keyUp);
-        stick.upPressed = true;
-    }
-    else if (!shouldBeUpPressed && stick.upPressed)
-    {
-        Keyboard.release(stick.keyUp);
-        stick.upPressed = false;
+        return;
     }
 
-    // Down
-    if (shouldBeDownPressed && !stick.downPressed)
+    if (event.connected)
     {
-        Keyboard.press(stick.keyDown);
-        stick.downPressed = true;
-    }
-    else if (!shouldBeDownPressed && stick.downPressed)
-    {
-        Keyboard.release(stick.keyDown);
-        stick.downPressed = false;
+        // Menus may be editing the config right now; swap only while running
+        if (run->handler->getCurrentAction() == run)
+        {
+            run->applyBinding(event.index, event.vendorId, event.productId);
+        }
+        return;
     }
 
-    // Left
-    if (shouldBeLeftPressed && !stick.leftPressed)
-    {
-        Keyboard.press(stick.keyLeft);
-        stick.leftPressed = true;
-    }
-    else if (!shouldBeLeftPressed && stick.leftPressed)
-    {
-        Keyboard.release(stick.keyLeft);
-        stick.leftPressed = false;
-    }
+    // Let go of what the unplugged pad was holding; keys other pads still
+    // hold are reference counted and stay down
+    run->pipelines[event.index].reset();
 
-    // Right
-    if (shouldBeRightPressed && !stick.rightPressed)
+    for (int i = 0; i < run->numPipelines; i++)
     {
-        Keyboard.press(stick.keyRight);
-        stick.rightPressed = true;
-    }
-    else if (!shouldBeRightPressed && stick.rightPressed)
-    {
-        Keyboard.release(stick.keyRight);
-        stick.rightPressed = false;
+        if (run->devices->getSnapshot(i)->connected)
+        {
+            run->output.flush();
+            return;
+        }
     }
+
+    // Last pad gone: nothing may stay pressed, macros included
+    run->macros.stopAll();
+    run->output.releaseAll();
 }
 
-void RunAction::processScrollWheel(StickConfig &stick, int yValue)
+void RunAction::applyBootBindings()
 {
-    unsigned long currentTime = millis();
-    if (currentTime - lastStickUpdate < stickUpdateInterval)
+    // Pads that enumerated before the first loop missed their hotplug event
+    if (bootBindingsApplied)
     {
         return;
     }
-    lastStickUpdate = currentTime;
+    bootBindingsApplied = true;
 
-    int adjustedY = applyDeadzone(yValue, 128, stick.deadzone);
-
-    if (adjustedY != 0)
+    for (int i = 0; i < numPipelines; i++)
     {
-        int scroll = (int)(adjustedY * stick.sensitivity * 0.1f);
-        if (scroll != 0)
+        const ControllerSnapshot *snapshot = devices->getSnapshot(i);
+        if (snapshot->connected)
         {
-            Mouse.move(0, 0, -scroll); // Negative for natural scrolling
+            applyBinding(i, snapshot->vendorId, snapshot->productId);
         }
     }
 }
 
-void RunAction::processWASDKeys(StickConfig &stick, int xValue, int yValue)
+void RunAction::onStorageReady()
 {
-    stick.keyUp = 'w';
-    stick.keyDown = 's';
-    stick.keyLeft = 'a';
-    stick.keyRight = 'd';
-    processButtonEmulation(stick, xValue, yValue);
-}
-
-void RunAction::processArrowKeys(StickConfig &stick, int xValue, int yValue)
-{
-    stick.keyUp = KEY_UP;
-    stick.keyDown = KEY_DOWN;
-    stick.keyLeft = KEY_LEFT;
-    stick.keyRight = KEY_RIGHT;
-    processButtonEmulation(stick, xValue, yValue);
-}
+    bootBindingsApplied = false;
 
-void RunAction::processTriggers(int leftAxis, int rightAxis)
-{
-    if (mappingConfig.triggers.behavior == TriggerBehavior::DISABLED)
+    // Pad 1 started from the flash copy; reload it if the card holds another version
+    if (!FlashProfile::matchesSD(mappingConfig))
     {
+        LOG_INFO("RunAction: %s differs on SD, reloading", mappingConfig.filename);
+        RunActionParams reload;
+        strncpy(reload.filename, mappingConfig.filename, sizeof(reload.filename));
+        handler->activateRun(reload);
         return;
     }
 
-    JoystickController *joy = devices->getJoystick();
-    int leftValue = joy->getAxis(leftAxis);
-    int rightValue = joy->getAxis(rightAxis);
-
-    // Apply behavior
-    switch (mappingConfig.triggers.behavior)
-    {
-    case TriggerBehavior::BUTTONS:
-        processTriggerButtons(leftValue, rightValue);
-        break;
-
-    case TriggerBehavior::MOUSE_X:
-        processTriggerMouseX(leftValue, rightValue);
-        break;
-
-    case TriggerBehavior::MOUSE_Y:
-        processTriggerMouseY(leftValue, rightValue);
-        break;
-
-    case TriggerBehavior::SCROLL_WHEEL:
-        processTriggerScroll(leftValue, rightValue);
-        break;
-
-    case TriggerBehavior::JOYSTICK_X:
-    case TriggerBehavior::JOYSTICK_Y:
-        // Joystick modes pass raw axis data - no processing needed here
-        break;
+    loadPlayerProfiles();
+    applyBootBindings();
+    DisplayLoadedFile();
+}
 
-    default:
-        break;
-    }
+void RunAction::scheduleFlashSave()
+{
+    // Flash writes stall the CPU; keep them off boot and menu exit
+    TimerService::cancel(flashSaveTimer);
+    flashSaveTimer = TimerService::schedule(FLASH_SAVE_DELAY_MS, onFlashSave, this);
 }
 
-void RunAction::processTriggerButtons(int leftValue, int rightValue)
+void RunAction::onFlashSave(void *context, uint32_t data)
 {
-    // Triggers are 0-255, check against threshold
-    bool shouldBeLeftPressed = (leftValue > mappingConfig.triggers.activationThreshold);
-    bool shouldBeRightPressed = (rightValue > mappingConfig.triggers.activationThreshold);
+    RunAction *run = static_cast<RunAction *>(context);
+    run->flashSaveTimer = TimerWheel::INVALID_TIMER;
 
-    // Left trigger
-    if (shouldBeLeftPressed && !mappingConfig.triggers.leftPressed)
+    // Only a saved profile is worth restoring at the next boot
+    if (!mappingConfig.modified)
     {
-        Keyboard.press(mappingConfig.triggers.keyLeft);
-        mappingConfig.triggers.leftPressed = true;
-        Serial.print("RunAction: Left Trigger pressed -> Key ");
-        Serial.println(mappingConfig.triggers.keyLeft);
+        FlashProfile::save(mappingConfig);
     }
-    else if (!shouldBeLeftPressed && mappingConfig.triggers.leftPressed)
+}
+
+bool RunAction::applyBinding(int pad, uint16_t vendorId, uint16_t productId)
+{
+    // Unsaved edits win over the binding
+    if (padConfigs[pad].modified || ProfileBindings::find(vendorId, productId) == nullptr)
     {
-        Keyboard.release(mappingConfig.triggers.keyLeft);
-        mappingConfig.triggers.leftPressed = false;
-        Serial.println("RunAction: Left Trigger released");
+        return false;
     }
 
-    // Right trigger
-    if (shouldBeRightPressed && !mappingConfig.triggers.rightPressed)
+    if (!ProfileBindings::apply(vendorId, productId, padConfigs[pad]))
     {
-        Keyboard.press(mappingConfig.triggers.keyRight);
-        mappingConfig.triggers.rightPressed = true;
-        Serial.print("RunAction: Right Trigger pressed -> Key ");
-        Serial.println(mappingConfig.triggers.keyRight);
+        return false;
     }
-    else if (!shouldBeRightPressed && mappingConfig.triggers.rightPressed)
+    publishConfig(pad);
+
+    LOG_INFO("RunAction: Pad %d switched to %s", pad + 1, padConfigs[pad].displayName);
+    if (pad == 0)
     {
-        Keyboard.release(mappingConfig.triggers.keyRight);
-        mappingConfig.triggers.rightPressed = false;
-        Serial.println("RunAction: Right Trigger released");
+        DisplayLoadedFile();
     }
+    return true;
 }
 
-void RunAction::processTriggerMouseX(int leftValue, int rightValue)
+void RunAction::loadPlayerProfiles()
 {
-    unsigned long currentTime = millis();
-    if (currentTime - lastTriggerUpdate < stickUpdateInterval)
-    {
-        return;
-    }
-    lastTriggerUpdate = currentTime;
-
-    // Apply deadzone - triggers are 0-255, treat 0 as rest position
-    int adjustedLeft = (leftValue > mappingConfig.triggers.deadzone) ? leftValue : 0;
-    int adjustedRight = (rightValue > mappingConfig.triggers.deadzone) ? rightValue : 0;
-
-    // Calculate net movement (right trigger moves right, left trigger moves left)
-    int netMovement = adjustedRight - adjustedLeft;
-
-    if (netMovement != 0)
+    // Pads 2..N use /Player2.json, /Player3.json, ... when present
+    for (int i = 1; i < numPipelines; i++)
     {
-        int mouseX = (int)(netMovement * mappingConfig.triggers.sensitivity);
+        char filename[JoystickMappingConfig::MAX_FILENAME_LENGTH];
+        snprintf(filename, sizeof(filename), "/Player%d.json", i + 1);
 
-        Mouse.move(mouseX, 0, 0);
+        if (!MappingConfig::getStorage().exists(filename) || !MappingConfig::loadConfig(filename, padConfigs[i]))
+        {
+            padConfigs[i] = JoystickMappingConfig();
+        }
+        publishConfig(i);
     }
 }
 
-void RunAction::processTriggerMouseY(int leftValue, int rightValue)
+bool RunAction::loadProfile(int pad, const char *json, size_t length, const char *filename)
 {
-    unsigned long currentTime = millis();
-    if (currentTime - lastTriggerUpdate < stickUpdateInterval)
+    // The menus edit the shadow copies in place; never load over them
+    if (handler->getCurrentAction() != this || pad < 0 || pad >= numPipelines)
     {
-        return;
+        LOG_WARN("RunAction: Profile for pad %d not loaded, not in the Run screen", pad + 1);
+        return false;
     }
-    lastTriggerUpdate = currentTime;
 
-    // Apply deadzone - triggers are 0-255, treat 0 as rest position
-    int adjustedLeft = (leftValue > mappingConfig.triggers.deadzone) ? leftValue : 0;
-    int adjustedRight = (rightValue > mappingConfig.triggers.deadzone) ? rightValue : 0;
-
-    // Calculate net movement (right trigger moves down, left trigger moves up)
-    int netMovement = adjustedRight - adjustedLeft;
-
-    if (netMovement != 0)
+    // Parsed aside, so a bad profile leaves the pad's config as it was
+    static JoystickMappingConfig loaded;
+    loaded = JoystickMappingConfig();
+    if (!MappingConfig::loadConfig(json, length, filename, loaded))
     {
-        int mouseY = (int)(netMovement * mappingConfig.triggers.sensitivity);
-
-        Mouse.move(0, mouseY, 0);
+        return false;
     }
-}
 
-void RunAction::processTriggerScroll(int leftValue, int rightValue)
-{
-    unsigned long currentTime = millis();
-    if (currentTime - lastTriggerUpdate < stickUpdateInterval)
+    const char *problem = LiveConfig::validate(loaded);
+    if (problem != nullptr)
     {
-        return;
+        LOG_WARN("RunAction: Profile for pad %d not loaded: %s", pad + 1, problem);
+        return false;
     }
-    lastTriggerUpdate = currentTime;
-
-    // Apply deadzone - triggers are 0-255, treatd 0 as rest position
-    int adjustedLeft = (leftValue > mappingConfig.triggers.deadzone) ? leftValue : 0;
-    int adjustedRight = (rightValue > mappingConfig.triggers.deadzone) ? rightValue : 0;
 
-    // Calculate net movement (right trigger scrolls down, left trigger scrolls up)
-    int netMovement = adjustedRight - adjustedLeft;
+    // Only in RAM until saved from the menus, which also keeps bindings and
+    // the flash copy from replacing it
+    padConfigs[pad] = loaded;
+    padConfigs[pad].modified = true;
+    publishConfig(pad);
 
-    if (netMovement != 0)
+    LOG_INFO("RunAction: Pad %d switched to an uploaded profile", pad + 1);
+    if (pad == 0)
     {
-        int scroll = (int)(netMovement * mappingConfig.triggers.sensitivity * 0.1f);
-        if (scroll != 0)
-        {
-            Mouse.move(0, 0, -scroll); // Negative for natural scrolling
-        }
+        closeTuning();
+        DisplayLoadedFile();
     }
+    return true;
 }
 
-int RunAction::applyDeadzone(int value, int centerValue, int deadzone)
+bool RunAction::publishConfig(int pad)
 {
-    int centered = value - centerValue;
-
-    if (abs(centered) < deadzone)
+    if (pad < 0 || pad >= numPipelines)
     {
-        return 0;
+        return false;
     }
 
-    return centered;
+    // The pad's frame switches over at its next start, keeping held keys
+    return liveConfigs[pad].publish(padConfigs[pad]);
 }
 
 void RunAction::initializeDefaultMappings()
 {
     mappingConfig.numMappings = 0;
 
+    auto add = [](uint8_t genericButton, uint16_t keyCode)
+    {
+        ButtonMapping &mapping = mappingConfig.mappings[mappingConfig.numMappings++];
+        mapping = ButtonMapping();
+        mapping.genericButton = genericButton;
+        mapping.keyCode = keyCode;
+    };
+
     // Face buttons - WASdD
-    mappingConfig.mappings[mappingConfig.numMappings++] = {GenericController::BTN_SOUTH, 's', false};
-    mappingConfig.mappings[mappingConfig.numMappings++] = {GenericController::BTN_EAST, 'd', false};
-    mappingConfig.mappings[mappingConfig.numMappings++] = {GenericController::BTN_WEST, 'a', false};
-    mappingConfig.mappings[mappingConfig.numMappings++] = {GenericController::BTN_NORTH, 'w', false};
+    add(GenericController::BTN_SOUTH, 's');
+    add(GenericController::BTN_EAST, 'd');
+    add(GenericController::BTN_WEST, 'a');
+    add(GenericController::BTN_NORTH, 'w');
 
     // Shoulder buttons
-    mappingConfig.mappings[mappingConfig.numMappings++] = {GenericController::BTN_L1, 'q', false};
-    mappingConfig.mappings[mappingConfig.numMappings++] = {GenericController::BTN_R1, 'e', false};
+    add(GenericController::BTN_L1, 'q');
+    add(GenericController::BTN_R1, 'e');
 
     // Center buttons
-    mappingConfig.mappings[mappingConfig.numMappings++] = {GenericController::BTN_START, 'r', false};
-    mappingConfig.mappings[mappingConfig.numMappings++] = {GenericController::BTN_SELECT, 'f', false};
+    add(GenericController::BTN_START, 'r');
+    add(GenericController::BTN_SELECT, 'f');
 
     // Stick clicks
-    mappingConfig.mappings[mappingConfig.numMappings++] = {GenericController::BTN_L3, 't', false};
-    mappingConfig.mappings[mappingConfig.numMappings++] = {GenericController::BTN_R3, 'g', false};
+    add(GenericController::BTN_L3, 't');
+    add(GenericController::BTN_R3, 'g');
 
     // D-Pad - Arrow keys
-    mappingConfig.mappings[mappingConfig.numMappings++] = {GenericController::BTN_DPAD_UP, KEY_UP, false};
-    mappingConfig.mappings[mappingConfig.numMappings++] = {GenericController::BTN_DPAD_DOWN, KEY_DOWN, false};
-    mappingConfig.mappings[mappingConfig.numMappings++] = {GenericController::BTN_DPAD_LEFT, KEY_LEFT, false};
-    mappingConfig.mappings[mappingConfig.numMappings++] = {GenericController::BTN_DPAD_RIGHT, KEY_RIGHT, false};
+    add(GenericController::BTN_DPAD_UP, KEY_UP);
+    add(GenericController::BTN_DPAD_DOWN, KEY_DOWN);
+    add(GenericController::BTN_DPAD_LEFT, KEY_LEFT);
+    add(GenericController::BTN_DPAD_RIGHT, KEY_RIGHT);
 
     // Special
-    mappingConfig.mappings[mappingConfig.numMappings++] = {GenericController::BTN_TOUCHPAD, 'h', false};
+    add(GenericController::BTN_TOUCHPAD, 'h');
 
-    Serial.print("RunAction: Initialized ");
-    Serial.print(mappingConfig.numMappings);
-    Serial.println(" default generic mappings");
+    LOG_INFO("RunAction: Initialized %d default generic mappings", mappingConfig.numMappings);
 }
 
 void RunAction::initializeDefaultStickConfigs()
@@ -642,11 +485,6 @@ void RunAction::initializeDefaultTriggerConfigs()
     mappingConfig.triggers.keyRight = KEY_RIGHT;
 }
 
-const char *RunAction::getGenericButtonName(uint8_t genericButton)
-{
-    return JoystickMapping::getGenericButtonName(genericButton);
-}
-
 void RunAction::setParams(RunActionParams p)
 {
     params = p;
@@ -657,39 +495,20 @@ void RunAction::onKeyPress(int unicode)
 {
     // Pass through regular key presses
     Keyboard.press(unicode);
-    Serial.print("RunAction: Keyboard passthrough: Key pressed - ");
-    if (unicode >= 32 && unicode <= 126)
-    {
-        Serial.print((char)unicode);
-        Serial.print(" ");
-    }
-    Serial.print("(0x");
-    Serial.print(unicode, HEX);
-    Serial.println(")");
+    LOG_DEBUG("RunAction: Keyboard passthrough: Key pressed - (0x%x)", unicode);
 }
 
 void RunAction::onKeyRelease(int unicode)
 {
     // Pass through regular key releases
     Keyboard.release(unicode);
-    Serial.print("RunAction: Keyboard passthrough: Key released - ");
-    if (unicode >= 32 && unicode <= 126)
-    {
-        Serial.print((char)unicode);
-        Serial.print(" ");
-    }
-    Serial.print("(0x");
-    Serial.print(unicode, HEX);
-    Serial.println(")");
+    LOG_DEBUG("RunAction: Keyboard passthrough: Key released - (0x%x)", unicode);
 }
 
 void RunAction::onExtrasPress(uint32_t top, uint16_t key)
 {
     // Handle special keys (modifiers, function keys, etc.)
-    Serial.print("RunAction: Keyboard passthrough: Extras pressed - top: 0x");
-    Serial.print(top, HEX);
-    Serial.print(", key: 0x");
-    Serial.println(key, HEX);
+    LOG_DEBUG("RunAction: Keyboard passthrough: Extras pressed - top: 0x%x, key: 0x%x", top, key);
 
     // Pass through the key using the key code format
     // The 'key' parameter contains the HID usage code
@@ -699,10 +518,7 @@ void RunAction::onExtrasPress(uint32_t top, uint16_t key)
 void RunAction::onExtrasRelease(uint32_t top, uint16_t key)
 {
     // Handle special key releases
-    Serial.print("RunAction: Keyboard passthrough: Extras released - top: 0x");
-    Serial.print(top, HEX);
-    Serial.print(", key: 0x");
-    Serial.println(key, HEX);
+    LOG_DEBUG("RunAction: Keyboard passthrough: Extras released - top: 0x%x, key: 0x%x", top, key);
 
     // Pass through the key release
     Keyboard.release(key | 0xF000);
@@ -710,6 +526,12 @@ void RunAction::onExtrasRelease(uint32_t top, uint16_t key)
 
 void RunAction::DisplayLoadedFile()
 {
+    // Fast boot maps before the LCD is up; onStorageReady() draws it
+    if (!devices->isDisplayStarted())
+    {
+        return;
+    }
+
     // Display loading message on LCD
     LiquidCrystal_I2C *lcd = devices->getLCD();
     lcd->clear();
@@ -722,5 +544,15 @@ void RunAction::DisplayLoadedFile()
     lcd->setCursor(filenamePos, 2);
     lcd->print(mappingConfig.displayName);
 
-    backlightOnTime = millis();
+    TimerService::cancel(backlightTimer);
+    backlightTimer = TimerService::schedule(BACKLIGHT_TIMEOUT_MS, onBacklightTimeout, this);
+}
+
+void RunAction::onBacklightTimeout(void *context, uint32_t data)
+{
+    RunAction *action = static_cast<RunAction *>(context);
+
+    LOG_DEBUG("RunAction: Backlight off");
+    action->devices->getLCD()->noBacklight();
+    action->backlightTimer = TimerWheel::INVALID_TIMER;
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "mapping/mapping_config.h"
 #include "mapping/keyboard_mapping.h"
 #include "utils.h"
+#include "logging/log.h"
 
 namespace {
     constexpr const char* STICK_CONFIG_MODE = "mode";
@@ -111,13 +112,7 @@ void StickConfigMenuAction::onConfirm()
 {
     MenuItem selectedItem = getSelectedItem();
 
-    Serial.print("StickConfigMenuAction: Item confirmed: ");
-    Serial.print(selectedItem.name);
-    Serial.print(" (identifier: ");
-    Serial.print(selectedItem.identifier);
-    Serial.print(", data: ");
-    Serial.print(selectedItem.data);
-    Serial.println(")");
+    LOG_DEBUG("StickConfigMenuAction: Item confirmed: %s (data: %d)", selectedItem.identifier, (int)selectedItem.data);
 
     // Handle each menu option using identifier (now char array - use strcmp)
     if (strcmp(selectedItem.identifier, STICK_CONFIG_MODE) == 0)
@@ -184,11 +179,11 @@ void StickConfigMenuAction::changeValue(bool isDecrease)
     else if (strcmp(selectedItem.identifier, STICK_CONFIG_DEADZONE) == 0)
     {
         needsRefresh = true;
-        stickConfig->deadzone += isDecrease ? -1 : 1;
+        stickConfig->deadzone = constrain(stickConfig->deadzone + (isDecrease ? -1 : 1), 0, 255);
     }
     else if (strcmp(selectedItem.identifier, STICK_CONFIG_THRESHOLD) == 0)
     {
         needsRefresh = true;
-        stickConfig->activationThreshold += isDecrease ? -1 : 1;
+        stickConfig->activationThreshold = constrain(stickConfig->activationThreshold + (isDecrease ? -1 : 1), 0, 255);
     }
 }
\ No newline at end of file
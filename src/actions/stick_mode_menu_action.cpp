@@ -13,6 +13,9 @@ namespace {
     constexpr const char* STICK_MODE_SCROLL = "scroll";
     constexpr const char* STICK_MODE_WASD = "wasd";
     constexpr const char* STICK_MODE_ARROWS = "arrows";
+    constexpr const char* STICK_MODE_JOYSTICK = "joystick";
+    constexpr const char* STICK_MODE_JOYSTICK_X = "joystick_x";
+    constexpr const char* STICK_MODE_JOYSTICK_Y = "joystick_y";
 }
 
 StickModeMenuAction::StickModeMenuAction(DeviceManager *dev, ActionHandler *hdlr, StickConfigActionParams p)
@@ -33,6 +36,9 @@ void StickModeMenuAction::setStickParams(StickConfigActionParams p)
     addItem("Scroll", STICK_MODE_SCROLL);
     addItem("WASD Keys", STICK_MODE_WASD);
     addItem("Arrow Keys", STICK_MODE_ARROWS);
+    addItem("Joystick", STICK_MODE_JOYSTICK);
+    addItem("Joystick X", STICK_MODE_JOYSTICK_X);
+    addItem("Joystick Y", STICK_MODE_JOYSTICK_Y);
 }
 
 void StickModeMenuAction::loop()
@@ -88,6 +94,18 @@ void StickModeMenuAction::onConfirm()
     {
         stickConfig->behavior = StickBehavior::ARROW_KEYS;
     }
+    else if (strcmp(selectedItem.identifier, STICK_MODE_JOYSTICK) == 0)
+    {
+        stickConfig->behavior = StickBehavior::JOYSTICK;
+    }
+    else if (strcmp(selectedItem.identifier, STICK_MODE_JOYSTICK_X) == 0)
+    {
+        stickConfig->behavior = StickBehavior::JOYSTICK_X;
+    }
+    else if (strcmp(selectedItem.identifier, STICK_MODE_JOYSTICK_Y) == 0)
+    {
+        stickConfig->behavior = StickBehavior::JOYSTICK_Y;
+    }
 
     handler->popAction();
 }
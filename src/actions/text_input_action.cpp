@@ -2,10 +2,12 @@
 #include "actions/action_handler.h"
 #include "mapping/keyboard_mapping.h"
 #include "devices.h"
+#include "timing/timer_service.h"
+#include "logging/log.h"
 
 TextInputAction::TextInputAction(DeviceManager *dev, ActionHandler *hdlr, TextInputActionParams p)
     : Action(dev, hdlr), params(p), cursorPosition(0),
-      lastBlinkTime(0), cursorVisible(true)
+      blinkTimer(TimerWheel::INVALID_TIMER), blinkDue(false), cursorVisible(true)
 {
 }
 
@@ -24,6 +26,10 @@ void TextInputAction::init()
         keyboardInput->reset();
     }
 
+    TimerService::cancel(blinkTimer);
+    blinkTimer = TimerService::schedule(BLINK_INTERVAL_MS, onBlink, this);
+    blinkDue = false;
+
     updateDisplay();
 }
 
@@ -46,15 +52,23 @@ void TextInputAction::loop()
         cancelInput();
     }
 
-    unsigned long currentTime = millis();
-    if (currentTime - lastBlinkTime >= blinkInterval)
+    if (blinkDue)
     {
+        // One-shot, so the timer stops once this action is no longer looping
+        blinkDue = false;
+        blinkTimer = TimerService::schedule(BLINK_INTERVAL_MS, onBlink, this);
         cursorVisible = !cursorVisible;
-        lastBlinkTime = currentTime;
         updateDisplay();
     }
 }
 
+void TextInputAction::onBlink(void *context, uint32_t data)
+{
+    TextInputAction *action = static_cast<TextInputAction *>(context);
+    action->blinkDue = true;
+    action->blinkTimer = TimerWheel::INVALID_TIMER;
+}
+
 void TextInputAction::setParams(TextInputActionParams p)
 {
     params = p;
@@ -86,7 +100,7 @@ void TextInputAction::handleKeyPress(int unicode)
     // Check if we can add more characters
     if (inputText.length() >= params.maxLength)
     {
-        Serial.println("TextInputAction: Max length reached");
+        LOG_DEBUG("TextInputAction: Max length reached");
         return;
     }
 
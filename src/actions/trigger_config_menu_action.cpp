@@ -133,11 +133,11 @@ void TriggerConfigMenuAction::changeValue(bool isDecrease)
     else if (strcmp(selectedItem.identifier, TRIGGER_CONFIG_DEADZONE) == 0)
     {
         needsRefresh = true;
-        mappingConfig.triggers.deadzone += isDecrease ? -1 : 1;
+        mappingConfig.triggers.deadzone = constrain(mappingConfig.triggers.deadzone + (isDecrease ? -1 : 1), 0, 255);
     }
     else if (strcmp(selectedItem.identifier, TRIGGER_CONFIG_THRESHOLD) == 0)
     {
         needsRefresh = true;
-        mappingConfig.triggers.activationThreshold += isDecrease ? -1 : 1;
+        mappingConfig.triggers.activationThreshold = constrain(mappingConfig.triggers.activationThreshold + (isDecrease ? -1 : 1), 0, 255);
     }
 }
\ No newline at end of file
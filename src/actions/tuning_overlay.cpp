@@ -0,0 +1,213 @@
+#include "actions/tuning_overlay.h"
+#include "mapping/mapping_config.h"
+#include "logging/log.h"
+#include <math.h>
+
+namespace {
+    const char *const GROUP_NAMES[] = {"L stick", "R stick", "Triggers"};
+    const char *const PARAM_NAMES[] = {"Sensitivity", "Deadzone", "Threshold"};
+}
+
+TuningOverlay::TuningOverlay()
+    : lcd(nullptr), config(nullptr), field(0), dirty(false)
+{
+}
+
+void TuningOverlay::open(LiquidCrystal_I2C *display, JoystickMappingConfig *profile)
+{
+    lcd = display;
+    config = profile;
+    dirty = true;
+
+    lcd->clear();
+    lcd->backlight();
+    for (int row = 0; row < LCD_ROWS; row++)
+    {
+        memset(shownRows[row], ' ', LCD_COLS);
+        shownRows[row][LCD_COLS] = '\0';
+    }
+
+    LOG_INFO("TuningOverlay: Opened on %s", config->displayName);
+}
+
+void TuningOverlay::close()
+{
+    if (config != nullptr)
+    {
+        LOG_INFO("TuningOverlay: Closed");
+    }
+    config = nullptr;
+}
+
+bool TuningOverlay::handle(GamepadInputEvent event)
+{
+    switch (event)
+    {
+    case INPUT_UP:
+        field = (field + NUM_FIELDS - 1) % NUM_FIELDS;
+        dirty = true;
+        return false;
+
+    case INPUT_DOWN:
+        field = (field + 1) % NUM_FIELDS;
+        dirty = true;
+        return false;
+
+    case INPUT_LEFT:
+        return nudge(-1);
+
+    case INPUT_RIGHT:
+        return nudge(1);
+
+    default:
+        return false;
+    }
+}
+
+void TuningOverlay::getParams(float *&sensitivity, uint8_t *&deadzone, uint8_t *&threshold) const
+{
+    switch (field / PARAMS_PER_GROUP)
+    {
+    case 0:
+        sensitivity = &config->leftStick.sensitivity;
+        deadzone = &config->leftStick.deadzone;
+        threshold = &config->leftStick.activationThreshold;
+        break;
+
+    case 1:
+        sensitivity = &config->rightStick.sensitivity;
+        deadzone = &config->rightStick.deadzone;
+        threshold = &config->rightStick.activationThreshold;
+        break;
+
+    default:
+        sensitivity = &config->triggers.sensitivity;
+        deadzone = &config->triggers.deadzone;
+        threshold = &config->triggers.activationThreshold;
+        break;
+    }
+}
+
+bool TuningOverlay::nudge(int steps)
+{
+    float *sensitivity;
+    uint8_t *deadzone;
+    uint8_t *threshold;
+    getParams(sensitivity, deadzone, threshold);
+
+    switch (field % PARAMS_PER_GROUP)
+    {
+    case 0:
+    {
+        // Whole steps, so repeated nudges do not drift
+        long maxSteps = lroundf(MAX_SENSITIVITY / SENSITIVITY_STEP);
+        long value = constrain(lroundf(*sensitivity / SENSITIVITY_STEP) + steps, 0L, maxSteps);
+        float next = value * SENSITIVITY_STEP;
+        if (next == *sensitivity)
+        {
+            return false;
+        }
+        *sensitivity = next;
+        break;
+    }
+
+    case 1:
+    {
+        int value = constrain(*deadzone + steps, 0, 255);
+        if (value == *deadzone)
+        {
+            return false;
+        }
+        *deadzone = value;
+        break;
+    }
+
+    default:
+    {
+        int value = constrain(*threshold + steps, 0, 255);
+        if (value == *threshold)
+        {
+            return false;
+        }
+        *threshold = value;
+        break;
+    }
+    }
+
+    config->modified = true;
+    dirty = true;
+    return true;
+}
+
+void TuningOverlay::draw()
+{
+    if (!dirty || config == nullptr)
+    {
+        return;
+    }
+    dirty = false;
+
+    float *sensitivity;
+    uint8_t *deadzone;
+    uint8_t *threshold;
+    getParams(sensitivity, deadzone, threshold);
+
+    int group = field / PARAMS_PER_GROUP;
+    int param = field % PARAMS_PER_GROUP;
+    char text[LCD_COLS + 1];
+
+    snprintf(text, sizeof(text), "Live tuning     %d/%d", field + 1, NUM_FIELDS);
+    drawRow(0, text);
+
+    const char *mode = (group < 2) ? MappingConfig::stickBehaviorToString(group == 0 ? config->leftStick.behavior
+                                                                                      : config->rightStick.behavior)
+                                   : MappingConfig::triggerBehaviorToString(config->triggers.behavior);
+    snprintf(text, sizeof(text), "%s: %s", GROUP_NAMES[group], mode);
+    drawRow(1, text);
+
+    char value[8];
+    if (param == 0)
+    {
+        snprintf(value, sizeof(value), "%.2f", *sensitivity);
+    }
+    else
+    {
+        snprintf(value, sizeof(value), "%d", param == 1 ? *deadzone : *threshold);
+    }
+    snprintf(text, sizeof(text), "%-14s%6s", PARAM_NAMES[param], value);
+    drawRow(2, text);
+
+    drawRow(3, "Select+Start: close");
+}
+
+void TuningOverlay::drawRow(int row, const char *text)
+{
+    // Full width, so a shorter line overwrites what was there before
+    char line[LCD_COLS + 1];
+    snprintf(line, sizeof(line), "%-20s", text);
+
+    // Send only the span that differs from what is on screen
+    const char *shown = shownRows[row];
+    int first = 0;
+    while (first < LCD_COLS && line[first] == shown[first])
+    {
+        first++;
+    }
+
+    if (first < LCD_COLS)
+    {
+        int last = LCD_COLS - 1;
+        while (line[last] == shown[last])
+        {
+            last--;
+        }
+
+        lcd->setCursor(first, row);
+        for (int col = first; col <= last; col++)
+        {
+            lcd->write((uint8_t)line[col]);
+        }
+    }
+
+    memcpy(shownRows[row], line, sizeof(line));
+}
@@ -1,12 +1,17 @@
 #include "devices.h"
 #include "input/gamepad_input.h"
 #include "input/keyboard_input.h"
+#include "logging/log.h"
+#include "timing/mapping_tier.h"
 
 DeviceManager::DeviceManager()
     : host(nullptr), keyboard(nullptr),
-      mouse(nullptr), joystick(nullptr),
-      keyboardConnected(false), mouseConnected(false), joystickConnected(false)
+      mouse(nullptr), numJoysticks(0), displayStarted(false), menuSequence(0)
 {
+    for (int i = 0; i < MAX_JOYSTICKS; i++)
+    {
+        joysticks[i] = nullptr;
+    }
 }
 
 DeviceManager::~DeviceManager()
@@ -15,82 +20,111 @@ DeviceManager::~DeviceManager()
 
 void DeviceManager::setup()
 {
-    lcd->init();
-    lcd->backlight();
+    displayStarted = false;
+
+    // Snapshots follow the pads before anyone else hears about them
+    hotplug.attach(keyboard, mouse, joysticks, numJoysticks);
+    hotplug.subscribe(onHotplug, this);
+
+    // Pads enumerate from the USB interrupt while the rest of boot runs
     host->begin();
 
-    gamepadInput = new GamepadInput(joystick);
+    gamepadInput = new GamepadInput(&menuSnapshot); // Pad used for menus
     keyboardInput = new KeyboardInput(keyboard);
     keyboardInput->setup();
 
     Mouse.begin();
 }
 
-void DeviceManager::loop()
+void DeviceManager::startDisplay()
 {
-    host->Task();
-    checkDeviceConnections();
+    lcd->init();
+    lcd->backlight();
+    displayStarted = true;
 }
 
-void DeviceManager::checkDeviceConnections()
+void DeviceManager::loop()
 {
-    // Check keyboard connection status
-    // Use idVendor() to detect if a device is connected (returns 0 if not connected)
-    bool keyboardNowConnected = (keyboard != nullptr && keyboard->idVendor() != 0);
-    if (keyboardNowConnected && !keyboardConnected)
-    {
-        Serial.println("DeviceManager: [USB] Keyboard connected");
-        Serial.print("DeviceManager: [USB] VID: 0x");
-        Serial.print(keyboard->idVendor(), HEX);
-        Serial.print(", PID: 0x");
-        Serial.println(keyboard->idProduct(), HEX);
-        Serial.print("DeviceManager: [USB] Timestamp: ");
-        Serial.println(millis());
-        keyboardConnected = true;
-    }
-    else if (!keyboardNowConnected && keyboardConnected)
+    host->Task();
+
+    if (!MappingTier::isRunning())
     {
-        Serial.println("DeviceManager: [USB] Keyboard disconnected");
-        Serial.print("DeviceManager: [USB] Timestamp: ");
-        Serial.println(millis());
-        keyboardConnected = false;
+        updateSnapshots();
+        return;
     }
 
-    // MouseController uses available() method instead of idVendor()
-    bool mouseNowConnected = (mouse != nullptr && mouse->available());
-    if (mouseNowConnected && !mouseConnected)
+    // The input tier reads the pads; plug events change what it reads
+    MappingTier::pause();
+    hotplug.update();
+    MappingTier::resume();
+    updateMenuSnapshot();
+}
+
+void DeviceManager::updateSnapshots()
+{
+    hotplug.update();
+    captureSnapshots();
+    updateMenuSnapshot();
+}
+
+void DeviceManager::captureSnapshots()
+{
+    for (int i = 0; i < numJoysticks; i++)
     {
-        Serial.println("DeviceManager: [USB] Mouse connected");
-        Serial.print("DeviceManager: [USB] Timestamp: ");
-        Serial.println(millis());
-        mouseConnected = true;
+        snapshots[i].capture(joysticks[i]);
     }
-    else if (!mouseNowConnected && mouseConnected)
+    menuFeed.write(snapshots[0]);
+}
+
+void DeviceManager::updateMenuSnapshot()
+{
+    menuFeed.read(menuSnapshot);
+
+    // Counts loops, not captures, so GamepadInput still spots loops it missed
+    menuSnapshot.sequence = ++menuSequence;
+}
+
+void DeviceManager::refreshLayouts()
+{
+    for (int i = 0; i < numJoysticks; i++)
     {
-        Serial.println("DeviceManager: [USB] Mouse disconnected");
-        Serial.print("DeviceManager: [USB] Timestamp: ");
-        Serial.println(millis());
-        mouseConnected = false;
+        if (snapshots[i].connected)
+        {
+            snapshots[i].connect(joysticks[i]);
+        }
     }
-    
-    // Check joystick connection status
-    bool joystickNowConnected = (joystick != nullptr && joystick->idVendor() != 0);
-    if (joystickNowConnected && !joystickConnected)
+}
+
+void DeviceManager::onHotplug(void *context, const HotplugEvent &event)
+{
+    DeviceManager *manager = static_cast<DeviceManager *>(context);
+
+    switch (event.type)
     {
-        Serial.println("DeviceManager: [USB] Joystick/Gamepad connected");
-        Serial.print("DeviceManager: [USB] VID: 0x");
-        Serial.print(joystick->idVendor(), HEX);
-        Serial.print(", PID: 0x");
-        Serial.println(joystick->idProduct(), HEX);
-        Serial.print("DeviceManager: [USB] Timestamp: ");
-        Serial.println(millis());
-        joystickConnected = true;
+    case HotplugDeviceType::KEYBOARD:
+        LOG_INFO("DeviceManager: [USB] Keyboard %s at %u ms", event.connected ? "connected" : "disconnected", millis());
+        break;
+    case HotplugDeviceType::MOUSE:
+        LOG_INFO("DeviceManager: [USB] Mouse %s at %u ms", event.connected ? "connected" : "disconnected", millis());
+        break;
+    case HotplugDeviceType::JOYSTICK:
+        LOG_INFO("DeviceManager: [USB] Joystick/Gamepad %d %s at %u ms", event.index + 1,
+                 event.connected ? "connected" : "disconnected", millis());
+
+        // The layout is resolved here once, not looked up every loop
+        if (event.connected)
+        {
+            manager->snapshots[event.index].connect(manager->joysticks[event.index]);
+        }
+        else
+        {
+            manager->snapshots[event.index].disconnect();
+        }
+        break;
     }
-    else if (!joystickNowConnected && joystickConnected)
+
+    if (event.connected && event.vendorId != 0)
     {
-        Serial.println("DeviceManager: [USB] Joystick/Gamepad disconnected");
-        Serial.print("DeviceManager: [USB] Timestamp: ");
-        Serial.println(millis());
-        joystickConnected = false;
+        LOG_INFO("DeviceManager: [USB] VID: 0x%x, PID: 0x%x", event.vendorId, event.productId);
     }
-}
\ No newline at end of file
+}
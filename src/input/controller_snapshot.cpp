@@ -0,0 +1,92 @@
+#include "input/controller_snapshot.h"
+#include "mapping/joystick_mappings.h"
+
+ControllerSnapshot::ControllerSnapshot()
+    : connected(false),
+      type(JoystickController::UNKNOWN),
+      vendorId(0),
+      productId(0),
+      layout(nullptr),
+      buttons(0),
+      axisMask(0),
+      sequence(0),
+      rawAxes(false)
+{
+    for (int i = 0; i < NUM_AXES; i++)
+    {
+        axes[i] = 0;
+    }
+}
+
+void ControllerSnapshot::connect(JoystickController *joystick)
+{
+    type = joystick->joystickType();
+    vendorId = joystick->idVendor();
+    productId = joystick->idProduct();
+    layout = ControllerDatabase::find(vendorId, productId, type);
+    updateAxisMask();
+    connected = true;
+}
+
+void ControllerSnapshot::disconnect()
+{
+    connected = false;
+    buttons = 0;
+}
+
+void ControllerSnapshot::capture(JoystickController *joystick)
+{
+    sequence++;
+
+    if (!connected)
+    {
+        return;
+    }
+
+    // HID pads can finish identifying themselves after the claim
+    if (joystick->joystickType() != type)
+    {
+        connect(joystick);
+    }
+
+    buttons = JoystickMapping::getGenericButtons(layout, joystick);
+
+    if (rawAxes)
+    {
+        for (int axis = 0; axis < NUM_AXES; axis++)
+        {
+            axes[axis] = (uint8_t)joystick->getAxis(layout->axisMap[axis]);
+        }
+        return;
+    }
+
+    for (int axis = 0; axis < NUM_AXES; axis++)
+    {
+        if (!hasAxis(axis))
+        {
+            continue;
+        }
+
+        int raw = joystick->getAxis(layout->axisMap[axis]);
+        int value = (axis < GenericController::AXIS_LEFT_TRIGGER) ? layout->normaliseStick(raw) : layout->normaliseTrigger(raw);
+        axes[axis] = (uint8_t)constrain(value, 0, 255);
+    }
+}
+
+void ControllerSnapshot::updateAxisMask()
+{
+    axisMask = 0;
+    for (int axis = 0; axis < NUM_AXES; axis++)
+    {
+        axes[axis] = 0;
+        if (layout->axisMap[axis] != ControllerLayout::NO_MAPPING)
+        {
+            axisMask |= 1u << axis;
+        }
+    }
+
+    // Every axis present and already 0-255: plain copy per frame
+    rawAxes = axisMask == (1u << NUM_AXES) - 1 &&
+              layout->stickMin == 0 && layout->stickMax == 255 &&
+              layout->triggerMin == 0 && layout->triggerMax == 255;
+}
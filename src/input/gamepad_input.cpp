@@ -1,174 +1,210 @@
 #include "input/gamepad_input.h"
+#include "timing/timer_service.h"
 
-GamepadInput::GamepadInput(JoystickController *controller)
+GamepadInput::GamepadInput(const ControllerSnapshot *controllerSnapshot)
 {
-    joystick = controller;
+    snapshot = controllerSnapshot;
+
+    for (int i = 0; i < 32; i++)
+    {
+        buttonTimer[i] = TimerWheel::INVALID_TIMER;
+    }
+    timedButtons = 0;
     reset();
 }
 
 void GamepadInput::reset()
 {
-    lastButtons = 0;
-    lastDPadValue = 0xFF;
+    cancelTimers();
+    queue.clear();
 
     for (int i = 0; i < 32; i++)
     {
-        buttonPressTime[i] = 0;
-        buttonRepeating[i] = false;
+        repeatCount[i] = 0;
     }
+
+    // Whatever is held now is a baseline, not a fresh press
+    lastButtons = snapshot->connected ? snapshot->buttons : 0;
+    lastSequence = snapshot->sequence;
 }
 
-bool GamepadInput::isButtonPressed(uint8_t genericButton)
+void GamepadInput::cancelTimers()
 {
-    if (!joystick->available())
-        return false;
-
-    uint32_t buttons = joystick->getButtons();
-    JoystickController::joytype_t type = joystick->joystickType();
-
-    int physicalButton = JoystickMapping::mapGenericToButton(type, genericButton);
+    while (timedButtons != 0)
+    {
+        uint8_t button = (uint8_t)__builtin_ctz(timedButtons);
+        timedButtons &= timedButtons - 1;
+        TimerService::cancel(buttonTimer[button]);
+    }
+}
 
-    if (physicalButton < 0)
+unsigned long GamepadInput::getRepeatInterval(uint8_t repeats) const
+{
+    unsigned long shift = repeats / repeatAccelerateAfter;
+    if (shift >= 8)
     {
-        return false;
+        return minRepeatInterval;
     }
+    return max(repeatInterval >> shift, minRepeatInterval);
+}
 
-    return buttons & (1 << physicalButton);
+bool GamepadInput::isButtonPressed(uint8_t genericButton)
+{
+    // D-pad bits are already decoded from the hat in the snapshot
+    return snapshot->connected && snapshot->isPressed(genericButton);
 }
 
-bool GamepadInput::isDPadPressed(uint8_t dpadButton)
+void GamepadInput::update()
 {
-    if (!joystick->available())
-        return false;
+    if (snapshot->sequence == lastSequence)
+    {
+        return;
+    }
+
+    // Nobody read input for a while (e.g. the Run action had the pad)
+    if (snapshot->sequence - lastSequence > MAX_SKIPPED_LOOPS + 1)
+    {
+        reset();
+        return;
+    }
+    lastSequence = snapshot->sequence;
 
-    JoystickController::joytype_t type = joystick->joystickType();
-    uint8_t axisNumber;
+    uint32_t buttons = snapshot->connected ? snapshot->buttons : 0;
+    uint32_t changed = buttons ^ lastButtons;
+    lastButtons = buttons;
 
-    if (JoystickMapping::usesDPadAxis(type, axisNumber))
+    while (changed != 0)
     {
-        uint64_t axisMask = joystick->axisMask();
-        if (axisMask & (1 << axisNumber))
+        uint8_t button = (uint8_t)__builtin_ctz(changed);
+        changed &= changed - 1;
+
+        if (buttons & (1u << button))
         {
-            int axisValue = joystick->getAxis(axisNumber);
-            int mappedButton = JoystickMapping::mapDPadValueToButton(type, axisValue);
-            return mappedButton == dpadButton;
+            onPress(button, buttons);
+        }
+        else
+        {
+            onRelease(button, buttons);
         }
     }
-    else
-    {
-        return isButtonPressed(dpadButton);
-    }
-
-    return false;
 }
 
-GamepadInputEvent GamepadInput::checkButton(uint8_t genericButton, GamepadInputEvent event)
+void GamepadInput::onPress(uint8_t genericButton, uint32_t buttons)
 {
-    bool pressed = false;
+    uint32_t bit = 1u << genericButton;
+    queue.push(InputEdge::PRESS, genericButton, buttons);
 
-    // Check if this is a D-pad button
-    if (genericButton >= GenericController::BTN_DPAD_UP &&
-        genericButton <= GenericController::BTN_DPAD_RIGHT)
+    if (REPEAT_BUTTONS & bit)
     {
-        pressed = isDPadPressed(genericButton);
+        repeatCount[genericButton] = 0;
+        buttonTimer[genericButton] = TimerService::schedule(repeatDelay, onRepeatTimer, this, genericButton);
+        timedButtons |= bit;
     }
-    else
+    else if (LONG_PRESS_BUTTONS & bit)
     {
-        pressed = isButtonPressed(genericButton);
-    }
-
-    if (!pressed)
-    {
-        buttonPressTime[genericButton] = 0;
-        buttonRepeating[genericButton] = false;
-        return INPUT_NONE;
+        buttonTimer[genericButton] = TimerService::schedule(longPressDelay, onLongPressTimer, this, genericButton);
+        timedButtons |= bit;
     }
+}
 
-    unsigned long currentTime = millis();
-
-    if (buttonPressTime[genericButton] == 0)
+void GamepadInput::onRelease(uint8_t genericButton, uint32_t buttons)
+{
+    uint32_t bit = 1u << genericButton;
+    if (timedButtons & bit)
     {
-        buttonPressTime[genericButton] = currentTime;
-        return event;
+        timedButtons &= ~bit;
+        TimerService::cancel(buttonTimer[genericButton]);
     }
+    queue.push(InputEdge::RELEASE, genericButton, buttons);
+}
 
-    unsigned long heldTime = currentTime - buttonPressTime[genericButton];
+void GamepadInput::onRepeatTimer(void *context, uint32_t genericButton)
+{
+    GamepadInput *input = static_cast<GamepadInput *>(context);
 
-    if (!buttonRepeating[genericButton] && heldTime >= repeatDelay)
+    // Released since the last update: stop here, update() reports the release
+    if (!input->isButtonPressed((uint8_t)genericButton))
     {
-        buttonRepeating[genericButton] = true;
-        return event;
+        input->timedButtons &= ~(1u << genericButton);
+        input->buttonTimer[genericButton] = TimerWheel::INVALID_TIMER;
+        return;
     }
 
-    if (buttonRepeating[genericButton])
+    // The wheel fires once per missed interval when it catches up
+    input->queue.push(InputEdge::REPEAT, (uint8_t)genericButton, input->lastButtons);
+    if (input->repeatCount[genericButton] < 255)
     {
-        unsigned long timeSinceRepeatStart = heldTime - repeatDelay;
-        if (timeSinceRepeatStart % repeatInterval < 20)
-        {
-            return event;
-        }
+        input->repeatCount[genericButton]++;
     }
 
-    return INPUT_NONE;
+    unsigned long interval = input->getRepeatInterval(input->repeatCount[genericButton]);
+    input->buttonTimer[genericButton] = TimerService::schedule(interval, onRepeatTimer, input, genericButton);
 }
 
-GamepadInputEvent GamepadInput::checkDPad()
+void GamepadInput::onLongPressTimer(void *context, uint32_t genericButton)
 {
-    GamepadInputEvent result;
+    GamepadInput *input = static_cast<GamepadInput *>(context);
 
-    result = checkButton(GenericController::BTN_DPAD_UP, INPUT_UP);
-    if (result != INPUT_NONE)
-        return result;
-
-    result = checkButton(GenericController::BTN_DPAD_DOWN, INPUT_DOWN);
-    if (result != INPUT_NONE)
-        return result;
-
-    result = checkButton(GenericController::BTN_DPAD_LEFT, INPUT_LEFT);
-    if (result != INPUT_NONE)
-        return result;
+    input->timedButtons &= ~(1u << genericButton);
+    input->buttonTimer[genericButton] = TimerWheel::INVALID_TIMER;
+    input->queue.push(InputEdge::LONG_PRESS, (uint8_t)genericButton, input->lastButtons);
+}
 
-    result = checkButton(GenericController::BTN_DPAD_RIGHT, INPUT_RIGHT);
-    if (result != INPUT_NONE)
-        return result;
+bool GamepadInput::pollEvent(InputEvent &event)
+{
+    return queue.pop(event);
+}
 
-    return INPUT_NONE;
+void GamepadInput::clearEvents()
+{
+    queue.clear();
 }
 
-GamepadInputEvent GamepadInput::getEvent()
+GamepadInputEvent GamepadInput::toNavigationEvent(const InputEvent &event)
 {
-    if (!joystick->available())
+    if (event.type != InputEdge::PRESS && event.type != InputEdge::REPEAT)
     {
         return INPUT_NONE;
     }
 
-    GamepadInputEvent dpadEvent = checkDPad();
-    if (dpadEvent != INPUT_NONE)
+    switch (event.button)
     {
-        return dpadEvent;
+    case GenericController::BTN_DPAD_UP:
+        return INPUT_UP;
+    case GenericController::BTN_DPAD_DOWN:
+        return INPUT_DOWN;
+    case GenericController::BTN_DPAD_LEFT:
+        return INPUT_LEFT;
+    case GenericController::BTN_DPAD_RIGHT:
+        return INPUT_RIGHT;
+    case GenericController::BTN_SOUTH:
+        return INPUT_CONFIRM;
+    case GenericController::BTN_EAST:
+        return INPUT_CANCEL;
+    case GenericController::BTN_MENU:
+        return INPUT_MENU;
+    case GenericController::BTN_START:
+        return INPUT_START;
+    case GenericController::BTN_SELECT:
+        return INPUT_SELECT;
+    default:
+        return INPUT_NONE;
     }
+}
 
-    GamepadInputEvent result;
-
-    result = checkButton(GenericController::BTN_SOUTH, INPUT_CONFIRM);
-    if (result != INPUT_NONE)
-        return result;
-
-    result = checkButton(GenericController::BTN_EAST, INPUT_CANCEL);
-    if (result != INPUT_NONE)
-        return result;
-
-    result = checkButton(GenericController::BTN_MENU, INPUT_MENU);
-    if (result != INPUT_NONE)
-        return result;
-
-    result = checkButton(GenericController::BTN_START, INPUT_START);
-    if (result != INPUT_NONE)
-        return result;
+GamepadInputEvent GamepadInput::getEvent()
+{
+    update();
 
-    result = checkButton(GenericController::BTN_SELECT, INPUT_SELECT);
-    if (result != INPUT_NONE)
-        return result;
+    InputEvent event;
+    while (queue.pop(event))
+    {
+        GamepadInputEvent result = toNavigationEvent(event);
+        if (result != INPUT_NONE)
+        {
+            return result;
+        }
+    }
 
     return INPUT_NONE;
 }
@@ -176,4 +212,4 @@ GamepadInputEvent GamepadInput::getEvent()
 bool GamepadInput::isHeld(uint8_t genericButton)
 {
     return isButtonPressed(genericButton);
-}
\ No newline at end of file
+}
@@ -0,0 +1,242 @@
+#include "input/hotplug.h"
+#include "logging/log.h"
+
+volatile bool HotplugManager::pending = false;
+
+void HotplugLatch::set(uint8_t edge)
+{
+    __atomic_fetch_or(&edges, edge, __ATOMIC_RELEASE);
+    HotplugManager::signal();
+}
+
+// Driver hooks: let the library do its work, then only record the edge
+
+bool HotplugKeyboard::claim(Device_t *dev, int type, const uint8_t *descriptors, uint32_t len)
+{
+    bool claimed = KeyboardController::claim(dev, type, descriptors, len);
+    if (claimed)
+    {
+        latch.set(HotplugLatch::CLAIMED);
+    }
+    return claimed;
+}
+
+void HotplugKeyboard::disconnect()
+{
+    KeyboardController::disconnect();
+    latch.set(HotplugLatch::RELEASED);
+}
+
+hidclaim_t HotplugKeyboard::claim_collection(USBHIDParser *driver, Device_t *dev, uint32_t topusage)
+{
+    hidclaim_t claimed = KeyboardController::claim_collection(driver, dev, topusage);
+    if (claimed != CLAIM_NO)
+    {
+        latch.set(HotplugLatch::CLAIMED);
+    }
+    return claimed;
+}
+
+void HotplugKeyboard::disconnect_collection(Device_t *dev)
+{
+    KeyboardController::disconnect_collection(dev);
+    latch.set(HotplugLatch::RELEASED);
+}
+
+hidclaim_t HotplugMouse::claim_collection(USBHIDParser *driver, Device_t *dev, uint32_t topusage)
+{
+    hidclaim_t claimed = MouseController::claim_collection(driver, dev, topusage);
+    if (claimed != CLAIM_NO)
+    {
+        latch.set(HotplugLatch::CLAIMED);
+    }
+    return claimed;
+}
+
+void HotplugMouse::disconnect_collection(Device_t *dev)
+{
+    MouseController::disconnect_collection(dev);
+    latch.set(HotplugLatch::RELEASED);
+}
+
+bool HotplugJoystick::claim(Device_t *dev, int type, const uint8_t *descriptors, uint32_t len)
+{
+    bool claimed = JoystickController::claim(dev, type, descriptors, len);
+    if (claimed)
+    {
+        latch.set(HotplugLatch::CLAIMED);
+    }
+    return claimed;
+}
+
+void HotplugJoystick::disconnect()
+{
+    JoystickController::disconnect();
+    latch.set(HotplugLatch::RELEASED);
+}
+
+hidclaim_t HotplugJoystick::claim_collection(USBHIDParser *driver, Device_t *dev, uint32_t topusage)
+{
+    hidclaim_t claimed = JoystickController::claim_collection(driver, dev, topusage);
+    if (claimed != CLAIM_NO)
+    {
+        latch.set(HotplugLatch::CLAIMED);
+    }
+    return claimed;
+}
+
+void HotplugJoystick::disconnect_collection(Device_t *dev)
+{
+    JoystickController::disconnect_collection(dev);
+    latch.set(HotplugLatch::RELEASED);
+}
+
+HotplugManager::HotplugManager()
+    : numDevices(0), numSubscribers(0)
+{
+}
+
+void HotplugManager::attach(HotplugKeyboard *keyboard, HotplugMouse *mouse, HotplugJoystick *const *joysticks, int numJoysticks)
+{
+    numDevices = 0;
+    if (keyboard != nullptr)
+    {
+        addDevice(HotplugDeviceType::KEYBOARD, 0, &keyboard->latch, keyboard);
+    }
+    if (mouse != nullptr)
+    {
+        addDevice(HotplugDeviceType::MOUSE, 0, &mouse->latch, mouse);
+    }
+    for (int i = 0; i < numJoysticks && i < MAX_JOYSTICKS; i++)
+    {
+        if (joysticks[i] != nullptr)
+        {
+            addDevice(HotplugDeviceType::JOYSTICK, (uint8_t)i, &joysticks[i]->latch, joysticks[i]);
+        }
+    }
+
+    // Devices may have been claimed before anyone was listening
+    signal();
+}
+
+void HotplugManager::addDevice(HotplugDeviceType type, uint8_t index, HotplugLatch *latch, void *driver)
+{
+    Device &device = devices[numDevices++];
+    device.type = type;
+    device.index = index;
+    device.latch = latch;
+    device.driver = driver;
+    device.connected = false;
+    device.vendorId = 0;
+    device.productId = 0;
+}
+
+bool HotplugManager::subscribe(HotplugCallback callback, void *context)
+{
+    for (int i = 0; i < numSubscribers; i++)
+    {
+        if (subscribers[i].callback == callback && subscribers[i].context == context)
+        {
+            return true;
+        }
+    }
+
+    if (numSubscribers >= MAX_SUBSCRIBERS)
+    {
+        LOG_WARN("HotplugManager: Too many subscribers");
+        return false;
+    }
+
+    subscribers[numSubscribers].callback = callback;
+    subscribers[numSubscribers].context = context;
+    numSubscribers++;
+    return true;
+}
+
+void HotplugManager::update()
+{
+    if (!__atomic_exchange_n(&pending, false, __ATOMIC_ACQ_REL))
+    {
+        return;
+    }
+
+    for (int i = 0; i < numDevices; i++)
+    {
+        Device &device = devices[i];
+
+        // take() also clears edges latched before attach(), so check every device once
+        uint8_t edges = device.latch->take();
+
+        uint16_t vendorId = 0;
+        uint16_t productId = 0;
+        bool connected = readDriver(device, vendorId, productId);
+
+        // Unplugged and plugged back in since the last update, or a different device claimed
+        if (device.connected &&
+            (!connected || (edges & HotplugLatch::RELEASED) || vendorId != device.vendorId || productId != device.productId))
+        {
+            device.connected = false;
+            dispatch(device, false);
+        }
+
+        if (!device.connected && connected)
+        {
+            device.connected = true;
+            device.vendorId = vendorId;
+            device.productId = productId;
+            dispatch(device, true);
+        }
+    }
+}
+
+bool HotplugManager::readDriver(const Device &device, uint16_t &vendorId, uint16_t &productId)
+{
+    switch (device.type)
+    {
+    case HotplugDeviceType::KEYBOARD:
+    {
+        KeyboardController *keyboard = static_cast<KeyboardController *>(device.driver);
+        vendorId = keyboard->idVendor();
+        productId = keyboard->idProduct();
+        return vendorId != 0;
+    }
+    case HotplugDeviceType::MOUSE:
+        // MouseController has no VID/PID accessors
+        return static_cast<MouseController *>(device.driver)->available();
+    case HotplugDeviceType::JOYSTICK:
+    {
+        JoystickController *joystick = static_cast<JoystickController *>(device.driver);
+        vendorId = joystick->idVendor();
+        productId = joystick->idProduct();
+        return (bool)*joystick;
+    }
+    }
+    return false;
+}
+
+void HotplugManager::dispatch(const Device &device, bool connected)
+{
+    HotplugEvent event;
+    event.connected = connected;
+    event.type = device.type;
+    event.index = device.index;
+    event.vendorId = device.vendorId;
+    event.productId = device.productId;
+
+    for (int i = 0; i < numSubscribers; i++)
+    {
+        subscribers[i].callback(subscribers[i].context, event);
+    }
+}
+
+bool HotplugManager::isConnected(HotplugDeviceType type, uint8_t index) const
+{
+    for (int i = 0; i < numDevices; i++)
+    {
+        if (devices[i].type == type && devices[i].index == index)
+        {
+            return devices[i].connected;
+        }
+    }
+    return false;
+}
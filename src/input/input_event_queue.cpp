@@ -0,0 +1,39 @@
+#include "input/input_event_queue.h"
+
+InputEventQueue::InputEventQueue()
+    : head(0), tail(0), dropped(0)
+{
+}
+
+bool InputEventQueue::push(InputEdge type, uint8_t button, uint32_t heldButtons)
+{
+    if (size() >= CAPACITY)
+    {
+        dropped++;
+        return false;
+    }
+
+    InputEvent &event = events[head & (CAPACITY - 1)];
+    event.type = type;
+    event.button = button;
+    event.heldButtons = heldButtons;
+    head++;
+    return true;
+}
+
+bool InputEventQueue::pop(InputEvent &event)
+{
+    if (isEmpty())
+    {
+        return false;
+    }
+
+    event = events[tail & (CAPACITY - 1)];
+    tail++;
+    return true;
+}
+
+void InputEventQueue::clear()
+{
+    tail = head;
+}
@@ -0,0 +1,166 @@
+#include "logging/log.h"
+
+Log::Record Log::records[Log::CAPACITY];
+uint16_t Log::head = 0;
+uint16_t Log::tail = 0;
+uint32_t Log::dropped = 0;
+uint32_t Log::reportedDropped = 0;
+
+uint16_t Log::getPending()
+{
+    return (uint16_t)(__atomic_load_n(&head, __ATOMIC_ACQUIRE) - __atomic_load_n(&tail, __ATOMIC_ACQUIRE));
+}
+
+void Log::push(const char *format, const intptr_t *args, const bool *strings, uint8_t argCount)
+{
+    // Claim a slot; an interrupt that logs in between just takes the next one
+    uint16_t writeIndex = __atomic_load_n(&head, __ATOMIC_RELAXED);
+    do
+    {
+        if ((uint16_t)(writeIndex - __atomic_load_n(&tail, __ATOMIC_ACQUIRE)) >= CAPACITY)
+        {
+            __atomic_fetch_add(&dropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+    } while (!__atomic_compare_exchange_n(&head, &writeIndex, (uint16_t)(writeIndex + 1), true,
+                                          __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+    Record &record = records[writeIndex & (CAPACITY - 1)];
+    record.format = format;
+    record.argCount = argCount;
+    record.stringArgs = 0;
+    size_t textLength = 0;
+    for (int i = 0; i < argCount; i++)
+    {
+        if (!strings[i])
+        {
+            record.args[i] = args[i];
+            continue;
+        }
+
+        // Copied, cut short if the strings before it used up the space
+        const char *value = args[i] != 0 ? (const char *)args[i] : "(null)";
+        size_t length = strnlen(value, MAX_TEXT - 1 - textLength);
+        memcpy(record.text + textLength, value, length);
+        record.text[textLength + length] = '\0';
+        record.args[i] = (intptr_t)textLength;
+        record.stringArgs |= (uint8_t)(1u << i);
+
+        // Past the terminator, unless the space is used up
+        textLength += length;
+        if (textLength < MAX_TEXT - 1)
+        {
+            textLength++;
+        }
+    }
+
+    // Publish only once the record is complete
+    __atomic_store_n(&record.ready, true, __ATOMIC_RELEASE);
+}
+
+bool Log::pop(char *line, size_t size)
+{
+    uint16_t readIndex = tail;
+    if (readIndex == __atomic_load_n(&head, __ATOMIC_ACQUIRE))
+    {
+        return false;
+    }
+
+    // Claimed but still being written by the code this one interrupted
+    Record &record = records[readIndex & (CAPACITY - 1)];
+    if (!__atomic_load_n(&record.ready, __ATOMIC_ACQUIRE))
+    {
+        return false;
+    }
+
+    format(line, size, record);
+    record.ready = false;
+    __atomic_store_n(&tail, (uint16_t)(readIndex + 1), __ATOMIC_RELEASE);
+    return true;
+}
+
+void Log::drain(int maxRecords)
+{
+    char line[MAX_LINE];
+
+    for (int i = 0; i < maxRecords; i++)
+    {
+        // Never let a full USB buffer block the loop
+        if (Serial.availableForWrite() < MAX_LINE)
+        {
+            return;
+        }
+
+        if (dropped != reportedDropped)
+        {
+            snprintf(line, sizeof(line), "Log: %lu records dropped", (unsigned long)(dropped - reportedDropped));
+            reportedDropped = dropped;
+        }
+        else if (!pop(line, sizeof(line)))
+        {
+            return;
+        }
+        Serial.println(line);
+    }
+}
+
+// printf subset: %d %i %u %x %X %c %s %%
+size_t Log::format(char *line, size_t size, const Record &record)
+{
+    size_t length = 0;
+    int argIndex = 0;
+
+    for (const char *p = record.format; *p != '\0' && length + 1 < size; p++)
+    {
+        if (*p != '%' || p[1] == '\0')
+        {
+            line[length++] = *p;
+            continue;
+        }
+
+        char spec = *++p;
+        if (spec == '%')
+        {
+            line[length++] = '%';
+            continue;
+        }
+
+        bool isString = argIndex < record.argCount && (record.stringArgs & (1u << argIndex)) != 0;
+        intptr_t value = argIndex < record.argCount ? record.args[argIndex++] : 0;
+        int written = 0;
+        switch (spec)
+        {
+        case 'd':
+        case 'i':
+            written = snprintf(line + length, size - length, "%ld", (long)value);
+            break;
+        case 'u':
+            written = snprintf(line + length, size - length, "%lu", (unsigned long)(uint32_t)value);
+            break;
+        case 'x':
+            written = snprintf(line + length, size - length, "%lx", (unsigned long)(uint32_t)value);
+            break;
+        case 'X':
+            written = snprintf(line + length, size - length, "%lX", (unsigned long)(uint32_t)value);
+            break;
+        case 'c':
+            written = snprintf(line + length, size - length, "%c", (char)value);
+            break;
+        case 's':
+            written = snprintf(line + length, size - length, "%s", isString ? record.text + value : "(null)");
+            break;
+        default:
+            written = snprintf(line + length, size - length, "%%%c", spec);
+            break;
+        }
+
+        length += (written > 0) ? (size_t)written : 0;
+        if (length >= size)
+        {
+            length = size - 1;
+        }
+    }
+
+    line[length] = '\0';
+    return length;
+}
@@ -1,5 +1,5 @@
 #include <USBHost_t36.h>
-#include <../lib/LCD_I2C-master/LiquidCrystal_I2C.h>
+#include <LiquidCrystal_I2C.h>
 
 #include "main.h"
 
@@ -7,6 +7,14 @@
 #include "actions/action_handler.h"
 #include "actions/run_action.h"
 #include "mapping/mapping_config.h"
+#include "mapping/controller_database.h"
+#include "mapping/profile_bindings.h"
+#include "mapping/flash_profile.h"
+#include "timing/timer_service.h"
+#include "logging/log.h"
+#include "timing/boot_profiler.h"
+#include "timing/mapping_tier.h"
+#include "protocol/control_port.h"
 #include "memory.h"
 
 USBHost usbh;
@@ -15,31 +23,115 @@ USBHub hub2(usbh);
 USBHIDParser hid1(usbh);
 USBHIDParser hid2(usbh);
 USBHIDParser hid3(usbh);
-KeyboardController keyboard(usbh);
-MouseController mouse(usbh);
-JoystickController joy(usbh);
+USBHIDParser hid4(usbh);
+USBHIDParser hid5(usbh);
+HotplugKeyboard keyboard(usbh);
+HotplugMouse mouse(usbh);
+HotplugJoystick joy1(usbh);
+HotplugJoystick joy2(usbh);
+HotplugJoystick joy3(usbh);
+HotplugJoystick joy4(usbh);
 LiquidCrystal_I2C lcd(0x27, 20, 4);
 
 DeviceManager devices;
 ActionHandler actionHandler(&devices);
-JoystickMappingConfig mappingConfig;
+JoystickMappingConfig padConfigs[DeviceManager::MAX_JOYSTICKS];
+JoystickMappingConfig &mappingConfig = padConfigs[0];
+
+// Fast boot leaves the LCD and the SD card to the first loop()
+static bool storagePending = false;
+
+static void startDisplay()
+{
+    devices.startDisplay();
+    BootProfiler::mark("LCD");
+}
+
+// Mount the card and parse what it holds; the layouts stay staged until
+// ControllerDatabase::publish()
+static void startStorage()
+{
+    MappingConfig::initSD();
+    ControllerDatabase::stage();
+    ProfileBindings::init();
+    BootProfiler::mark("SD card");
+}
+
+// The input tier: read the pads, map, send
+static void inputFrame(void *context)
+{
+    (void)context;
+    devices.captureSnapshots();
+    actionHandler.inputFrame();
+}
+
+#ifdef UI_LOAD_TEST
+// Jitter check on hardware: loop() keeps the LCD and I2C bus busy and logs
+// the input tier's timing every second
+static void uiLoadTest()
+{
+    static unsigned long lastReport = 0;
+    static uint8_t counter = 0;
+
+    LiquidCrystal_I2C *display = devices.getLCD();
+    display->setCursor(0, 3);
+    for (int i = 0; i < 20; i++)
+    {
+        display->write((uint8_t)('0' + (counter + i) % 10));
+    }
+    counter++;
+
+    if (millis() - lastReport >= 1000)
+    {
+        lastReport = millis();
+
+        MappingTier::Stats stats;
+        MappingTier::getStats(stats);
+        LOG_INFO("MappingTier: Interval %u..%u us, frame max %u us", stats.minIntervalUs, stats.maxIntervalUs, stats.maxFrameUs);
+        MappingTier::resetStats();
+    }
+}
+#endif
 
 void setup()
 {
+    BootProfiler::mark("Core start-up");
+
     devices.host = &usbh;
     devices.keyboard = &keyboard;
     devices.mouse = &mouse;
-    devices.joystick = &joy;
+    devices.joysticks[0] = &joy1;
+    devices.joysticks[1] = &joy2;
+    devices.joysticks[2] = &joy3;
+    devices.joysticks[3] = &joy4;
+    devices.numJoysticks = DeviceManager::MAX_JOYSTICKS;
     devices.lcd = &lcd;
 
     Serial.begin(115200);
     Serial.println("Main: === GamePad to Keyboard Starting ===");
     Serial.println("Main: Initializing USB Host...");
 
-    MappingConfig::initSD();
-
     devices.setup();
-    actionHandler.setup();
+    BootProfiler::mark("USB host");
+
+    // Fast path: map with the last profile from program flash right away
+    if (FlashProfile::begin() && FlashProfile::load(mappingConfig))
+    {
+        BootProfiler::mark("Flash profile");
+        ControllerDatabase::init(nullptr); // Built-in layouts until the card is up
+        storagePending = true;
+        actionHandler.setup("");
+    }
+    else
+    {
+        startDisplay();
+        startStorage();
+        ControllerDatabase::publish();
+        actionHandler.setup();
+    }
+
+    MappingTier::begin(inputFrame, nullptr);
+    ControlPort::begin(&actionHandler, &devices);
 
     //MemoryMonitor::init();
 }
@@ -47,7 +139,44 @@ void setup()
 void loop()
 {
     devices.loop();
+    TimerService::update();
     actionHandler.loop();
+    actionHandler.sendReports();
+
+    if (storagePending)
+    {
+        // Mapping runs by now; the LCD's init delays leave the input tier alone
+        storagePending = false;
+        startDisplay();
+
+        // The card is read alongside the input frame; only the layout swap
+        // holds it off. Bindings are read from loop() alone.
+        startStorage();
+        MappingTier::pause();
+        ControllerDatabase::publish();
+        devices.refreshLayouts();
+        MappingTier::resume();
+
+        // Profiles reach the pads through their LiveConfig
+        actionHandler.onStorageReady();
+    }
+    BootProfiler::update();
+
+#ifdef UI_LOAD_TEST
+    uiLoadTest();
+#endif
+
+    // Host requests over USB serial; never waits for a partial frame
+    ControlPort::poll();
+
+    // Idle time: write out queued log lines, unless a host fetches them
+    if (!ControlPort::isHostAttached())
+    {
+        Log::drain();
+    }
+
+    // Frames from the tier that came in while loop() was busy
+    actionHandler.sendReports();
 
     //MemoryMonitor::update();
 }
\ No newline at end of file
@@ -0,0 +1,368 @@
+#include "mapping/controller_database.h"
+#include "mapping/joystick_mappings.h"
+#include "mapping/mapping_config.h"
+#include "logging/log.h"
+
+ControllerLayout ControllerDatabase::layouts[MAX_LAYOUTS];
+int ControllerDatabase::layoutCount = 0;
+bool ControllerDatabase::initialized = false;
+ControllerLayout ControllerDatabase::staged[MAX_LAYOUTS];
+int ControllerDatabase::stagedCount = 0;
+uint8_t ControllerDatabase::vidPidIndex[HASH_SIZE];
+uint8_t ControllerDatabase::typeIndex[MAX_JOY_TYPES];
+uint8_t ControllerDatabase::genericIndex = ControllerDatabase::EMPTY_SLOT;
+
+namespace
+{
+    struct ButtonPair
+    {
+        uint8_t physicalButton;
+        uint8_t genericButton;
+    };
+
+    // Xbox 360 button mapping
+    const ButtonPair xbox360Buttons[] = {
+        {Xbox360Physical::A, GenericController::BTN_SOUTH},
+        {Xbox360Physical::B, GenericController::BTN_EAST},
+        {Xbox360Physical::X, GenericController::BTN_WEST},
+        {Xbox360Physical::Y, GenericController::BTN_NORTH},
+        {Xbox360Physical::LB, GenericController::BTN_L1},
+        {Xbox360Physical::RB, GenericController::BTN_R1},
+        {Xbox360Physical::BACK, GenericController::BTN_SELECT},
+        {Xbox360Physical::START, GenericController::BTN_START},
+        {Xbox360Physical::XBOX_BUTTON, GenericController::BTN_MENU},
+        {Xbox360Physical::LEFT_STICK, GenericController::BTN_L3},
+        {Xbox360Physical::RIGHT_STICK, GenericController::BTN_R3},
+        {Xbox360Physical::DPAD_UP, GenericController::BTN_DPAD_UP},
+        {Xbox360Physical::DPAD_DOWN, GenericController::BTN_DPAD_DOWN},
+        {Xbox360Physical::DPAD_LEFT, GenericController::BTN_DPAD_LEFT},
+        {Xbox360Physical::DPAD_RIGHT, GenericController::BTN_DPAD_RIGHT}
+    };
+
+    // PS4 button mapping (also the default for generic HID gamepads)
+    const ButtonPair ps4Buttons[] = {
+        {PS4Physical::CROSS, GenericController::BTN_SOUTH},
+        {PS4Physical::CIRCLE, GenericController::BTN_EAST},
+        {PS4Physical::SQUARE, GenericController::BTN_WEST},
+        {PS4Physical::TRIANGLE, GenericController::BTN_NORTH},
+        {PS4Physical::L1, GenericController::BTN_L1},
+        {PS4Physical::R1, GenericController::BTN_R1},
+        {PS4Physical::L2, GenericController::BTN_L2},
+        {PS4Physical::R2, GenericController::BTN_R2},
+        {PS4Physical::SHARE, GenericController::BTN_SELECT},
+        {PS4Physical::OPTIONS, GenericController::BTN_START},
+        {PS4Physical::PS_BUTTON, GenericController::BTN_MENU},
+        {PS4Physical::L3, GenericController::BTN_L3},
+        {PS4Physical::R3, GenericController::BTN_R3},
+        {PS4Physical::TOUCHPAD, GenericController::BTN_TOUCHPAD}
+    };
+
+    // Generic axis order: LX, LY, RX, RY, LT, RT
+    const uint8_t standardAxes[ControllerLayout::NUM_AXES] = {0, 1, 2, 3, 4, 5};
+    const uint8_t hidAxes[ControllerLayout::NUM_AXES] = {0, 1, 2, 5, 3, 4};
+
+    struct BuiltinLayout
+    {
+        const char *name;
+        JoystickController::joytype_t joyType;
+        DPadEncoding dpadEncoding;
+        uint8_t dpadAxis;
+        const uint8_t *axisMap;
+        const ButtonPair *buttons;
+        int buttonCount;
+    };
+
+    const BuiltinLayout builtinLayouts[] = {
+        {"Xbox360", JoystickController::XBOX360, DPadEncoding::BUTTONS, 0, standardAxes,
+         xbox360Buttons, sizeof(xbox360Buttons) / sizeof(xbox360Buttons[0])},
+        {"PS4", JoystickController::PS4, DPadEncoding::HAT, PS4Physical::DPAD_AXIS, hidAxes,
+         ps4Buttons, sizeof(ps4Buttons) / sizeof(ps4Buttons[0])},
+        {"Generic", JoystickController::UNKNOWN, DPadEncoding::HAT, PS4Physical::DPAD_AXIS, hidAxes,
+         ps4Buttons, sizeof(ps4Buttons) / sizeof(ps4Buttons[0])}
+    };
+
+    const int builtinLayoutCount = sizeof(builtinLayouts) / sizeof(builtinLayouts[0]);
+
+    uint16_t readU16(const uint8_t *p)
+    {
+        return (uint16_t)(p[0] | (p[1] << 8));
+    }
+
+    int16_t readI16(const uint8_t *p)
+    {
+        return (int16_t)readU16(p);
+    }
+}
+
+void ControllerDatabase::init(const char *filename)
+{
+    stage(filename);
+    publish();
+}
+
+void ControllerDatabase::stage(const char *filename)
+{
+    stagedCount = 0;
+    registerBuiltins();
+
+    if (filename != nullptr && MappingConfig::getStorage().exists(filename))
+    {
+        loadFromSD(filename);
+    }
+}
+
+void ControllerDatabase::publish()
+{
+    memcpy(layouts, staged, stagedCount * sizeof(ControllerLayout));
+    layoutCount = stagedCount;
+    rebuildIndex();
+    initialized = true;
+
+    LOG_INFO("ControllerDatabase: %d controller layouts available", layoutCount);
+}
+
+void ControllerDatabase::registerBuiltins()
+{
+    for (int i = 0; i < builtinLayoutCount; i++)
+    {
+        const BuiltinLayout &builtin = builtinLayouts[i];
+        ControllerLayout layout;
+
+        layout.vendorId = 0;
+        layout.productId = 0;
+        layout.joyType = builtin.joyType;
+        layout.dpadEncoding = builtin.dpadEncoding;
+        layout.dpadAxis = builtin.dpadAxis;
+        layout.stickMin = 0;
+        layout.stickMax = 255;
+        layout.triggerMin = 0;
+        layout.triggerMax = 255;
+
+        memcpy(layout.axisMap, builtin.axisMap, ControllerLayout::NUM_AXES);
+        memset(layout.buttonMap, ControllerLayout::NO_MAPPING, ControllerLayout::MAX_BUTTONS);
+        for (int b = 0; b < builtin.buttonCount; b++)
+        {
+            layout.buttonMap[builtin.buttons[b].physicalButton] = builtin.buttons[b].genericButton;
+        }
+
+        strncpy(layout.name, builtin.name, ControllerLayout::MAX_NAME_LENGTH);
+        layout.name[ControllerLayout::MAX_NAME_LENGTH] = '\0';
+
+        addLayout(layout);
+    }
+}
+
+bool ControllerDatabase::loadFromSD(const char *filename)
+{
+    StorageFile file = MappingConfig::getStorage().open(filename);
+    if (!file)
+    {
+        LOG_WARN("ControllerDatabase: Failed to open file: %s", filename);
+        return false;
+    }
+
+    uint8_t header[HEADER_SIZE];
+    if (file.read(header, HEADER_SIZE) != HEADER_SIZE ||
+        memcmp(header, "GPDB", 4) != 0 ||
+        header[4] != FILE_VERSION ||
+        header[5] < RECORD_SIZE)
+    {
+        LOG_ERROR("ControllerDatabase: Invalid database header in: %s", filename);
+        file.close();
+        return false;
+    }
+
+    uint8_t recordSize = header[5];
+    uint16_t recordCount = readU16(&header[6]);
+    int loaded = 0;
+
+    uint8_t record[256];
+    for (uint16_t i = 0; i < recordCount; i++)
+    {
+        if (file.read(record, recordSize) != recordSize)
+        {
+            LOG_WARN("ControllerDatabase: Warning: Truncated database file");
+            break;
+        }
+
+        ControllerLayout layout;
+        if (!parseRecord(record, layout))
+        {
+            LOG_WARN("ControllerDatabase: Warning: Skipping invalid record %d", i);
+            continue;
+        }
+
+        if (!addLayout(layout))
+        {
+            LOG_WARN("ControllerDatabase: Warning: Too many layouts, truncating");
+            break;
+        }
+        loaded++;
+    }
+
+    file.close();
+
+    LOG_INFO("ControllerDatabase: Loaded %d layouts from: %s", loaded, filename);
+
+    return true;
+}
+
+bool ControllerDatabase::parseRecord(const uint8_t *record, ControllerLayout &layout)
+{
+    layout.vendorId = readU16(&record[0]);
+    layout.productId = readU16(&record[2]);
+    layout.joyType = record[4];
+    layout.dpadEncoding = (DPadEncoding)record[5];
+    layout.dpadAxis = record[6];
+    layout.stickMin = readI16(&record[8]);
+    layout.stickMax = readI16(&record[10]);
+    layout.triggerMin = readI16(&record[12]);
+    layout.triggerMax = readI16(&record[14]);
+    memcpy(layout.axisMap, &record[16], ControllerLayout::NUM_AXES);
+    memcpy(layout.buttonMap, &record[24], ControllerLayout::MAX_BUTTONS);
+    memcpy(layout.name, &record[56], ControllerLayout::MAX_NAME_LENGTH);
+    layout.name[ControllerLayout::MAX_NAME_LENGTH] = '\0';
+
+    if (layout.joyType >= MAX_JOY_TYPES ||
+        layout.dpadEncoding > DPadEncoding::HAT ||
+        layout.stickMax <= layout.stickMin ||
+        layout.triggerMax <= layout.triggerMin)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < ControllerLayout::MAX_BUTTONS; i++)
+    {
+        if (layout.buttonMap[i] != ControllerLayout::NO_MAPPING &&
+            layout.buttonMap[i] >= ControllerLayout::MAX_BUTTONS)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ControllerDatabase::addLayout(const ControllerLayout &layout)
+{
+    // A record for the same device (or the same type default) replaces the old one
+    for (int i = 0; i < stagedCount; i++)
+    {
+        if (staged[i].vendorId == layout.vendorId &&
+            staged[i].productId == layout.productId &&
+            (layout.vendorId != 0 || staged[i].joyType == layout.joyType))
+        {
+            staged[i] = layout;
+            deriveReverseMap(staged[i]);
+            return true;
+        }
+    }
+
+    if (stagedCount >= MAX_LAYOUTS)
+    {
+        return false;
+    }
+
+    staged[stagedCount] = layout;
+    deriveReverseMap(staged[stagedCount]);
+    stagedCount++;
+    return true;
+}
+
+void ControllerDatabase::deriveReverseMap(ControllerLayout &layout)
+{
+    memset(layout.genericToPhysical, ControllerLayout::NO_MAPPING, ControllerLayout::MAX_BUTTONS);
+
+    // Lowest physical button wins if several map to the same generic button
+    for (int physical = ControllerLayout::MAX_BUTTONS - 1; physical >= 0; physical--)
+    {
+        uint8_t generic = layout.buttonMap[physical];
+        if (generic != ControllerLayout::NO_MAPPING)
+        {
+            layout.genericToPhysical[generic] = physical;
+        }
+    }
+}
+
+void ControllerDatabase::rebuildIndex()
+{
+    memset(vidPidIndex, EMPTY_SLOT, sizeof(vidPidIndex));
+    memset(typeIndex, EMPTY_SLOT, sizeof(typeIndex));
+    genericIndex = EMPTY_SLOT;
+
+    for (int i = 0; i < layoutCount; i++)
+    {
+        const ControllerLayout &layout = layouts[i];
+
+        if (layout.vendorId == 0)
+        {
+            typeIndex[layout.joyType] = i;
+            if (layout.joyType == JoystickController::UNKNOWN)
+            {
+                genericIndex = i;
+            }
+            continue;
+        }
+
+        uint32_t slot = hashVidPid(layout.vendorId, layout.productId);
+        while (vidPidIndex[slot] != EMPTY_SLOT)
+        {
+            slot = (slot + 1) & (HASH_SIZE - 1);
+        }
+        vidPidIndex[slot] = i;
+    }
+}
+
+uint32_t ControllerDatabase::hashVidPid(uint16_t vendorId, uint16_t productId)
+{
+    uint32_t key = ((uint32_t)vendorId << 16) | productId;
+    return (key * 2654435761u) >> 26; // Top 6 bits (HASH_SIZE = 64)
+}
+
+const ControllerLayout *ControllerDatabase::find(uint16_t vendorId, uint16_t productId, JoystickController::joytype_t type)
+{
+    if (!initialized)
+    {
+        init(nullptr);
+    }
+
+    if (vendorId != 0)
+    {
+        uint32_t slot = hashVidPid(vendorId, productId);
+        while (vidPidIndex[slot] != EMPTY_SLOT)
+        {
+            const ControllerLayout &layout = layouts[vidPidIndex[slot]];
+            if (layout.vendorId == vendorId && layout.productId == productId)
+            {
+                return &layout;
+            }
+            slot = (slot + 1) & (HASH_SIZE - 1);
+        }
+    }
+
+    return findByType(type);
+}
+
+const ControllerLayout *ControllerDatabase::find(JoystickController *joystick)
+{
+    if (joystick == nullptr)
+    {
+        return findByType(JoystickController::UNKNOWN);
+    }
+    return find(joystick->idVendor(), joystick->idProduct(), joystick->joystickType());
+}
+
+const ControllerLayout *ControllerDatabase::findByType(JoystickController::joytype_t type)
+{
+    if (!initialized)
+    {
+        init(nullptr);
+    }
+
+    if ((int)type >= 0 && (int)type < MAX_JOY_TYPES && typeIndex[type] != EMPTY_SLOT)
+    {
+        return &layouts[typeIndex[type]];
+    }
+
+    return &layouts[genericIndex];
+}
@@ -0,0 +1,148 @@
+#include "mapping/flash_profile.h"
+#include "mapping/mapping_config.h"
+#include "storage/fs_storage.h"
+#include "logging/log.h"
+
+namespace
+{
+    const char *const PROFILE_FILE = "/profile.bin";
+    FlashStorage flashFS(FlashProfile::FS_SIZE);
+}
+
+bool FlashProfile::mounted = false;
+FlashProfile::Header FlashProfile::cached = {0, 0, 0, 0, 0};
+
+bool FlashProfile::begin()
+{
+    mounted = flashFS.begin();
+    if (!mounted)
+    {
+        LOG_ERROR("FlashProfile: Failed to mount program flash");
+    }
+    return mounted;
+}
+
+bool FlashProfile::load(JoystickMappingConfig &config)
+{
+    if (!mounted)
+    {
+        return false;
+    }
+
+    StorageFile file = flashFS.open(PROFILE_FILE);
+    if (!file)
+    {
+        return false;
+    }
+
+    Header header;
+    bool ok = file.read(&header, sizeof(header)) == (int)sizeof(header) &&
+              header.magic == MAGIC && header.configSize == sizeof(JoystickMappingConfig) &&
+              file.read(&config, sizeof(config)) == (int)sizeof(config);
+    file.close();
+
+    if (!ok || checksum(config) != header.checksum)
+    {
+        LOG_WARN("FlashProfile: Cached profile does not match this build");
+        config = JoystickMappingConfig();
+        return false;
+    }
+
+    cached = header;
+    LOG_INFO("FlashProfile: Restored %s", config.filename);
+    return true;
+}
+
+bool FlashProfile::save(const JoystickMappingConfig &config)
+{
+    if (!mounted || config.filename[0] == '\0')
+    {
+        return false;
+    }
+
+    Header header;
+    header.magic = MAGIC;
+    header.configSize = sizeof(JoystickMappingConfig);
+    hashSourceFile(config.filename, header.sourceSize, header.sourceCrc);
+    header.checksum = checksum(config);
+
+    if (memcmp(&header, &cached, sizeof(header)) == 0)
+    {
+        return true;
+    }
+
+    StorageFile file = flashFS.open(PROFILE_FILE, StorageMode::WRITE);
+    if (!file)
+    {
+        LOG_ERROR("FlashProfile: Failed to create profile cache");
+        return false;
+    }
+
+    file.write((const uint8_t *)&header, sizeof(header));
+    file.write((const uint8_t *)&config, sizeof(config));
+    file.close();
+
+    cached = header;
+    return true;
+}
+
+bool FlashProfile::matchesSD(const JoystickMappingConfig &config)
+{
+    if (cached.magic != MAGIC)
+    {
+        return false;
+    }
+
+    uint32_t size;
+    uint32_t crc;
+    hashSourceFile(config.filename, size, crc);
+    return size == cached.sourceSize && crc == cached.sourceCrc;
+}
+
+uint32_t FlashProfile::checksum(const JoystickMappingConfig &config)
+{
+    // FNV-1a
+    const uint8_t *bytes = (const uint8_t *)&config;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(config); i++)
+    {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+uint32_t FlashProfile::crc32(const uint8_t *data, size_t length, uint32_t crc)
+{
+    // Reflected, polynomial 0xEDB88320; pass 0 to start, chain for more data
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+        }
+    }
+    return ~crc;
+}
+
+void FlashProfile::hashSourceFile(const char *filename, uint32_t &size, uint32_t &crc)
+{
+    size = 0;
+    crc = 0;
+
+    // Read through the SD cache, which the profile load just filled
+    StorageFile file = MappingConfig::getStorage().open(filename);
+    if (!file)
+    {
+        return;
+    }
+
+    uint8_t buffer[256];
+    int count;
+    while ((count = file.read(buffer, sizeof(buffer))) > 0)
+    {
+        crc = crc32(buffer, (size_t)count, crc);
+        size += (uint32_t)count;
+    }
+}
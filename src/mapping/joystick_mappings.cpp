@@ -1,4 +1,6 @@
 #include "mapping/joystick_mappings.h"
+#include "mapping/controller_database.h"
+#include "logging/log.h"
 
 // Static button name mapping array
 const JoystickMapping::ButtonNameMapping JoystickMapping::buttonNameMap[] = {
@@ -24,175 +26,90 @@ const JoystickMapping::ButtonNameMapping JoystickMapping::buttonNameMap[] = {
 
 const int JoystickMapping::buttonNameMapSize = sizeof(JoystickMapping::buttonNameMap) / sizeof(JoystickMapping::buttonNameMap[0]);
 
-// Xbox 360 button mapping array
-const JoystickMapping::ControllerButtonMapping JoystickMapping::xbox360ButtonMap[] = {
-    {Xbox360Physical::A, GenericController::BTN_SOUTH},
-    {Xbox360Physical::B, GenericController::BTN_EAST},
-    {Xbox360Physical::X, GenericController::BTN_WEST},
-    {Xbox360Physical::Y, GenericController::BTN_NORTH},
-    {Xbox360Physical::LB, GenericController::BTN_L1},
-    {Xbox360Physical::RB, GenericController::BTN_R1},
-    {Xbox360Physical::BACK, GenericController::BTN_SELECT},
-    {Xbox360Physical::START, GenericController::BTN_START},
-    {Xbox360Physical::XBOX_BUTTON, GenericController::BTN_MENU},
-    {Xbox360Physical::LEFT_STICK, GenericController::BTN_L3},
-    {Xbox360Physical::RIGHT_STICK, GenericController::BTN_R3},
-    {Xbox360Physical::DPAD_UP, GenericController::BTN_DPAD_UP},
-    {Xbox360Physical::DPAD_DOWN, GenericController::BTN_DPAD_DOWN},
-    {Xbox360Physical::DPAD_LEFT, GenericController::BTN_DPAD_LEFT},
-    {Xbox360Physical::DPAD_RIGHT, GenericController::BTN_DPAD_RIGHT}
+// Indexed by hat value: 0 = up, clockwise to 7 = up-left, 8 = neutral
+const uint8_t JoystickMapping::hatDirectionTable[9] = {
+    GenericController::DPAD_MASK_UP,
+    GenericController::DPAD_MASK_UP | GenericController::DPAD_MASK_RIGHT,
+    GenericController::DPAD_MASK_RIGHT,
+    GenericController::DPAD_MASK_DOWN | GenericController::DPAD_MASK_RIGHT,
+    GenericController::DPAD_MASK_DOWN,
+    GenericController::DPAD_MASK_DOWN | GenericController::DPAD_MASK_LEFT,
+    GenericController::DPAD_MASK_LEFT,
+    GenericController::DPAD_MASK_UP | GenericController::DPAD_MASK_LEFT,
+    0
 };
 
-const int JoystickMapping::xbox360ButtonMapSize = sizeof(JoystickMapping::xbox360ButtonMap) / sizeof(JoystickMapping::xbox360ButtonMap[0]);
-
-// PS4 button mapping array
-const JoystickMapping::ControllerButtonMapping JoystickMapping::ps4ButtonMap[] = {
-    {PS4Physical::CROSS, GenericController::BTN_SOUTH},
-    {PS4Physical::CIRCLE, GenericController::BTN_EAST},
-    {PS4Physical::SQUARE, GenericController::BTN_WEST},
-    {PS4Physical::TRIANGLE, GenericController::BTN_NORTH},
-    {PS4Physical::L1, GenericController::BTN_L1},
-    {PS4Physical::R1, GenericController::BTN_R1},
-    {PS4Physical::L2, GenericController::BTN_L2},
-    {PS4Physical::R2, GenericController::BTN_R2},
-    {PS4Physical::SHARE, GenericController::BTN_SELECT},
-    {PS4Physical::OPTIONS, GenericController::BTN_START},
-    {PS4Physical::PS_BUTTON, GenericController::BTN_MENU},
-    {PS4Physical::L3, GenericController::BTN_L3},
-    {PS4Physical::R3, GenericController::BTN_R3},
-    {PS4Physical::TOUCHPAD, GenericController::BTN_TOUCHPAD}
-};
-
-const int JoystickMapping::ps4ButtonMapSize = sizeof(JoystickMapping::ps4ButtonMap) / sizeof(JoystickMapping::ps4ButtonMap[0]);
-
-int JoystickMapping::mapButtonToGeneric(JoystickController::joytype_t type, uint8_t controllerButton)
+int JoystickMapping::mapButtonToGeneric(JoystickController *joystick, uint8_t controllerButton)
 {
-    const ControllerButtonMapping *mappingArray = nullptr;
-    int mappingSize = 0;
-
-    switch (type)
+    if (controllerButton >= ControllerLayout::MAX_BUTTONS)
     {
-    case JoystickController::XBOX360:
-        mappingArray = xbox360ButtonMap;
-        mappingSize = xbox360ButtonMapSize;
-        break;
-    case JoystickController::PS4:
-        mappingArray = ps4ButtonMap;
-        mappingSize = ps4ButtonMapSize;
-        break;
-    default:
         return -1;
     }
 
-    for (int i = 0; i < mappingSize; i++)
-    {
-        if (mappingArray[i].physicalButton == controllerButton)
-        {
-            return mappingArray[i].genericButton;
-        }
-    }
-
-    return -1;
+    uint8_t genericButton = ControllerDatabase::find(joystick)->buttonMap[controllerButton];
+    return genericButton == ControllerLayout::NO_MAPPING ? -1 : genericButton;
 }
 
-int JoystickMapping::mapGenericToButton(JoystickController::joytype_t type, uint8_t genericButton)
+int JoystickMapping::mapGenericToButton(JoystickController *joystick, uint8_t genericButton)
 {
-    const ControllerButtonMapping *mappingArray = nullptr;
-    int mappingSize = 0;
-
-    switch (type)
+    if (genericButton >= ControllerLayout::MAX_BUTTONS)
     {
-    case JoystickController::XBOX360:
-        mappingArray = xbox360ButtonMap;
-        mappingSize = xbox360ButtonMapSize;
-        break;
-    case JoystickController::PS4:
-        mappingArray = ps4ButtonMap;
-        mappingSize = ps4ButtonMapSize;
-        break;
-    default:
         return -1;
     }
 
-    for (int i = 0; i < mappingSize; i++)
-    {
-        if (mappingArray[i].genericButton == genericButton)
-        {
-            return mappingArray[i].physicalButton;
-        }
-    }
-
-    return -1;
+    uint8_t physicalButton = ControllerDatabase::find(joystick)->genericToPhysical[genericButton];
+    return physicalButton == ControllerLayout::NO_MAPPING ? -1 : physicalButton;
 }
 
-int JoystickMapping::mapAxisToGeneric(JoystickController::joytype_t type, uint8_t controllerAxis)
+int JoystickMapping::mapAxisToGeneric(JoystickController *joystick, uint8_t controllerAxis)
 {
-    switch (type)
+    if (controllerAxis >= ControllerLayout::NUM_AXES)
     {
-    case JoystickController::PS4:
-        // PS4/PS3 have different axis ordering
-        // Physical axes: 0=LX, 1=LY, 2=RX, 3=L2, 4=R2, 5=RY
-        switch (controllerAxis)
-        {
-        case GenericController::AXIS_LEFT_X:
-            return 0;
-        case GenericController::AXIS_LEFT_Y:
-            return 1;
-        case GenericController::AXIS_RIGHT_X:
-            return 2;
-        case GenericController::AXIS_RIGHT_Y:
-            return 5; // PS4 right Y is on axis 5
-        case GenericController::AXIS_LEFT_TRIGGER:
-            return 3;
-        case GenericController::AXIS_RIGHT_TRIGGER:
-            return 4;
-        default:
-            return -1;
-        }
-
-    case JoystickController::XBOX360:
-    default:
-        // Xbox and most controllers use standard ordering
-        // 0=LX, 1=LY, 2=RX, 3=RY, 4=LT, 5=RT
-        if (controllerAxis <= 5)
-            return controllerAxis;
         return -1;
     }
+
+    uint8_t physicalAxis = ControllerDatabase::find(joystick)->axisMap[controllerAxis];
+    return physicalAxis == ControllerLayout::NO_MAPPING ? -1 : physicalAxis;
 }
 
-bool JoystickMapping::usesDPadAxis(JoystickController::joytype_t type, uint8_t &axisNumber)
+bool JoystickMapping::usesDPadAxis(JoystickController *joystick, uint8_t &axisNumber)
 {
-    switch (type)
+    const ControllerLayout *layout = ControllerDatabase::find(joystick);
+    if (layout->dpadEncoding != DPadEncoding::HAT)
     {
-    case JoystickController::PS4:
-        axisNumber = PS4Physical::DPAD_AXIS;
-        return true;
-    default:
         return false;
     }
+
+    axisNumber = layout->dpadAxis;
+    return true;
 }
 
-int JoystickMapping::mapDPadValueToButton(JoystickController::joytype_t type, uint8_t axisValue)
+uint32_t JoystickMapping::getGenericButtons(const ControllerLayout *layout, JoystickController *joystick)
 {
-    switch (type)
+    uint32_t physical = joystick->getButtons();
+    uint32_t generic = 0;
+
+    // Only set bits cost anything, so an idle pad is a single test
+    while (physical)
     {
-    case JoystickController::PS4:
-        switch (axisValue)
+        uint8_t physicalButton = __builtin_ctz(physical);
+        physical &= physical - 1;
+
+        uint8_t genericButton = layout->buttonMap[physicalButton];
+        if (genericButton != ControllerLayout::NO_MAPPING)
         {
-        case PS4Physical::DPAD_UP_VALUE:
-            return GenericController::BTN_DPAD_UP;
-        case PS4Physical::DPAD_DOWN_VALUE:
-            return GenericController::BTN_DPAD_DOWN;
-        case PS4Physical::DPAD_LEFT_VALUE:
-            return GenericController::BTN_DPAD_LEFT;
-        case PS4Physical::DPAD_RIGHT_VALUE:
-            return GenericController::BTN_DPAD_RIGHT;
-        default:
-            return -1;
+            generic |= 1u << genericButton;
         }
-    default:
-        return -1;
     }
+
+    if (layout->dpadEncoding == DPadEncoding::HAT)
+    {
+        const uint32_t dpadBits = 0x0Fu << GenericController::BTN_DPAD_UP;
+        uint32_t dpad = (uint32_t)mapHatToDPadMask(joystick->getAxis(layout->dpadAxis)) << GenericController::BTN_DPAD_UP;
+        generic = (generic & ~dpadBits) | dpad;
+    }
+
+    return generic;
 }
 
 const char *JoystickMapping::getGenericButtonName(uint8_t genericButton)
@@ -218,7 +135,67 @@ int JoystickMapping::parseGenericButtonName(const char *buttonName)
         }
     }
 
-    Serial.print("JoystickMapping: Warning: Unknown generic button name: ");
-    Serial.println(buttonName);
+    LOG_WARN("JoystickMapping: Warning: Unknown generic button name: %s", buttonName);
     return -1;
-}
\ No newline at end of file
+}
+
+int JoystickMapping::parseChordName(const char *chordName, uint32_t &chordButtons)
+{
+    chordButtons = 0;
+    if (chordName == nullptr)
+    {
+        return -1;
+    }
+
+    char buffer[MAX_CHORD_NAME_LENGTH];
+    strncpy(buffer, chordName, sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = '\0';
+
+    int primary = -1;
+    char *part = buffer;
+    while (part != nullptr)
+    {
+        char *next = strchr(part, '+');
+        if (next != nullptr)
+        {
+            *next++ = '\0';
+        }
+
+        if (primary != -1)
+        {
+            chordButtons |= 1u << primary;
+        }
+
+        primary = parseGenericButtonName(part);
+        if (primary == -1)
+        {
+            chordButtons = 0;
+            return -1;
+        }
+        part = next;
+    }
+
+    chordButtons &= ~(1u << primary);
+    return primary;
+}
+
+void JoystickMapping::formatChordName(uint8_t genericButton, uint32_t chordButtons, char *buffer, size_t bufferSize)
+{
+    size_t length = 0;
+    buffer[0] = '\0';
+
+    for (uint8_t button = 0; button < 32 && chordButtons != 0; button++)
+    {
+        if (chordButtons & (1u << button))
+        {
+            chordButtons &= ~(1u << button);
+            length += snprintf(buffer + length, bufferSize - length, "%s+", getGenericButtonName(button));
+            if (length >= bufferSize)
+            {
+                return;
+            }
+        }
+    }
+
+    snprintf(buffer + length, bufferSize - length, "%s", getGenericButtonName(genericButton));
+}
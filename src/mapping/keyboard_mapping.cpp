@@ -1,5 +1,6 @@
 #include "mapping/keyboard_mapping.h"
 #include <Arduino.h>
+#include "logging/log.h"
 
 // Unified key mapping structure
 struct KeyMapping
@@ -84,6 +85,17 @@ static const KeyMapping specialKeyMappings[] = {
     {KEYPAD_0, "KP 0", "KP_0", '0'},
     {KEYPAD_PERIOD, "KP .", "KP_DOT", '.'},
 
+    // Mouse buttons and wheel steps (no ASCII equivalents)
+    {KeyboardMapping::MOUSE_BUTTON_BASE + MOUSE_LEFT, "Mouse Left", "Left Click", 0},
+    {KeyboardMapping::MOUSE_BUTTON_BASE + MOUSE_RIGHT, "Mouse Right", "Right Click", 0},
+    {KeyboardMapping::MOUSE_BUTTON_BASE + MOUSE_MIDDLE, "Mouse Middle", "Middle Click", 0},
+    {KeyboardMapping::MOUSE_BUTTON_BASE + MOUSE_BACK, "Mouse Back", nullptr, 0},
+    {KeyboardMapping::MOUSE_BUTTON_BASE + MOUSE_FORWARD, "Mouse Fwd", "Mouse Forward", 0},
+    {KeyboardMapping::MOUSE_WHEEL_UP, "Wheel Up", nullptr, 0},
+    {KeyboardMapping::MOUSE_WHEEL_DOWN, "Wheel Down", nullptr, 0},
+    {KeyboardMapping::MOUSE_WHEEL_LEFT, "Wheel Left", nullptr, 0},
+    {KeyboardMapping::MOUSE_WHEEL_RIGHT, "Wheel Right", nullptr, 0},
+
     // Symbol/Punctuation keys (ASCII values for the unshifted character)
     {KEY_MINUS, "-", "Minus", '-'},           // - and _
     {KEY_EQUAL, "=", "Equals", '='},           // = and +
@@ -135,6 +147,16 @@ int KeyboardMapping::parseKeyCode(const char *keyStr)
         return keyStr[0];
     }
 
+    // Joystick buttons: "Joy 1" to "Joy 32"
+    if (strncasecmp(keyStr, "Joy ", 4) == 0)
+    {
+        int button = atoi(keyStr + 4);
+        if (button >= 1 && button <= MAX_JOYSTICK_BUTTONS)
+        {
+            return JOYSTICK_BUTTON_BASE + button;
+        }
+    }
+
     // Check unified key mappings
     for (int i = 0; i < specialKeyMappingsCount; i++)
     {
@@ -150,8 +172,7 @@ int KeyboardMapping::parseKeyCode(const char *keyStr)
         }
     }
 
-    Serial.print("KeyMapping: Warning: Unknown key string: ");
-    Serial.println(keyStr);
+    LOG_WARN("KeyMapping: Warning: Unknown key string: %s", keyStr);
     return -1;
 }
 
@@ -175,6 +196,13 @@ const char *KeyboardMapping::keyCodeToString(int keyCode)
         return letterBuf;
     }
 
+    if (isJoystickButton(keyCode))
+    {
+        static char joystickBuf[8];
+        snprintf(joystickBuf, sizeof(joystickBuf), "Joy %d", keyCode - JOYSTICK_BUTTON_BASE);
+        return joystickBuf;
+    }
+
     // Numbers: KEY_0 through KEY_9
     if (keyCode >= KEY_0 && keyCode <= KEY_9)
     {
@@ -253,10 +281,6 @@ int KeyboardMapping::unicodeToKeyCode(int unicode)
     }
 
     // Unknown/unsupported key
-    Serial.print("KeyMapping: Warning: Unsupported unicode value: 0x");
-    Serial.print(unicode, HEX);
-    Serial.print(" (");
-    Serial.print(unicode);
-    Serial.println(")");
+    LOG_WARN("KeyMapping: Warning: Unsupported unicode value: 0x%x (%d)", unicode, unicode);
     return unicode; // Return as-is and let the system handle it
 }
@@ -0,0 +1,126 @@
+#include "mapping/live_config.h"
+#include "mapping/mapping_config.h"
+#include "logging/log.h"
+#include <math.h>
+
+LiveConfig::LiveConfig()
+    : active(&buffers[0]), pending(nullptr)
+{
+}
+
+bool LiveConfig::publish(const JoystickMappingConfig &shadow)
+{
+    const char *problem = validate(shadow);
+    if (problem != nullptr)
+    {
+        LOG_WARN("LiveConfig: %s not applied: %s", shadow.displayName, problem);
+        return false;
+    }
+
+    // Withdraw a config the engine has not taken yet; it is rewritten below
+    __atomic_store_n(&pending, (JoystickMappingConfig *)nullptr, __ATOMIC_SEQ_CST);
+
+    // The engine switches buffers only inside take(), never while this runs
+    const JoystickMappingConfig *current = __atomic_load_n(&active, __ATOMIC_ACQUIRE);
+    JoystickMappingConfig *spare = (current == &buffers[0]) ? &buffers[1] : &buffers[0];
+    *spare = shadow;
+    compile(*spare);
+
+    __atomic_store_n(&pending, spare, __ATOMIC_RELEASE);
+    return true;
+}
+
+const JoystickMappingConfig *LiveConfig::take()
+{
+    JoystickMappingConfig *next = __atomic_exchange_n(&pending, (JoystickMappingConfig *)nullptr, __ATOMIC_ACQUIRE);
+    if (next != nullptr)
+    {
+        __atomic_store_n(&active, next, __ATOMIC_RELEASE);
+    }
+    return next;
+}
+
+const char *LiveConfig::validate(const JoystickMappingConfig &config)
+{
+    if (config.numMappings < 0 || config.numMappings > JoystickMappingConfig::MAX_MAPPINGS)
+    {
+        return "mapping count";
+    }
+    if (config.numLayers < 1 || config.numLayers > JoystickMappingConfig::MAX_LAYERS)
+    {
+        return "layer count";
+    }
+    if (config.macroCodeSize < 0 || config.macroCodeSize > JoystickMappingConfig::MAX_MACRO_BYTES)
+    {
+        return "macro size";
+    }
+
+    for (int i = 1; i < config.numLayers; i++)
+    {
+        if (config.layerButtons[i] >= 32)
+        {
+            return "layer button";
+        }
+    }
+
+    for (int i = 0; i < config.numMappings; i++)
+    {
+        const ButtonMapping &mapping = config.mappings[i];
+        if (mapping.genericButton >= 32)
+        {
+            return "button";
+        }
+        if (mapping.macro != ButtonMapping::NO_MACRO && mapping.macro >= config.macroCodeSize)
+        {
+            return "macro";
+        }
+        if (mapping.turboRate > ButtonMapping::MAX_TURBO_RATE ||
+            (mapping.turboRate != 0 && (mapping.turboDuty < ButtonMapping::MIN_TURBO_DUTY || mapping.turboDuty > ButtonMapping::MAX_TURBO_DUTY)))
+        {
+            return "turbo";
+        }
+        if (mapping.holdKeyCode != 0 && mapping.holdTime == 0)
+        {
+            return "hold time";
+        }
+    }
+
+    const StickConfig *sticks[] = {&config.leftStick, &config.rightStick};
+    for (const StickConfig *stick : sticks)
+    {
+        if (stick->behavior > StickBehavior::JOYSTICK_Y || !isfinite(stick->sensitivity))
+        {
+            return "stick";
+        }
+    }
+    if (config.triggers.behavior > TriggerBehavior::JOYSTICK_Y || !isfinite(config.triggers.sensitivity))
+    {
+        return "triggers";
+    }
+
+    return nullptr;
+}
+
+void LiveConfig::compile(JoystickMappingConfig &config)
+{
+    MappingConfig::prepareMatching(config);
+
+    StickConfig *sticks[] = {&config.leftStick, &config.rightStick};
+    for (StickConfig *stick : sticks)
+    {
+        if (stick->behavior == StickBehavior::WASD_KEYS)
+        {
+            stick->keyUp = 'w';
+            stick->keyDown = 's';
+            stick->keyLeft = 'a';
+            stick->keyRight = 'd';
+        }
+        else if (stick->behavior == StickBehavior::ARROW_KEYS)
+        {
+            stick->keyUp = KEY_UP;
+            stick->keyDown = KEY_DOWN;
+            stick->keyLeft = KEY_LEFT;
+            stick->keyRight = KEY_RIGHT;
+        }
+    }
+}
@@ -0,0 +1,159 @@
+#include "mapping/macro.h"
+#include "mapping/keyboard_mapping.h"
+#include "logging/log.h"
+
+int Macro::instructionSize(uint8_t op)
+{
+    switch (op)
+    {
+    case MacroOp::OP_PRESS:
+    case MacroOp::OP_RELEASE:
+    case MacroOp::OP_WAIT:
+        return 3;
+    case MacroOp::OP_MOUSE:
+        return 4;
+    default:
+        return 1;
+    }
+}
+
+int Macro::compile(JsonArray steps, uint8_t *code, int capacity)
+{
+    int size = 0;
+
+    for (JsonVariant step : steps)
+    {
+        const char *stepStr = step.as<const char *>();
+        if (stepStr == nullptr)
+        {
+            LOG_WARN("Macro: Step is not a string");
+            return -1;
+        }
+
+        int written = compileStep(stepStr, code + size, capacity - size - 1);
+        if (written < 0)
+        {
+            LOG_WARN("Macro: Invalid step: %s", stepStr);
+            return -1;
+        }
+        size += written;
+    }
+
+    if (size >= capacity)
+    {
+        return -1;
+    }
+    code[size++] = MacroOp::OP_END;
+    return size;
+}
+
+int Macro::compileStep(const char *step, uint8_t *code, int capacity)
+{
+    auto emit16 = [&](int at, uint8_t op, uint16_t value)
+    {
+        code[at] = op;
+        code[at + 1] = value & 0xFF;
+        code[at + 2] = value >> 8;
+    };
+
+    if (strncasecmp(step, "wait ", 5) == 0)
+    {
+        long ms = strtol(step + 5, nullptr, 10);
+        if (ms < 0 || ms > 0xFFFF || capacity < 3)
+        {
+            return -1;
+        }
+        emit16(0, MacroOp::OP_WAIT, (uint16_t)ms);
+        return 3;
+    }
+
+    if (strncasecmp(step, "mouse ", 6) == 0)
+    {
+        int x = 0, y = 0, wheel = 0;
+        if (sscanf(step + 6, "%d %d %d", &x, &y, &wheel) < 2 || capacity < 4)
+        {
+            return -1;
+        }
+        code[0] = MacroOp::OP_MOUSE;
+        code[1] = (uint8_t)(int8_t)constrain(x, -127, 127);
+        code[2] = (uint8_t)(int8_t)constrain(y, -127, 127);
+        code[3] = (uint8_t)(int8_t)constrain(wheel, -127, 127);
+        return 4;
+    }
+
+    // "+key" / "-key" press or release, a bare key name taps
+    uint8_t op = 0;
+    const char *keyStr = step;
+    if (strlen(step) > 1 && (step[0] == '+' || step[0] == '-'))
+    {
+        op = (step[0] == '+') ? MacroOp::OP_PRESS : MacroOp::OP_RELEASE;
+        keyStr = step + 1;
+    }
+
+    int keyCode = KeyboardMapping::parseKeyCode(keyStr);
+    if (keyCode < 0 || keyCode > 0xFFFF)
+    {
+        return -1;
+    }
+
+    if (op != 0)
+    {
+        if (capacity < 3)
+        {
+            return -1;
+        }
+        emit16(0, op, keyCode);
+        return 3;
+    }
+
+    // Tap: hold for one tick so the press and release go out in separate reports
+    if (capacity < 9)
+    {
+        return -1;
+    }
+    emit16(0, MacroOp::OP_PRESS, keyCode);
+    emit16(3, MacroOp::OP_WAIT, 0);
+    emit16(6, MacroOp::OP_RELEASE, keyCode);
+    return 9;
+}
+
+void Macro::decompile(const uint8_t *code, JsonArray steps)
+{
+    char step[MAX_STEP_LENGTH];
+
+    for (int pc = 0; code[pc] != MacroOp::OP_END; pc += instructionSize(code[pc]))
+    {
+        uint8_t op = code[pc];
+        uint16_t value = code[pc + 1] | (code[pc + 2] << 8);
+
+        switch (op)
+        {
+        case MacroOp::OP_PRESS:
+            // Fold press / wait 0 / release of the same key back into a tap
+            if (code[pc + 3] == MacroOp::OP_WAIT && code[pc + 4] == 0 && code[pc + 5] == 0 &&
+                code[pc + 6] == MacroOp::OP_RELEASE && (code[pc + 7] | (code[pc + 8] << 8)) == value)
+            {
+                snprintf(step, sizeof(step), "%s", KeyboardMapping::keyCodeToString(value));
+                pc += 6;
+            }
+            else
+            {
+                snprintf(step, sizeof(step), "+%s", KeyboardMapping::keyCodeToString(value));
+            }
+            break;
+        case MacroOp::OP_RELEASE:
+            snprintf(step, sizeof(step), "-%s", KeyboardMapping::keyCodeToString(value));
+            break;
+        case MacroOp::OP_WAIT:
+            snprintf(step, sizeof(step), "wait %u", value);
+            break;
+        case MacroOp::OP_MOUSE:
+            snprintf(step, sizeof(step), "mouse %d %d %d", (int8_t)code[pc + 1], (int8_t)code[pc + 2], (int8_t)code[pc + 3]);
+            break;
+        default:
+            return;
+        }
+
+        steps.add(step);
+    }
+}
@@ -0,0 +1,156 @@
+#include "mapping/macro_engine.h"
+#include "logging/log.h"
+
+MacroEngine::MacroEngine()
+    : activeCount(0)
+{
+    for (int i = 0; i < MAX_EXECUTORS; i++)
+    {
+        executors[i].code = nullptr;
+    }
+}
+
+bool MacroEngine::start(const uint8_t *code, HidOutput *output, unsigned long now)
+{
+    for (int i = 0; i < MAX_EXECUTORS; i++)
+    {
+        Executor &executor = executors[i];
+        if (executor.code == nullptr)
+        {
+            executor.code = code;
+            executor.pc = 0;
+            executor.wakeTime = now;
+            executor.output = output;
+            executor.numHeld = 0;
+            activeCount++;
+
+            // Steps run from the next tick()
+            return true;
+        }
+    }
+
+    LOG_WARN("MacroEngine: Warning: All executors busy, macro dropped");
+    return false;
+}
+
+void MacroEngine::tick(unsigned long now)
+{
+    if (activeCount == 0)
+    {
+        return;
+    }
+
+    for (int i = 0; i < MAX_EXECUTORS; i++)
+    {
+        Executor &executor = executors[i];
+        if (executor.code != nullptr && (long)(now - executor.wakeTime) >= 0)
+        {
+            run(executor, now);
+        }
+    }
+}
+
+void MacroEngine::run(Executor &executor, unsigned long now)
+{
+    const uint8_t *code = executor.code;
+
+    while (true)
+    {
+        const uint8_t *step = &code[executor.pc];
+        uint16_t value = step[1] | (step[2] << 8);
+
+        switch (step[0])
+        {
+        case MacroOp::OP_PRESS:
+            executor.output->pressKey(value);
+            if (executor.numHeld < MAX_HELD_KEYS)
+            {
+                executor.heldKeys[executor.numHeld++] = value;
+            }
+            break;
+
+        case MacroOp::OP_RELEASE:
+            executor.output->releaseKey(value);
+            for (int i = 0; i < executor.numHeld; i++)
+            {
+                if (executor.heldKeys[i] == value)
+                {
+                    executor.heldKeys[i] = executor.heldKeys[--executor.numHeld];
+                    break;
+                }
+            }
+            break;
+
+        case MacroOp::OP_MOUSE:
+            executor.output->moveMouse((int8_t)step[1], (int8_t)step[2], (int8_t)step[3]);
+            break;
+
+        case MacroOp::OP_WAIT:
+            executor.pc += Macro::instructionSize(MacroOp::OP_WAIT);
+            if (value == 0)
+            {
+                // Resume on the next tick
+                executor.wakeTime = now;
+                return;
+            }
+
+            // Measured from when the previous wait ended, so steps do not drift
+            executor.wakeTime += value;
+            if ((long)(now - executor.wakeTime) < 0)
+            {
+                return;
+            }
+            continue;
+
+        default: // OP_END
+            stop(executor);
+            return;
+        }
+
+        executor.pc += Macro::instructionSize(step[0]);
+    }
+}
+
+void MacroEngine::stop(Executor &executor)
+{
+    // Keys left pressed by an unfinished or unbalanced macro
+    for (int i = 0; i < executor.numHeld; i++)
+    {
+        executor.output->releaseKey(executor.heldKeys[i]);
+    }
+    executor.numHeld = 0;
+    executor.code = nullptr;
+    activeCount--;
+}
+
+void MacroEngine::stopAll()
+{
+    for (int i = 0; i < MAX_EXECUTORS; i++)
+    {
+        if (executors[i].code != nullptr)
+        {
+            stop(executors[i]);
+        }
+    }
+}
+
+void MacroEngine::relocate(const uint8_t *from, const uint8_t *to, size_t size)
+{
+    for (int i = 0; i < MAX_EXECUTORS; i++)
+    {
+        Executor &executor = executors[i];
+        if (executor.code == nullptr || executor.code < from || executor.code >= from + size)
+        {
+            continue;
+        }
+
+        if (to != nullptr)
+        {
+            executor.code = to + (executor.code - from);
+        }
+        else
+        {
+            stop(executor);
+        }
+    }
+}
@@ -1,6 +1,18 @@
 #include "mapping/mapping_config.h"
 #include "mapping/joystick_mappings.h"
 #include "mapping/keyboard_mapping.h"
+#include "mapping/macro.h"
+#include "storage/fs_storage.h"
+#include "storage/cached_storage.h"
+#include "logging/log.h"
+
+namespace
+{
+    SdStorage sdStorage;
+    CachedStorage sdCache(sdStorage);
+}
+
+Storage *MappingConfig::storage = &sdCache;
 
 const MappingConfig::StickBehaviorMapping MappingConfig::stickBehaviorMap[] = {
     {StickBehavior::DISABLED, "Disabled"},
@@ -8,11 +20,16 @@ const MappingConfig::StickBehaviorMapping MappingConfig::stickBehaviorMap[] = {
     {StickBehavior::BUTTON_EMULATION, "Custom Keys"},
     {StickBehavior::SCROLL_WHEEL, "Scroll"},
     {StickBehavior::WASD_KEYS, "WASD Keys"},
-    {StickBehavior::ARROW_KEYS, "Arrow Keys"}
+    {StickBehavior::ARROW_KEYS, "Arrow Keys"},
+    {StickBehavior::JOYSTICK, "Joystick"},
+    {StickBehavior::JOYSTICK_X, "Joystick X"},
+    {StickBehavior::JOYSTICK_Y, "Joystick Y"}
 };
 
 const int MappingConfig::stickBehaviorMapSize = sizeof(MappingConfig::stickBehaviorMap) / sizeof(MappingConfig::stickBehaviorMap[0]);
 
+uint32_t MappingConfig::fileChangeCount = 0;
+
 const MappingConfig::TriggerBehaviorMapping MappingConfig::triggerBehaviorMap[] = {
     {TriggerBehavior::DISABLED, "Disabled"},
     {TriggerBehavior::MOUSE_X, "Mouse X"},
@@ -27,43 +44,54 @@ const int MappingConfig::triggerBehaviorMapSize = sizeof(MappingConfig::triggerB
 
 void MappingConfig::initSD()
 {
-    if (!SD.begin(CHIPSELECT_PIN))
+    if (!storage->begin())
     {
-        Serial.println("MappingConfig: SD Card initialization failed!");
+        LOG_ERROR("MappingConfig: SD Card initialization failed!");
         return;
     }
-    Serial.println("MappingConfig: SD Card initialized successfully");
+    LOG_INFO("MappingConfig: SD Card initialized successfully");
 }
 
 bool MappingConfig::loadConfig(const char *filename, JoystickMappingConfig &config)
 {
-    File file = SD.open(filename, FILE_READ);
+    StorageFile file = storage->open(filename);
     if (!file)
     {
-        Serial.print("MappingConfig: Failed to open file: ");
-        Serial.println(filename);
+        LOG_ERROR("MappingConfig: Failed to open file: %s", filename);
         return false;
     }
 
-    Serial.print("MappingConfig: Reading mappings from: ");
-    Serial.println(filename);
+    LOG_INFO("MappingConfig: Reading mappings from: %s", filename);
 
     JsonDocument doc;
 
     DeserializationError error = deserializeJson(doc, file);
     file.close();
 
+    return loadDocument(doc, error, filename, config);
+}
+
+bool MappingConfig::loadConfig(const char *json, size_t length, const char *filename, JoystickMappingConfig &config)
+{
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, json, length);
+    return loadDocument(doc, error, filename, config);
+}
+
+bool MappingConfig::loadDocument(JsonDocument &doc, DeserializationError error, const char *filename, JoystickMappingConfig &config)
+{
     if (error)
     {
-        Serial.print("MappingConfig: JSON parsing failed: ");
-        Serial.println(error.c_str());
+        LOG_ERROR("MappingConfig: JSON parsing failed: %s", error.c_str());
         return false;
     }
 
     config.setFilename(filename);
-    loadMappings(doc, config.mappings, config.numMappings, config.MAX_MAPPINGS);
+    loadMappings(doc, config);
     loadStickConfig(doc, &config.leftStick, &config.rightStick);
     loadTriggerConfig(doc, &config.triggers);
+    loadLayers(doc, config);
+    prepareMatching(config);
 
     // Mark config as unmodified since we just loaded it
     config.modified = false;
@@ -83,20 +111,18 @@ bool MappingConfig::saveConfig(const char *filename, JoystickMappingConfig &conf
 
     JsonDocument doc;
 
-    saveMappings(doc, config.mappings, config.numMappings);
+    saveMappings(doc, config);
     saveStickConfig(doc, &config.leftStick, &config.rightStick);
     saveTriggerConfig(doc, &config.triggers);
+    saveLayers(doc, config);
 
-    if (SD.exists(targetFile))
-    {
-        SD.remove(targetFile);
-    }
+    // The directory changes from here on, even if the write fails
+    fileChangeCount++;
 
-    File file = SD.open(targetFile, FILE_WRITE);
+    StorageFile file = storage->open(targetFile, StorageMode::WRITE);
     if (!file)
     {
-        Serial.print("MappingConfig: Failed to create file: ");
-        Serial.println(targetFile);
+        LOG_ERROR("MappingConfig: Failed to create file: %s", targetFile);
         return false;
     }
 
@@ -109,43 +135,112 @@ bool MappingConfig::saveConfig(const char *filename, JoystickMappingConfig &conf
     return true;
 }
 
-void MappingConfig::loadMappings(JsonDocument &doc, ButtonMapping *mappings, int &numMappings, int maxMappings)
+void MappingConfig::loadMappings(JsonDocument &doc, JoystickMappingConfig &config)
 {
+    ButtonMapping *mappings = config.mappings;
+    int &numMappings = config.numMappings;
+
     JsonArray mappingsArray = doc["mappings"].as<JsonArray>();
     numMappings = 0;
+    config.macroCodeSize = 0;
 
     for (JsonObject mapping : mappingsArray)
     {
-        if (numMappings >= maxMappings)
+        if (numMappings >= JoystickMappingConfig::MAX_MAPPINGS)
         {
-            Serial.println("MappingConfig: Warning: Too many mappings, truncating");
+            LOG_WARN("MappingConfig: Warning: Too many mappings, truncating");
             break;
         }
 
         const char *buttonStr = mapping["button"];
-        const char *keyStr = mapping["key"];
+        const char *keyStr = mapping["key"] | "";
+
+        uint32_t chordButtons = 0;
+        int genericButton = JoystickMapping::parseChordName(buttonStr, chordButtons);
+        int layer = mapping["layer"] | 0;
+        int keyCode;
+        uint16_t macro = ButtonMapping::NO_MACRO;
+
+        if (genericButton == -1)
+        {
+            continue;
+        }
+
+        // Checked before the macro is compiled, so a skipped mapping takes no macro space
+        if (layer < 0 || layer >= JoystickMappingConfig::MAX_LAYERS)
+        {
+            LOG_WARN("MappingConfig: Warning: Invalid layer for: %s", buttonStr);
+            continue;
+        }
+
+        if (mapping["macro"].is<JsonArray>())
+        {
+            // Macros are compiled once here, the mapping then runs them by offset
+            int size = Macro::compile(mapping["macro"].as<JsonArray>(), &config.macroCode[config.macroCodeSize],
+                                      JoystickMappingConfig::MAX_MACRO_BYTES - config.macroCodeSize);
+            if (size < 0)
+            {
+                LOG_WARN("MappingConfig: Warning: Invalid or oversized macro for: %s", buttonStr);
+                continue;
+            }
+            macro = config.macroCodeSize;
+            config.macroCodeSize += size;
+            keyCode = 0;
+            keyStr = "Macro";
+        }
+        else
+        {
+            keyCode = KeyboardMapping::parseKeyCode(keyStr);
+        }
+
+        int turboRate = 0;
+        int turboDuty = 50;
+        if (mapping["turbo"].is<JsonObject>())
+        {
+            turboRate = mapping["turbo"]["rate"] | 0;
+            turboDuty = mapping["turbo"]["duty"] | 50;
+
+            if (turboRate < 0 || turboRate > ButtonMapping::MAX_TURBO_RATE)
+            {
+                LOG_WARN("MappingConfig: Warning: Invalid turbo rate for: %s", buttonStr);
+                turboRate = 0;
+            }
+            turboDuty = constrain(turboDuty, ButtonMapping::MIN_TURBO_DUTY, ButtonMapping::MAX_TURBO_DUTY);
+        }
 
-        int genericButton = JoystickMapping::parseGenericButtonName(buttonStr);
-        int keyCode = KeyboardMapping::parseKeyCode(keyStr);
+        int holdKeyCode = 0;
+        int holdTime = ButtonMapping::DEFAULT_HOLD_TIME;
+        if (mapping["hold"].is<JsonObject>())
+        {
+            holdKeyCode = KeyboardMapping::parseKeyCode(mapping["hold"]["key"] | "");
+            holdTime = constrain(mapping["hold"]["ms"] | (int)ButtonMapping::DEFAULT_HOLD_TIME, 10, 2000);
+
+            if (holdKeyCode == -1 || macro != ButtonMapping::NO_MACRO)
+            {
+                LOG_WARN("MappingConfig: Warning: Invalid hold key for: %s", buttonStr);
+                holdKeyCode = 0;
+            }
+        }
 
-        if (genericButton != -1 && keyCode != -1)
+        if (keyCode != -1)
         {
             mappings[numMappings].genericButton = genericButton;
             mappings[numMappings].keyCode = keyCode;
-            mappings[numMappings].currentlyPressed = false;
+            mappings[numMappings].chordButtons = chordButtons;
+            mappings[numMappings].layer = layer;
+            mappings[numMappings].macro = macro;
+            mappings[numMappings].turboRate = turboRate;
+            mappings[numMappings].turboDuty = turboDuty;
+            mappings[numMappings].holdKeyCode = holdKeyCode;
+            mappings[numMappings].holdTime = holdTime;
 
-            Serial.print("MappingConfig: Loaded: ");
-            Serial.print(buttonStr);
-            Serial.print(" -> ");
-            Serial.println(keyStr);
+            LOG_DEBUG("MappingConfig: Loaded: %s -> %s", buttonStr, keyStr);
 
             numMappings++;
         }
     }
 
-    Serial.print("MappingConfig: Loaded ");
-    Serial.print(numMappings);
-    Serial.println(" mappings");
+    LOG_INFO("MappingConfig: Loaded %d mappings", numMappings);
 }
 
 void MappingConfig::loadStickConfig(JsonDocument &doc, StickConfig *leftStick, StickConfig *rightStick)
@@ -157,8 +252,7 @@ void MappingConfig::loadStickConfig(JsonDocument &doc, StickConfig *leftStick, S
         JsonObject left = doc["leftStick"];
         parseStickConfig(leftStick, left);
 
-        Serial.print("MappingConfig: Left stick: ");
-        Serial.println(stickBehaviorToString(leftStick->behavior));
+        LOG_INFO("MappingConfig: Left stick: %s", stickBehaviorToString(leftStick->behavior));
     }
 
     // Load right stick config
@@ -167,11 +261,10 @@ void MappingConfig::loadStickConfig(JsonDocument &doc, StickConfig *leftStick, S
         JsonObject right = doc["rightStick"];
         parseStickConfig(rightStick, right);
 
-        Serial.print("MappingConfig: Right stick: ");
-        Serial.println(stickBehaviorToString(rightStick->behavior));
+        LOG_INFO("MappingConfig: Right stick: %s", stickBehaviorToString(rightStick->behavior));
     }
 
-    Serial.println("MappingConfig: Stick configuration loaded");
+    LOG_DEBUG("MappingConfig: Stick configuration loaded");
 }
 
 void MappingConfig::loadTriggerConfig(JsonDocument &doc, TriggerConfig *trigger)
@@ -181,8 +274,8 @@ void MappingConfig::loadTriggerConfig(JsonDocument &doc, TriggerConfig *trigger)
         JsonObject jsonObject = doc["triggers"];
         trigger->behavior = parseTriggerBehavior(jsonObject["behavior"]);
         trigger->sensitivity = jsonObject["sensitivity"] | 0.15f;
-        trigger->deadzone = jsonObject["deadzone"] | 16;
-        trigger->activationThreshold = jsonObject["activationThreshold"] | 64;
+        trigger->deadzone = constrain(jsonObject["deadzone"] | 16, 0, 255);
+        trigger->activationThreshold = constrain(jsonObject["activationThreshold"] | 64, 0, 255);
 
         if (jsonObject["keys"].is<JsonObject>())
         {
@@ -193,20 +286,47 @@ void MappingConfig::loadTriggerConfig(JsonDocument &doc, TriggerConfig *trigger)
     }
 }
 
-bool MappingConfig::saveMappings(JsonDocument &doc, ButtonMapping *mappings, int numMappings)
+bool MappingConfig::saveMappings(JsonDocument &doc, JoystickMappingConfig &config)
 {
+    ButtonMapping *mappings = config.mappings;
+    int numMappings = config.numMappings;
+
     JsonArray mappingsArray = doc["mappings"].to<JsonArray>();
 
     for (int i = 0; i < numMappings; i++)
     {
+        char buttonName[JoystickMapping::MAX_CHORD_NAME_LENGTH];
+        JoystickMapping::formatChordName(mappings[i].genericButton, mappings[i].chordButtons, buttonName, sizeof(buttonName));
+
         JsonObject mapping = mappingsArray.add<JsonObject>();
-        mapping["button"] = JoystickMapping::getGenericButtonName(mappings[i].genericButton);
-        mapping["key"] = KeyboardMapping::keyCodeToString(mappings[i].keyCode);
+        mapping["button"] = buttonName;
+        if (mappings[i].macro != ButtonMapping::NO_MACRO)
+        {
+            Macro::decompile(&config.macroCode[mappings[i].macro], mapping["macro"].to<JsonArray>());
+        }
+        else
+        {
+            mapping["key"] = KeyboardMapping::keyCodeToString(mappings[i].keyCode);
+        }
+        if (mappings[i].layer != 0)
+        {
+            mapping["layer"] = mappings[i].layer;
+        }
+        if (mappings[i].holdKeyCode != 0)
+        {
+            JsonObject hold = mapping["hold"].to<JsonObject>();
+            hold["key"] = KeyboardMapping::keyCodeToString(mappings[i].holdKeyCode);
+            hold["ms"] = mappings[i].holdTime;
+        }
+        if (mappings[i].turboRate != 0)
+        {
+            JsonObject turbo = mapping["turbo"].to<JsonObject>();
+            turbo["rate"] = mappings[i].turboRate;
+            turbo["duty"] = mappings[i].turboDuty;
+        }
     }
 
-    Serial.print("MappingConfig: Saved ");
-    Serial.print(numMappings);
-    Serial.println(" mappings");
+    LOG_INFO("MappingConfig: Saved %d mappings", numMappings);
 
     return true;
 }
@@ -244,13 +364,13 @@ bool MappingConfig::saveStickConfig(JsonDocument &doc, StickConfig *leftStick, S
         rightKeys["right"] = KeyboardMapping::keyCodeToString(rightStick->keyRight);
     }
 
-    Serial.println("MappingConfig: Stick configuration saved");
+    LOG_DEBUG("MappingConfig: Stick configuration saved");
     return true;
 }
 
 bool MappingConfig::saveTriggerConfig(JsonDocument &doc, TriggerConfig *trigger)
 {
-    Serial.println("MappingConfig: Trigger configuration saving");
+    LOG_DEBUG("MappingConfig: Trigger configuration saving");
     
     JsonObject left = doc["triggers"].to<JsonObject>();
     left["behavior"] = triggerBehaviorToString(trigger->behavior);
@@ -265,16 +385,16 @@ bool MappingConfig::saveTriggerConfig(JsonDocument &doc, TriggerConfig *trigger)
         leftKeys["right"] = KeyboardMapping::keyCodeToString(trigger->keyRight);
     }
 
-    Serial.println("MappingConfig: Trigger configuration saved");
+    LOG_DEBUG("MappingConfig: Trigger configuration saved");
     return true;
 }
 
-void MappingConfig::parseStickConfig(StickConfig *stickConfig, ArduinoJson::V742PB22::JsonObject &jsonObject)
+void MappingConfig::parseStickConfig(StickConfig *stickConfig, JsonObject &jsonObject)
 {
     stickConfig->behavior = parseStickBehavior(jsonObject["behavior"]);
     stickConfig->sensitivity = jsonObject["sensitivity"] | 0.15f;
-    stickConfig->deadzone = jsonObject["deadzone"] | 16;
-    stickConfig->activationThreshold = jsonObject["activationThreshold"] | 64;
+    stickConfig->deadzone = constrain(jsonObject["deadzone"] | 16, 0, 255);
+    stickConfig->activationThreshold = constrain(jsonObject["activationThreshold"] | 64, 0, 255);
 
     if (jsonObject["keys"].is<JsonObject>())
     {
@@ -296,8 +416,7 @@ StickBehavior MappingConfig::parseStickBehavior(const char *behaviorStr)
         }
     }
 
-    Serial.print("MappingConfig: Warning: Unknown stick behavior: ");
-    Serial.println(behaviorStr);
+    LOG_WARN("MappingConfig: Warning: Unknown stick behavior: %s", behaviorStr);
     return StickBehavior::DISABLED;
 }
 
@@ -324,8 +443,7 @@ TriggerBehavior MappingConfig::parseTriggerBehavior(const char *behaviorStr)
         }
     }
 
-    Serial.print("MappingConfig: Warning: Unknown trigger behavior: ");
-    Serial.println(behaviorStr);
+    LOG_WARN("MappingConfig: Warning: Unknown trigger behavior: %s", behaviorStr);
     return TriggerBehavior::DISABLED;
 }
 
@@ -340,4 +458,101 @@ const char *MappingConfig::triggerBehaviorToString(TriggerBehavior behavior)
     }
 
     return "Disabled";
-}
\ No newline at end of file
+}
+
+void MappingConfig::loadLayers(JsonDocument &doc, JoystickMappingConfig &config)
+{
+    config.numLayers = 1;
+
+    // "layers": ["L2", "R2"] -> holding L2 selects layer 1, R2 selects layer 2
+    JsonArray layersArray = doc["layers"].as<JsonArray>();
+    for (JsonVariant layer : layersArray)
+    {
+        if (config.numLayers >= JoystickMappingConfig::MAX_LAYERS)
+        {
+            LOG_WARN("MappingConfig: Warning: Too many layers, truncating");
+            break;
+        }
+
+        int genericButton = JoystickMapping::parseGenericButtonName(layer.as<const char *>());
+        if (genericButton != -1)
+        {
+            config.layerButtons[config.numLayers++] = genericButton;
+        }
+    }
+
+    if (config.numLayers > 1)
+    {
+        LOG_INFO("MappingConfig: Loaded %d layer buttons", config.numLayers - 1);
+    }
+}
+
+bool MappingConfig::saveLayers(JsonDocument &doc, JoystickMappingConfig &config)
+{
+    if (config.numLayers <= 1)
+    {
+        return true;
+    }
+
+    JsonArray layersArray = doc["layers"].to<JsonArray>();
+    for (int i = 1; i < config.numLayers; i++)
+    {
+        layersArray.add(JoystickMapping::getGenericButtonName(config.layerButtons[i]));
+    }
+
+    return true;
+}
+
+void MappingConfig::prepareMatching(JoystickMappingConfig &config)
+{
+    config.layerButtonMask = 0;
+    for (int i = 1; i < config.numLayers; i++)
+    {
+        config.layerButtonMask |= 1u << config.layerButtons[i];
+    }
+
+    // Order mappings by layer, larger chords first so they win over their subsets
+    auto sortKey = [](const ButtonMapping &mapping)
+    {
+        return mapping.layer * 64 + (32 - __builtin_popcount(mapping.chordButtons));
+    };
+
+    int count = 0;
+    for (int i = 0; i < config.numMappings; i++)
+    {
+        if (config.mappings[i].layer >= config.numLayers)
+        {
+            continue; // Layer has no button, mapping can never fire
+        }
+
+        int pos = count++;
+        while (pos > 0 && sortKey(config.mappings[config.matchOrder[pos - 1]]) > sortKey(config.mappings[i]))
+        {
+            config.matchOrder[pos] = config.matchOrder[pos - 1];
+            pos--;
+        }
+        config.matchOrder[pos] = i;
+    }
+
+    int pos = 0;
+    for (int layer = 0; layer < config.numLayers; layer++)
+    {
+        while (pos < count && config.mappings[config.matchOrder[pos]].layer < layer)
+        {
+            pos++;
+        }
+        config.layerStart[layer] = pos;
+    }
+    config.layerStart[config.numLayers] = count;
+
+    config.matchGroupStart = 0;
+    for (int k = 0; k < count; k++)
+    {
+        const ButtonMapping &mapping = config.mappings[config.matchOrder[k]];
+        config.matchButtons[k] = mapping.chordButtons | (1u << mapping.genericButton);
+        if (k == 0 || sortKey(mapping) != sortKey(config.mappings[config.matchOrder[k - 1]]))
+        {
+            config.matchGroupStart |= 1u << k;
+        }
+    }
+}
@@ -0,0 +1,879 @@
+#include "mapping/mapping_pipeline.h"
+#include "timing/timer_service.h"
+#include "logging/log.h"
+
+MappingPipeline::MappingPipeline()
+    : index(0),
+      snapshot(nullptr),
+      live(nullptr),
+      config(nullptr),
+      output(nullptr),
+      macros(nullptr),
+      timers(nullptr),
+      controllerType(JoystickController::UNKNOWN),
+      layout(nullptr),
+      connected(false),
+      genericButtons(0),
+      ignoredButtons(0),
+      chordButtons(0),
+      chordLastHeld(0),
+      chordStart(0),
+      chordTaken(false),
+      chordCount(0),
+      pressedMappings(0),
+      pendingTapHolds(0),
+      deferredPresses(0),
+      deferredTaps(0),
+      tapReleases(0),
+      turboKeysDown(0),
+      triggerKeysDown(0),
+      analogTimer(TimerWheel::INVALID_TIMER),
+      analogTickDue(false)
+{
+    for (int i = 0; i < JoystickMappingConfig::MAX_MAPPINGS; i++)
+    {
+        mappingTimers[i] = TimerWheel::INVALID_TIMER;
+    }
+    stickKeysDown[0] = stickKeysDown[1] = 0;
+}
+
+void MappingPipeline::bind(int padIndex, const ControllerSnapshot *padSnapshot, LiveConfig *liveConfig, HidOutput *out,
+                           MacroEngine *macroEngine, TimerWheel *timerWheel)
+{
+    index = padIndex;
+    snapshot = padSnapshot;
+    live = liveConfig;
+    config = live->getActive();
+    output = out;
+    macros = macroEngine;
+    timers = timerWheel;
+    layout = ControllerDatabase::findByType(JoystickController::UNKNOWN);
+}
+
+void MappingPipeline::updateLayout()
+{
+    controllerType = snapshot->type;
+    layout = snapshot->layout;
+
+    // Runs in the input frame; Serial could block there
+    LOG_INFO("MappingPipeline: Pad %d controller type %d, layout %s", index + 1, (int)controllerType, layout->name);
+}
+
+bool MappingPipeline::process()
+{
+    // Frame boundary: the only place the config changes under the pipeline
+    const JoystickMappingConfig *next = live->take();
+    if (next != nullptr)
+    {
+        adopt(next);
+    }
+
+    if (snapshot == nullptr || !snapshot->connected)
+    {
+        if (connected)
+        {
+            // Let go of anything the pad was holding when it was unplugged
+            releaseHeld();
+            connected = false;
+        }
+        genericButtons = 0;
+        return false;
+    }
+
+    if (!connected || snapshot->layout != layout)
+    {
+        connected = true;
+        updateLayout();
+    }
+
+    // Buttons and hat D-pad were decoded when the snapshot was taken
+    genericButtons = snapshot->buttons & ~__atomic_load_n(&ignoredButtons, __ATOMIC_ACQUIRE);
+
+    // Before the ignore mask, so the chord still closes what it opened
+    filterChord(snapshot->buttons);
+
+    // Menu button belongs to the menu system, not the profile
+    if (isMenuPressed())
+    {
+        return true;
+    }
+
+    // Mouse and scroll output runs at a fixed rate off the timer wheel
+    if (analogTimer == TimerWheel::INVALID_TIMER && usesAnalogTick())
+    {
+        analogTimer = timers->schedule(ANALOG_UPDATE_INTERVAL, onAnalogTimer, this, 0);
+    }
+
+    // Process button mappings (D-pad included)
+    processButtonMappings();
+
+    // Process analog sticks
+    if (snapshot->hasAxis(GenericController::AXIS_LEFT_X) && snapshot->hasAxis(GenericController::AXIS_LEFT_Y))
+    {
+        processAnalogStick(config->leftStick, GenericController::AXIS_LEFT_X, GenericController::AXIS_LEFT_Y);
+    }
+
+    if (snapshot->hasAxis(GenericController::AXIS_RIGHT_X) && snapshot->hasAxis(GenericController::AXIS_RIGHT_Y))
+    {
+        processAnalogStick(config->rightStick, GenericController::AXIS_RIGHT_X, GenericController::AXIS_RIGHT_Y);
+    }
+
+    if (snapshot->hasAxis(GenericController::AXIS_LEFT_TRIGGER) && snapshot->hasAxis(GenericController::AXIS_RIGHT_TRIGGER))
+    {
+        processTriggers(GenericController::AXIS_LEFT_TRIGGER, GenericController::AXIS_RIGHT_TRIGGER);
+    }
+
+    analogTickDue = false;
+    return true;
+}
+
+void MappingPipeline::filterChord(uint32_t buttons)
+{
+    uint32_t chord = __atomic_load_n(&chordButtons, __ATOMIC_ACQUIRE);
+    uint32_t held = buttons & chord;
+    uint32_t pressed = held & ~chordLastHeld;
+    chordLastHeld = held;
+    if (chord == 0)
+    {
+        return;
+    }
+
+    if (pressed != 0 && !chordTaken)
+    {
+        // All down together, or the last one inside the window of the press before
+        unsigned long now = timers->getTime();
+        if (held == chord && (pressed == chord || now - chordStart < CHORD_WINDOW))
+        {
+            chordTaken = true;
+            __atomic_store_n(&chordCount, (uint8_t)(chordCount + 1), __ATOMIC_RELEASE);
+        }
+        chordStart = now;
+    }
+
+    // Taken: none of it maps, letting go of what it pressed, until all released
+    if (chordTaken)
+    {
+        chordTaken = held != 0;
+        genericButtons &= ~chord;
+    }
+}
+
+bool MappingPipeline::usesAnalogTick() const
+{
+    return config->leftStick.behavior == StickBehavior::MOUSE_MOVEMENT ||
+           config->leftStick.behavior == StickBehavior::SCROLL_WHEEL ||
+           config->rightStick.behavior == StickBehavior::MOUSE_MOVEMENT ||
+           config->rightStick.behavior == StickBehavior::SCROLL_WHEEL ||
+           config->triggers.behavior == TriggerBehavior::MOUSE_X ||
+           config->triggers.behavior == TriggerBehavior::MOUSE_Y ||
+           config->triggers.behavior == TriggerBehavior::SCROLL_WHEEL;
+}
+
+void MappingPipeline::onAnalogTimer(void *context, uint32_t data)
+{
+    MappingPipeline *pipeline = static_cast<MappingPipeline *>(context);
+    pipeline->analogTickDue = true;
+    pipeline->analogTimer = pipeline->timers->schedule(ANALOG_UPDATE_INTERVAL, onAnalogTimer, pipeline, 0);
+}
+
+void MappingPipeline::reset()
+{
+    releaseHeld();
+    genericButtons = 0;
+}
+
+void MappingPipeline::releaseHeld()
+{
+    timers->cancel(analogTimer);
+    analogTimer = TimerWheel::INVALID_TIMER;
+    analogTickDue = false;
+
+    // Undecided and deferred buttons have not sent anything yet
+    for (uint32_t bits = pendingTapHolds; bits != 0; bits &= bits - 1)
+    {
+        int i = __builtin_ctz(bits);
+        timers->cancel(mappingTimers[i]);
+        mappingTimers[i] = TimerWheel::INVALID_TIMER;
+    }
+
+    for (uint32_t bits = pressedMappings & ~(pendingTapHolds | deferredPresses); bits != 0; bits &= bits - 1)
+    {
+        releaseMapping(__builtin_ctz(bits));
+    }
+
+    for (uint32_t bits = tapReleases; bits != 0; bits &= bits - 1)
+    {
+        output->releaseKey(config->mappings[__builtin_ctz(bits)].keyCode);
+    }
+
+    pressedMappings = 0;
+    pendingTapHolds = 0;
+    deferredPresses = 0;
+    deferredTaps = 0;
+    tapReleases = 0;
+
+    const StickConfig *sticks[] = {&config->leftStick, &config->rightStick};
+    for (int s = 0; s < 2; s++)
+    {
+        updateKey(stickKeysDown[s], STICK_UP, false, sticks[s]->keyUp);
+        updateKey(stickKeysDown[s], STICK_DOWN, false, sticks[s]->keyDown);
+        updateKey(stickKeysDown[s], STICK_LEFT, false, sticks[s]->keyLeft);
+        updateKey(stickKeysDown[s], STICK_RIGHT, false, sticks[s]->keyRight);
+    }
+
+    updateKey(triggerKeysDown, TRIGGER_LEFT, false, config->triggers.keyLeft);
+    updateKey(triggerKeysDown, TRIGGER_RIGHT, false, config->triggers.keyRight);
+}
+
+void MappingPipeline::adopt(const JoystickMappingConfig *next)
+{
+    const JoystickMappingConfig *previous = config;
+
+    // Taps sent last frame go up with the key they went down with
+    for (uint32_t bits = tapReleases; bits != 0; bits &= bits - 1)
+    {
+        output->releaseKey(previous->mappings[__builtin_ctz(bits)].keyCode);
+    }
+    tapReleases = 0;
+
+    // A mapping that is the same in both keeps its state: its key stays down
+    // and its turbo or tap-hold timer keeps running. The rest are let go as
+    // the old config had them and match again as fresh presses.
+    uint32_t kept = 0;
+    int common = min(previous->numMappings, next->numMappings);
+    for (int i = 0; i < common; i++)
+    {
+        if (memcmp(&previous->mappings[i], &next->mappings[i], sizeof(ButtonMapping)) == 0)
+        {
+            kept |= 1u << i;
+        }
+    }
+
+    for (uint32_t bits = pendingTapHolds & ~kept; bits != 0; bits &= bits - 1)
+    {
+        int i = __builtin_ctz(bits);
+        timers->cancel(mappingTimers[i]);
+        mappingTimers[i] = TimerWheel::INVALID_TIMER;
+    }
+    for (uint32_t bits = pressedMappings & ~(kept | pendingTapHolds | deferredPresses); bits != 0; bits &= bits - 1)
+    {
+        releaseMapping(__builtin_ctz(bits));
+    }
+    pressedMappings &= kept;
+    pendingTapHolds &= kept;
+    deferredPresses &= kept;
+    deferredTaps &= kept;
+
+    // Stick and trigger keys stay down only if the new config sends the same key
+    const StickConfig *oldSticks[] = {&previous->leftStick, &previous->rightStick};
+    const StickConfig *newSticks[] = {&next->leftStick, &next->rightStick};
+    for (int s = 0; s < 2; s++)
+    {
+        const StickConfig &was = *oldSticks[s];
+        const StickConfig &now = *newSticks[s];
+        bool keys = now.behavior == StickBehavior::BUTTON_EMULATION || now.behavior == StickBehavior::WASD_KEYS ||
+                    now.behavior == StickBehavior::ARROW_KEYS;
+        uint8_t keep = 0;
+        if (keys)
+        {
+            keep |= (was.keyUp == now.keyUp) ? STICK_UP : 0;
+            keep |= (was.keyDown == now.keyDown) ? STICK_DOWN : 0;
+            keep |= (was.keyLeft == now.keyLeft) ? STICK_LEFT : 0;
+            keep |= (was.keyRight == now.keyRight) ? STICK_RIGHT : 0;
+        }
+        keep &= stickKeysDown[s];
+        updateKey(stickKeysDown[s], STICK_UP, keep & STICK_UP, was.keyUp);
+        updateKey(stickKeysDown[s], STICK_DOWN, keep & STICK_DOWN, was.keyDown);
+        updateKey(stickKeysDown[s], STICK_LEFT, keep & STICK_LEFT, was.keyLeft);
+        updateKey(stickKeysDown[s], STICK_RIGHT, keep & STICK_RIGHT, was.keyRight);
+    }
+
+    uint8_t keepTriggers = 0;
+    if (next->triggers.behavior == TriggerBehavior::BUTTONS)
+    {
+        keepTriggers |= (previous->triggers.keyLeft == next->triggers.keyLeft) ? TRIGGER_LEFT : 0;
+        keepTriggers |= (previous->triggers.keyRight == next->triggers.keyRight) ? TRIGGER_RIGHT : 0;
+    }
+    keepTriggers &= triggerKeysDown;
+    updateKey(triggerKeysDown, TRIGGER_LEFT, keepTriggers & TRIGGER_LEFT, previous->triggers.keyLeft);
+    updateKey(triggerKeysDown, TRIGGER_RIGHT, keepTriggers & TRIGGER_RIGHT, previous->triggers.keyRight);
+
+    // Macros read their code from the config buffer, which is about to be reused
+    bool sameMacros = previous->macroCodeSize == next->macroCodeSize &&
+                      memcmp(previous->macroCode, next->macroCode, previous->macroCodeSize) == 0;
+    macros->relocate(previous->macroCode, sameMacros ? next->macroCode : nullptr, sizeof(previous->macroCode));
+
+    config = next;
+
+    if (analogTimer != TimerWheel::INVALID_TIMER && !usesAnalogTick())
+    {
+        timers->cancel(analogTimer);
+        analogTimer = TimerWheel::INVALID_TIMER;
+    }
+
+    // Presses held back for a tap-hold that was just dropped
+    flushDeferred();
+}
+
+uint32_t MappingPipeline::matchMappings() const
+{
+    // Highest held layer button selects the layer
+    int layer = 0;
+    for (int l = config->numLayers - 1; l >= 1; l--)
+    {
+        if (genericButtons & (1u << config->layerButtons[l]))
+        {
+            layer = l;
+            break;
+        }
+    }
+
+    // Layer buttons only select layers, they never complete a chord
+    uint32_t available = genericButtons & ~config->layerButtonMask;
+    if (available == 0)
+    {
+        return 0;
+    }
+
+    uint32_t consumed = 0;        // Buttons used by larger chords that matched
+    uint32_t consumedPending = 0; // Buttons used by chords of the current size
+    uint32_t matched = 0;
+
+    for (int k = config->layerStart[layer]; k < config->layerStart[layer + 1]; k++)
+    {
+        // Chords of equal size do not block each other (e.g. A bound twice)
+        if (config->matchGroupStart & (1u << k))
+        {
+            consumed |= consumedPending;
+        }
+
+        uint32_t want = config->matchButtons[k];
+        if ((available & want) == want && (consumed & want) == 0)
+        {
+            matched |= 1u << config->matchOrder[k];
+            consumedPending |= want;
+        }
+    }
+
+    return matched;
+}
+
+void MappingPipeline::processButtonMappings()
+{
+    // Taps sent last frame are released now, so the host sees them as separate reports
+    if (tapReleases != 0)
+    {
+        for (uint32_t bits = tapReleases; bits != 0; bits &= bits - 1)
+        {
+            output->releaseKey(config->mappings[__builtin_ctz(bits)].keyCode);
+        }
+        tapReleases = 0;
+    }
+
+    uint32_t matched = matchMappings();
+    uint32_t changed = matched ^ pressedMappings;
+    pressedMappings = matched;
+
+    // Only mappings whose state changed are visited
+    for (uint32_t bits = changed; bits != 0; bits &= bits - 1)
+    {
+        int i = __builtin_ctz(bits);
+        uint32_t bit = 1u << i;
+        bool isPressed = (matched & bit) != 0;
+
+        if (isPressed)
+        {
+            if (pendingTapHolds != 0 || deferredPresses != 0 || deferredTaps != 0)
+            {
+                // Wait for the tap/hold decision so keys reach the host in order
+                deferredPresses |= bit;
+            }
+            else
+            {
+                pressMapping(i);
+            }
+        }
+        else if (pendingTapHolds & bit)
+        {
+            // Released before the hold time: it was a tap
+            timers->cancel(mappingTimers[i]);
+            mappingTimers[i] = TimerWheel::INVALID_TIMER;
+            pendingTapHolds &= ~bit;
+            tapMapping(i);
+            flushDeferred();
+        }
+        else if (deferredPresses & bit)
+        {
+            // Another button tapped inside the hold time: the pending buttons are modifiers
+            deferredPresses &= ~bit;
+            deferredTaps |= bit;
+            for (uint32_t pending = pendingTapHolds; pending != 0; pending &= pending - 1)
+            {
+                int tapHold = __builtin_ctz(pending);
+                timers->cancel(mappingTimers[tapHold]);
+                resolveHold(tapHold);
+            }
+            flushDeferred();
+        }
+        else
+        {
+            LOG_DEBUG("MappingPipeline: Button %s released", JoystickMapping::getGenericButtonName(config->mappings[i].genericButton));
+
+            releaseMapping(i);
+        }
+    }
+}
+
+void MappingPipeline::pressMapping(int mappingIndex)
+{
+    const ButtonMapping &mapping = config->mappings[mappingIndex];
+    if (mapping.macro != ButtonMapping::NO_MACRO)
+    {
+        // Macros start on press and run to completion
+        LOG_DEBUG("MappingPipeline: Button %s pressed -> Macro", JoystickMapping::getGenericButtonName(mapping.genericButton));
+
+        macros->start(&config->macroCode[mapping.macro], output, TimerService::now());
+    }
+    else if (mapping.holdKeyCode != 0)
+    {
+        LOG_DEBUG("MappingPipeline: Button %s pressed -> Tap/Hold", JoystickMapping::getGenericButtonName(mapping.genericButton));
+
+        // Decided by whichever comes first: release, another tap, or the timer
+        pendingTapHolds |= 1u << mappingIndex;
+        mappingTimers[mappingIndex] = timers->schedule(mapping.holdTime, onTapHoldTimer, this, mappingIndex);
+    }
+    else
+    {
+        LOG_DEBUG("MappingPipeline: Button %s pressed -> Key %d", JoystickMapping::getGenericButtonName(mapping.genericButton),
+                  mapping.keyCode);
+
+        if (mapping.turboRate != 0)
+        {
+            startTurbo(mappingIndex);
+        }
+        else
+        {
+            output->pressKey(mapping.keyCode);
+        }
+    }
+}
+
+void MappingPipeline::releaseMapping(int mappingIndex)
+{
+    const ButtonMapping &mapping = config->mappings[mappingIndex];
+
+    if (mapping.macro != ButtonMapping::NO_MACRO)
+    {
+        return;
+    }
+
+    if (mapping.holdKeyCode != 0)
+    {
+        output->releaseKey(mapping.holdKeyCode);
+    }
+    else if (mapping.turboRate != 0)
+    {
+        stopTurbo(mappingIndex);
+    }
+    else
+    {
+        output->releaseKey(mapping.keyCode);
+    }
+}
+
+void MappingPipeline::tapMapping(int mappingIndex)
+{
+    const ButtonMapping &mapping = config->mappings[mappingIndex];
+
+    LOG_DEBUG("MappingPipeline: Button %s tapped", JoystickMapping::getGenericButtonName(mapping.genericButton));
+
+    if (mapping.macro != ButtonMapping::NO_MACRO)
+    {
+        macros->start(&config->macroCode[mapping.macro], output, TimerService::now());
+        return;
+    }
+
+    // Press now, release next frame
+    output->pressKey(mapping.keyCode);
+    tapReleases |= 1u << mappingIndex;
+}
+
+void MappingPipeline::resolveHold(int mappingIndex)
+{
+    const ButtonMapping &mapping = config->mappings[mappingIndex];
+
+    LOG_DEBUG("MappingPipeline: Button %s held -> Key %d", JoystickMapping::getGenericButtonName(mapping.genericButton),
+              mapping.holdKeyCode);
+
+    pendingTapHolds &= ~(1u << mappingIndex);
+    mappingTimers[mappingIndex] = TimerWheel::INVALID_TIMER;
+    output->pressKey(mapping.holdKeyCode);
+}
+
+void MappingPipeline::flushDeferred()
+{
+    // Send what was held back while a decision was pending, until another decision starts
+    while (pendingTapHolds == 0 && (deferredTaps | deferredPresses) != 0)
+    {
+        if (deferredTaps != 0)
+        {
+            int i = __builtin_ctz(deferredTaps);
+            deferredTaps &= ~(1u << i);
+            tapMapping(i);
+        }
+        else
+        {
+            int i = __builtin_ctz(deferredPresses);
+            deferredPresses &= ~(1u << i);
+            pressMapping(i);
+        }
+    }
+}
+
+void MappingPipeline::onTapHoldTimer(void *context, uint32_t mappingIndex)
+{
+    MappingPipeline *pipeline = static_cast<MappingPipeline *>(context);
+    pipeline->resolveHold(mappingIndex);
+    pipeline->flushDeferred();
+}
+
+void MappingPipeline::startTurbo(int mappingIndex)
+{
+    const ButtonMapping &mapping = config->mappings[mappingIndex];
+
+    // First pulse goes out immediately, the timer wheel drives the rest
+    output->pressKey(mapping.keyCode);
+    turboKeysDown |= 1u << mappingIndex;
+
+    unsigned long period = 1000 / mapping.turboRate;
+    mappingTimers[mappingIndex] = timers->schedule(period * mapping.turboDuty / 100, onTurboTimer, this, mappingIndex);
+}
+
+void MappingPipeline::stopTurbo(int mappingIndex)
+{
+    timers->cancel(mappingTimers[mappingIndex]);
+    mappingTimers[mappingIndex] = TimerWheel::INVALID_TIMER;
+
+    uint32_t bit = 1u << mappingIndex;
+    if (turboKeysDown & bit)
+    {
+        output->releaseKey(config->mappings[mappingIndex].keyCode);
+        turboKeysDown &= ~bit;
+    }
+}
+
+void MappingPipeline::onTurboTimer(void *context, uint32_t mappingIndex)
+{
+    MappingPipeline *pipeline = static_cast<MappingPipeline *>(context);
+    const ButtonMapping &mapping = pipeline->config->mappings[mappingIndex];
+    uint32_t bit = 1u << mappingIndex;
+
+    unsigned long period = 1000 / mapping.turboRate;
+    unsigned long onTime = period * mapping.turboDuty / 100;
+    unsigned long delay;
+
+    if (pipeline->turboKeysDown & bit)
+    {
+        pipeline->output->releaseKey(mapping.keyCode);
+        delay = period - onTime;
+    }
+    else
+    {
+        pipeline->output->pressKey(mapping.keyCode);
+        delay = onTime;
+    }
+
+    pipeline->turboKeysDown ^= bit;
+    pipeline->mappingTimers[mappingIndex] = pipeline->timers->schedule(delay, onTurboTimer, pipeline, mappingIndex);
+}
+
+void MappingPipeline::processAnalogStick(const StickConfig &stick, uint8_t xAxis, uint8_t yAxis)
+{
+    if (stick.behavior == StickBehavior::DISABLED)
+    {
+        return;
+    }
+
+    int xValue = snapshot->axes[xAxis];
+    int yValue = snapshot->axes[yAxis];
+
+    // Apply behavior
+    switch (stick.behavior)
+    {
+    case StickBehavior::MOUSE_MOVEMENT:
+        processMouseMovement(stick, xValue, yValue);
+        break;
+
+    case StickBehavior::BUTTON_EMULATION:
+    case StickBehavior::WASD_KEYS:  // Keys were filled in by LiveConfig::compile()
+    case StickBehavior::ARROW_KEYS:
+        processButtonEmulation(stick, xValue, yValue);
+        break;
+
+    case StickBehavior::SCROLL_WHEEL:
+        processScrollWheel(stick, yValue);
+        break;
+
+    case StickBehavior::JOYSTICK:
+    case StickBehavior::JOYSTICK_X:
+    case StickBehavior::JOYSTICK_Y:
+        processJoystick(stick, xValue, yValue, &stick == &config->rightStick);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void MappingPipeline::processMouseMovement(const StickConfig &stick, int xValue, int yValue)
+{
+    if (!analogTickDue)
+    {
+        return;
+    }
+
+    int adjustedX = applyDeadzone(xValue, 128, stick.deadzone);
+    int adjustedY = applyDeadzone(yValue, 128, stick.deadzone);
+
+    if (adjustedX != 0 || adjustedY != 0)
+    {
+        int mouseX = (int)(adjustedX * stick.sensitivity);
+        int mouseY = (int)(adjustedY * stick.sensitivity);
+
+        // Serial.print("Mouse ");
+        // Serial.print(xValue);
+        // Serial.print(", ");
+        // Serial.print(yValue);
+        // Serial.print(" - ");
+        // Serial.print(adjustedX);
+        // Serial.print(", ");
+        // Serial.print(adjustedY);
+        // Serial.print(" - ");
+        // Serial.print(mouseX);
+        // Serial.print(", ");
+        // Serial.println(mouseY);
+
+        output->moveMouse(mouseX, mouseY, 0);
+    }
+}
+
+void MappingPipeline::processJoystick(const StickConfig &stick, int xValue, int yValue, bool rightStick)
+{
+    // Left stick drives X/Y, right stick Z/Z rotate, like most HID gamepads
+    uint8_t xAxis = rightStick ? HidOutput::AXIS_Z : HidOutput::AXIS_X;
+    uint8_t yAxis = rightStick ? HidOutput::AXIS_Z_ROTATE : HidOutput::AXIS_Y;
+
+    if (stick.behavior != StickBehavior::JOYSTICK_Y)
+    {
+        output->moveJoystickAxis(xAxis, applyDeadzone(xValue, 128, stick.deadzone));
+    }
+    if (stick.behavior != StickBehavior::JOYSTICK_X)
+    {
+        output->moveJoystickAxis(yAxis, applyDeadzone(yValue, 128, stick.deadzone));
+    }
+}
+
+void MappingPipeline::processButtonEmulation(const StickConfig &stick, int xValue, int yValue)
+{
+    int adjustedX = applyDeadzone(xValue, 128, stick.deadzone);
+    int adjustedY = applyDeadzone(yValue, 128, stick.deadzone);
+
+    // Check each direction
+    bool shouldBeUpPressed = (adjustedY < -stick.activationThreshold);
+    bool shouldBeDownPressed = (adjustedY > stick.activationThreshold);
+    bool shouldBeLeftPressed = (adjustedX < -stick.activationThreshold);
+    bool shouldBeRightPressed = (adjustedX > stick.activationThreshold);
+
+    uint8_t &keysDown = stickKeysDown[&stick == &config->rightStick ? 1 : 0];
+    updateKey(keysDown, STICK_UP, shouldBeUpPressed, stick.keyUp);
+    updateKey(keysDown, STICK_DOWN, shouldBeDownPressed, stick.keyDown);
+    updateKey(keysDown, STICK_LEFT, shouldBeLeftPressed, stick.keyLeft);
+    updateKey(keysDown, STICK_RIGHT, shouldBeRightPressed, stick.keyRight);
+}
+
+void MappingPipeline::processScrollWheel(const StickConfig &stick, int yValue)
+{
+    if (!analogTickDue)
+    {
+        return;
+    }
+
+    int adjustedY = applyDeadzone(yValue, 128, stick.deadzone);
+
+    if (adjustedY != 0)
+    {
+        int scroll = (int)(adjustedY * stick.sensitivity * 0.1f);
+        if (scroll != 0)
+        {
+            output->moveMouse(0, 0, -scroll); // Negative for natural scrolling
+        }
+    }
+}
+
+void MappingPipeline::processTriggers(uint8_t leftAxis, uint8_t rightAxis)
+{
+    if (config->triggers.behavior == TriggerBehavior::DISABLED)
+    {
+        return;
+    }
+
+    int leftValue = snapshot->axes[leftAxis];
+    int rightValue = snapshot->axes[rightAxis];
+
+    // Apply behavior
+    switch (config->triggers.behavior)
+    {
+    case TriggerBehavior::BUTTONS:
+        processTriggerButtons(leftValue, rightValue);
+        break;
+
+    case TriggerBehavior::MOUSE_X:
+        processTriggerMouseX(leftValue, rightValue);
+        break;
+
+    case TriggerBehavior::MOUSE_Y:
+        processTriggerMouseY(leftValue, rightValue);
+        break;
+
+    case TriggerBehavior::SCROLL_WHEEL:
+        processTriggerScroll(leftValue, rightValue);
+        break;
+
+    case TriggerBehavior::JOYSTICK_X:
+    case TriggerBehavior::JOYSTICK_Y:
+        processTriggerJoystick(leftValue, rightValue);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void MappingPipeline::processTriggerJoystick(int leftValue, int rightValue)
+{
+    // Both triggers share one axis: left pulls below centre, right above
+    int left = applyDeadzone(leftValue, 0, config->triggers.deadzone);
+    int right = applyDeadzone(rightValue, 0, config->triggers.deadzone);
+    uint8_t axis = config->triggers.behavior == TriggerBehavior::JOYSTICK_X ? HidOutput::AXIS_X : HidOutput::AXIS_Y;
+
+    output->moveJoystickAxis(axis, (right - left) / 2);
+}
+
+void MappingPipeline::processTriggerButtons(int leftValue, int rightValue)
+{
+    // Triggers are 0-255, check against threshold
+    bool shouldBeLeftPressed = (leftValue > config->triggers.activationThreshold);
+    bool shouldBeRightPressed = (rightValue > config->triggers.activationThreshold);
+
+    if (updateKey(triggerKeysDown, TRIGGER_LEFT, shouldBeLeftPressed, config->triggers.keyLeft))
+    {
+        LOG_DEBUG("MappingPipeline: Left Trigger %s -> Key %d", shouldBeLeftPressed ? "pressed" : "released",
+                  config->triggers.keyLeft);
+    }
+
+    if (updateKey(triggerKeysDown, TRIGGER_RIGHT, shouldBeRightPressed, config->triggers.keyRight))
+    {
+        LOG_DEBUG("MappingPipeline: Right Trigger %s -> Key %d", shouldBeRightPressed ? "pressed" : "released",
+                  config->triggers.keyRight);
+    }
+}
+
+void MappingPipeline::processTriggerMouseX(int leftValue, int rightValue)
+{
+    if (!analogTickDue)
+    {
+        return;
+    }
+
+    // Apply deadzone - triggers are 0-255, treat 0 as rest position
+    int adjustedLeft = (leftValue > config->triggers.deadzone) ? leftValue : 0;
+    int adjustedRight = (rightValue > config->triggers.deadzone) ? rightValue : 0;
+
+    // Calculate net movement (right trigger moves right, left trigger moves left)
+    int netMovement = adjustedRight - adjustedLeft;
+
+    if (netMovement != 0)
+    {
+        int mouseX = (int)(netMovement * config->triggers.sensitivity);
+
+        output->moveMouse(mouseX, 0, 0);
+    }
+}
+
+void MappingPipeline::processTriggerMouseY(int leftValue, int rightValue)
+{
+    if (!analogTickDue)
+    {
+        return;
+    }
+
+    // Apply deadzone - triggers are 0-255, treat 0 as rest position
+    int adjustedLeft = (leftValue > config->triggers.deadzone) ? leftValue : 0;
+    int adjustedRight = (rightValue > config->triggers.deadzone) ? rightValue : 0;
+
+    // Calculate net movement (right trigger moves down, left trigger moves up)
+    int netMovement = adjustedRight - adjustedLeft;
+
+    if (netMovement != 0)
+    {
+        int mouseY = (int)(netMovement * config->triggers.sensitivity);
+
+        output->moveMouse(0, mouseY, 0);
+    }
+}
+
+void MappingPipeline::processTriggerScroll(int leftValue, int rightValue)
+{
+    if (!analogTickDue)
+    {
+        return;
+    }
+
+    // Apply deadzone - triggers are 0-255, treatd 0 as rest position
+    int adjustedLeft = (leftValue > config->triggers.deadzone) ? leftValue : 0;
+    int adjustedRight = (rightValue > config->triggers.deadzone) ? rightValue : 0;
+
+    // Calculate net movement (right trigger scrolls down, left trigger scrolls up)
+    int netMovement = adjustedRight - adjustedLeft;
+
+    if (netMovement != 0)
+    {
+        int scroll = (int)(netMovement * config->triggers.sensitivity * 0.1f);
+        if (scroll != 0)
+        {
+            output->moveMouse(0, 0, -scroll); // Negative for natural scrolling
+        }
+    }
+}
+
+int MappingPipeline::applyDeadzone(int value, int centerValue, int deadzone)
+{
+    int centered = value - centerValue;
+
+    if (abs(centered) < deadzone)
+    {
+        return 0;
+    }
+
+    return centered;
+}
+
+bool MappingPipeline::updateKey(uint8_t &keysDown, uint8_t bit, bool shouldBePressed, int keyCode)
+{
+    if (shouldBePressed == ((keysDown & bit) != 0))
+    {
+        return false;
+    }
+
+    if (shouldBePressed)
+    {
+        output->pressKey(keyCode);
+        keysDown |= bit;
+    }
+    else
+    {
+        output->releaseKey(keyCode);
+        keysDown &= ~bit;
+    }
+    return true;
+}
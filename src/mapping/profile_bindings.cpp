@@ -0,0 +1,225 @@
+#include "mapping/profile_bindings.h"
+#include "mapping/mapping_config.h"
+#include <ArduinoJson.h>
+#include "logging/log.h"
+
+ProfileBindings::Binding ProfileBindings::bindings[MAX_BINDINGS];
+int ProfileBindings::numBindings = 0;
+JoystickMappingConfig ProfileBindings::cache[MAX_CACHED_PROFILES];
+uint32_t ProfileBindings::cacheFileChangeCount = 0;
+char ProfileBindings::filename[JoystickMappingConfig::MAX_FILENAME_LENGTH] = "";
+
+void ProfileBindings::init(const char *bindingsFile)
+{
+    strncpy(filename, bindingsFile, sizeof(filename) - 1);
+    filename[sizeof(filename) - 1] = '\0';
+
+    numBindings = 0;
+    if (MappingConfig::getStorage().exists(filename))
+    {
+        load();
+    }
+    rebuildCache();
+
+    LOG_INFO("ProfileBindings: %d controller bindings", numBindings);
+}
+
+bool ProfileBindings::load()
+{
+    StorageFile file = MappingConfig::getStorage().open(filename);
+    if (!file)
+    {
+        LOG_WARN("ProfileBindings: Failed to open file: %s", filename);
+        return false;
+    }
+
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, file);
+    file.close();
+
+    if (error)
+    {
+        LOG_ERROR("ProfileBindings: JSON parsing failed: %s", error.c_str());
+        return false;
+    }
+
+    JsonArray array = doc["bindings"].as<JsonArray>();
+    for (JsonObject entry : array)
+    {
+        if (numBindings >= MAX_BINDINGS)
+        {
+            LOG_WARN("ProfileBindings: Too many bindings, rest ignored");
+            break;
+        }
+
+        const char *vid = entry["vid"] | "";
+        const char *pid = entry["pid"] | "";
+        const char *profile = entry["profile"] | "";
+        if (vid[0] == '\0' || pid[0] == '\0' || profile[0] == '\0')
+        {
+            continue;
+        }
+
+        Binding &binding = bindings[numBindings++];
+        binding.vendorId = (uint16_t)strtoul(vid, nullptr, 16);
+        binding.productId = (uint16_t)strtoul(pid, nullptr, 16);
+        strncpy(binding.profile, profile, sizeof(binding.profile) - 1);
+        binding.profile[sizeof(binding.profile) - 1] = '\0';
+        binding.cacheSlot = -1;
+    }
+
+    return true;
+}
+
+bool ProfileBindings::save()
+{
+    JsonDocument doc;
+    JsonArray array = doc["bindings"].to<JsonArray>();
+
+    for (int i = 0; i < numBindings; i++)
+    {
+        char vid[5];
+        char pid[5];
+        snprintf(vid, sizeof(vid), "%04X", bindings[i].vendorId);
+        snprintf(pid, sizeof(pid), "%04X", bindings[i].productId);
+
+        JsonObject entry = array.add<JsonObject>();
+        entry["vid"] = vid;
+        entry["pid"] = pid;
+        entry["profile"] = bindings[i].profile;
+    }
+
+    StorageFile file = MappingConfig::getStorage().open(filename, StorageMode::WRITE);
+    if (!file)
+    {
+        LOG_ERROR("ProfileBindings: Failed to create file: %s", filename);
+        return false;
+    }
+
+    serializeJsonPretty(doc, file);
+    file.close();
+    return true;
+}
+
+void ProfileBindings::rebuildCache()
+{
+    cacheFileChangeCount = MappingConfig::getFileChangeCount();
+
+    int numCached = 0;
+    for (int i = 0; i < numBindings; i++)
+    {
+        bindings[i].cacheSlot = -1;
+
+        // Several pads can share one profile
+        for (int j = 0; j < i; j++)
+        {
+            if (bindings[j].cacheSlot >= 0 && strcmp(bindings[j].profile, bindings[i].profile) == 0)
+            {
+                bindings[i].cacheSlot = bindings[j].cacheSlot;
+                break;
+            }
+        }
+
+        if (bindings[i].cacheSlot >= 0)
+        {
+            continue;
+        }
+
+        if (numCached >= MAX_CACHED_PROFILES)
+        {
+            LOG_WARN("ProfileBindings: Cache full, will read from SD: %s", bindings[i].profile);
+            continue;
+        }
+
+        if (MappingConfig::loadConfig(bindings[i].profile, cache[numCached]))
+        {
+            bindings[i].cacheSlot = (int8_t)numCached;
+            numCached++;
+        }
+    }
+}
+
+void ProfileBindings::refresh()
+{
+    if (cacheFileChangeCount != MappingConfig::getFileChangeCount())
+    {
+        rebuildCache();
+    }
+}
+
+bool ProfileBindings::bind(uint16_t vendorId, uint16_t productId, const char *profile)
+{
+    int index = indexOf(vendorId, productId);
+    if (index < 0)
+    {
+        if (numBindings >= MAX_BINDINGS)
+        {
+            LOG_WARN("ProfileBindings: Binding table full");
+            return false;
+        }
+        index = numBindings++;
+        bindings[index].vendorId = vendorId;
+        bindings[index].productId = productId;
+    }
+
+    Binding *binding = &bindings[index];
+
+    strncpy(binding->profile, profile, sizeof(binding->profile) - 1);
+    binding->profile[sizeof(binding->profile) - 1] = '\0';
+
+    rebuildCache();
+    return save();
+}
+
+bool ProfileBindings::unbind(int index)
+{
+    if (index < 0 || index >= numBindings)
+    {
+        return false;
+    }
+
+    for (int i = index; i < numBindings - 1; i++)
+    {
+        bindings[i] = bindings[i + 1];
+    }
+    numBindings--;
+
+    rebuildCache();
+    return save();
+}
+
+int ProfileBindings::indexOf(uint16_t vendorId, uint16_t productId)
+{
+    for (int i = 0; i < numBindings; i++)
+    {
+        if (bindings[i].vendorId == vendorId && bindings[i].productId == productId)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const ProfileBindings::Binding *ProfileBindings::find(uint16_t vendorId, uint16_t productId)
+{
+    int index = indexOf(vendorId, productId);
+    return index >= 0 ? &bindings[index] : nullptr;
+}
+
+bool ProfileBindings::apply(uint16_t vendorId, uint16_t productId, JoystickMappingConfig &config)
+{
+    const Binding *binding = find(vendorId, productId);
+    if (binding == nullptr)
+    {
+        return false;
+    }
+
+    if (binding->cacheSlot >= 0)
+    {
+        // Already parsed and match tables built
+        config = cache[binding->cacheSlot];
+        return true;
+    }
+
+    return MappingConfig::loadConfig(binding->profile, config);
+}
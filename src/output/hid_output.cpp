@@ -0,0 +1,320 @@
+#include "output/hid_output.h"
+#include "mapping/keyboard_mapping.h"
+#include <Keyboard.h>
+#include <Mouse.h>
+#include "logging/log.h"
+#include "timing/boot_profiler.h"
+
+HidOutput::HidOutput()
+    : numKeys(0), mouseX(0), mouseY(0), mouseWheel(0), mouseHoriz(0), mouseButtons(0), sentMouseButtons(0),
+      joystickButtons(0), joystickActive(false), joystickManual(false), joystickNeutral(true),
+      sentJoystickButtons(0), queueHead(0), queueTail(0)
+{
+    uint16_t centre = scaleJoystickAxis(128);
+    for (int i = 0; i < NUM_JOYSTICK_AXES; i++)
+    {
+        joystickOffsets[i] = 0;
+        sentReport.axes[i] = centre;
+    }
+    sentReport.buttons = 0;
+}
+
+int HidOutput::findKey(int keyCode) const
+{
+    for (int i = 0; i < numKeys; i++)
+    {
+        if (keys[i].keyCode == keyCode)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void HidOutput::pressKey(int keyCode)
+{
+    int index = findKey(keyCode);
+    if (index < 0)
+    {
+        if (numKeys >= MAX_HELD_KEYS)
+        {
+            LOG_WARN("HidOutput: Warning: Too many held keys, ignoring press");
+            return;
+        }
+        index = numKeys++;
+        keys[index] = {keyCode, 0, false};
+    }
+
+    if (keys[index].refCount < 255)
+    {
+        keys[index].refCount++;
+    }
+}
+
+void HidOutput::releaseKey(int keyCode)
+{
+    int index = findKey(keyCode);
+    if (index >= 0 && keys[index].refCount > 0)
+    {
+        keys[index].refCount--;
+    }
+}
+
+void HidOutput::moveMouse(int x, int y, int wheel, int horiz)
+{
+    mouseX += x;
+    mouseY += y;
+    mouseWheel += wheel;
+    mouseHoriz += horiz;
+}
+
+void HidOutput::moveJoystickAxis(uint8_t axis, int offset)
+{
+    if (axis < NUM_JOYSTICK_AXES)
+    {
+        joystickOffsets[axis] += offset;
+        joystickActive = true;
+    }
+}
+
+HidOutput::Report *HidOutput::claimReport()
+{
+    if ((uint8_t)(queueHead - __atomic_load_n(&queueTail, __ATOMIC_ACQUIRE)) >= QUEUE_SIZE)
+    {
+        return nullptr;
+    }
+    return &queue[queueHead & (QUEUE_SIZE - 1)];
+}
+
+void HidOutput::commitReport()
+{
+    // Publish only once the report is complete
+    __atomic_store_n(&queueHead, (uint8_t)(queueHead + 1), __ATOMIC_RELEASE);
+}
+
+uint8_t HidOutput::getQueued() const
+{
+    return (uint8_t)(__atomic_load_n(&queueHead, __ATOMIC_ACQUIRE) - __atomic_load_n(&queueTail, __ATOMIC_ACQUIRE));
+}
+
+bool HidOutput::applyKey(int keyCode, bool pressed)
+{
+    if (KeyboardMapping::isJoystickButton(keyCode))
+    {
+        uint32_t bit = 1u << (keyCode - KeyboardMapping::JOYSTICK_BUTTON_BASE - 1);
+        joystickButtons = pressed ? (joystickButtons | bit) : (joystickButtons & ~bit);
+        joystickActive = true;
+    }
+    else if (KeyboardMapping::isMouseButton(keyCode))
+    {
+        uint8_t bit = (uint8_t)(keyCode - KeyboardMapping::MOUSE_BUTTON_BASE);
+        mouseButtons = pressed ? (mouseButtons | bit) : (mouseButtons & ~bit);
+    }
+    else if (KeyboardMapping::isMouseWheel(keyCode))
+    {
+        // One step per press
+        if (pressed)
+        {
+            switch (keyCode)
+            {
+            case KeyboardMapping::MOUSE_WHEEL_UP:
+                mouseWheel++;
+                break;
+            case KeyboardMapping::MOUSE_WHEEL_DOWN:
+                mouseWheel--;
+                break;
+            case KeyboardMapping::MOUSE_WHEEL_LEFT:
+                mouseHoriz--;
+                break;
+            default:
+                mouseHoriz++;
+                break;
+            }
+        }
+    }
+    else
+    {
+        // Keyboard keys are the only ones that are a report of their own
+        Report *report = claimReport();
+        if (report == nullptr)
+        {
+            return false;
+        }
+        report->type = pressed ? Report::KEY_PRESS : Report::KEY_RELEASE;
+        report->keyCode = keyCode;
+        commitReport();
+    }
+    return true;
+}
+
+void HidOutput::flushJoystick()
+{
+    JoystickReport report;
+    for (int i = 0; i < NUM_JOYSTICK_AXES; i++)
+    {
+        report.axes[i] = scaleJoystickAxis((uint8_t)constrain(128 + joystickOffsets[i], 0, 255));
+        joystickOffsets[i] = 0;
+    }
+    report.buttons = joystickButtons;
+    joystickActive = false;
+
+    if (memcmp(&report, &sentReport, sizeof(report)) == 0)
+    {
+        return;
+    }
+
+    // One report per frame however many axes and buttons changed
+    Report *queued = claimReport();
+    if (queued == nullptr)
+    {
+        joystickActive = true; // Try again next frame
+        return;
+    }
+    queued->type = Report::JOYSTICK;
+    queued->joystick = report;
+    commitReport();
+    sentReport = report;
+
+    joystickNeutral = report.buttons == 0;
+    for (int i = 0; i < NUM_JOYSTICK_AXES; i++)
+    {
+        joystickNeutral = joystickNeutral && report.axes[i] == scaleJoystickAxis(128);
+    }
+}
+
+int HidOutput::clampMouse(int value)
+{
+    return constrain(value, -127, 127);
+}
+
+void HidOutput::flush()
+{
+    for (int i = 0; i < numKeys;)
+    {
+        KeyState &key = keys[i];
+        bool held = key.refCount > 0;
+
+        if (held && !key.sent)
+        {
+            key.sent = applyKey(key.keyCode, true);
+        }
+        else if (!held && key.sent)
+        {
+            key.sent = !applyKey(key.keyCode, false);
+        }
+
+        // Compact out keys that are fully released
+        if (!held && !key.sent)
+        {
+            keys[i] = keys[--numKeys];
+            continue;
+        }
+        i++;
+    }
+
+    // Buttons ride along with the motion: one report per frame carries both
+    Report *report;
+    if ((mouseX != 0 || mouseY != 0 || mouseWheel != 0 || mouseHoriz != 0 || mouseButtons != sentMouseButtons) &&
+        (report = claimReport()) != nullptr)
+    {
+        report->type = Report::MOUSE;
+        report->mouse.buttons = mouseButtons;
+        report->mouse.x = (int8_t)clampMouse(mouseX);
+        report->mouse.y = (int8_t)clampMouse(mouseY);
+        report->mouse.wheel = (int8_t)clampMouse(mouseWheel);
+        report->mouse.horiz = (int8_t)clampMouse(mouseHoriz);
+        commitReport();
+        sentMouseButtons = mouseButtons;
+        mouseX = 0;
+        mouseY = 0;
+        mouseWheel = 0;
+        mouseHoriz = 0;
+    }
+
+    // An untouched joystick is only revisited to recentre what it last sent
+    if (joystickActive || !joystickNeutral)
+    {
+        flushJoystick();
+    }
+}
+
+void HidOutput::send()
+{
+    uint8_t readIndex = queueTail;
+    while (readIndex != __atomic_load_n(&queueHead, __ATOMIC_ACQUIRE))
+    {
+        sendReport(queue[readIndex & (QUEUE_SIZE - 1)]);
+        readIndex++;
+        __atomic_store_n(&queueTail, readIndex, __ATOMIC_RELEASE);
+    }
+}
+
+void HidOutput::sendReport(const Report &report)
+{
+    switch (report.type)
+    {
+    case Report::KEY_PRESS:
+        BootProfiler::hidEvent();
+        Keyboard.press(report.keyCode);
+        break;
+    case Report::KEY_RELEASE:
+        Keyboard.release(report.keyCode);
+        break;
+    case Report::MOUSE:
+        BootProfiler::hidEvent();
+        usb_mouse_buttons_state = report.mouse.buttons;
+        Mouse.move(report.mouse.x, report.mouse.y, report.mouse.wheel, report.mouse.horiz);
+        break;
+    case Report::JOYSTICK:
+    {
+        const JoystickReport &joystick = report.joystick;
+        if (!joystickManual)
+        {
+            Joystick.useManualSend(true);
+            joystickManual = true;
+        }
+
+        Joystick.X(joystick.axes[AXIS_X]);
+        Joystick.Y(joystick.axes[AXIS_Y]);
+        Joystick.Z(joystick.axes[AXIS_Z]);
+        Joystick.Zrotate(joystick.axes[AXIS_Z_ROTATE]);
+        Joystick.sliderLeft(joystick.axes[AXIS_SLIDER_LEFT]);
+        Joystick.sliderRight(joystick.axes[AXIS_SLIDER_RIGHT]);
+
+        for (uint32_t changed = joystick.buttons ^ sentJoystickButtons; changed != 0; changed &= changed - 1)
+        {
+            int button = __builtin_ctz(changed);
+            Joystick.button(button + 1, (joystick.buttons >> button) & 1);
+        }
+
+        BootProfiler::hidEvent();
+        Joystick.send_now();
+        sentJoystickButtons = joystick.buttons;
+        break;
+    }
+    }
+}
+
+void HidOutput::releaseAll()
+{
+    for (int i = 0; i < numKeys; i++)
+    {
+        keys[i].refCount = 0;
+    }
+    mouseX = 0;
+    mouseY = 0;
+    mouseWheel = 0;
+    mouseHoriz = 0;
+    for (int i = 0; i < NUM_JOYSTICK_AXES; i++)
+    {
+        joystickOffsets[i] = 0;
+    }
+    flush();
+    send();
+}
+
+bool HidOutput::isKeyHeld(int keyCode) const
+{
+    int index = findKey(keyCode);
+    return index >= 0 && keys[index].refCount > 0;
+}
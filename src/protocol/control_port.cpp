@@ -0,0 +1,271 @@
+#include "protocol/control_port.h"
+#include "actions/action_handler.h"
+#include "devices.h"
+#include "timing/mapping_tier.h"
+#include "logging/log.h"
+
+using namespace ControlProtocol;
+
+ActionHandler *ControlPort::handler = nullptr;
+DeviceManager *ControlPort::devices = nullptr;
+FrameParser ControlPort::parser;
+uint32_t ControlPort::framesReceived = 0;
+unsigned long ControlPort::lastFrameMs = 0;
+char ControlPort::upload[MAX_PROFILE_SIZE];
+char ControlPort::uploadName[JoystickMappingConfig::MAX_FILENAME_LENGTH];
+uint16_t ControlPort::uploadSize = 0;
+uint16_t ControlPort::uploadReceived = 0;
+bool ControlPort::uploadOpen = false;
+uint8_t ControlPort::reply[FrameCodec::MAX_FRAME];
+size_t ControlPort::replyLength = 0;
+
+void ControlPort::begin(ActionHandler *actionHandler, DeviceManager *deviceManager)
+{
+    handler = actionHandler;
+    devices = deviceManager;
+    parser.reset();
+    replyLength = 0;
+}
+
+bool ControlPort::isHostAttached()
+{
+    return framesReceived > 0 && millis() - lastFrameMs < HOST_TIMEOUT_MS;
+}
+
+void ControlPort::poll()
+{
+    // One request at a time: the host waits for each reply
+    if (!flushReply())
+    {
+        return;
+    }
+
+    for (int i = 0; i < MAX_BYTES_PER_POLL && Serial.available() > 0; i++)
+    {
+        if (parser.feed((uint8_t)Serial.read()))
+        {
+            framesReceived++;
+            lastFrameMs = millis();
+            handleFrame();
+
+            if (!flushReply())
+            {
+                return;
+            }
+        }
+    }
+}
+
+void ControlPort::handleFrame()
+{
+    const uint8_t *payload = parser.getPayload();
+    size_t length = parser.getLength();
+
+    switch (parser.getType())
+    {
+    case PING:
+    {
+        uint8_t info[5];
+        info[0] = VERSION;
+        FrameCodec::put16(info + 1, (uint16_t)FrameCodec::MAX_PAYLOAD);
+        FrameCodec::put16(info + 3, MAX_PROFILE_SIZE);
+        sendReply(info, sizeof(info));
+        break;
+    }
+
+    case UPLOAD_BEGIN:
+        handleUploadBegin(payload, length);
+        break;
+
+    case UPLOAD_DATA:
+        handleUploadData(payload, length);
+        break;
+
+    case ACTIVATE:
+        handleActivate(payload, length);
+        break;
+
+    case GET_METRICS:
+        handleMetrics();
+        break;
+
+    case DUMP_LOG:
+        handleDumpLog();
+        break;
+
+    default:
+        sendError(ERR_UNKNOWN_TYPE);
+        break;
+    }
+}
+
+void ControlPort::handleUploadBegin(const uint8_t *payload, size_t length)
+{
+    // Size, then a non-empty name
+    if (length < 3 || length - 2 >= sizeof(uploadName))
+    {
+        sendError(ERR_BAD_LENGTH);
+        return;
+    }
+    size_t nameLength = length - 2;
+
+    uint16_t size = FrameCodec::get16(payload);
+    if (size == 0 || size > MAX_PROFILE_SIZE)
+    {
+        uploadOpen = false;
+        sendError(ERR_TOO_LARGE);
+        return;
+    }
+
+    memcpy(uploadName, payload + 2, nameLength);
+    uploadName[nameLength] = '\0';
+    uploadSize = size;
+    uploadReceived = 0;
+    uploadOpen = true;
+    sendReply(nullptr, 0);
+}
+
+void ControlPort::handleUploadData(const uint8_t *payload, size_t length)
+{
+    if (!uploadOpen)
+    {
+        sendError(ERR_NO_UPLOAD);
+        return;
+    }
+    if (length < 2)
+    {
+        sendError(ERR_BAD_LENGTH);
+        return;
+    }
+
+    uint16_t offset = FrameCodec::get16(payload);
+    size_t count = length - 2;
+    if (offset != uploadReceived)
+    {
+        sendError(ERR_OUT_OF_ORDER);
+        return;
+    }
+    if (offset + count > uploadSize)
+    {
+        sendError(ERR_TOO_LARGE);
+        return;
+    }
+
+    memcpy(upload + offset, payload + 2, count);
+    uploadReceived += count;
+
+    uint8_t received[2];
+    FrameCodec::put16(received, uploadReceived);
+    sendReply(received, sizeof(received));
+}
+
+void ControlPort::handleActivate(const uint8_t *payload, size_t length)
+{
+    if (length != 1)
+    {
+        sendError(ERR_BAD_LENGTH);
+        return;
+    }
+    if (!uploadOpen || uploadReceived != uploadSize)
+    {
+        sendError(ERR_NO_UPLOAD);
+        return;
+    }
+
+    int pad = payload[0];
+    if (pad >= devices->getJoystickCount())
+    {
+        sendError(ERR_BAD_PAD);
+        return;
+    }
+
+    if (!handler->loadProfile(pad, upload, uploadSize, uploadName))
+    {
+        sendError(ERR_REJECTED);
+        return;
+    }
+    sendReply(nullptr, 0);
+}
+
+void ControlPort::handleMetrics()
+{
+    MappingTier::Stats stats;
+    MappingTier::getStats(stats);
+    MappingTier::resetStats();
+
+    Metrics metrics;
+    metrics.uptimeMs = millis();
+    metrics.tierFrames = stats.frames;
+    metrics.tierPaused = stats.paused;
+    metrics.tierMinIntervalUs = stats.minIntervalUs;
+    metrics.tierMaxIntervalUs = stats.maxIntervalUs;
+    metrics.tierMaxFrameUs = stats.maxFrameUs;
+    metrics.tierRunning = MappingTier::isRunning() ? 1 : 0;
+    metrics.padsConnected = 0;
+    for (int i = 0; i < devices->getJoystickCount(); i++)
+    {
+        if (devices->getSnapshot(i)->connected)
+        {
+            metrics.padsConnected |= 1u << i;
+        }
+    }
+    metrics.logPending = Log::getPending();
+    metrics.logDropped = Log::getDroppedCount();
+    metrics.framesReceived = framesReceived;
+    metrics.frameErrors = parser.getErrorCount();
+    metrics.uploadBytes = uploadReceived;
+
+    uint8_t payload[METRICS_SIZE];
+    encodeMetrics(metrics, payload);
+    sendReply(payload, sizeof(payload));
+}
+
+void ControlPort::handleDumpLog()
+{
+    // As many whole lines as fit; the host asks again while records remain
+    uint8_t payload[FrameCodec::MAX_PAYLOAD];
+    size_t length = 2;
+    char line[Log::MAX_LINE];
+
+    while (FrameCodec::MAX_PAYLOAD - length > Log::MAX_LINE && Log::pop(line, sizeof(line)))
+    {
+        size_t lineLength = strlen(line);
+        memcpy(payload + length, line, lineLength);
+        length += lineLength;
+        payload[length++] = '\n';
+    }
+
+    FrameCodec::put16(payload, Log::getPending());
+    sendReply(payload, length);
+}
+
+void ControlPort::sendReply(const uint8_t *payload, size_t length)
+{
+    replyLength = FrameCodec::encode(parser.getType() | REPLY, parser.getSequence(), payload, length, reply, sizeof(reply));
+}
+
+void ControlPort::sendError(ErrorCode code)
+{
+    LOG_WARN("ControlPort: Request 0x%x failed with error %d", parser.getType(), code);
+
+    uint8_t payload[2] = {parser.getType(), code};
+    replyLength = FrameCodec::encode(NAK, parser.getSequence(), payload, sizeof(payload), reply, sizeof(reply));
+}
+
+bool ControlPort::flushReply()
+{
+    if (replyLength == 0)
+    {
+        return true;
+    }
+
+    // Never block on a host that is not reading
+    if ((size_t)Serial.availableForWrite() < replyLength)
+    {
+        return false;
+    }
+
+    Serial.write(reply, replyLength);
+    replyLength = 0;
+    return true;
+}
@@ -0,0 +1,108 @@
+#include "protocol/frame_codec.h"
+#include <string.h>
+
+uint16_t FrameCodec::crc16(const uint8_t *data, size_t length, uint16_t crc)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)(data[i] << 8);
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t FrameCodec::encode(uint8_t type, uint8_t sequence, const uint8_t *payload, size_t length, uint8_t *out, size_t outSize)
+{
+    size_t total = HEADER_SIZE + length + CRC_SIZE;
+    if (length > MAX_PAYLOAD || total > outSize)
+    {
+        return 0;
+    }
+
+    out[0] = SYNC1;
+    out[1] = SYNC2;
+    out[2] = type;
+    out[3] = sequence;
+    put16(out + 4, (uint16_t)length);
+    if (length > 0)
+    {
+        memcpy(out + HEADER_SIZE, payload, length);
+    }
+    put16(out + HEADER_SIZE + length, crc16(out + 2, HEADER_SIZE - 2 + length));
+    return total;
+}
+
+FrameParser::FrameParser()
+    : received(0), length(0), complete(false), errors(0)
+{
+}
+
+void FrameParser::reset()
+{
+    received = 0;
+    length = 0;
+    complete = false;
+}
+
+bool FrameParser::feed(uint8_t b)
+{
+    // The previous byte completed a frame; start the next one
+    if (complete)
+    {
+        reset();
+    }
+
+    // Hunt for the sync bytes; a repeated first byte may still start a frame
+    if (received == 0)
+    {
+        if (b == FrameCodec::SYNC1)
+        {
+            buffer[received++] = b;
+        }
+        return false;
+    }
+    if (received == 1)
+    {
+        if (b == FrameCodec::SYNC2)
+        {
+            buffer[received++] = b;
+        }
+        else if (b != FrameCodec::SYNC1)
+        {
+            received = 0;
+        }
+        return false;
+    }
+
+    buffer[received++] = b;
+
+    if (received == FrameCodec::HEADER_SIZE)
+    {
+        length = FrameCodec::get16(buffer + 4);
+        if (length > FrameCodec::MAX_PAYLOAD)
+        {
+            errors++;
+            reset();
+        }
+        return false;
+    }
+
+    if (received < FrameCodec::HEADER_SIZE || received < FrameCodec::HEADER_SIZE + length + FrameCodec::CRC_SIZE)
+    {
+        return false;
+    }
+
+    uint16_t expected = FrameCodec::get16(buffer + FrameCodec::HEADER_SIZE + length);
+    if (FrameCodec::crc16(buffer + 2, FrameCodec::HEADER_SIZE - 2 + length) != expected)
+    {
+        errors++;
+        reset();
+        return false;
+    }
+
+    complete = true;
+    return true;
+}
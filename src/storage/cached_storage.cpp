@@ -0,0 +1,379 @@
+#include "storage/cached_storage.h"
+#include "logging/log.h"
+
+CachedStorage::CachedStorage(Storage &b)
+    : backend(b), useCounter(0), hits(0), misses(0)
+{
+    for (int i = 0; i < MAX_OPEN_FILES; i++)
+    {
+        handles[i].open = false;
+    }
+    for (int i = 0; i < NUM_BLOCKS; i++)
+    {
+        blocks[i].file = -1;
+    }
+    invalidate();
+}
+
+bool CachedStorage::begin()
+{
+    // A new mount may be a different card
+    invalidate();
+    return backend.begin();
+}
+
+void CachedStorage::invalidate()
+{
+    for (int i = 0; i < MAX_CACHED_FILES; i++)
+    {
+        dropFile(i);
+    }
+}
+
+bool CachedStorage::stat(const char *path, StorageStat &stat)
+{
+    int file = findFile(path);
+    if (file >= 0)
+    {
+        stat.isDirectory = false;
+        stat.size = files[file].size;
+        return true;
+    }
+    return backend.stat(path, stat);
+}
+
+bool CachedStorage::remove(const char *path)
+{
+    dropPath(path);
+    return backend.remove(path);
+}
+
+bool CachedStorage::rename(const char *from, const char *to)
+{
+    dropPath(from);
+    dropPath(to);
+    return backend.rename(from, to);
+}
+
+int CachedStorage::list(const char *directory, StorageListCallback callback, void *context)
+{
+    return backend.list(directory, callback, context);
+}
+
+int CachedStorage::openHandle(const char *path, StorageMode mode)
+{
+    int handle = INVALID_HANDLE;
+    for (int i = 0; i < MAX_OPEN_FILES; i++)
+    {
+        if (!handles[i].open)
+        {
+            handle = i;
+            break;
+        }
+    }
+    if (handle == INVALID_HANDLE)
+    {
+        LOG_WARN("CachedStorage: Too many open files");
+        return INVALID_HANDLE;
+    }
+
+    Handle &h = handles[handle];
+    h.file = -1;
+    h.backendHandle = INVALID_HANDLE;
+    h.lastBlock = -1;
+    h.writing = (mode == StorageMode::WRITE);
+
+    if (h.writing)
+    {
+        dropPath(path);
+        h.backendHandle = backend.openHandle(path, mode);
+        if (h.backendHandle == INVALID_HANDLE)
+        {
+            return INVALID_HANDLE;
+        }
+    }
+    else
+    {
+        h.file = (int8_t)findFile(path);
+        if (h.file < 0)
+        {
+            // First open: the backend handle is needed for the size anyway
+            h.backendHandle = backend.openHandle(path, mode);
+            if (h.backendHandle == INVALID_HANDLE)
+            {
+                return INVALID_HANDLE;
+            }
+            h.file = (int8_t)addFile(path, backend.size(h.backendHandle));
+            if (h.file < 0)
+            {
+                backend.close(h.backendHandle);
+                return INVALID_HANDLE;
+            }
+        }
+        files[h.file].lastUse = ++useCounter;
+    }
+
+    h.open = true;
+    return handle;
+}
+
+int CachedStorage::read(int handle, uint32_t offset, void *buffer, uint32_t length)
+{
+    Handle &h = handles[handle];
+    if (h.writing)
+    {
+        return backend.read(h.backendHandle, offset, buffer, length);
+    }
+    if (h.file < 0)
+    {
+        return -1; // Changed while open
+    }
+
+    uint32_t fileSize = files[h.file].size;
+    if (offset >= fileSize)
+    {
+        return 0;
+    }
+    if (length > fileSize - offset)
+    {
+        length = fileSize - offset;
+    }
+
+    uint8_t *out = (uint8_t *)buffer;
+    uint32_t done = 0;
+    while (done < length)
+    {
+        uint32_t position = offset + done;
+        uint16_t index = (uint16_t)(position / BLOCK_SIZE);
+
+        // Byte-wise Stream reads stay in the same block most of the time
+        int block = h.lastBlock;
+        if (block < 0 || blocks[block].file != h.file || blocks[block].index != index)
+        {
+            block = findBlock(h.file, index);
+        }
+
+        if (block >= 0)
+        {
+            hits++;
+        }
+        else
+        {
+            misses++;
+            block = fillBlocks(h, index);
+            if (block < 0)
+            {
+                return done > 0 ? (int)done : -1;
+            }
+        }
+
+        Block &b = blocks[block];
+        b.lastUse = ++useCounter;
+        h.lastBlock = (int8_t)block;
+
+        uint32_t within = position - (uint32_t)index * BLOCK_SIZE;
+        if (within >= b.length)
+        {
+            break;
+        }
+        uint32_t count = b.length - within;
+        if (count > length - done)
+        {
+            count = length - done;
+        }
+        memcpy(out + done, b.data + within, count);
+        done += count;
+    }
+    return (int)done;
+}
+
+int CachedStorage::fillBlocks(Handle &h, uint16_t index)
+{
+    const CachedFile &file = files[h.file];
+
+    if (h.backendHandle == INVALID_HANDLE)
+    {
+        h.backendHandle = backend.openHandle(file.path, StorageMode::READ);
+        if (h.backendHandle == INVALID_HANDLE)
+        {
+            return -1;
+        }
+    }
+
+    int first = -1;
+    for (int ahead = 0; ahead < READ_AHEAD; ahead++)
+    {
+        uint32_t start = (uint32_t)(index + ahead) * BLOCK_SIZE;
+        if (start >= file.size)
+        {
+            break;
+        }
+        if (ahead > 0 && findBlock(h.file, index + ahead) >= 0)
+        {
+            continue;
+        }
+
+        // Free block, else the least recently used one
+        int victim = 0;
+        for (int i = 0; i < NUM_BLOCKS; i++)
+        {
+            if (blocks[i].file < 0)
+            {
+                victim = i;
+                break;
+            }
+            if (blocks[i].lastUse < blocks[victim].lastUse)
+            {
+                victim = i;
+            }
+        }
+
+        Block &b = blocks[victim];
+        uint32_t length = file.size - start;
+        if (length > BLOCK_SIZE)
+        {
+            length = BLOCK_SIZE;
+        }
+
+        b.file = -1;
+        int count = backend.read(h.backendHandle, start, b.data, length);
+        if (count <= 0)
+        {
+            break;
+        }
+
+        b.file = h.file;
+        b.index = (uint16_t)(index + ahead);
+        b.length = (uint16_t)count;
+        b.lastUse = ++useCounter;
+        if (ahead == 0)
+        {
+            first = victim;
+        }
+    }
+    return first;
+}
+
+int CachedStorage::write(int handle, const void *data, uint32_t length)
+{
+    Handle &h = handles[handle];
+    if (!h.writing)
+    {
+        return -1;
+    }
+    return backend.write(h.backendHandle, data, length);
+}
+
+uint32_t CachedStorage::size(int handle)
+{
+    Handle &h = handles[handle];
+    if (h.writing)
+    {
+        return backend.size(h.backendHandle);
+    }
+    return h.file >= 0 ? files[h.file].size : 0;
+}
+
+void CachedStorage::close(int handle)
+{
+    Handle &h = handles[handle];
+    if (h.backendHandle != INVALID_HANDLE)
+    {
+        backend.close(h.backendHandle);
+    }
+    h.open = false;
+}
+
+int CachedStorage::findFile(const char *path) const
+{
+    for (int i = 0; i < MAX_CACHED_FILES; i++)
+    {
+        if (files[i].valid && strcmp(files[i].path, path) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int CachedStorage::addFile(const char *path, uint32_t size)
+{
+    // Free slot, else the least recently used file nobody has open
+    int victim = -1;
+    for (int i = 0; i < MAX_CACHED_FILES; i++)
+    {
+        if (!files[i].valid)
+        {
+            victim = i;
+            break;
+        }
+
+        bool inUse = false;
+        for (int j = 0; j < MAX_OPEN_FILES; j++)
+        {
+            if (handles[j].open && handles[j].file == i)
+            {
+                inUse = true;
+            }
+        }
+        if (!inUse && (victim < 0 || files[i].lastUse < files[victim].lastUse))
+        {
+            victim = i;
+        }
+    }
+    if (victim < 0)
+    {
+        return -1;
+    }
+
+    dropFile(victim);
+
+    CachedFile &file = files[victim];
+    strncpy(file.path, path, MAX_PATH_LENGTH - 1);
+    file.path[MAX_PATH_LENGTH - 1] = '\0';
+    file.size = size;
+    file.lastUse = ++useCounter;
+    file.valid = true;
+    return victim;
+}
+
+void CachedStorage::dropFile(int file)
+{
+    files[file].valid = false;
+    for (int i = 0; i < NUM_BLOCKS; i++)
+    {
+        if (blocks[i].file == file)
+        {
+            blocks[i].file = -1;
+            blocks[i].lastUse = 0;
+        }
+    }
+    for (int i = 0; i < MAX_OPEN_FILES; i++)
+    {
+        if (handles[i].open && !handles[i].writing && handles[i].file == file)
+        {
+            handles[i].file = -1;
+        }
+    }
+}
+
+void CachedStorage::dropPath(const char *path)
+{
+    int file = findFile(path);
+    if (file >= 0)
+    {
+        dropFile(file);
+    }
+}
+
+int CachedStorage::findBlock(int file, uint16_t index) const
+{
+    for (int i = 0; i < NUM_BLOCKS; i++)
+    {
+        if (blocks[i].file == file && blocks[i].index == index)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
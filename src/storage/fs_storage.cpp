@@ -0,0 +1,122 @@
+#include "storage/fs_storage.h"
+#include "logging/log.h"
+
+FsStorage::FsStorage(FS &f)
+    : fs(f)
+{
+}
+
+bool FsStorage::stat(const char *path, StorageStat &stat)
+{
+    // FS has no stat; opening is the only way to get at the size
+    File file = fs.open(path, FILE_READ);
+    if (!file)
+    {
+        return false;
+    }
+    stat.isDirectory = file.isDirectory();
+    stat.size = stat.isDirectory ? 0 : (uint32_t)file.size();
+    file.close();
+    return true;
+}
+
+bool FsStorage::remove(const char *path)
+{
+    return fs.remove(path);
+}
+
+bool FsStorage::rename(const char *from, const char *to)
+{
+    return fs.rename(from, to);
+}
+
+int FsStorage::list(const char *directory, StorageListCallback callback, void *context)
+{
+    File dir = fs.open(directory, FILE_READ);
+    if (!dir || !dir.isDirectory())
+    {
+        return -1;
+    }
+
+    int count = 0;
+    File entry = dir.openNextFile();
+    while (entry)
+    {
+        StorageStat stat;
+        stat.isDirectory = entry.isDirectory();
+        stat.size = stat.isDirectory ? 0 : (uint32_t)entry.size();
+        callback(context, entry.name(), stat);
+        count++;
+
+        entry.close();
+        entry = dir.openNextFile();
+    }
+    dir.close();
+    return count;
+}
+
+int FsStorage::openHandle(const char *path, StorageMode mode)
+{
+    int handle = INVALID_HANDLE;
+    for (int i = 0; i < MAX_OPEN_FILES; i++)
+    {
+        if (!files[i])
+        {
+            handle = i;
+            break;
+        }
+    }
+    if (handle == INVALID_HANDLE)
+    {
+        LOG_WARN("FsStorage: Too many open files");
+        return INVALID_HANDLE;
+    }
+
+    if (mode == StorageMode::WRITE)
+    {
+        // FILE_WRITE appends to an existing file
+        if (fs.exists(path))
+        {
+            fs.remove(path);
+        }
+        files[handle] = fs.open(path, FILE_WRITE);
+    }
+    else
+    {
+        files[handle] = fs.open(path, FILE_READ);
+    }
+
+    if (!files[handle] || files[handle].isDirectory())
+    {
+        files[handle].close();
+        return INVALID_HANDLE;
+    }
+    return handle;
+}
+
+int FsStorage::read(int handle, uint32_t offset, void *buffer, uint32_t length)
+{
+    File &file = files[handle];
+
+    // Sequential reads skip the seek
+    if (file.position() != offset && !file.seek(offset))
+    {
+        return -1;
+    }
+    return file.read(buffer, length);
+}
+
+int FsStorage::write(int handle, const void *data, uint32_t length)
+{
+    return (int)files[handle].write((const uint8_t *)data, length);
+}
+
+uint32_t FsStorage::size(int handle)
+{
+    return (uint32_t)files[handle].size();
+}
+
+void FsStorage::close(int handle)
+{
+    files[handle].close();
+}
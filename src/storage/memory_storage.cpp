@@ -0,0 +1,196 @@
+#include "storage/memory_storage.h"
+
+MemoryStorage::MemoryStorage()
+    : openCount(0), readCount(0), bytesRead(0)
+{
+    clear();
+}
+
+void MemoryStorage::clear()
+{
+    for (int i = 0; i < MAX_FILES; i++)
+    {
+        files[i].used = false;
+    }
+    for (int i = 0; i < MAX_OPEN_FILES; i++)
+    {
+        handles[i] = -1;
+    }
+}
+
+const char *MemoryStorage::baseName(const char *path)
+{
+    // Single directory: "/Default.json" and "Default.json" are the same file
+    return path[0] == '/' ? path + 1 : path;
+}
+
+int MemoryStorage::find(const char *path) const
+{
+    const char *name = baseName(path);
+    for (int i = 0; i < MAX_FILES; i++)
+    {
+        if (files[i].used && strcmp(files[i].name, name) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool MemoryStorage::stat(const char *path, StorageStat &stat)
+{
+    if (baseName(path)[0] == '\0')
+    {
+        stat.isDirectory = true;
+        stat.size = 0;
+        return true;
+    }
+
+    int index = find(path);
+    if (index < 0)
+    {
+        return false;
+    }
+    stat.isDirectory = false;
+    stat.size = files[index].size;
+    return true;
+}
+
+bool MemoryStorage::remove(const char *path)
+{
+    int index = find(path);
+    if (index < 0)
+    {
+        return false;
+    }
+    files[index].used = false;
+    return true;
+}
+
+bool MemoryStorage::rename(const char *from, const char *to)
+{
+    int index = find(from);
+    if (index < 0)
+    {
+        return false;
+    }
+
+    int existing = find(to);
+    if (existing >= 0 && existing != index)
+    {
+        files[existing].used = false;
+    }
+
+    strncpy(files[index].name, baseName(to), MAX_PATH_LENGTH - 1);
+    files[index].name[MAX_PATH_LENGTH - 1] = '\0';
+    return true;
+}
+
+int MemoryStorage::list(const char *directory, StorageListCallback callback, void *context)
+{
+    if (baseName(directory)[0] != '\0')
+    {
+        return -1;
+    }
+
+    int count = 0;
+    for (int i = 0; i < MAX_FILES; i++)
+    {
+        if (files[i].used)
+        {
+            StorageStat stat = {files[i].size, false};
+            callback(context, files[i].name, stat);
+            count++;
+        }
+    }
+    return count;
+}
+
+int MemoryStorage::openHandle(const char *path, StorageMode mode)
+{
+    int handle = INVALID_HANDLE;
+    for (int i = 0; i < MAX_OPEN_FILES; i++)
+    {
+        if (handles[i] < 0)
+        {
+            handle = i;
+            break;
+        }
+    }
+    if (handle == INVALID_HANDLE)
+    {
+        return INVALID_HANDLE;
+    }
+
+    int index = find(path);
+    if (mode == StorageMode::WRITE)
+    {
+        if (index < 0)
+        {
+            for (int i = 0; i < MAX_FILES; i++)
+            {
+                if (!files[i].used)
+                {
+                    index = i;
+                    break;
+                }
+            }
+            if (index < 0)
+            {
+                return INVALID_HANDLE;
+            }
+            files[index].used = true;
+            strncpy(files[index].name, baseName(path), MAX_PATH_LENGTH - 1);
+            files[index].name[MAX_PATH_LENGTH - 1] = '\0';
+        }
+        files[index].size = 0;
+    }
+    else if (index < 0)
+    {
+        return INVALID_HANDLE;
+    }
+
+    openCount++;
+    handles[handle] = (int8_t)index;
+    return handle;
+}
+
+int MemoryStorage::read(int handle, uint32_t offset, void *buffer, uint32_t length)
+{
+    const Entry &file = files[handles[handle]];
+    if (offset >= file.size)
+    {
+        return 0;
+    }
+    if (length > file.size - offset)
+    {
+        length = file.size - offset;
+    }
+    memcpy(buffer, file.data + offset, length);
+
+    readCount++;
+    bytesRead += length;
+    return (int)length;
+}
+
+int MemoryStorage::write(int handle, const void *data, uint32_t length)
+{
+    Entry &file = files[handles[handle]];
+    if (length > MAX_FILE_SIZE - file.size)
+    {
+        length = MAX_FILE_SIZE - file.size;
+    }
+    memcpy(file.data + file.size, data, length);
+    file.size += length;
+    return (int)length;
+}
+
+uint32_t MemoryStorage::size(int handle)
+{
+    return files[handles[handle]].size;
+}
+
+void MemoryStorage::close(int handle)
+{
+    handles[handle] = -1;
+}
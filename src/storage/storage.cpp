@@ -0,0 +1,136 @@
+#include "storage/storage.h"
+
+StorageFile Storage::open(const char *path, StorageMode mode)
+{
+    int handle = openHandle(path, mode);
+    if (handle == INVALID_HANDLE)
+    {
+        return StorageFile();
+    }
+    return StorageFile(this, handle);
+}
+
+bool Storage::exists(const char *path)
+{
+    StorageStat info;
+    return stat(path, info);
+}
+
+StorageFile::StorageFile()
+    : storage(nullptr), handle(Storage::INVALID_HANDLE), pos(0)
+{
+}
+
+StorageFile::StorageFile(Storage *s, int h)
+    : storage(s), handle(h), pos(0)
+{
+}
+
+StorageFile::StorageFile(StorageFile &&other)
+    : storage(other.storage), handle(other.handle), pos(other.pos)
+{
+    other.handle = Storage::INVALID_HANDLE;
+}
+
+StorageFile &StorageFile::operator=(StorageFile &&other)
+{
+    if (this != &other)
+    {
+        close();
+        storage = other.storage;
+        handle = other.handle;
+        pos = other.pos;
+        other.handle = Storage::INVALID_HANDLE;
+    }
+    return *this;
+}
+
+int StorageFile::available()
+{
+    if (handle == Storage::INVALID_HANDLE)
+    {
+        return 0;
+    }
+    uint32_t length = storage->size(handle);
+    return pos < length ? (int)(length - pos) : 0;
+}
+
+int StorageFile::read()
+{
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+}
+
+int StorageFile::peek()
+{
+    uint8_t b;
+    if (handle == Storage::INVALID_HANDLE || storage->read(handle, pos, &b, 1) != 1)
+    {
+        return -1;
+    }
+    return b;
+}
+
+int StorageFile::read(void *buffer, uint32_t length)
+{
+    if (handle == Storage::INVALID_HANDLE)
+    {
+        return -1;
+    }
+    int count = storage->read(handle, pos, buffer, length);
+    if (count > 0)
+    {
+        pos += count;
+    }
+    return count;
+}
+
+size_t StorageFile::readBytes(char *buffer, size_t length)
+{
+    int count = read(buffer, (uint32_t)length);
+    return count > 0 ? (size_t)count : 0;
+}
+
+size_t StorageFile::write(uint8_t b)
+{
+    return write(&b, 1);
+}
+
+size_t StorageFile::write(const uint8_t *buffer, size_t length)
+{
+    if (handle == Storage::INVALID_HANDLE)
+    {
+        return 0;
+    }
+    int count = storage->write(handle, buffer, (uint32_t)length);
+    if (count <= 0)
+    {
+        return 0;
+    }
+    pos += count;
+    return (size_t)count;
+}
+
+uint32_t StorageFile::size()
+{
+    return handle != Storage::INVALID_HANDLE ? storage->size(handle) : 0;
+}
+
+bool StorageFile::seek(uint32_t position)
+{
+    if (handle == Storage::INVALID_HANDLE || position > storage->size(handle))
+    {
+        return false;
+    }
+    pos = position;
+    return true;
+}
+
+void StorageFile::close()
+{
+    if (handle != Storage::INVALID_HANDLE)
+    {
+        storage->close(handle);
+        handle = Storage::INVALID_HANDLE;
+    }
+}
@@ -0,0 +1,37 @@
+#include "timing/boot_profiler.h"
+#include "logging/log.h"
+
+const char *BootProfiler::phaseNames[MAX_PHASES];
+uint32_t BootProfiler::phaseMicros[MAX_PHASES];
+int BootProfiler::numPhases = 0;
+uint32_t BootProfiler::firstHidMicros = 0;
+bool BootProfiler::reported = false;
+
+void BootProfiler::mark(const char *phase)
+{
+    if (numPhases < MAX_PHASES)
+    {
+        phaseNames[numPhases] = phase;
+        phaseMicros[numPhases] = micros();
+        numPhases++;
+    }
+}
+
+void BootProfiler::update()
+{
+    if (reported || firstHidMicros == 0)
+    {
+        return;
+    }
+    reported = true;
+
+    // Times are since reset, which includes the core's own USB start-up
+    uint32_t previous = 0;
+    for (int i = 0; i < numPhases; i++)
+    {
+        LOG_INFO("BootProfiler: %s done at %u us (+%u us)", phaseNames[i], phaseMicros[i], phaseMicros[i] - previous);
+        previous = phaseMicros[i];
+    }
+
+    LOG_INFO("BootProfiler: First HID report at %u us", firstHidMicros);
+}
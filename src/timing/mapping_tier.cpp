@@ -0,0 +1,108 @@
+#include "timing/mapping_tier.h"
+#include "logging/log.h"
+
+IntervalTimer MappingTier::timer;
+MappingTier::Frame MappingTier::frame = nullptr;
+void *MappingTier::context = nullptr;
+bool MappingTier::running = false;
+uint8_t MappingTier::pauseDepth = 0;
+MappingTier::Stats MappingTier::stats;
+DoubleBuffer<MappingTier::Stats> MappingTier::published;
+uint32_t MappingTier::lastStart = 0;
+uint32_t MappingTier::resetRequests = 0;
+uint32_t MappingTier::resetsSeen = 0;
+
+bool MappingTier::begin(Frame newFrame, void *newContext)
+{
+    end();
+
+    frame = newFrame;
+    context = newContext;
+    resetsSeen = resetRequests;
+    clearStats();
+
+    timer.priority(PRIORITY);
+    running = timer.begin(onTimer, PERIOD_US);
+    if (running)
+    {
+        LOG_INFO("MappingTier: Input frames every %u us from a timer interrupt", PERIOD_US);
+    }
+    else
+    {
+        LOG_WARN("MappingTier: No free timer, input frames run from loop()");
+    }
+    return running;
+}
+
+void MappingTier::end()
+{
+    if (running)
+    {
+        timer.end();
+        running = false;
+    }
+}
+
+void MappingTier::pause()
+{
+    __atomic_add_fetch(&pauseDepth, 1, __ATOMIC_SEQ_CST);
+}
+
+void MappingTier::resume()
+{
+    __atomic_sub_fetch(&pauseDepth, 1, __ATOMIC_SEQ_CST);
+}
+
+void MappingTier::getStats(Stats &result)
+{
+    if (!published.read(result))
+    {
+        result = Stats();
+    }
+}
+
+void MappingTier::resetStats()
+{
+    // The interrupt owns the counters; it clears them at its next frame
+    __atomic_add_fetch(&resetRequests, 1, __ATOMIC_RELEASE);
+}
+
+void MappingTier::clearStats()
+{
+    stats = Stats();
+    stats.minIntervalUs = UINT32_MAX;
+    lastStart = 0;
+}
+
+void MappingTier::onTimer()
+{
+    uint32_t start = micros();
+
+    uint32_t requests = __atomic_load_n(&resetRequests, __ATOMIC_ACQUIRE);
+    if (requests != resetsSeen)
+    {
+        resetsSeen = requests;
+        clearStats();
+    }
+
+    if (stats.frames > 0)
+    {
+        uint32_t interval = start - lastStart;
+        stats.minIntervalUs = min(stats.minIntervalUs, interval);
+        stats.maxIntervalUs = max(stats.maxIntervalUs, interval);
+    }
+    lastStart = start;
+    stats.frames++;
+
+    if (__atomic_load_n(&pauseDepth, __ATOMIC_ACQUIRE) != 0)
+    {
+        stats.paused++;
+    }
+    else
+    {
+        frame(context);
+    }
+
+    stats.maxFrameUs = max(stats.maxFrameUs, micros() - start);
+    published.write(stats);
+}
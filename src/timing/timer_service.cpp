@@ -0,0 +1,40 @@
+#include "timing/timer_service.h"
+
+TimerWheel TimerService::wheel;
+TimerService::Clock TimerService::clock = nullptr;
+bool TimerService::updating = false;
+
+void TimerService::setClock(Clock newClock)
+{
+    clock = newClock;
+}
+
+unsigned long TimerService::now()
+{
+    return clock != nullptr ? clock() : millis();
+}
+
+void TimerService::update()
+{
+    updating = true;
+    wheel.advance(now());
+    updating = false;
+}
+
+int TimerService::schedule(unsigned long delay, TimerWheel::Callback callback, void *context, uint32_t data)
+{
+    // An empty wheel may not have been advanced for a while. Inside a callback
+    // the wheel is at the firing time and must stay there.
+    if (!updating && wheel.getActiveCount() == 0)
+    {
+        wheel.advance(now());
+    }
+
+    return wheel.schedule(delay, callback, context, data);
+}
+
+void TimerService::cancel(int &id)
+{
+    wheel.cancel(id);
+    id = TimerWheel::INVALID_TIMER;
+}
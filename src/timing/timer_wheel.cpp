@@ -0,0 +1,200 @@
+#include "timing/timer_wheel.h"
+#include "logging/log.h"
+
+TimerWheel::TimerWheel()
+    : currentTime(0), activeCount(0), level0Count(0)
+{
+    for (int i = 0; i < NUM_LISTS; i++)
+    {
+        heads[i] = NONE;
+    }
+
+    for (int i = 0; i < MAX_TIMERS; i++)
+    {
+        timers[i].generation = 0;
+        link(i, LIST_FREE);
+    }
+}
+
+void TimerWheel::link(int index, int list)
+{
+    Timer &timer = timers[index];
+    timer.list = list;
+    timer.prev = NONE;
+    timer.next = heads[list];
+    if (heads[list] != NONE)
+    {
+        timers[heads[list]].prev = index;
+    }
+    heads[list] = index;
+
+    if (list < LIST_LEVEL1)
+    {
+        level0Count++;
+    }
+}
+
+void TimerWheel::unlink(int index)
+{
+    Timer &timer = timers[index];
+    if (timer.prev != NONE)
+    {
+        timers[timer.prev].next = timer.next;
+    }
+    else
+    {
+        heads[timer.list] = timer.next;
+    }
+    if (timer.next != NONE)
+    {
+        timers[timer.next].prev = timer.prev;
+    }
+
+    if (timer.list < LIST_LEVEL1)
+    {
+        level0Count--;
+    }
+}
+
+void TimerWheel::insert(int index)
+{
+    unsigned long delta = timers[index].expiry - currentTime;
+
+    if (delta < (unsigned long)SLOTS)
+    {
+        link(index, timers[index].expiry & SLOT_MASK);
+    }
+    else if (delta < LEVEL1_SPAN)
+    {
+        link(index, LIST_LEVEL1 + ((timers[index].expiry >> SLOT_BITS) & SLOT_MASK));
+    }
+    else
+    {
+        link(index, LIST_OVERFLOW);
+    }
+}
+
+void TimerWheel::release(int index)
+{
+    unlink(index);
+    timers[index].generation = (timers[index].generation + 1) & 0x7F;
+    link(index, LIST_FREE);
+    activeCount--;
+}
+
+void TimerWheel::cascade(int list)
+{
+    // Re-file every timer in the list relative to the current time
+    int8_t index = heads[list];
+    heads[list] = NONE;
+
+    while (index != NONE)
+    {
+        int8_t next = timers[index].next;
+        insert(index);
+        index = next;
+    }
+}
+
+int TimerWheel::schedule(unsigned long delay, Callback callback, void *context, uint32_t data)
+{
+    int index = heads[LIST_FREE];
+    if (index == NONE)
+    {
+        LOG_WARN("TimerWheel: Warning: All timers busy");
+        return INVALID_TIMER;
+    }
+
+    unlink(index);
+
+    Timer &timer = timers[index];
+    timer.expiry = currentTime + (delay > 0 ? delay : 1);
+    timer.callback = callback;
+    timer.context = context;
+    timer.data = data;
+    insert(index);
+    activeCount++;
+
+    return (timer.generation << 8) | index;
+}
+
+void TimerWheel::cancel(int id)
+{
+    if (id < 0)
+    {
+        return;
+    }
+
+    int index = id & 0xFF;
+    if (index >= MAX_TIMERS || timers[index].list == LIST_FREE || timers[index].generation != (id >> 8))
+    {
+        return;
+    }
+
+    release(index);
+}
+
+void TimerWheel::cancelAll()
+{
+    for (int i = 0; i < MAX_TIMERS; i++)
+    {
+        if (timers[i].list != LIST_FREE)
+        {
+            release(i);
+        }
+    }
+}
+
+void TimerWheel::advance(unsigned long now)
+{
+    if (activeCount == 0)
+    {
+        currentTime = now;
+        return;
+    }
+
+    while (currentTime != now)
+    {
+        if (level0Count == 0)
+        {
+            // Nothing can fire before the next level 1 slot comes due
+            unsigned long slotEnd = currentTime | SLOT_MASK;
+            if ((long)(now - slotEnd) <= 0)
+            {
+                currentTime = now;
+                return;
+            }
+            currentTime = slotEnd;
+        }
+
+        currentTime++;
+
+        if ((currentTime & SLOT_MASK) == 0)
+        {
+            if (((currentTime >> SLOT_BITS) & SLOT_MASK) == 0)
+            {
+                cascade(LIST_OVERFLOW);
+            }
+            cascade(LIST_LEVEL1 + ((currentTime >> SLOT_BITS) & SLOT_MASK));
+        }
+
+        // Everything in this slot expires now; callbacks may add new timers
+        int list = currentTime & SLOT_MASK;
+        while (heads[list] != NONE)
+        {
+            int index = heads[list];
+            Callback callback = timers[index].callback;
+            void *context = timers[index].context;
+            uint32_t data = timers[index].data;
+
+            release(index);
+            callback(context, data);
+        }
+
+        if (activeCount == 0)
+        {
+            currentTime = now;
+            return;
+        }
+    }
+}
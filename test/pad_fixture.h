@@ -0,0 +1,86 @@
+#ifndef PAD_FIXTURE_H
+#define PAD_FIXTURE_H
+
+#include <Arduino.h>
+#include <Keyboard.h>
+#include "mapping/mapping_config.h"
+#include "mapping/mapping_pipeline.h"
+
+// One pad driven straight through a MappingPipeline, frame by frame, the
+// way RunAction::inputFrame() runs it, with the reports sent as loop()
+// sends them. Buttons are generic (bit n = GenericController button n) and
+// written into the snapshot, so tests do not depend on a controller layout. Time is the manual native clock and
+// frame() moves it by 1 ms, the input tier's period.
+struct PadFixture
+{
+    ControllerSnapshot snapshot;
+    LiveConfig live;
+    HidOutput output;
+    MacroEngine macros;
+    TimerWheel timers;
+    MappingPipeline pipeline;
+    JoystickMappingConfig config;
+
+    PadFixture()
+    {
+        nativeClockSetManual(true);
+        nativeClockSet(1000);
+        Keyboard.releaseAll();
+
+        USBHost host;
+        JoystickController joystick(host);
+        joystick.simConnect(JoystickController::XBOX360, 0, 0);
+        snapshot.connect(&joystick);
+        for (int axis = 0; axis < ControllerSnapshot::NUM_AXES; axis++)
+        {
+            snapshot.axes[axis] = axis < GenericController::AXIS_LEFT_TRIGGER ? 128 : 0;
+        }
+    }
+
+    ~PadFixture()
+    {
+        pipeline.reset();
+        macros.stopAll();
+        output.releaseAll();
+    }
+
+    // Parse a profile and hand it to the pipeline, as RunAction does
+    bool load(const char *json)
+    {
+        if (!MappingConfig::loadConfig(json, strlen(json), "/Test.json", config) || !live.publish(config))
+        {
+            return false;
+        }
+        pipeline.bind(0, &snapshot, &live, &output, &macros, &timers);
+        return true;
+    }
+
+    void frame(uint32_t buttons)
+    {
+        snapshot.buttons = buttons;
+
+        unsigned long now = millis();
+        timers.advance(now);
+        pipeline.process();
+        macros.tick(now);
+        output.flush();
+        output.send();
+
+        nativeClockAdvance(1);
+    }
+
+    void hold(uint32_t buttons, int frames)
+    {
+        for (int i = 0; i < frames; i++)
+        {
+            frame(buttons);
+        }
+    }
+};
+
+inline uint32_t button(uint8_t genericButton)
+{
+    return 1u << genericButton;
+}
+
+#endif // PAD_FIXTURE_H
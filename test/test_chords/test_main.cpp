@@ -0,0 +1,136 @@
+#include <unity.h>
+#include "../pad_fixture.h"
+
+using namespace GenericController;
+
+static PadFixture *pad;
+
+static const char *PROFILE = R"({
+    "mappings": [
+        {"button": "A", "key": "a"},
+        {"button": "L1+A", "key": "b"},
+        {"button": "L1", "key": "c"},
+        {"button": "R1+L1+A", "key": "e"},
+        {"button": "R1+A", "key": "f"},
+        {"button": "A", "key": "d", "layer": 1}
+    ],
+    "layers": ["L2"]
+})";
+
+void setUp(void)
+{
+    pad = new PadFixture();
+    TEST_ASSERT_TRUE(pad->load(PROFILE));
+}
+
+void tearDown(void)
+{
+    delete pad;
+}
+
+static void test_single_button(void)
+{
+    pad->frame(button(BTN_SOUTH));
+    TEST_ASSERT_TRUE(Keyboard.isPressed('a'));
+    TEST_ASSERT_FALSE(Keyboard.isPressed('b'));
+
+    pad->frame(0);
+    TEST_ASSERT_FALSE(Keyboard.isPressed('a'));
+}
+
+static void test_chord_replaces_its_buttons(void)
+{
+    pad->frame(button(BTN_L1) | button(BTN_SOUTH));
+    TEST_ASSERT_TRUE(Keyboard.isPressed('b'));
+    TEST_ASSERT_FALSE(Keyboard.isPressed('a'));
+    TEST_ASSERT_FALSE(Keyboard.isPressed('c'));
+}
+
+static void test_chord_completed_after_modifier(void)
+{
+    // The modifier's own mapping gives way once the chord completes
+    pad->frame(button(BTN_L1));
+    TEST_ASSERT_TRUE(Keyboard.isPressed('c'));
+
+    pad->frame(button(BTN_L1) | button(BTN_SOUTH));
+    TEST_ASSERT_TRUE(Keyboard.isPressed('b'));
+    TEST_ASSERT_FALSE(Keyboard.isPressed('c'));
+    TEST_ASSERT_FALSE(Keyboard.isPressed('a'));
+}
+
+static void test_releasing_modifier_falls_back(void)
+{
+    pad->frame(button(BTN_L1) | button(BTN_SOUTH));
+    pad->frame(button(BTN_SOUTH));
+    TEST_ASSERT_FALSE(Keyboard.isPressed('b'));
+    TEST_ASSERT_TRUE(Keyboard.isPressed('a'));
+
+    pad->frame(0);
+    TEST_ASSERT_FALSE(Keyboard.isPressed('a'));
+}
+
+static void test_larger_chord_wins(void)
+{
+    pad->frame(button(BTN_R1) | button(BTN_L1) | button(BTN_SOUTH));
+    TEST_ASSERT_TRUE(Keyboard.isPressed('e'));
+    TEST_ASSERT_FALSE(Keyboard.isPressed('b'));
+    TEST_ASSERT_FALSE(Keyboard.isPressed('f'));
+    TEST_ASSERT_FALSE(Keyboard.isPressed('a'));
+    TEST_ASSERT_FALSE(Keyboard.isPressed('c'));
+}
+
+static void test_overlapping_chords_of_equal_size(void)
+{
+    // L1+A and R1+A share A; with R1+L1+A gone neither blocks the other
+    pad->frame(button(BTN_R1) | button(BTN_L1) | button(BTN_SOUTH));
+    pad->frame(button(BTN_R1) | button(BTN_SOUTH));
+    TEST_ASSERT_TRUE(Keyboard.isPressed('f'));
+    TEST_ASSERT_FALSE(Keyboard.isPressed('e'));
+    TEST_ASSERT_FALSE(Keyboard.isPressed('a'));
+
+    TEST_ASSERT_TRUE(pad->load(R"({"mappings": [
+        {"button": "L1+A", "key": "b"},
+        {"button": "R1+A", "key": "f"}
+    ]})"));
+    pad->frame(button(BTN_R1) | button(BTN_L1) | button(BTN_SOUTH));
+    TEST_ASSERT_TRUE(Keyboard.isPressed('b'));
+    TEST_ASSERT_TRUE(Keyboard.isPressed('f'));
+}
+
+static void test_layer_button(void)
+{
+    // The layer button only selects the layer and sends nothing itself
+    unsigned long presses = Keyboard.pressCount;
+    pad->frame(button(BTN_L2));
+    TEST_ASSERT_EQUAL(presses, Keyboard.pressCount);
+
+    pad->frame(button(BTN_L2) | button(BTN_SOUTH));
+    TEST_ASSERT_TRUE(Keyboard.isPressed('d'));
+    TEST_ASSERT_FALSE(Keyboard.isPressed('a'));
+
+    pad->frame(0);
+    TEST_ASSERT_FALSE(Keyboard.isPressed('d'));
+}
+
+static void test_layer_has_no_chords_of_base(void)
+{
+    // Chords live in the base layer; on layer 1 only A is mapped
+    pad->frame(button(BTN_L2) | button(BTN_L1) | button(BTN_SOUTH));
+    TEST_ASSERT_TRUE(Keyboard.isPressed('d'));
+    TEST_ASSERT_FALSE(Keyboard.isPressed('b'));
+    TEST_ASSERT_FALSE(Keyboard.isPressed('c'));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_single_button);
+    RUN_TEST(test_chord_replaces_its_buttons);
+    RUN_TEST(test_chord_completed_after_modifier);
+    RUN_TEST(test_releasing_modifier_falls_back);
+    RUN_TEST(test_larger_chord_wins);
+    RUN_TEST(test_overlapping_chords_of_equal_size);
+    RUN_TEST(test_layer_button);
+    RUN_TEST(test_layer_has_no_chords_of_base);
+    return UNITY_END();
+}
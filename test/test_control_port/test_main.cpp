@@ -0,0 +1,162 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+#include "main.h"
+#include "control_client.h"
+
+// The control client against the firmware over a pseudo-terminal, as with
+// native/device: a child process runs setup() and loop() with its serial
+// port on the master end, and the tests talk to it through the slave end.
+static pid_t device = -1;
+static const char *port;
+static ControlClient::Link *client;
+
+static void runDevice(int master, pid_t tests)
+{
+    Serial.simAttach(master);
+    setup();
+
+    // Gone with the tests, even if they crash
+    while (getppid() == tests)
+    {
+        loop();
+        usleep(1000);
+    }
+}
+
+static bool startDevice()
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+    {
+        return false;
+    }
+
+    // The slave end stays open and raw for the whole run, as on a CDC port
+    port = ptsname(master);
+    int slave = open(port, O_RDWR | O_NOCTTY);
+    termios mode;
+    if (slave < 0 || tcgetattr(slave, &mode) != 0)
+    {
+        return false;
+    }
+    cfmakeraw(&mode);
+    tcsetattr(slave, TCSANOW, &mode);
+
+    pid_t tests = getpid();
+    device = fork();
+    if (device == 0)
+    {
+        runDevice(master, tests);
+        _exit(0);
+    }
+    close(master);
+    return device > 0;
+}
+
+static void stopDevice()
+{
+    if (device > 0)
+    {
+        kill(device, SIGTERM);
+        waitpid(device, nullptr, 0);
+    }
+}
+
+void setUp(void)
+{
+    client = new ControlClient::Link();
+    TEST_ASSERT_TRUE(client->open(port));
+}
+
+void tearDown(void)
+{
+    delete client;
+}
+
+static void test_ping(void)
+{
+    ControlClient::DeviceInfo info;
+    TEST_ASSERT_TRUE(ControlClient::ping(*client, info));
+    TEST_ASSERT_EQUAL(ControlProtocol::VERSION, info.version);
+    TEST_ASSERT_EQUAL(FrameCodec::MAX_PAYLOAD, info.maxPayload);
+    TEST_ASSERT_EQUAL(ControlProtocol::MAX_PROFILE_SIZE, info.maxProfileSize);
+}
+
+static void test_upload_and_activate(void)
+{
+    // Longer than one payload, so it goes in several chunks
+    std::string profile = R"({"mappings":[)";
+    for (char key = 'a'; key <= 'j'; key++)
+    {
+        profile += std::string(key == 'a' ? "" : ",") + R"({"button":"A","key":")" + key + R"("})";
+    }
+    profile += R"(],"displayName":"Uploaded"})";
+    TEST_ASSERT_GREATER_THAN(FrameCodec::MAX_PAYLOAD, profile.size());
+
+    TEST_ASSERT_TRUE(ControlClient::upload(*client, (const uint8_t *)profile.data(), profile.size(), "/Uploaded.json"));
+    TEST_ASSERT_TRUE(ControlClient::activate(*client, 0));
+
+    ControlProtocol::Metrics metrics;
+    TEST_ASSERT_TRUE(ControlClient::getMetrics(*client, metrics));
+    TEST_ASSERT_EQUAL(profile.size(), metrics.uploadBytes);
+}
+
+static void test_bad_pad_is_refused(void)
+{
+    TEST_ASSERT_FALSE(ControlClient::activate(*client, 9));
+
+    // The link carries on after a refusal
+    ControlClient::DeviceInfo info;
+    TEST_ASSERT_TRUE(ControlClient::ping(*client, info));
+}
+
+static void test_metrics(void)
+{
+    ControlProtocol::Metrics metrics;
+    TEST_ASSERT_TRUE(ControlClient::getMetrics(*client, metrics));
+    TEST_ASSERT_GREATER_THAN(0, metrics.uptimeMs);
+    TEST_ASSERT_GREATER_THAN(0, metrics.framesReceived);
+    TEST_ASSERT_EQUAL(0, metrics.frameErrors);
+}
+
+static void test_log_dump(void)
+{
+    // Held for the host since the first request; the activation is in it
+    char *text = nullptr;
+    size_t length = 0;
+    FILE *out = open_memstream(&text, &length);
+    TEST_ASSERT_TRUE(ControlClient::dumpLog(*client, out));
+    fclose(out);
+    TEST_ASSERT_NOT_NULL(strstr(text, "Pad 1 switched to an uploaded profile"));
+    free(text);
+
+    ControlProtocol::Metrics metrics;
+    TEST_ASSERT_TRUE(ControlClient::getMetrics(*client, metrics));
+    TEST_ASSERT_EQUAL(0, metrics.logPending);
+}
+
+int main(int argc, char **argv)
+{
+    if (!startDevice())
+    {
+        return 1;
+    }
+
+    UNITY_BEGIN();
+    RUN_TEST(test_ping);
+    RUN_TEST(test_upload_and_activate);
+    RUN_TEST(test_bad_pad_is_refused);
+    RUN_TEST(test_metrics);
+    RUN_TEST(test_log_dump);
+    int failures = UNITY_END();
+
+    stopDevice();
+    return failures;
+}
@@ -0,0 +1,147 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <Keyboard.h>
+#include <SD.h>
+#include "main.h"
+#include "devices.h"
+#include "actions/action_handler.h"
+#include "mapping/flash_profile.h"
+#include "timing/mapping_tier.h"
+#include <IntervalTimer.h>
+
+// Boot from the profile cached in program flash: mapping starts before the
+// LCD and the SD card, and the card's copy wins if its contents changed
+extern DeviceManager devices;
+extern ActionHandler actionHandler;
+
+static const uint32_t A = 1u << Xbox360Physical::A;
+
+// Same length, so only the contents tell them apart
+static const char *PROFILE_A = R"({"mappings":[{"button":"A","key":"a"}]})";
+static const char *PROFILE_B = R"({"mappings":[{"button":"A","key":"b"}]})";
+
+static void runLoops(int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        loop();
+        nativeClockAdvance(5);
+    }
+}
+
+static void connectPad()
+{
+    JoystickController *pad = devices.getJoystick(0);
+    pad->simConnect(JoystickController::XBOX360, 0x045E, 0x028E);
+    for (int axis = 0; axis < 6; axis++)
+    {
+        pad->simSetAxis(axis, axis < 4 ? 128 : 0);
+    }
+}
+
+// Boot normally from the card and let the flash copy be written, which
+// RunAction leaves for 5 s
+static void cacheProfile(const char *json)
+{
+    SD.simWriteFile("/Default.json", json);
+    setup();
+    connectPad();
+    runLoops(1100);
+    devices.getJoystick(0)->simSetButtons(0);
+    runLoops(2);
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+    SD.simSetAccessDelay(5);
+    devices.getJoystick(0)->simSetButtons(0);
+    runLoops(2);
+}
+
+static void test_flash_boot_maps_before_lcd_and_card(void)
+{
+    // Nothing in flash yet: the first boot reads the card and starts the LCD in setup()
+    SD.simWriteFile("/Default.json", PROFILE_A);
+    setup();
+    TEST_ASSERT_TRUE(devices.isDisplayStarted());
+
+    cacheProfile(PROFILE_A);
+    TEST_ASSERT_TRUE(FlashProfile::matchesSD(mappingConfig));
+
+    LiquidCrystal_I2C *lcd = devices.getLCD();
+    unsigned long sdOpens = SD.openCount;
+    unsigned long lcdOps = lcd->opCount;
+    unsigned long lcdInits = lcd->initCount;
+    devices.getJoystick(0)->simSetButtons(A);
+
+    // setup() touches neither
+    setup();
+    TEST_ASSERT_EQUAL(sdOpens, SD.openCount);
+    TEST_ASSERT_EQUAL(lcdInits, lcd->initCount);
+    TEST_ASSERT_EQUAL(lcdOps, lcd->opCount);
+    TEST_ASSERT_FALSE(devices.isDisplayStarted());
+
+    // The first loop maps, then starts the LCD and the card and draws
+    runLoops(1);
+    TEST_ASSERT_TRUE(Keyboard.isPressed('a'));
+    TEST_ASSERT_EQUAL(lcdInits + 1, lcd->initCount);
+    TEST_ASSERT_GREATER_THAN(sdOpens, SD.openCount);
+    TEST_ASSERT_EQUAL_STRING("   Running file:    ", lcd->getRow(1));
+    TEST_ASSERT_EQUAL_STRING("      Default       ", lcd->getRow(2));
+}
+
+static void test_same_size_edit_reloads_from_card(void)
+{
+    cacheProfile(PROFILE_A);
+
+    // Edited on a PC: same size, different key. The card is mounted again
+    // on boot, so nothing cached from before is trusted.
+    SD.simWriteFile("/Default.json", PROFILE_B);
+
+    devices.getJoystick(0)->simSetButtons(A);
+    setup();
+    runLoops(3);
+    TEST_ASSERT_TRUE(Keyboard.isPressed('b'));
+    TEST_ASSERT_FALSE(Keyboard.isPressed('a'));
+}
+
+static void test_card_is_read_while_mapping(void)
+{
+    cacheProfile(PROFILE_A);
+
+    // A slow card: the input tier keeps running through the mount and the
+    // reads, and is held off only for the layout swap, which reads nothing
+    SD.simSetAccessDelay(5);
+    IntervalTimer::simSetAvailable(true);
+    devices.getJoystick(0)->simSetButtons(A);
+    setup();
+    MappingTier::resetStats();
+    runLoops(1);
+
+    MappingTier::Stats stats;
+    MappingTier::getStats(stats);
+    TEST_ASSERT_GREATER_THAN(0, stats.frames);
+    TEST_ASSERT_EQUAL(0, stats.paused);
+
+    // Mapped during the reads and sent at the end of the same loop
+    TEST_ASSERT_TRUE(Keyboard.isPressed('a'));
+
+    MappingTier::end();
+    IntervalTimer::simSetAvailable(false);
+}
+
+int main(int argc, char **argv)
+{
+    nativeClockSetManual(true);
+    nativeClockSet(1000);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_flash_boot_maps_before_lcd_and_card);
+    RUN_TEST(test_same_size_edit_reloads_from_card);
+    RUN_TEST(test_card_is_read_while_mapping);
+    return UNITY_END();
+}
@@ -0,0 +1,231 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <Keyboard.h>
+#include <SD.h>
+#include "main.h"
+#include "devices.h"
+#include "actions/action_handler.h"
+#include "input/hotplug.h"
+
+extern DeviceManager devices;
+extern ActionHandler actionHandler;
+
+// HotplugManager on its own drivers, and the firmware letting go of keys
+// when a pad leaves
+static const int MAX_EVENTS = 8;
+static HotplugEvent events[MAX_EVENTS];
+static int eventCount;
+
+static void record(void *context, const HotplugEvent &event)
+{
+    (void)context;
+    if (eventCount < MAX_EVENTS)
+    {
+        events[eventCount] = event;
+    }
+    eventCount++;
+}
+
+static USBHost host;
+static HotplugKeyboard keyboard(host);
+static HotplugJoystick joystick1(host);
+static HotplugJoystick joystick2(host);
+static HotplugManager *hotplug;
+
+static void assertEvent(int index, bool connected, HotplugDeviceType type, uint8_t pad, uint16_t vendorId)
+{
+    TEST_ASSERT_TRUE(connected == events[index].connected);
+    TEST_ASSERT_TRUE(type == events[index].type);
+    TEST_ASSERT_EQUAL(pad, events[index].index);
+    TEST_ASSERT_EQUAL_HEX16(vendorId, events[index].vendorId);
+}
+
+void setUp(void)
+{
+    hotplug = new HotplugManager();
+    HotplugJoystick *const joysticks[] = {&joystick1, &joystick2};
+    hotplug->attach(&keyboard, nullptr, joysticks, 2);
+    hotplug->subscribe(record, nullptr);
+    eventCount = 0;
+}
+
+void tearDown(void)
+{
+    keyboard.simDisconnect();
+    joystick1.simDisconnect();
+    joystick2.simDisconnect();
+    delete hotplug;
+}
+
+static void test_connect_and_disconnect(void)
+{
+    joystick2.simConnect(JoystickController::PS4, 0x054C, 0x09CC);
+    hotplug->update();
+    TEST_ASSERT_EQUAL(1, eventCount);
+    assertEvent(0, true, HotplugDeviceType::JOYSTICK, 1, 0x054C);
+    TEST_ASSERT_EQUAL_HEX16(0x09CC, events[0].productId);
+    TEST_ASSERT_TRUE(hotplug->isConnected(HotplugDeviceType::JOYSTICK, 1));
+    TEST_ASSERT_FALSE(hotplug->isConnected(HotplugDeviceType::JOYSTICK, 0));
+
+    // No edge, no event
+    hotplug->update();
+    TEST_ASSERT_EQUAL(1, eventCount);
+
+    // The disconnect names the pad that went
+    joystick2.simDisconnect();
+    hotplug->update();
+    TEST_ASSERT_EQUAL(2, eventCount);
+    assertEvent(1, false, HotplugDeviceType::JOYSTICK, 1, 0x054C);
+    TEST_ASSERT_FALSE(hotplug->isConnected(HotplugDeviceType::JOYSTICK, 1));
+}
+
+static void test_replug_between_updates(void)
+{
+    joystick1.simConnect(JoystickController::XBOX360, 0x045E, 0x028E);
+    hotplug->update();
+
+    // Out and back in before loop() looked: still a disconnect and a connect
+    joystick1.simDisconnect();
+    joystick1.simConnect(JoystickController::XBOX360, 0x045E, 0x028E);
+    hotplug->update();
+
+    TEST_ASSERT_EQUAL(3, eventCount);
+    assertEvent(1, false, HotplugDeviceType::JOYSTICK, 0, 0x045E);
+    assertEvent(2, true, HotplugDeviceType::JOYSTICK, 0, 0x045E);
+}
+
+static void test_swap_between_updates(void)
+{
+    joystick1.simConnect(JoystickController::XBOX360, 0x045E, 0x028E);
+    hotplug->update();
+
+    // Another pad on the same port: the old one leaves first
+    joystick1.simDisconnect();
+    joystick1.simConnect(JoystickController::PS4, 0x054C, 0x09CC);
+    hotplug->update();
+
+    TEST_ASSERT_EQUAL(3, eventCount);
+    assertEvent(1, false, HotplugDeviceType::JOYSTICK, 0, 0x045E);
+    assertEvent(2, true, HotplugDeviceType::JOYSTICK, 0, 0x054C);
+}
+
+static void test_keyboard_events(void)
+{
+    keyboard.simConnect(0x046D, 0xC31C);
+    hotplug->update();
+    keyboard.simDisconnect();
+    hotplug->update();
+
+    TEST_ASSERT_EQUAL(2, eventCount);
+    assertEvent(0, true, HotplugDeviceType::KEYBOARD, 0, 0x046D);
+    assertEvent(1, false, HotplugDeviceType::KEYBOARD, 0, 0x046D);
+}
+
+static void test_subscribers_in_order_and_bounded(void)
+{
+    static int order[HotplugManager::MAX_SUBSCRIBERS];
+    static int calls;
+    calls = 0;
+
+    HotplugManager manager;
+    HotplugJoystick *const joysticks[] = {&joystick1};
+    manager.attach(nullptr, nullptr, joysticks, 1);
+    for (intptr_t i = 0; i < HotplugManager::MAX_SUBSCRIBERS; i++)
+    {
+        TEST_ASSERT_TRUE(manager.subscribe([](void *context, const HotplugEvent &) { order[calls++] = (int)(intptr_t)context; },
+                                           (void *)i));
+    }
+    TEST_ASSERT_FALSE(manager.subscribe(record, nullptr));
+
+    joystick1.simConnect(JoystickController::XBOX360, 0x045E, 0x028E);
+    manager.update();
+    TEST_ASSERT_EQUAL(HotplugManager::MAX_SUBSCRIBERS, calls);
+    for (int i = 0; i < calls; i++)
+    {
+        TEST_ASSERT_EQUAL(i, order[i]);
+    }
+}
+
+// The firmware, two pads running A -> a, B -> b
+static void runLoops(int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        loop();
+        nativeClockAdvance(1);
+    }
+}
+
+static void connectPad(int index)
+{
+    JoystickController *pad = devices.getJoystick(index);
+    pad->simConnect(JoystickController::XBOX360, 0x045E, 0x028E);
+    for (int axis = 0; axis < 6; axis++)
+    {
+        pad->simSetAxis(axis, axis < 4 ? 128 : 0);
+    }
+}
+
+static void test_unplugged_pad_releases_its_keys(void)
+{
+    const uint32_t A = 1u << Xbox360Physical::A;
+    const uint32_t B = 1u << Xbox360Physical::B;
+    JoystickController *pad1 = devices.getJoystick(0);
+    JoystickController *pad2 = devices.getJoystick(1);
+
+    connectPad(0);
+    connectPad(1);
+    runLoops(5);
+
+    // Both pads hold A, pad 2 also holds B
+    pad1->simSetButtons(A);
+    pad2->simSetButtons(A | B);
+    runLoops(5);
+    TEST_ASSERT_TRUE(Keyboard.isPressed('a'));
+    TEST_ASSERT_TRUE(Keyboard.isPressed('b'));
+
+    // Pad 1 still holds a, so only b goes up
+    pad2->simDisconnect();
+    runLoops(2);
+    TEST_ASSERT_TRUE(Keyboard.isPressed('a'));
+    TEST_ASSERT_FALSE(Keyboard.isPressed('b'));
+
+    // Last pad gone: nothing stays down
+    pad1->simDisconnect();
+    runLoops(2);
+    TEST_ASSERT_FALSE(Keyboard.isPressed('a'));
+
+    // Plugged back in, the pad maps again
+    connectPad(0);
+    runLoops(5);
+    pad1->simSetButtons(B);
+    runLoops(5);
+    TEST_ASSERT_TRUE(Keyboard.isPressed('b'));
+    pad1->simSetButtons(0);
+    runLoops(5);
+    TEST_ASSERT_FALSE(Keyboard.isPressed('b'));
+    pad1->simDisconnect();
+    runLoops(2);
+}
+
+int main(int argc, char **argv)
+{
+    SD.simWriteFile("/Default.json", R"({"mappings":[{"button":"A","key":"a"},{"button":"B","key":"b"}]})");
+    nativeClockSetManual(true);
+    nativeClockSet(1000);
+    setup();
+    loop();
+
+    // Pad 2 runs the same profile as pad 1
+    padConfigs[1] = mappingConfig;
+    actionHandler.publishConfig(1);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_connect_and_disconnect);
+    RUN_TEST(test_replug_between_updates);
+    RUN_TEST(test_swap_between_updates);
+    RUN_TEST(test_keyboard_events);
+    RUN_TEST(test_subscribers_in_order_and_bounded);
+    RUN_TEST(test_unplugged_pad_releases_its_keys);
+    return UNITY_END();
+}
@@ -0,0 +1,202 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <Keyboard.h>
+#include "output/hid_output.h"
+#include "mapping/keyboard_mapping.h"
+
+static HidOutput *output;
+static unsigned long reportsBefore;
+
+// Joystick reports sent since the test started
+static unsigned long reports()
+{
+    return Joystick.reportCount - reportsBefore;
+}
+
+// One input frame followed by loop()'s send
+static void frame()
+{
+    output->flush();
+    output->send();
+}
+
+static int joystickButton(int number)
+{
+    return KeyboardMapping::JOYSTICK_BUTTON_BASE + number;
+}
+
+void setUp(void)
+{
+    output = new HidOutput();
+    reportsBefore = Joystick.reportCount;
+}
+
+void tearDown(void)
+{
+    output->releaseAll();
+    delete output;
+}
+
+static void test_scale_covers_the_range(void)
+{
+    TEST_ASSERT_EQUAL(0, HidOutput::scaleJoystickAxis(0));
+    TEST_ASSERT_EQUAL(514, HidOutput::scaleJoystickAxis(128));
+    TEST_ASSERT_EQUAL(HidOutput::JOYSTICK_AXIS_MAX, HidOutput::scaleJoystickAxis(255));
+
+    for (int value = 0; value < 256; value++)
+    {
+        uint16_t scaled = HidOutput::scaleJoystickAxis((uint8_t)value);
+        TEST_ASSERT_LESS_OR_EQUAL(HidOutput::JOYSTICK_AXIS_MAX, scaled);
+        // Within a step of the exact linear scale, and strictly rising
+        TEST_ASSERT_INT_WITHIN(2, value * 1023 / 255, scaled);
+        if (value > 0)
+        {
+            TEST_ASSERT_GREATER_THAN(HidOutput::scaleJoystickAxis((uint8_t)(value - 1)), scaled);
+        }
+    }
+}
+
+static void test_idle_sends_nothing(void)
+{
+    for (int i = 0; i < 10; i++)
+    {
+        frame();
+    }
+    TEST_ASSERT_EQUAL(0, reports());
+}
+
+static void test_one_report_per_frame(void)
+{
+    // Three axes and two buttons change together: one report carries them all
+    output->moveJoystickAxis(HidOutput::AXIS_X, 127);
+    output->moveJoystickAxis(HidOutput::AXIS_Y, -128);
+    output->moveJoystickAxis(HidOutput::AXIS_SLIDER_LEFT, 64);
+    output->pressKey(joystickButton(1));
+    output->pressKey(joystickButton(5));
+    frame();
+
+    TEST_ASSERT_EQUAL(1, reports());
+    TEST_ASSERT_TRUE(Joystick.manualMode);
+    TEST_ASSERT_EQUAL(1023, Joystick.axes[HidOutput::AXIS_X]);
+    TEST_ASSERT_EQUAL(0, Joystick.axes[HidOutput::AXIS_Y]);
+    TEST_ASSERT_EQUAL(HidOutput::scaleJoystickAxis(192), Joystick.axes[HidOutput::AXIS_SLIDER_LEFT]);
+    TEST_ASSERT_EQUAL(514, Joystick.axes[HidOutput::AXIS_Z]);
+    TEST_ASSERT_EQUAL(0x11, Joystick.buttons);
+}
+
+static void test_unchanged_frame_sends_nothing(void)
+{
+    for (int i = 0; i < 5; i++)
+    {
+        output->moveJoystickAxis(HidOutput::AXIS_X, 40);
+        output->pressKey(joystickButton(2));
+        frame();
+        output->releaseKey(joystickButton(2));
+        output->pressKey(joystickButton(2));
+    }
+    TEST_ASSERT_EQUAL(1, reports());
+}
+
+static void test_untouched_axes_recentre_once(void)
+{
+    output->moveJoystickAxis(HidOutput::AXIS_Z_ROTATE, -50);
+    frame();
+    TEST_ASSERT_EQUAL(1, reports());
+
+    // Nothing moved the axis this frame, so it goes back to centre
+    frame();
+    TEST_ASSERT_EQUAL(2, reports());
+    TEST_ASSERT_EQUAL(514, Joystick.axes[HidOutput::AXIS_Z_ROTATE]);
+
+    for (int i = 0; i < 5; i++)
+    {
+        frame();
+    }
+    TEST_ASSERT_EQUAL(2, reports());
+}
+
+static void test_pads_add_up_and_clamp(void)
+{
+    output->moveJoystickAxis(HidOutput::AXIS_X, 40);
+    output->moveJoystickAxis(HidOutput::AXIS_X, 30);
+    output->moveJoystickAxis(HidOutput::AXIS_Y, -100);
+    output->moveJoystickAxis(HidOutput::AXIS_Y, -100);
+    frame();
+
+    TEST_ASSERT_EQUAL(1, reports());
+    TEST_ASSERT_EQUAL(HidOutput::scaleJoystickAxis(198), Joystick.axes[HidOutput::AXIS_X]);
+    TEST_ASSERT_EQUAL(0, Joystick.axes[HidOutput::AXIS_Y]);
+}
+
+static void test_button_release_is_one_report(void)
+{
+    output->pressKey(joystickButton(3));
+    frame();
+    output->releaseKey(joystickButton(3));
+    frame();
+
+    TEST_ASSERT_EQUAL(2, reports());
+    TEST_ASSERT_EQUAL(0, Joystick.buttons);
+
+    frame();
+    TEST_ASSERT_EQUAL(2, reports());
+}
+
+static void test_flush_only_queues(void)
+{
+    output->pressKey(joystickButton(1));
+    output->pressKey('a');
+    output->flush();
+
+    TEST_ASSERT_EQUAL(2, output->getQueued());
+    TEST_ASSERT_EQUAL(0, reports());
+    TEST_ASSERT_FALSE(Keyboard.isPressed('a'));
+
+    output->send();
+    TEST_ASSERT_EQUAL(0, output->getQueued());
+    TEST_ASSERT_EQUAL(1, reports());
+    TEST_ASSERT_TRUE(Keyboard.isPressed('a'));
+}
+
+static void test_full_queue_keeps_changes_pending(void)
+{
+    // Every held key pressed and released without loop() getting to send
+    for (int key = 0; key < HidOutput::MAX_HELD_KEYS; key++)
+    {
+        output->pressKey('a' + key);
+    }
+    output->flush();
+    for (int key = 0; key < HidOutput::MAX_HELD_KEYS; key++)
+    {
+        output->releaseKey('a' + key);
+    }
+    output->flush();
+    TEST_ASSERT_EQUAL(HidOutput::QUEUE_SIZE, output->getQueued());
+
+    // No room for the joystick report; it goes once the queue drains
+    output->pressKey(joystickButton(2));
+    output->flush();
+    output->send();
+    TEST_ASSERT_EQUAL(0, reports());
+
+    output->flush();
+    output->send();
+    TEST_ASSERT_EQUAL(1, reports());
+    TEST_ASSERT_EQUAL(0x2, Joystick.buttons);
+    TEST_ASSERT_FALSE(Keyboard.isPressed('a'));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_scale_covers_the_range);
+    RUN_TEST(test_idle_sends_nothing);
+    RUN_TEST(test_one_report_per_frame);
+    RUN_TEST(test_unchanged_frame_sends_nothing);
+    RUN_TEST(test_untouched_axes_recentre_once);
+    RUN_TEST(test_pads_add_up_and_clamp);
+    RUN_TEST(test_button_release_is_one_report);
+    RUN_TEST(test_flush_only_queues);
+    RUN_TEST(test_full_queue_keeps_changes_pending);
+    return UNITY_END();
+}
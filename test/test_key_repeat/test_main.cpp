@@ -0,0 +1,212 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "input/gamepad_input.h"
+#include "timing/timer_service.h"
+
+// GamepadInput on a virtual clock, one loop() per millisecond unless a test
+// skips some
+static unsigned long virtualTime;
+
+static unsigned long virtualClock()
+{
+    return virtualTime;
+}
+
+static ControllerSnapshot *snapshot;
+static GamepadInput *input;
+
+// Times of the events seen so far, by type
+static const int MAX_EVENTS = 64;
+static unsigned long repeats[MAX_EVENTS];
+static int repeatCount;
+static unsigned long longPresses[MAX_EVENTS];
+static int longPressCount;
+static int pressCount;
+
+static void drain()
+{
+    InputEvent event;
+    while (input->pollEvent(event))
+    {
+        if (event.type == InputEdge::REPEAT && repeatCount < MAX_EVENTS)
+        {
+            repeats[repeatCount++] = virtualTime;
+        }
+        else if (event.type == InputEdge::LONG_PRESS && longPressCount < MAX_EVENTS)
+        {
+            longPresses[longPressCount++] = virtualTime;
+        }
+        else if (event.type == InputEdge::PRESS)
+        {
+            pressCount++;
+        }
+    }
+}
+
+// One loop(): the clock moves on, a capture bumps the snapshot, then timers
+// and input run as main.cpp orders them
+static void loopOnce(uint32_t buttons, unsigned long elapsed = 1)
+{
+    virtualTime += elapsed;
+    snapshot->buttons = buttons;
+    snapshot->sequence++;
+    TimerService::update();
+    input->update();
+    drain();
+}
+
+static void run(uint32_t buttons, unsigned long until)
+{
+    while (virtualTime < until)
+    {
+        loopOnce(buttons);
+    }
+}
+
+static const uint32_t DOWN = 1u << GenericController::BTN_DPAD_DOWN;
+static const uint32_t SOUTH = 1u << GenericController::BTN_SOUTH;
+
+void setUp(void)
+{
+    virtualTime = 10000;
+    TimerService::setClock(virtualClock);
+    TimerService::getWheel()->cancelAll();
+    TimerService::update();
+
+    static USBHost host;
+    static JoystickController joystick(host);
+    joystick.simConnect(JoystickController::XBOX360, 0, 0);
+    snapshot = new ControllerSnapshot();
+    snapshot->connect(&joystick);
+    snapshot->buttons = 0;
+    input = new GamepadInput(snapshot);
+
+    repeatCount = 0;
+    longPressCount = 0;
+    pressCount = 0;
+}
+
+void tearDown(void)
+{
+    delete input;
+    delete snapshot;
+    TimerService::getWheel()->cancelAll();
+    TimerService::setClock(nullptr);
+}
+
+static void test_initial_delay(void)
+{
+    loopOnce(DOWN);
+    unsigned long pressed = virtualTime;
+    TEST_ASSERT_EQUAL(1, pressCount);
+
+    run(DOWN, pressed + 399);
+    TEST_ASSERT_EQUAL(0, repeatCount);
+    loopOnce(DOWN);
+    TEST_ASSERT_EQUAL(1, repeatCount);
+    TEST_ASSERT_EQUAL(pressed + 400, repeats[0]);
+}
+
+static void test_interval_accelerates(void)
+{
+    TEST_ASSERT_EQUAL(100, input->getRepeatInterval(0));
+    TEST_ASSERT_EQUAL(100, input->getRepeatInterval(7));
+    TEST_ASSERT_EQUAL(50, input->getRepeatInterval(8));
+    TEST_ASSERT_EQUAL(25, input->getRepeatInterval(16));
+    TEST_ASSERT_EQUAL(25, input->getRepeatInterval(255));
+
+    loopOnce(DOWN);
+    unsigned long pressed = virtualTime;
+    run(DOWN, pressed + 2000);
+
+    // Each gap is the interval for the repeats already sent: 8 at 100 ms,
+    // 8 at 50 ms, then 25 ms from there on
+    TEST_ASSERT_GREATER_THAN(24, repeatCount);
+    TEST_ASSERT_EQUAL(pressed + 400, repeats[0]);
+    TEST_ASSERT_EQUAL(pressed + 1100, repeats[7]);
+    TEST_ASSERT_EQUAL(pressed + 1150, repeats[8]);
+    TEST_ASSERT_EQUAL(pressed + 1500, repeats[15]);
+    TEST_ASSERT_EQUAL(pressed + 1525, repeats[16]);
+    for (int i = 1; i < repeatCount; i++)
+    {
+        TEST_ASSERT_EQUAL(input->getRepeatInterval((uint8_t)i), repeats[i] - repeats[i - 1]);
+    }
+}
+
+static void test_missed_intervals_catch_up(void)
+{
+    loopOnce(DOWN);
+    unsigned long pressed = virtualTime;
+    run(DOWN, pressed + 400);
+    TEST_ASSERT_EQUAL(1, repeatCount);
+
+    // A slow loop: one update 350 ms later owes three repeats (500, 600, 700)
+    loopOnce(DOWN, 350);
+    TEST_ASSERT_EQUAL(4, repeatCount);
+
+    // and the schedule carries on from the missed times, not from the late update
+    run(DOWN, pressed + 799);
+    TEST_ASSERT_EQUAL(4, repeatCount);
+    loopOnce(DOWN);
+    TEST_ASSERT_EQUAL(5, repeatCount);
+}
+
+static void test_release_stops_repeat(void)
+{
+    loopOnce(DOWN);
+    unsigned long pressed = virtualTime;
+    run(DOWN, pressed + 450);
+    TEST_ASSERT_EQUAL(1, repeatCount);
+
+    loopOnce(0);
+    run(0, pressed + 2000);
+    TEST_ASSERT_EQUAL(1, repeatCount);
+    TEST_ASSERT_EQUAL(0, TimerService::getWheel()->getActiveCount());
+
+    // A new press starts over with the full delay and interval
+    loopOnce(DOWN);
+    unsigned long again = virtualTime;
+    run(DOWN, again + 500);
+    TEST_ASSERT_EQUAL(3, repeatCount);
+    TEST_ASSERT_EQUAL(again + 400, repeats[1]);
+    TEST_ASSERT_EQUAL(again + 500, repeats[2]);
+}
+
+static void test_long_press_fires_once(void)
+{
+    loopOnce(SOUTH);
+    unsigned long pressed = virtualTime;
+    run(SOUTH, pressed + 3000);
+
+    TEST_ASSERT_EQUAL(0, repeatCount);
+    TEST_ASSERT_EQUAL(1, longPressCount);
+    TEST_ASSERT_EQUAL(pressed + 800, longPresses[0]);
+}
+
+static void test_skipped_loops_resync(void)
+{
+    // Too many captures without an update: held buttons become the baseline
+    // and their timers stop, rather than replaying a press
+    loopOnce(DOWN);
+    for (int i = 0; i < 10; i++)
+    {
+        snapshot->sequence++;
+    }
+    loopOnce(DOWN, 1000);
+    run(DOWN, virtualTime + 1000);
+
+    TEST_ASSERT_EQUAL(1, pressCount);
+    TEST_ASSERT_EQUAL(0, repeatCount);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_initial_delay);
+    RUN_TEST(test_interval_accelerates);
+    RUN_TEST(test_missed_intervals_catch_up);
+    RUN_TEST(test_release_stops_repeat);
+    RUN_TEST(test_long_press_fires_once);
+    RUN_TEST(test_skipped_loops_resync);
+    return UNITY_END();
+}
@@ -0,0 +1,184 @@
+#include <unity.h>
+#include "../pad_fixture.h"
+#include "mapping/live_config.h"
+
+using namespace GenericController;
+
+static PadFixture *pad;
+static JoystickMappingConfig shadow;
+
+static const char *PROFILE_A = R"({"mappings": [
+    {"button": "A", "key": "a"},
+    {"button": "B", "key": "b"}
+]})";
+
+// Same A, different B
+static const char *PROFILE_B = R"({"mappings": [
+    {"button": "A", "key": "a"},
+    {"button": "B", "key": "c"}
+]})";
+
+// A sends another key
+static const char *PROFILE_X = R"({"mappings": [
+    {"button": "A", "key": "x"},
+    {"button": "B", "key": "b"}
+]})";
+
+// A taps y and holds Left Shift after 200 ms
+static const char *PROFILE_HOLD_A = R"({"mappings": [
+    {"button": "A", "key": "y", "hold": {"key": "L Shift", "ms": 200}},
+    {"button": "B", "key": "b"}
+]})";
+
+static const char *PROFILE_HOLD_B = R"({"mappings": [
+    {"button": "A", "key": "y", "hold": {"key": "L Shift", "ms": 200}},
+    {"button": "B", "key": "c"}
+]})";
+
+static const uint32_t A = 1u << BTN_SOUTH;
+static const uint32_t B = 1u << BTN_EAST;
+
+// Parse into the shadow copy and publish it, as the menus and loaders do
+static bool publish(LiveConfig &live, const char *json)
+{
+    TEST_ASSERT_TRUE(MappingConfig::loadConfig(json, strlen(json), "/Test.json", shadow));
+    return live.publish(shadow);
+}
+
+static int keyOf(const JoystickMappingConfig *config, uint8_t genericButton)
+{
+    for (int i = 0; i < config->numMappings; i++)
+    {
+        if (config->mappings[i].genericButton == genericButton)
+        {
+            return config->mappings[i].keyCode;
+        }
+    }
+    return 0;
+}
+
+void setUp(void)
+{
+    pad = new PadFixture();
+    TEST_ASSERT_TRUE(pad->load(PROFILE_A));
+    pad->frame(0);
+}
+
+void tearDown(void)
+{
+    delete pad;
+}
+
+static void test_publish_twice_before_take(void)
+{
+    LiveConfig live;
+    const JoystickMappingConfig *first = live.getActive();
+    TEST_ASSERT_TRUE(publish(live, PROFILE_B));
+    TEST_ASSERT_TRUE(publish(live, PROFILE_X));
+
+    // Nothing changes for the engine until it takes, and then it gets the last one
+    TEST_ASSERT_EQUAL_PTR(first, live.getActive());
+    const JoystickMappingConfig *taken = live.take();
+    TEST_ASSERT_NOT_NULL(taken);
+    TEST_ASSERT_EQUAL_PTR(taken, live.getActive());
+    TEST_ASSERT_EQUAL('x', keyOf(taken, BTN_SOUTH));
+    TEST_ASSERT_NULL(live.take());
+}
+
+static void test_publish_writes_the_spare_buffer(void)
+{
+    LiveConfig live;
+    TEST_ASSERT_TRUE(publish(live, PROFILE_B));
+    const JoystickMappingConfig *active = live.take();
+
+    // The next publish must not write into what the engine is running on
+    TEST_ASSERT_TRUE(publish(live, PROFILE_X));
+    TEST_ASSERT_EQUAL('a', keyOf(active, BTN_SOUTH));
+    TEST_ASSERT_EQUAL('c', keyOf(active, BTN_EAST));
+    const JoystickMappingConfig *next = live.take();
+    TEST_ASSERT_TRUE(next != active);
+    TEST_ASSERT_EQUAL('x', keyOf(next, BTN_SOUTH));
+}
+
+static void test_rejected_config_keeps_the_active_one(void)
+{
+    pad->hold(A, 5);
+    TEST_ASSERT_TRUE(Keyboard.isPressed('a'));
+
+    TEST_ASSERT_TRUE(MappingConfig::loadConfig(PROFILE_X, strlen(PROFILE_X), "/Test.json", shadow));
+    shadow.numLayers = 0;
+    TEST_ASSERT_FALSE(pad->live.publish(shadow));
+    TEST_ASSERT_NULL(pad->live.take());
+
+    // Still the old profile, key still down
+    pad->hold(A, 5);
+    TEST_ASSERT_TRUE(Keyboard.isPressed('a'));
+    TEST_ASSERT_FALSE(Keyboard.isPressed('x'));
+    TEST_ASSERT_EQUAL('a', keyOf(pad->live.getActive(), BTN_SOUTH));
+    pad->hold(0, 2);
+}
+
+static void test_held_key_survives_an_unrelated_edit(void)
+{
+    pad->hold(A, 5);
+    unsigned long releases = Keyboard.releaseCount;
+    unsigned long presses = Keyboard.pressCount;
+
+    TEST_ASSERT_TRUE(publish(pad->live, PROFILE_B));
+    pad->hold(A, 5);
+
+    // A's mapping did not change: no release, no second press
+    TEST_ASSERT_TRUE(Keyboard.isPressed('a'));
+    TEST_ASSERT_EQUAL(releases, Keyboard.releaseCount);
+    TEST_ASSERT_EQUAL(presses, Keyboard.pressCount);
+
+    // B maps to the new key
+    pad->hold(A | B, 2);
+    TEST_ASSERT_TRUE(Keyboard.isPressed('c'));
+    TEST_ASSERT_FALSE(Keyboard.isPressed('b'));
+    pad->hold(0, 2);
+    TEST_ASSERT_FALSE(Keyboard.isPressed('a'));
+    TEST_ASSERT_FALSE(Keyboard.isPressed('c'));
+}
+
+static void test_pending_hold_keeps_its_timer(void)
+{
+    TEST_ASSERT_TRUE(publish(pad->live, PROFILE_HOLD_A));
+    pad->hold(A, 100);
+
+    // Half way to the hold decision; an unrelated edit must not restart it
+    TEST_ASSERT_TRUE(publish(pad->live, PROFILE_HOLD_B));
+    pad->hold(A, 99);
+    TEST_ASSERT_FALSE(Keyboard.isPressed(KEY_LEFT_SHIFT));
+    pad->hold(A, 5);
+    TEST_ASSERT_TRUE(Keyboard.isPressed(KEY_LEFT_SHIFT));
+    TEST_ASSERT_FALSE(Keyboard.isPressed('y'));
+    pad->hold(0, 2);
+    TEST_ASSERT_FALSE(Keyboard.isPressed(KEY_LEFT_SHIFT));
+}
+
+static void test_held_key_switches_with_its_mapping(void)
+{
+    pad->hold(A, 5);
+    TEST_ASSERT_TRUE(publish(pad->live, PROFILE_X));
+
+    // The old key goes up as the old config had it, the new one goes down
+    pad->frame(A);
+    pad->frame(A);
+    TEST_ASSERT_FALSE(Keyboard.isPressed('a'));
+    TEST_ASSERT_TRUE(Keyboard.isPressed('x'));
+    pad->hold(0, 2);
+    TEST_ASSERT_FALSE(Keyboard.isPressed('x'));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_publish_twice_before_take);
+    RUN_TEST(test_publish_writes_the_spare_buffer);
+    RUN_TEST(test_rejected_config_keeps_the_active_one);
+    RUN_TEST(test_held_key_survives_an_unrelated_edit);
+    RUN_TEST(test_pending_hold_keeps_its_timer);
+    RUN_TEST(test_held_key_switches_with_its_mapping);
+    return UNITY_END();
+}
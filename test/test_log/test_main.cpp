@@ -0,0 +1,93 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "logging/log.h"
+
+static char line[Log::MAX_LINE];
+
+void setUp(void)
+{
+    while (Log::pop(line, sizeof(line)))
+    {
+    }
+}
+
+void tearDown(void)
+{
+}
+
+static void test_formats_integers(void)
+{
+    Log::write("Test: %d %u %x", -5, 7u, 255);
+    TEST_ASSERT_TRUE(Log::pop(line, sizeof(line)));
+    TEST_ASSERT_EQUAL_STRING("Test: -5 7 ff", line);
+    TEST_ASSERT_FALSE(Log::pop(line, sizeof(line)));
+}
+
+static void test_string_is_copied(void)
+{
+    // The buffer changes before the record is formatted
+    char name[16] = "Before";
+    Log::write("Test: %s done", name);
+    strcpy(name, "After");
+
+    TEST_ASSERT_TRUE(Log::pop(line, sizeof(line)));
+    TEST_ASSERT_EQUAL_STRING("Test: Before done", line);
+}
+
+static void test_several_strings_and_integers(void)
+{
+    char first[8] = "one";
+    Log::write("Test: %s %d %s", first, 2, "three");
+    first[0] = '\0';
+
+    TEST_ASSERT_TRUE(Log::pop(line, sizeof(line)));
+    TEST_ASSERT_EQUAL_STRING("Test: one 2 three", line);
+}
+
+static void test_long_strings_are_cut(void)
+{
+    // Strings share MAX_TEXT bytes; later ones get what is left
+    char longName[64];
+    memset(longName, 'a', sizeof(longName) - 1);
+    longName[sizeof(longName) - 1] = '\0';
+    Log::write("%s|%s", longName, "b");
+
+    TEST_ASSERT_TRUE(Log::pop(line, sizeof(line)));
+    TEST_ASSERT_EQUAL(Log::MAX_TEXT, strlen(line));
+    TEST_ASSERT_EQUAL('|', line[Log::MAX_TEXT - 1]);
+}
+
+static void test_null_string(void)
+{
+    const char *missing = nullptr;
+    Log::write("Test: %s", missing);
+    TEST_ASSERT_TRUE(Log::pop(line, sizeof(line)));
+    TEST_ASSERT_EQUAL_STRING("Test: (null)", line);
+}
+
+static void test_full_buffer_drops(void)
+{
+    uint32_t dropped = Log::getDroppedCount();
+    for (int i = 0; i < Log::CAPACITY + 3; i++)
+    {
+        Log::write("Test: %d", i);
+    }
+    TEST_ASSERT_EQUAL(Log::CAPACITY, Log::getPending());
+    TEST_ASSERT_EQUAL(dropped + 3, Log::getDroppedCount());
+
+    // Oldest first
+    TEST_ASSERT_TRUE(Log::pop(line, sizeof(line)));
+    TEST_ASSERT_EQUAL_STRING("Test: 0", line);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_formats_integers);
+    RUN_TEST(test_string_is_copied);
+    RUN_TEST(test_several_strings_and_integers);
+    RUN_TEST(test_long_strings_are_cut);
+    RUN_TEST(test_null_string);
+    RUN_TEST(test_full_buffer_drops);
+    return UNITY_END();
+}
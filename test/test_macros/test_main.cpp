@@ -0,0 +1,198 @@
+#include <unity.h>
+#include "../pad_fixture.h"
+#include "mapping/macro.h"
+
+using namespace GenericController;
+
+static uint8_t code[JoystickMappingConfig::MAX_MACRO_BYTES];
+static HidOutput *output;
+static MacroEngine *engine;
+
+static int compile(const char *steps)
+{
+    JsonDocument doc;
+    deserializeJson(doc, steps);
+    return Macro::compile(doc.as<JsonArray>(), code, sizeof(code));
+}
+
+// Tick the engine every millisecond up to and including time
+static void tickUntil(unsigned long time)
+{
+    while (millis() < time)
+    {
+        nativeClockAdvance(1);
+        engine->tick(millis());
+    }
+}
+
+void setUp(void)
+{
+    nativeClockSetManual(true);
+    nativeClockSet(1000);
+    output = new HidOutput();
+    engine = new MacroEngine();
+}
+
+void tearDown(void)
+{
+    engine->stopAll();
+    output->releaseAll();
+    delete engine;
+    delete output;
+}
+
+static void test_steps_follow_the_clock(void)
+{
+    TEST_ASSERT_GREATER_THAN(0, compile(R"(["+a", "wait 50", "-a", "b"])"));
+    TEST_ASSERT_TRUE(engine->start(code, output, 1000));
+
+    // Nothing runs until the first tick
+    TEST_ASSERT_FALSE(output->isKeyHeld('a'));
+    engine->tick(1000);
+    TEST_ASSERT_TRUE(output->isKeyHeld('a'));
+
+    tickUntil(1049);
+    TEST_ASSERT_TRUE(output->isKeyHeld('a'));
+
+    tickUntil(1050);
+    TEST_ASSERT_FALSE(output->isKeyHeld('a'));
+    TEST_ASSERT_TRUE(output->isKeyHeld('b'));
+
+    // A tap is held for exactly one tick
+    tickUntil(1051);
+    TEST_ASSERT_FALSE(output->isKeyHeld('b'));
+    TEST_ASSERT_EQUAL(0, engine->getActiveCount());
+}
+
+static void test_waits_do_not_drift(void)
+{
+    TEST_ASSERT_GREATER_THAN(0, compile(R"(["+a", "wait 10", "-a", "wait 10", "+b", "wait 50", "-b"])"));
+    engine->start(code, output, 1000);
+    engine->tick(1000);
+
+    // A late tick catches up; the next wait still ends 20 ms after the start
+    nativeClockSet(1015);
+    engine->tick(1015);
+    TEST_ASSERT_FALSE(output->isKeyHeld('a'));
+    TEST_ASSERT_FALSE(output->isKeyHeld('b'));
+
+    tickUntil(1019);
+    TEST_ASSERT_FALSE(output->isKeyHeld('b'));
+    tickUntil(1020);
+    TEST_ASSERT_TRUE(output->isKeyHeld('b'));
+}
+
+static void test_long_gap_runs_every_due_step(void)
+{
+    TEST_ASSERT_GREATER_THAN(0, compile(R"(["+a", "wait 5", "-a", "wait 5", "+b", "wait 5", "-b", "+c", "wait 500", "-c"])"));
+    engine->start(code, output, 1000);
+
+    nativeClockSet(1100);
+    engine->tick(1100);
+    TEST_ASSERT_FALSE(output->isKeyHeld('a'));
+    TEST_ASSERT_FALSE(output->isKeyHeld('b'));
+    TEST_ASSERT_TRUE(output->isKeyHeld('c'));
+
+    // Keys an unbalanced macro leaves down go up when it ends
+    TEST_ASSERT_GREATER_THAN(0, compile(R"(["+d"])"));
+    engine->start(code, output, 1100);
+    engine->tick(1100);
+    TEST_ASSERT_FALSE(output->isKeyHeld('d'));
+}
+
+static void test_macros_overlap(void)
+{
+    uint8_t second[32];
+    TEST_ASSERT_GREATER_THAN(0, compile(R"(["+b", "wait 5", "-b"])"));
+    memcpy(second, code, sizeof(second));
+    TEST_ASSERT_GREATER_THAN(0, compile(R"(["+a", "wait 20", "-a"])"));
+
+    engine->start(code, output, 1000);
+    engine->tick(1000);
+    tickUntil(1003);
+    engine->start(second, output, 1003);
+    engine->tick(1003);
+    TEST_ASSERT_EQUAL(2, engine->getActiveCount());
+    TEST_ASSERT_TRUE(output->isKeyHeld('a'));
+    TEST_ASSERT_TRUE(output->isKeyHeld('b'));
+
+    tickUntil(1008);
+    TEST_ASSERT_TRUE(output->isKeyHeld('a'));
+    TEST_ASSERT_FALSE(output->isKeyHeld('b'));
+
+    tickUntil(1020);
+    TEST_ASSERT_FALSE(output->isKeyHeld('a'));
+    TEST_ASSERT_EQUAL(0, engine->getActiveCount());
+}
+
+static void test_stop_releases_held_keys(void)
+{
+    TEST_ASSERT_GREATER_THAN(0, compile(R"(["+L Shift", "+a", "wait 1000", "-a", "-L Shift"])"));
+    engine->start(code, output, 1000);
+    engine->tick(1000);
+    TEST_ASSERT_TRUE(output->isKeyHeld(KEY_LEFT_SHIFT));
+
+    engine->stopAll();
+    TEST_ASSERT_FALSE(output->isKeyHeld(KEY_LEFT_SHIFT));
+    TEST_ASSERT_FALSE(output->isKeyHeld('a'));
+    TEST_ASSERT_EQUAL(0, engine->getActiveCount());
+}
+
+static void test_pool_full(void)
+{
+    TEST_ASSERT_GREATER_THAN(0, compile(R"(["wait 100"])"));
+    for (int i = 0; i < MacroEngine::MAX_EXECUTORS; i++)
+    {
+        TEST_ASSERT_TRUE(engine->start(code, output, 1000));
+    }
+    TEST_ASSERT_FALSE(engine->start(code, output, 1000));
+}
+
+static void test_macro_does_not_block_other_buttons(void)
+{
+    PadFixture pad;
+    TEST_ASSERT_TRUE(pad.load(R"({"mappings": [
+        {"button": "A", "macro": ["+x", "wait 100", "-x"]},
+        {"button": "B", "key": "b"}
+    ]})"));
+
+    pad.hold(button(BTN_SOUTH), 5);
+    TEST_ASSERT_TRUE(Keyboard.isPressed('x'));
+
+    pad.frame(button(BTN_EAST));
+    TEST_ASSERT_TRUE(Keyboard.isPressed('b'));
+    TEST_ASSERT_TRUE(Keyboard.isPressed('x'));
+
+    // The macro runs to the end after A is let go
+    pad.hold(0, 100);
+    TEST_ASSERT_FALSE(Keyboard.isPressed('x'));
+}
+
+static void test_skipped_mapping_takes_no_macro_space(void)
+{
+    JoystickMappingConfig config;
+    const char *json = R"({"mappings": [
+        {"button": "A", "layer": 9, "macro": ["+a", "wait 10", "-a"]},
+        {"button": "Nope", "macro": ["+a", "wait 10", "-a"]},
+        {"button": "B", "macro": ["+a", "wait 10", "-a"]}
+    ]})";
+    TEST_ASSERT_TRUE(MappingConfig::loadConfig(json, strlen(json), "/Test.json", config));
+
+    TEST_ASSERT_EQUAL(1, config.numMappings);
+    TEST_ASSERT_EQUAL(0, config.mappings[0].macro);
+    TEST_ASSERT_EQUAL(compile(R"(["+a", "wait 10", "-a"])"), config.macroCodeSize);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_steps_follow_the_clock);
+    RUN_TEST(test_waits_do_not_drift);
+    RUN_TEST(test_long_gap_runs_every_due_step);
+    RUN_TEST(test_macros_overlap);
+    RUN_TEST(test_stop_releases_held_keys);
+    RUN_TEST(test_pool_full);
+    RUN_TEST(test_macro_does_not_block_other_buttons);
+    RUN_TEST(test_skipped_mapping_takes_no_macro_space);
+    return UNITY_END();
+}
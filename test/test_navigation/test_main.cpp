@@ -0,0 +1,217 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <SD.h>
+#include "main.h"
+#include "devices.h"
+#include "actions/action_handler.h"
+#include "timing/timer_service.h"
+#include "mapping/mapping_config.h"
+
+// Menu navigation on the whole firmware, counting SD and LCD work through the
+// stubs. Going back must resume the action below, not initialise it again.
+extern DeviceManager devices;
+extern ActionHandler actionHandler;
+
+static JoystickController *pad;
+static LiquidCrystal_I2C *lcd;
+
+// PS4 hat values
+static const int HAT_UP = 0;
+static const int HAT_DOWN = 4;
+static const int HAT_CENTRE = 8;
+static const int HAT_AXIS = 9;
+
+static unsigned long sdOpens;
+static unsigned long lcdOps;
+static unsigned long lcdClears;
+
+static void runLoop()
+{
+    devices.updateSnapshots();
+    TimerService::update();
+    actionHandler.loop();
+    nativeClockAdvance(5);
+}
+
+// Two loops: the one that acts on the change and one to settle
+static void step()
+{
+    runLoop();
+    runLoop();
+}
+
+static void startCounting()
+{
+    sdOpens = SD.openCount;
+    lcdOps = lcd->opCount;
+    lcdClears = lcd->clearCount;
+}
+
+static void pressHat(int direction)
+{
+    pad->simSetAxis(HAT_AXIS, direction);
+    step();
+    pad->simSetAxis(HAT_AXIS, HAT_CENTRE);
+    step();
+}
+
+// Row 1-3 that carries the selection marker
+static int selectedRow()
+{
+    for (int row = 1; row < 4; row++)
+    {
+        if (lcd->getRow(row)[0] == '>')
+        {
+            return row;
+        }
+    }
+    return -1;
+}
+
+void setUp(void)
+{
+    actionHandler.popToRunAction();
+    step();
+}
+
+void tearDown(void)
+{
+}
+
+static void test_reentering_load_config_reads_the_card_once(void)
+{
+    actionHandler.activateMainMenu();
+    step();
+
+    startCounting();
+    actionHandler.activateLoadConfigMenu();
+    step();
+    TEST_ASSERT_LESS_OR_EQUAL(1, SD.openCount - sdOpens);
+
+    actionHandler.popAction();
+    step();
+    startCounting();
+    actionHandler.activateLoadConfigMenu();
+    step();
+    TEST_ASSERT_EQUAL(0, SD.openCount - sdOpens);
+    TEST_ASSERT_EQUAL_STRING("Configs             ", lcd->getRow(0));
+}
+
+static void test_back_to_main_menu_resumes(void)
+{
+    actionHandler.activateMainMenu();
+    step();
+    pressHat(HAT_DOWN);
+    TEST_ASSERT_EQUAL(2, selectedRow());
+
+    actionHandler.activateEditConfigMenu();
+    step();
+
+    // init() would switch the backlight on and could move the selection
+    lcd->noBacklight();
+    startCounting();
+    actionHandler.popAction();
+    step();
+
+    TEST_ASSERT_EQUAL(0, SD.openCount - sdOpens);
+    TEST_ASSERT_FALSE(lcd->isBacklightOn());
+    TEST_ASSERT_EQUAL_STRING("Main Menu           ", lcd->getRow(0));
+    TEST_ASSERT_EQUAL(2, selectedRow());
+    lcd->backlight();
+}
+
+static void test_back_to_run_keeps_the_profile(void)
+{
+    actionHandler.activateMainMenu();
+    step();
+    actionHandler.activateLoadConfigMenu();
+    step();
+
+    // Loading the profile again would open it on the card
+    startCounting();
+    actionHandler.popToRunAction();
+    step();
+    TEST_ASSERT_EQUAL(0, SD.openCount - sdOpens);
+    TEST_ASSERT_EQUAL_STRING("      Default       ", lcd->getRow(2));
+}
+
+static void test_menu_step_redraws_only_changes(void)
+{
+    actionHandler.activateMainMenu();
+    step();
+    actionHandler.activateLoadConfigMenu();
+    step();
+
+    startCounting();
+    pressHat(HAT_DOWN);
+    TEST_ASSERT_EQUAL(0, lcd->clearCount - lcdClears);
+    TEST_ASSERT_LESS_OR_EQUAL(20, lcd->opCount - lcdOps);
+
+    startCounting();
+    pressHat(HAT_UP);
+    TEST_ASSERT_EQUAL(0, lcd->clearCount - lcdClears);
+    TEST_ASSERT_LESS_OR_EQUAL(20, lcd->opCount - lcdOps);
+    TEST_ASSERT_EQUAL(0, SD.openCount - sdOpens);
+}
+
+static void test_save_refreshes_the_file_list(void)
+{
+    actionHandler.activateMainMenu();
+    step();
+    actionHandler.activateLoadConfigMenu();
+    step();
+    actionHandler.popToRunAction();
+    step();
+
+    // A new file on the card means one fresh listing
+    MappingConfig::saveConfig("/Zz.json", mappingConfig);
+    actionHandler.activateMainMenu();
+    step();
+    startCounting();
+    actionHandler.activateLoadConfigMenu();
+    step();
+    TEST_ASSERT_EQUAL(1, SD.openCount - sdOpens);
+
+    for (int i = 0; i < 20; i++)
+    {
+        pressHat(HAT_DOWN);
+    }
+    TEST_ASSERT_EQUAL_STRING(">Zz                 ", lcd->getRow(selectedRow()));
+}
+
+int main(int argc, char **argv)
+{
+    const char *profile = R"({"mappings":[{"button":"A","key":"a"}]})";
+    char filename[32];
+    for (int i = 0; i < 8; i++)
+    {
+        snprintf(filename, sizeof(filename), "/Cfg%02d.json", i);
+        SD.simWriteFile(filename, profile);
+    }
+    SD.simWriteFile("/Default.json", profile);
+
+    nativeClockSetManual(true);
+    nativeClockSet(1000);
+    setup();
+
+    pad = devices.getJoystick(0);
+    lcd = devices.getLCD();
+    pad->simConnect(JoystickController::PS4, 0x054C, 0x09CC);
+    for (int axis = 0; axis < HAT_AXIS; axis++)
+    {
+        pad->simSetAxis(axis, 128);
+    }
+    pad->simSetAxis(HAT_AXIS, HAT_CENTRE);
+    for (int i = 0; i < 5; i++)
+    {
+        runLoop();
+    }
+
+    UNITY_BEGIN();
+    RUN_TEST(test_reentering_load_config_reads_the_card_once);
+    RUN_TEST(test_back_to_main_menu_resumes);
+    RUN_TEST(test_back_to_run_keeps_the_profile);
+    RUN_TEST(test_menu_step_redraws_only_changes);
+    RUN_TEST(test_save_refreshes_the_file_list);
+    return UNITY_END();
+}
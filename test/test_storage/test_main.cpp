@@ -0,0 +1,251 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <string>
+#include "storage/memory_storage.h"
+#include "storage/cached_storage.h"
+#include "mapping/mapping_config.h"
+
+static MemoryStorage *memory;
+static CachedStorage *cache;
+
+static bool writeFile(Storage &storage, const char *path, const std::string &contents)
+{
+    StorageFile file = storage.open(path, StorageMode::WRITE);
+    return file && file.write((const uint8_t *)contents.data(), contents.size()) == contents.size();
+}
+
+static std::string readFile(Storage &storage, const char *path)
+{
+    StorageFile file = storage.open(path);
+    std::string contents;
+    int c;
+    while (file && (c = file.read()) >= 0)
+    {
+        contents += (char)c;
+    }
+    return contents;
+}
+
+// n bytes that differ from block to block
+static std::string pattern(size_t length, char seed)
+{
+    std::string contents;
+    for (size_t i = 0; i < length; i++)
+    {
+        contents += (char)(seed + (i / CachedStorage::BLOCK_SIZE) + (i % 7));
+    }
+    return contents;
+}
+
+static void collect(void *context, const char *name, const StorageStat &stat)
+{
+    (void)stat;
+    std::string *names = static_cast<std::string *>(context);
+    *names += name;
+    *names += ' ';
+}
+
+void setUp(void)
+{
+    memory = new MemoryStorage();
+    cache = new CachedStorage(*memory);
+}
+
+void tearDown(void)
+{
+    delete cache;
+    delete memory;
+}
+
+static void test_memory_round_trip(void)
+{
+    std::string contents = pattern(3000, 'a');
+    TEST_ASSERT_TRUE(writeFile(*memory, "/One.json", contents));
+    TEST_ASSERT_TRUE(readFile(*memory, "/One.json") == contents);
+
+    StorageStat stat;
+    TEST_ASSERT_TRUE(memory->stat("/One.json", stat));
+    TEST_ASSERT_EQUAL(3000, stat.size);
+
+    TEST_ASSERT_TRUE(memory->rename("/One.json", "/Two.json"));
+    TEST_ASSERT_FALSE(memory->exists("/One.json"));
+    TEST_ASSERT_TRUE(readFile(*memory, "/Two.json") == contents);
+
+    writeFile(*memory, "/Three.json", "x");
+    std::string names;
+    TEST_ASSERT_EQUAL(2, memory->list("/", collect, &names));
+    TEST_ASSERT_EQUAL_STRING("Two.json Three.json ", names.c_str());
+
+    TEST_ASSERT_TRUE(memory->remove("/Two.json"));
+    TEST_ASSERT_FALSE(memory->exists("/Two.json"));
+    TEST_ASSERT_FALSE((bool)memory->open("/Two.json"));
+}
+
+static void test_cache_serves_repeat_reads(void)
+{
+    std::string contents = pattern(1500, 'a');
+    writeFile(*memory, "/Profile.json", contents);
+    uint32_t opens = memory->openCount;
+
+    // One miss reads the whole file ahead, three blocks
+    TEST_ASSERT_TRUE(readFile(*cache, "/Profile.json") == contents);
+    TEST_ASSERT_EQUAL(opens + 1, memory->openCount);
+    TEST_ASSERT_EQUAL(3, memory->readCount);
+    TEST_ASSERT_EQUAL(1, cache->getMisses());
+
+    // Reopening costs the backend nothing
+    TEST_ASSERT_TRUE(readFile(*cache, "/Profile.json") == contents);
+    TEST_ASSERT_EQUAL(opens + 1, memory->openCount);
+    TEST_ASSERT_EQUAL(3, memory->readCount);
+    TEST_ASSERT_EQUAL(1, cache->getMisses());
+
+    StorageStat stat;
+    TEST_ASSERT_TRUE(cache->stat("/Profile.json", stat));
+    TEST_ASSERT_EQUAL(1500, stat.size);
+}
+
+static void test_changes_through_the_cache_invalidate(void)
+{
+    writeFile(*memory, "/A.json", "first");
+    TEST_ASSERT_EQUAL_STRING("first", readFile(*cache, "/A.json").c_str());
+
+    // Rewrite
+    TEST_ASSERT_TRUE(writeFile(*cache, "/A.json", "second, longer"));
+    TEST_ASSERT_EQUAL_STRING("second, longer", readFile(*cache, "/A.json").c_str());
+
+    // Rename over a cached file, and away from one
+    writeFile(*memory, "/B.json", "bee");
+    TEST_ASSERT_EQUAL_STRING("bee", readFile(*cache, "/B.json").c_str());
+    TEST_ASSERT_TRUE(cache->rename("/A.json", "/B.json"));
+    TEST_ASSERT_EQUAL_STRING("second, longer", readFile(*cache, "/B.json").c_str());
+    TEST_ASSERT_FALSE(cache->exists("/A.json"));
+    TEST_ASSERT_EQUAL_STRING("", readFile(*cache, "/A.json").c_str());
+
+    // Remove
+    TEST_ASSERT_TRUE(cache->remove("/B.json"));
+    TEST_ASSERT_FALSE(cache->exists("/B.json"));
+    TEST_ASSERT_FALSE((bool)cache->open("/B.json"));
+}
+
+static void test_invalidate_after_outside_change(void)
+{
+    writeFile(*memory, "/A.json", "old");
+    TEST_ASSERT_EQUAL_STRING("old", readFile(*cache, "/A.json").c_str());
+
+    // Changed behind the cache: it still has the old copy until told
+    writeFile(*memory, "/A.json", "new");
+    TEST_ASSERT_EQUAL_STRING("old", readFile(*cache, "/A.json").c_str());
+
+    cache->invalidate();
+    TEST_ASSERT_EQUAL_STRING("new", readFile(*cache, "/A.json").c_str());
+
+    // A new mount may be a different card
+    writeFile(*memory, "/A.json", "card");
+    cache->begin();
+    TEST_ASSERT_EQUAL_STRING("card", readFile(*cache, "/A.json").c_str());
+}
+
+static void test_least_recently_used_file_goes(void)
+{
+    char path[16];
+    for (int i = 0; i <= CachedStorage::MAX_CACHED_FILES; i++)
+    {
+        snprintf(path, sizeof(path), "/F%d.json", i);
+        writeFile(*memory, path, std::string(10, (char)('a' + i)));
+    }
+
+    // Fill the file table, then touch F0 so F1 is the oldest
+    for (int i = 0; i < CachedStorage::MAX_CACHED_FILES; i++)
+    {
+        snprintf(path, sizeof(path), "/F%d.json", i);
+        readFile(*cache, path);
+    }
+    readFile(*cache, "/F0.json");
+    snprintf(path, sizeof(path), "/F%d.json", CachedStorage::MAX_CACHED_FILES);
+    readFile(*cache, path);
+
+    uint32_t opens = memory->openCount;
+    readFile(*cache, "/F0.json");
+    readFile(*cache, "/F2.json");
+    TEST_ASSERT_EQUAL(opens, memory->openCount);
+
+    readFile(*cache, "/F1.json");
+    TEST_ASSERT_EQUAL(opens + 1, memory->openCount);
+}
+
+static void test_least_recently_used_blocks_go(void)
+{
+    // Two files of 12 blocks each overflow the 16 blocks; the first file's
+    // early blocks are the oldest and are read again, the rest are not
+    const uint32_t length = 12 * CachedStorage::BLOCK_SIZE;
+    std::string first = pattern(length, 'a');
+    std::string second = pattern(length, 'A');
+    writeFile(*memory, "/First.json", first);
+    writeFile(*memory, "/Second.json", second);
+
+    TEST_ASSERT_TRUE(readFile(*cache, "/First.json") == first);
+    TEST_ASSERT_TRUE(readFile(*cache, "/Second.json") == second);
+    TEST_ASSERT_EQUAL(24, memory->readCount);
+
+    uint32_t reads = memory->readCount;
+    TEST_ASSERT_TRUE(readFile(*cache, "/Second.json") == second);
+    TEST_ASSERT_EQUAL(reads, memory->readCount);
+
+    TEST_ASSERT_TRUE(readFile(*cache, "/First.json") == first);
+    TEST_ASSERT_GREATER_THAN(reads, memory->readCount);
+}
+
+static void test_open_file_survives_eviction(void)
+{
+    char path[16];
+    writeFile(*memory, "/Open.json", pattern(100, 'o'));
+    StorageFile open = cache->open("/Open.json");
+    TEST_ASSERT_TRUE((bool)open);
+
+    for (int i = 0; i < CachedStorage::MAX_CACHED_FILES + 2; i++)
+    {
+        snprintf(path, sizeof(path), "/F%d.json", i);
+        writeFile(*memory, path, "x");
+        readFile(*cache, path);
+    }
+
+    TEST_ASSERT_EQUAL(100, open.size());
+    TEST_ASSERT_EQUAL('o', open.read());
+}
+
+static void test_profile_round_trip_through_cache(void)
+{
+    Storage &previous = MappingConfig::getStorage();
+    MappingConfig::setStorage(*cache);
+
+    static JoystickMappingConfig config;
+    static JoystickMappingConfig loaded;
+    const char *json = R"({"mappings":[{"button":"A","key":"a"},{"button":"B","key":"L Shift"},{"button":"X","macro":"+c, wait 20, -c"}]})";
+    TEST_ASSERT_TRUE(MappingConfig::loadConfig(json, strlen(json), "/Trip.json", config));
+
+    TEST_ASSERT_TRUE(MappingConfig::saveConfig("/Trip.json", config));
+    std::string saved = readFile(*memory, "/Trip.json");
+    TEST_ASSERT_TRUE(saved.size() > 0);
+
+    // Load it back through the cache and save again: same bytes
+    TEST_ASSERT_TRUE(MappingConfig::loadConfig("/Trip.json", loaded));
+    TEST_ASSERT_TRUE(MappingConfig::saveConfig("/Again.json", loaded));
+    TEST_ASSERT_TRUE(readFile(*memory, "/Again.json") == saved);
+    TEST_ASSERT_EQUAL(config.numMappings, loaded.numMappings);
+
+    MappingConfig::setStorage(previous);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_memory_round_trip);
+    RUN_TEST(test_cache_serves_repeat_reads);
+    RUN_TEST(test_changes_through_the_cache_invalidate);
+    RUN_TEST(test_invalidate_after_outside_change);
+    RUN_TEST(test_least_recently_used_file_goes);
+    RUN_TEST(test_least_recently_used_blocks_go);
+    RUN_TEST(test_open_file_survives_eviction);
+    RUN_TEST(test_profile_round_trip_through_cache);
+    return UNITY_END();
+}
@@ -0,0 +1,140 @@
+#include <unity.h>
+#include <string>
+#include "../pad_fixture.h"
+
+using namespace GenericController;
+
+static PadFixture *pad;
+
+// A taps x and holds Left Shift after 200 ms; B is a plain key
+static const char *PROFILE = R"({"mappings": [
+    {"button": "A", "key": "x", "hold": {"key": "L Shift", "ms": 200}},
+    {"button": "B", "key": "b"}
+]})";
+
+static const uint32_t A = 1u << BTN_SOUTH;
+static const uint32_t B = 1u << BTN_EAST;
+
+struct Step
+{
+    int frames;
+    uint32_t buttons;
+};
+
+// Replay the steps, then let go, and return the key edges the host saw.
+// Edges in the same report are written together ("+S+b"), reports are
+// separated by spaces. S is Left Shift.
+static std::string replay(const Step *steps, int numSteps)
+{
+    const int keys[] = {KEY_LEFT_SHIFT, 'x', 'b'};
+    const char names[] = {'S', 'x', 'b'};
+    bool down[3] = {};
+    std::string log;
+
+    for (int s = 0; s <= numSteps; s++)
+    {
+        Step step = s < numSteps ? steps[s] : Step{400, 0};
+        for (int f = 0; f < step.frames; f++)
+        {
+            pad->frame(step.buttons);
+
+            std::string report;
+            for (int k = 0; k < 3; k++)
+            {
+                if (Keyboard.isPressed(keys[k]) != down[k])
+                {
+                    down[k] = !down[k];
+                    report += down[k] ? '+' : '-';
+                    report += names[k];
+                }
+            }
+            if (!report.empty())
+            {
+                log += log.empty() ? report : " " + report;
+            }
+        }
+    }
+    return log;
+}
+
+#define REPLAY(...)                                                   \
+    [] {                                                              \
+        const Step steps[] = {__VA_ARGS__};                           \
+        return replay(steps, sizeof(steps) / sizeof(steps[0]));       \
+    }()
+
+void setUp(void)
+{
+    pad = new PadFixture();
+    TEST_ASSERT_TRUE(pad->load(PROFILE));
+}
+
+void tearDown(void)
+{
+    delete pad;
+}
+
+static void test_tap(void)
+{
+    // The tap key goes down on release and up in the next report
+    TEST_ASSERT_EQUAL_STRING("+x -x", REPLAY({50, A}).c_str());
+}
+
+static void test_hold(void)
+{
+    TEST_ASSERT_EQUAL_STRING("+S -S", REPLAY({300, A}).c_str());
+}
+
+static void test_hold_decided_by_timer(void)
+{
+    // Pressed at 0 ms, the hold key goes out with the frame at 200 ms
+    pad->hold(A, 200);
+    TEST_ASSERT_FALSE(Keyboard.isPressed(KEY_LEFT_SHIFT));
+    TEST_ASSERT_FALSE(Keyboard.isPressed('x'));
+
+    pad->frame(A);
+    TEST_ASSERT_TRUE(Keyboard.isPressed(KEY_LEFT_SHIFT));
+}
+
+static void test_permissive_hold(void)
+{
+    // B tapped inside A's hold time: A is a modifier for B straight away
+    TEST_ASSERT_EQUAL_STRING("+S+b -b -S", REPLAY({20, A}, {20, A | B}, {20, A}).c_str());
+}
+
+static void test_permissive_hold_after_a_while(void)
+{
+    TEST_ASSERT_EQUAL_STRING("+S+b -b -S", REPLAY({150, A}, {20, A | B}, {10, A}).c_str());
+}
+
+static void test_rolling_presses(void)
+{
+    // A let go before B: A was a tap, and B follows it in order
+    TEST_ASSERT_EQUAL_STRING("+x+b -x -b", REPLAY({20, A}, {20, A | B}, {20, B}).c_str());
+}
+
+static void test_other_key_first(void)
+{
+    // B already down is sent at once; A is still a tap
+    TEST_ASSERT_EQUAL_STRING("+b +x -x -b", REPLAY({20, B}, {20, B | A}, {20, B}).c_str());
+}
+
+static void test_both_held_past_hold_time(void)
+{
+    // B waits for A's decision, then goes out behind the hold key
+    TEST_ASSERT_EQUAL_STRING("+S+b -S-b", REPLAY({5, A}, {300, A | B}).c_str());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_tap);
+    RUN_TEST(test_hold);
+    RUN_TEST(test_hold_decided_by_timer);
+    RUN_TEST(test_permissive_hold);
+    RUN_TEST(test_permissive_hold_after_a_while);
+    RUN_TEST(test_rolling_presses);
+    RUN_TEST(test_other_key_first);
+    RUN_TEST(test_both_held_past_hold_time);
+    return UNITY_END();
+}
@@ -0,0 +1,232 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "timing/timer_wheel.h"
+#include "timing/timer_service.h"
+
+static TimerWheel *wheel;
+
+// Firing time of each timer, by its data value
+static const int MAX_RECORDS = 16;
+static unsigned long fired[MAX_RECORDS];
+static int fireCount;
+
+static void record(void *context, uint32_t data)
+{
+    TimerWheel *owner = static_cast<TimerWheel *>(context);
+    fired[data] = owner->getTime();
+    fireCount++;
+}
+
+static void repeat(void *context, uint32_t period)
+{
+    TimerWheel *owner = static_cast<TimerWheel *>(context);
+    if (fireCount < MAX_RECORDS)
+    {
+        fired[fireCount++] = owner->getTime();
+        owner->schedule(period, repeat, owner, period);
+    }
+}
+
+// Advance one millisecond at a time, as the input frame does
+static void stepTo(unsigned long time)
+{
+    while (wheel->getTime() < time)
+    {
+        wheel->advance(wheel->getTime() + 1);
+    }
+}
+
+void setUp(void)
+{
+    wheel = new TimerWheel();
+    wheel->advance(1000);
+    fireCount = 0;
+    for (int i = 0; i < MAX_RECORDS; i++)
+    {
+        fired[i] = 0;
+    }
+}
+
+void tearDown(void)
+{
+    delete wheel;
+}
+
+static void test_fires_on_time_at_every_level(void)
+{
+    // Level 0, the level 1 boundary, level 1, and the overflow list
+    const unsigned long delays[] = {1, 63, 64, 65, 200, 4095, 4096, 10000};
+    const int count = sizeof(delays) / sizeof(delays[0]);
+    for (int i = 0; i < count; i++)
+    {
+        TEST_ASSERT_NOT_EQUAL(TimerWheel::INVALID_TIMER, wheel->schedule(delays[i], record, wheel, i));
+    }
+
+    stepTo(1000 + 10000);
+    TEST_ASSERT_EQUAL(count, fireCount);
+    for (int i = 0; i < count; i++)
+    {
+        TEST_ASSERT_EQUAL(1000 + delays[i], fired[i]);
+    }
+    TEST_ASSERT_EQUAL(0, wheel->getActiveCount());
+}
+
+static void test_fires_on_time_across_a_jump(void)
+{
+    // One advance() over many slots still files and fires each timer at its time
+    wheel->schedule(5, record, wheel, 0);
+    wheel->schedule(300, record, wheel, 1);
+    wheel->schedule(7000, record, wheel, 2);
+
+    wheel->advance(1299);
+    TEST_ASSERT_EQUAL(1, fireCount);
+    TEST_ASSERT_EQUAL(1005, fired[0]);
+
+    wheel->advance(20000);
+    TEST_ASSERT_EQUAL(3, fireCount);
+    TEST_ASSERT_EQUAL(1300, fired[1]);
+    TEST_ASSERT_EQUAL(8000, fired[2]);
+}
+
+static void test_not_before_expiry(void)
+{
+    wheel->schedule(100, record, wheel, 0);
+    stepTo(1099);
+    TEST_ASSERT_EQUAL(0, fireCount);
+    stepTo(1100);
+    TEST_ASSERT_EQUAL(1, fireCount);
+}
+
+static void test_zero_delay_is_next_millisecond(void)
+{
+    wheel->schedule(0, record, wheel, 0);
+    wheel->advance(1000);
+    TEST_ASSERT_EQUAL(0, fireCount);
+    wheel->advance(1001);
+    TEST_ASSERT_EQUAL(1, fireCount);
+}
+
+static void test_cancel(void)
+{
+    int level0 = wheel->schedule(10, record, wheel, 0);
+    int level1 = wheel->schedule(500, record, wheel, 1);
+    int overflow = wheel->schedule(9000, record, wheel, 2);
+    wheel->schedule(20, record, wheel, 3);
+
+    wheel->cancel(level0);
+    wheel->cancel(level1);
+    wheel->cancel(overflow);
+    TEST_ASSERT_EQUAL(1, wheel->getActiveCount());
+
+    wheel->advance(20000);
+    TEST_ASSERT_EQUAL(1, fireCount);
+    TEST_ASSERT_EQUAL(1020, fired[3]);
+}
+
+static void test_stale_id_is_ignored(void)
+{
+    // The slot is reused with a new generation; the old id must not stop it
+    int old = wheel->schedule(10, record, wheel, 0);
+    wheel->cancel(old);
+    int reused = wheel->schedule(10, record, wheel, 1);
+    TEST_ASSERT_NOT_EQUAL(old, reused);
+
+    wheel->cancel(old);
+    wheel->cancel(TimerWheel::INVALID_TIMER);
+    TEST_ASSERT_EQUAL(1, wheel->getActiveCount());
+
+    stepTo(1010);
+    TEST_ASSERT_EQUAL(1010, fired[1]);
+}
+
+static void test_cancel_all(void)
+{
+    wheel->schedule(10, record, wheel, 0);
+    wheel->schedule(1000, record, wheel, 1);
+    wheel->cancelAll();
+    TEST_ASSERT_EQUAL(0, wheel->getActiveCount());
+    wheel->advance(5000);
+    TEST_ASSERT_EQUAL(0, fireCount);
+}
+
+static void test_callback_reschedules_without_drift(void)
+{
+    // Delays inside a callback count from the firing time, even when
+    // advance() covers several periods at once
+    wheel->schedule(30, repeat, wheel, 30);
+    wheel->advance(1100);
+    stepTo(1150);
+
+    TEST_ASSERT_EQUAL(5, fireCount);
+    for (int i = 0; i < fireCount; i++)
+    {
+        TEST_ASSERT_EQUAL(1030 + 30 * i, fired[i]);
+    }
+}
+
+static void test_pool_full(void)
+{
+    for (int i = 0; i < TimerWheel::MAX_TIMERS; i++)
+    {
+        TEST_ASSERT_NOT_EQUAL(TimerWheel::INVALID_TIMER, wheel->schedule(100 + i, record, wheel, 0));
+    }
+    TEST_ASSERT_EQUAL(TimerWheel::INVALID_TIMER, wheel->schedule(1, record, wheel, 0));
+    TEST_ASSERT_EQUAL(TimerWheel::MAX_TIMERS, wheel->getActiveCount());
+}
+
+static unsigned long virtualTime;
+
+static unsigned long virtualClock()
+{
+    return virtualTime;
+}
+
+static void countFires(void *context, uint32_t data)
+{
+    (void)context;
+    (void)data;
+    fireCount++;
+}
+
+static void test_service_runs_on_injected_clock(void)
+{
+    virtualTime = 50000;
+    TimerService::setClock(virtualClock);
+    TEST_ASSERT_EQUAL(50000, TimerService::now());
+
+    // The idle wheel catches up with the clock before the delay is counted
+    int id = TimerService::schedule(100, countFires, nullptr);
+    virtualTime = 50099;
+    TimerService::update();
+    TEST_ASSERT_EQUAL(0, fireCount);
+    virtualTime = 50100;
+    TimerService::update();
+    TEST_ASSERT_EQUAL(1, fireCount);
+
+    // Cancel clears the caller's id
+    id = TimerService::schedule(10, countFires, nullptr);
+    TimerService::cancel(id);
+    TEST_ASSERT_EQUAL(TimerWheel::INVALID_TIMER, id);
+    virtualTime = 60000;
+    TimerService::update();
+    TEST_ASSERT_EQUAL(1, fireCount);
+
+    TimerService::setClock(nullptr);
+    TEST_ASSERT_EQUAL(millis(), TimerService::now());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fires_on_time_at_every_level);
+    RUN_TEST(test_fires_on_time_across_a_jump);
+    RUN_TEST(test_not_before_expiry);
+    RUN_TEST(test_zero_delay_is_next_millisecond);
+    RUN_TEST(test_cancel);
+    RUN_TEST(test_stale_id_is_ignored);
+    RUN_TEST(test_cancel_all);
+    RUN_TEST(test_callback_reschedules_without_drift);
+    RUN_TEST(test_pool_full);
+    RUN_TEST(test_service_runs_on_injected_clock);
+    return UNITY_END();
+}
@@ -0,0 +1,142 @@
+#include <unity.h>
+#include <string>
+#include "../pad_fixture.h"
+#include "actions/tuning_overlay.h"
+
+using namespace GenericController;
+
+static PadFixture *pad;
+
+// Select and Start have keys of their own and make the tuning chord together
+static const char *PROFILE = R"({"mappings": [
+    {"button": "Select", "key": "s"},
+    {"button": "Start", "key": "t"},
+    {"button": "A", "key": "a"}
+]})";
+
+static const uint32_t SELECT = 1u << BTN_SELECT;
+static const uint32_t START = 1u << BTN_START;
+static const uint32_t A = 1u << BTN_SOUTH;
+
+struct Step
+{
+    int frames;
+    uint32_t buttons;
+};
+
+// Replay the steps, then let go, and return the key edges the host saw,
+// as in test_tap_hold: "+s -s", reports separated by spaces
+static std::string replay(const Step *steps, int numSteps)
+{
+    const int keys[] = {'s', 't', 'a'};
+    bool down[3] = {};
+    std::string log;
+
+    for (int s = 0; s <= numSteps; s++)
+    {
+        Step step = s < numSteps ? steps[s] : Step{100, 0};
+        for (int f = 0; f < step.frames; f++)
+        {
+            pad->frame(step.buttons);
+
+            std::string report;
+            for (int k = 0; k < 3; k++)
+            {
+                if (Keyboard.isPressed(keys[k]) != down[k])
+                {
+                    down[k] = !down[k];
+                    report += down[k] ? '+' : '-';
+                    report += (char)keys[k];
+                }
+            }
+            if (!report.empty())
+            {
+                log += log.empty() ? report : " " + report;
+            }
+        }
+    }
+    return log;
+}
+
+#define REPLAY(...)                                                   \
+    [] {                                                              \
+        const Step steps[] = {__VA_ARGS__};                           \
+        return replay(steps, sizeof(steps) / sizeof(steps[0]));       \
+    }()
+
+void setUp(void)
+{
+    pad = new PadFixture();
+    TEST_ASSERT_TRUE(pad->load(PROFILE));
+    pad->pipeline.setChordButtons(TuningOverlay::CHORD);
+}
+
+void tearDown(void)
+{
+    delete pad;
+}
+
+static void test_chord_is_taken(void)
+{
+    // The first button maps at once and lets go when the chord completes
+    uint8_t chords = pad->pipeline.getChordCount();
+    TEST_ASSERT_EQUAL_STRING("+s -s", REPLAY({20, SELECT}, {500, SELECT | START}).c_str());
+    TEST_ASSERT_EQUAL(chords + 1, pad->pipeline.getChordCount());
+
+    // Held after the chord, what is left stays unmapped until let go
+    TEST_ASSERT_EQUAL_STRING("+t -t", REPLAY({30, START}, {200, SELECT | START}, {200, START}).c_str());
+    TEST_ASSERT_EQUAL(chords + 2, pad->pipeline.getChordCount());
+}
+
+static void test_together_sends_nothing(void)
+{
+    uint8_t chords = pad->pipeline.getChordCount();
+    TEST_ASSERT_EQUAL_STRING("", REPLAY({300, SELECT | START}).c_str());
+    TEST_ASSERT_EQUAL(chords + 1, pad->pipeline.getChordCount());
+}
+
+static void test_lone_press_is_not_delayed(void)
+{
+    pad->frame(START);
+    TEST_ASSERT_TRUE(Keyboard.isPressed('t'));
+    pad->frame(0);
+    TEST_ASSERT_FALSE(Keyboard.isPressed('t'));
+
+    TEST_ASSERT_EQUAL_STRING("+s -s", REPLAY({20, SELECT}).c_str());
+}
+
+static void test_late_second_button_is_no_chord(void)
+{
+    // Select held as a modifier: Start maps too, and the overlay stays shut
+    uint8_t chords = pad->pipeline.getChordCount();
+    TEST_ASSERT_EQUAL_STRING("+s +t -s-t", REPLAY({100, SELECT}, {100, SELECT | START}).c_str());
+    TEST_ASSERT_EQUAL(chords, pad->pipeline.getChordCount());
+}
+
+static void test_window_restarts_on_each_press(void)
+{
+    // Select gives way to Start in one frame; Start's press opens a new window
+    uint8_t chords = pad->pipeline.getChordCount();
+    TEST_ASSERT_EQUAL_STRING("+s -s+t -t", REPLAY({45, SELECT}, {15, START}, {20, SELECT | START}).c_str());
+    TEST_ASSERT_EQUAL(chords + 1, pad->pipeline.getChordCount());
+}
+
+static void test_other_buttons_map_alongside(void)
+{
+    pad->frame(SELECT | A);
+    TEST_ASSERT_TRUE(Keyboard.isPressed('a'));
+    TEST_ASSERT_TRUE(Keyboard.isPressed('s'));
+    pad->hold(0, 2);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_chord_is_taken);
+    RUN_TEST(test_together_sends_nothing);
+    RUN_TEST(test_lone_press_is_not_delayed);
+    RUN_TEST(test_late_second_button_is_no_chord);
+    RUN_TEST(test_window_restarts_on_each_press);
+    RUN_TEST(test_other_buttons_map_alongside);
+    return UNITY_END();
+}
@@ -0,0 +1,125 @@
+#include <unity.h>
+#include "../pad_fixture.h"
+
+using namespace GenericController;
+
+static PadFixture *pad;
+
+// Key edges seen by the host, in ms since the button went down
+static const int MAX_EDGES = 16;
+static unsigned long edges[MAX_EDGES];
+static int numEdges;
+
+static void loadTurbo(int rate, int duty)
+{
+    char json[128];
+    snprintf(json, sizeof(json), R"({"mappings": [{"button": "A", "key": "t", "turbo": {"rate": %d, "duty": %d}}]})", rate, duty);
+    TEST_ASSERT_TRUE(pad->load(json));
+}
+
+// Hold A for the given time, then let go for as long again
+static void pulse(int holdMs)
+{
+    unsigned long start = millis();
+    bool down = false;
+    numEdges = 0;
+
+    for (int ms = 0; ms < 2 * holdMs; ms++)
+    {
+        pad->frame(ms < holdMs ? button(BTN_SOUTH) : 0);
+        if (Keyboard.isPressed('t') != down && numEdges < MAX_EDGES)
+        {
+            down = !down;
+            edges[numEdges++] = millis() - 1 - start;
+        }
+    }
+}
+
+void setUp(void)
+{
+    pad = new PadFixture();
+}
+
+void tearDown(void)
+{
+    delete pad;
+}
+
+static void test_rate_and_duty(void)
+{
+    // 10 Hz at 50%: 50 ms down, 50 ms up, first press straight away
+    loadTurbo(10, 50);
+    pulse(320);
+
+    const unsigned long expected[] = {0, 50, 100, 150, 200, 250, 300, 320};
+    TEST_ASSERT_EQUAL(8, numEdges);
+    TEST_ASSERT_EQUAL_MEMORY(expected, edges, sizeof(expected));
+}
+
+static void test_uneven_duty(void)
+{
+    // 20 Hz at 25%: 12 ms of each 50 ms period down
+    loadTurbo(20, 25);
+    pulse(120);
+
+    const unsigned long expected[] = {0, 12, 50, 62, 100, 112};
+    TEST_ASSERT_EQUAL(6, numEdges);
+    TEST_ASSERT_EQUAL_MEMORY(expected, edges, sizeof(expected));
+}
+
+static void test_duty_clamped_to_maximum(void)
+{
+    loadTurbo(10, 99);
+    TEST_ASSERT_EQUAL(ButtonMapping::MAX_TURBO_DUTY, pad->config.mappings[0].turboDuty);
+    pulse(250);
+
+    const unsigned long expected[] = {0, 90, 100, 190, 200, 250};
+    TEST_ASSERT_EQUAL(6, numEdges);
+    TEST_ASSERT_EQUAL_MEMORY(expected, edges, sizeof(expected));
+}
+
+static void test_duty_clamped_to_minimum(void)
+{
+    loadTurbo(10, 1);
+    TEST_ASSERT_EQUAL(ButtonMapping::MIN_TURBO_DUTY, pad->config.mappings[0].turboDuty);
+    pulse(250);
+
+    const unsigned long expected[] = {0, 10, 100, 110, 200, 210};
+    TEST_ASSERT_EQUAL(6, numEdges);
+    TEST_ASSERT_EQUAL_MEMORY(expected, edges, sizeof(expected));
+}
+
+static void test_release_stops_pulses(void)
+{
+    // Let go in the key-down part: the key goes up at once and stays up
+    loadTurbo(10, 50);
+    pulse(130);
+
+    const unsigned long expected[] = {0, 50, 100, 130};
+    TEST_ASSERT_EQUAL(4, numEdges);
+    TEST_ASSERT_EQUAL_MEMORY(expected, edges, sizeof(expected));
+    TEST_ASSERT_EQUAL(0, pad->timers.getActiveCount());
+}
+
+static void test_rate_out_of_range_disables_turbo(void)
+{
+    loadTurbo(ButtonMapping::MAX_TURBO_RATE + 1, 50);
+    TEST_ASSERT_EQUAL(0, pad->config.mappings[0].turboRate);
+    pulse(200);
+
+    const unsigned long expected[] = {0, 200};
+    TEST_ASSERT_EQUAL(2, numEdges);
+    TEST_ASSERT_EQUAL_MEMORY(expected, edges, sizeof(expected));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_rate_and_duty);
+    RUN_TEST(test_uneven_duty);
+    RUN_TEST(test_duty_clamped_to_maximum);
+    RUN_TEST(test_duty_clamped_to_minimum);
+    RUN_TEST(test_release_stops_pulses);
+    RUN_TEST(test_rate_out_of_range_disables_turbo);
+    return UNITY_END();
+}
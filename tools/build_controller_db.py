@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+"""Build controllers.bin for ControllerDatabase from a JSON description.
+
+Usage: build_controller_db.py [controllers.json] [controllers.bin]
+
+Copy the output to the root of the SD card. The record layout must match
+include/mapping/controller_database.h.
+"""
+
+import json
+import struct
+import sys
+
+MAGIC = b"GPDB"
+VERSION = 1
+RECORD_SIZE = 64
+NO_MAPPING = 0xFF
+
+JOY_TYPES = {
+    "UNKNOWN": 0, "PS3": 1, "PS4": 2, "XBOXONE": 3,
+    "XBOX360": 4, "PS3_MOTION": 5, "SPACENAV": 6, "SWITCH": 7,
+}
+
+DPAD_ENCODINGS = {"buttons": 0, "hat": 1}
+
+# Generic axis order and button names, as in joystick_mappings.h/.cpp
+AXES = ["LX", "LY", "RX", "RY", "LT", "RT"]
+BUTTONS = [
+    "A", "B", "X", "Y", "L1", "R1", "L2", "R2", "Select", "Start",
+    "Menu", "L3", "R3", "Up", "Down", "Left", "Right", "Touchpad",
+]
+
+
+def parse_int(value):
+    return int(value, 0) if isinstance(value, str) else int(value)
+
+
+def build_record(entry):
+    name = entry["name"]
+    axes = entry.get("axes", {})
+    buttons = entry.get("buttons", {})
+
+    axis_map = [parse_int(axes[a]) if a in axes else NO_MAPPING for a in AXES]
+
+    button_map = [NO_MAPPING] * 32
+    for physical, generic in buttons.items():
+        physical = parse_int(physical)
+        if not 0 <= physical < 32:
+            raise ValueError(f"{name}: physical button {physical} out of range")
+        if generic not in BUTTONS:
+            raise ValueError(f"{name}: unknown generic button '{generic}'")
+        button_map[physical] = BUTTONS.index(generic)
+
+    stick_min, stick_max = entry.get("stick", [0, 255])
+    trigger_min, trigger_max = entry.get("trigger", [0, 255])
+
+    record = struct.pack(
+        "<HHBBBBhhhh6B2x32B8s",
+        parse_int(entry.get("vid", 0)),
+        parse_int(entry.get("pid", 0)),
+        JOY_TYPES[entry.get("type", "UNKNOWN").upper()],
+        DPAD_ENCODINGS[entry.get("dpad", "buttons")],
+        parse_int(entry.get("dpadAxis", 0)),
+        0,
+        stick_min, stick_max, trigger_min, trigger_max,
+        *axis_map,
+        *button_map,
+        name.encode("ascii")[:8],
+    )
+    assert len(record) == RECORD_SIZE
+    return record
+
+
+def main():
+    src = sys.argv[1] if len(sys.argv) > 1 else "controllers.json"
+    dst = sys.argv[2] if len(sys.argv) > 2 else "controllers.bin"
+
+    with open(src) as f:
+        controllers = json.load(f)["controllers"]
+
+    records = [build_record(entry) for entry in controllers]
+
+    with open(dst, "wb") as f:
+        f.write(MAGIC + struct.pack("<BBH", VERSION, RECORD_SIZE, len(records)))
+        for record in records:
+            f.write(record)
+
+    print(f"Wrote {len(records)} layouts to {dst}")
+
+
+if __name__ == "__main__":
+    main()